@@ -0,0 +1,183 @@
+/*
+	==============================================================================
+	AnalysisDecimator.h
+
+	Decimatore a cascata di filtri half-band polifase per il percorso di analisi.
+
+	Porta il segnale in ingresso al DissonanceAnalyser a una frequenza di
+	analisi fissa (<= MAX_ANALYSIS_RATE, cioe' 44.1/48 kHz) qualunque sia la
+	frequenza di campionamento dell'host. Cosi' la risoluzione in frequenza
+	della FFT e il numero di frame analizzati al secondo non dipendono piu'
+	dalla sessione (88.2/96/176.4/192/384 kHz).
+
+	Struttura:
+		- ogni stadio dimezza la frequenza (decimazione per 2)
+		- gli stadi iniziali usano un half-band corto (transizione larghissima:
+		  devono solo proteggere la banda 0..24 kHz dagli alias)
+		- l'ultimo stadio usa un half-band lungo con transizione stretta
+		  attorno a fs_out / 2
+		- forma polifase: si calcola un'uscita ogni due ingressi e, essendo
+		  half-band, i tap pari (tranne il centrale) sono nulli e i dispari
+		  sono simmetrici → (NumTaps + 1) / 4 moltiplicazioni per uscita
+
+	Nessuna allocazione dinamica in pushSample().
+	==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cmath>
+
+//==============================================================================
+// Singolo stadio half-band (decimazione per 2).
+// NumTaps = 4K - 1: gli estremi cadono su tap dispari, quindi sono non nulli.
+template <int NumTaps>
+class HalfBandDecimatorStage
+{
+public:
+	static_assert ((NumTaps + 1) % 4 == 0, "NumTaps deve essere nella forma 4K - 1");
+
+	static constexpr int CENTRE = (NumTaps - 1) / 2;
+	static constexpr int NUM_ODD_TAPS = (NumTaps + 1) / 4;   // tap dispari unici (simmetria)
+
+	explicit HalfBandDecimatorStage(float kaiserBeta)
+	{
+		// Sinc ideale half-band (cutoff fs/4) pesato con finestra di Kaiser:
+		//   h[d] = sin(pi*d/2) / (pi*d) * w[d],  h[0] = 0.5
+		std::array<float, NumTaps> kaiser{};
+		juce::dsp::WindowingFunction<float>::fillWindowingTables(
+			kaiser.data(), NumTaps,
+			juce::dsp::WindowingFunction<float>::kaiser, false, kaiserBeta);
+
+		float sum = 0.0f;
+		for (int i = 0; i < NUM_ODD_TAPS; ++i)
+		{
+			const int d = 2 * i + 1;
+			const double sinc = std::sin(juce::MathConstants<double>::halfPi * d)
+				/ (juce::MathConstants<double>::pi * d);
+			oddTaps[i] = (float)sinc * kaiser[CENTRE + d];
+			sum += 2.0f * oddTaps[i];
+		}
+
+		// Guadagno in DC unitario: 0.5 (centrale) + somma dei dispari = 1
+		for (auto& t : oddTaps)
+			t *= 0.5f / sum;
+
+		reset();
+	}
+
+	void reset() noexcept
+	{
+		delayLine.fill(0.0f);
+		writePos = 0;
+		phase = 0;
+	}
+
+	// Restituisce true quando e' disponibile un campione decimato in 'out'
+	bool pushSample(float in, float& out) noexcept
+	{
+		// Linea di ritardo duplicata: x[0] = piu' recente, x[NumTaps-1] = piu' vecchio,
+		// sempre contigui senza wrap-around
+		writePos = (writePos == 0 ? NumTaps : writePos) - 1;
+		delayLine[writePos] = in;
+		delayLine[writePos + NumTaps] = in;
+
+		phase ^= 1;
+		if (phase != 0)
+			return false;
+
+		const float* x = delayLine.data() + writePos;
+		float acc = 0.5f * x[CENTRE];
+
+		for (int i = 0; i < NUM_ODD_TAPS; ++i)
+		{
+			const int d = 2 * i + 1;
+			acc += oddTaps[i] * (x[CENTRE - d] + x[CENTRE + d]);
+		}
+
+		out = acc;
+		return true;
+	}
+
+private:
+	std::array<float, NUM_ODD_TAPS> oddTaps{};
+	std::array<float, NumTaps * 2>  delayLine{};
+	int writePos = 0;
+	int phase = 0;
+};
+
+//==============================================================================
+class AnalysisDecimator
+{
+public:
+	//============================================================================
+	static constexpr int    MAX_STAGES = 3;                  // fino a 384 kHz
+	static constexpr double MAX_ANALYSIS_RATE = 50000.0;     // 44.1/48 kHz restano invariati
+	static constexpr int    COARSE_TAPS = 11;
+	static constexpr int    FINE_TAPS = 63;
+
+	//============================================================================
+	AnalysisDecimator()
+		: coarseStages{ { HalfBandDecimatorStage<COARSE_TAPS>(5.0f),
+						  HalfBandDecimatorStage<COARSE_TAPS>(5.0f) } },
+		  fineStage(7.0f)
+	{
+	}
+
+	//============================================================================
+	// Sceglie il numero di stadi: si dimezza finche' la frequenza supera
+	// MAX_ANALYSIS_RATE (88.2/96 kHz → 1 stadio, 176.4/192 kHz → 2 stadi)
+	void prepare(double sampleRate) noexcept
+	{
+		numStages = 0;
+		outputSampleRate = sampleRate;
+
+		while (outputSampleRate > MAX_ANALYSIS_RATE && numStages < MAX_STAGES)
+		{
+			outputSampleRate *= 0.5;
+			++numStages;
+		}
+
+		reset();
+	}
+
+	void reset() noexcept
+	{
+		for (auto& s : coarseStages)
+			s.reset();
+		fineStage.reset();
+	}
+
+	//============================================================================
+	// Restituisce true quando 'out' contiene un nuovo campione alla frequenza
+	// di analisi. Con numStages == 0 e' un pass-through.
+	bool pushSample(float in, float& out) noexcept
+	{
+		if (numStages == 0)
+		{
+			out = in;
+			return true;
+		}
+
+		float x = in;
+		for (int i = 0; i < numStages - 1; ++i)
+			if (! coarseStages[(size_t)i].pushSample(x, x))
+				return false;
+
+		return fineStage.pushSample(x, out);
+	}
+
+	//============================================================================
+	double getOutputSampleRate() const noexcept { return outputSampleRate; }
+	int    getDecimationFactor() const noexcept { return 1 << numStages; }
+
+private:
+	std::array<HalfBandDecimatorStage<COARSE_TAPS>, MAX_STAGES - 1> coarseStages;
+	HalfBandDecimatorStage<FINE_TAPS> fineStage;
+
+	int    numStages = 0;
+	double outputSampleRate = 44100.0;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalysisDecimator)
+};
@@ -0,0 +1,262 @@
+/*
+	==============================================================================
+	CrossDissonanceAnalyser.h
+
+	Dissonanza incrociata tra due segnali (ingresso principale e sidechain):
+	misura quanto i due si scontrano tra loro, ignorando la dissonanza
+	interna a ciascuno (un accordo dissonante sul solo ingresso principale,
+	con la sidechain muta, da' 0).
+
+	Algoritmo:
+		0. Decima entrambi gli ingressi alla frequenza di analisi (due
+		   AnalysisDecimator indipendenti, vedi AnalysisDecimator.h)
+		1. Accumula i campioni in due buffer circolari di FFT_SIZE
+		2. Ogni mezzo frame un solo passaggio di finestra di Hann costruisce
+		   z[n] = h[n] (m[n] + j s[n]) ed esegue una sola FFT complessa: le due
+		   trasformate reali stanno nella parte reale e immaginaria. Con
+		   FrequencyEstimator::Reassignment ogni segnale ha invece la sua FFT
+		   (finestra e derivata impacchettate)
+		3. Separa gli spettri ed estrae i parziali di ciascuno: buffer,
+		   finestra, separazione, soglia e stima della frequenza sono quelli
+		   del DissonanceAnalyser (vedi SpectralPeakPicker.h)
+		4. Somma il modello a coppie (vedi DissonanceModels.h) solo sulle
+		   coppie miste principale x sidechain, normalizzata dai pesi delle
+		   stesse coppie
+		5. Espone il risultato in [0,1] via atomic
+
+	Finestra e piani FFT condivisi con gli altri analizzatori del processo
+	(vedi SharedAnalysisTables.h). Nessuna allocazione dinamica in pushSample().
+	==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "AnalysisDecimator.h"
+#include "DissonanceAnalyser.h"
+#include "DissonanceModels.h"
+#include "SharedAnalysisTables.h"
+#include "SpectralPeakPicker.h"
+
+class CrossDissonanceAnalyser
+{
+public:
+	//============================================================================
+	static constexpr int   FFT_SIZE = DissonanceAnalyser::FFT_SIZE;
+	static constexpr int   FFT_ORDER = DissonanceAnalyser::FFT_ORDER;
+	static constexpr int   MIN_FFT_ORDER = DissonanceAnalyser::MIN_FFT_ORDER;
+	static constexpr int   MAX_PARTIALS = DissonanceAnalyser::MAX_PARTIALS;     // per segnale
+	static constexpr float AMPLITUDE_THRESHOLD = DissonanceAnalyser::AMPLITUDE_THRESHOLD;
+
+	using FrameTimings = DissonanceAnalyser::FrameTimings;
+	using FrequencyEstimator = DissonanceAnalyser::FrequencyEstimator;
+	using Partial = SpectralPeakPicker::Partial;
+
+	//============================================================================
+	CrossDissonanceAnalyser()
+		: tables(&sharedTables->getConfiguration(FFT_ORDER)),
+		  leaseHint(sharedTables->nextLeaseHint())
+	{
+	}
+
+	//============================================================================
+	// Come DissonanceAnalyser::prepare(): frame e hop in campioni di analisi.
+	// Puo' allocare (prima richiesta delle tabelle condivise): non chiamare
+	// dal thread audio.
+	void prepare(double sampleRate, int newFrameOrder = FFT_ORDER)
+	{
+		mainDecimator.prepare(sampleRate);
+		sideDecimator.prepare(sampleRate);
+		currentSampleRate = static_cast<float> (mainDecimator.getOutputSampleRate());
+
+		newFrameOrder = juce::jlimit(MIN_FFT_ORDER, FFT_ORDER, newFrameOrder);
+		if (newFrameOrder != frameOrder)
+		{
+			frameOrder = newFrameOrder;
+			tables = &sharedTables->getConfiguration(frameOrder);
+		}
+
+		reset();
+	}
+
+	int getFrameSize() const noexcept { return 1 << frameOrder; }
+
+	void setDissonanceModel(DissonanceModel m) noexcept { dissonanceModel.store((int)m); }
+	DissonanceModel getDissonanceModel() const noexcept { return (DissonanceModel)dissonanceModel.load(); }
+
+	// Come nel DissonanceAnalyser: applicato al frame successivo. La
+	// riassegnazione costa una FFT per segnale invece di una per entrambi.
+	void setFrequencyEstimator(FrequencyEstimator e) noexcept { frequencyEstimator.store((int)e); }
+	FrequencyEstimator getFrequencyEstimator() const noexcept { return (FrequencyEstimator)frequencyEstimator.load(); }
+
+	//============================================================================
+	// Un campione mono per ingresso alla frequenza dell'host — nessuna allocazione.
+	// I due decimatori sono identici e avanzano insieme, quindi escono in fase.
+	void pushSample(float mainSample, float sideSample) noexcept
+	{
+		float decimatedMain, decimatedSide;
+		const bool ready = mainDecimator.pushSample(mainSample, decimatedMain);
+		sideDecimator.pushSample(sideSample, decimatedSide);
+
+		if (ready)
+			pushAnalysisSample(decimatedMain, decimatedSide);
+	}
+
+	//============================================================================
+	// Dissonanza incrociata normalizzata [0,1]: 0 = i due segnali non si
+	// scontrano (o uno dei due e' muto), 1 = massima dissonanza
+	float getDissonance() const noexcept { return dissonanceValue.load(); }
+
+	float getAnalysisSampleRate() const noexcept { return currentSampleRate; }
+
+	// Parziali dell'ultimo frame per ciascun ingresso. Solo dal thread che
+	// chiama pushSample() (o offline, nei test).
+	int   getNumMainPartials() const noexcept { return numMainPartials; }
+	int   getNumSidePartials() const noexcept { return numSidePartials; }
+	float getMainPartialFrequency(int i) const noexcept { return mainPartials[(size_t)i].freq; }
+	float getSidePartialFrequency(int i) const noexcept { return sidePartials[(size_t)i].freq; }
+	float getMainPartialAmplitude(int i) const noexcept { return mainPartials[(size_t)i].amp; }
+	float getSidePartialAmplitude(int i) const noexcept { return sidePartials[(size_t)i].amp; }
+
+	// Intervalli di analyseFrame(), come DissonanceAnalyser::getFrameTimings()
+	const FrameTimings& getFrameTimings() const noexcept { return frameTimings; }
+	void clearFrameTimings() noexcept { frameTimings.totalTicks = 0; frameTimings.numFrames = 0; }
+	void setFrameTimingEnabled(bool shouldBeEnabled) noexcept { frameTimings.enabled = shouldBeEnabled; }
+	juce::uint32 getFrameCount() const noexcept { return frameCount; }
+
+	// Frame saltati perche' nessun piano FFT condiviso era libero
+	int getNumSkippedFrames() const noexcept { return skippedFrames; }
+
+	//============================================================================
+	void reset() noexcept
+	{
+		mainDecimator.reset();
+		sideDecimator.reset();
+		mainRing.clear();
+		sideRing.clear();
+		sampleCount = 0;
+		numMainPartials = 0;
+		numSidePartials = 0;
+		dissonanceValue.store(0.0f);
+	}
+
+	//============================================================================
+	// 4. Solo le coppie miste: numA x numB termini, nessuna coppia interna a un
+	// insieme. Usata anche fuori dall'analizzatore (matrice di sessione).
+	template <typename Model>
+	static float computeCrossDissonance(const Partial* a, int numA, const Partial* b, int numB) noexcept
+	{
+		float totalDissonance = 0.0f;
+		float maxDissonance = 0.0f;
+
+		for (int i = 0; i < numA; ++i)
+		{
+			for (int j = 0; j < numB; ++j)
+			{
+				const bool aLower = a[i].freq <= b[j].freq;
+
+				totalDissonance += aLower ? Model::pair(a[i].freq, b[j].freq, a[i].amp, b[j].amp)
+				                          : Model::pair(b[j].freq, a[i].freq, b[j].amp, a[i].amp);
+				maxDissonance += Model::weight(a[i].amp, b[j].amp);
+			}
+		}
+
+		if (maxDissonance <= 1e-6f)
+			return 0.0f;
+
+		return juce::jlimit(0.0f, 1.0f, totalDissonance / maxDissonance);
+	}
+
+private:
+	//============================================================================
+	void pushAnalysisSample(float mainSample, float sideSample) noexcept
+	{
+		mainRing.push(mainSample);
+		sideRing.push(sideSample);
+
+		if (++sampleCount < (1 << frameOrder) / 2)
+			return;
+
+		sampleCount = 0;
+
+		frameTimings.measure([this] { analyseFrame(); });
+		++frameCount;
+	}
+
+	//============================================================================
+	void analyseFrame() noexcept
+	{
+		// Piano condiviso in prestito; tutti occupati: si salta il frame
+		const auto fft = tables->tryLease(leaseHint);
+		if (! fft)
+		{
+			++skippedFrames;
+			return;
+		}
+
+		mainPeaks.beginFrame(frameOrder);
+		sidePeaks.beginFrame(frameOrder);
+
+		if (getFrequencyEstimator() == FrequencyEstimator::Reassignment)
+		{
+			mainPeaks.addSignal(mainRing, *tables, fft, FrequencyEstimator::Reassignment);
+			sidePeaks.addSignal(sideRing, *tables, fft, FrequencyEstimator::Reassignment);
+		}
+		else
+		{
+			// 2. Una sola finestra e una sola FFT per i due segnali: z = h (m + j s)
+			SpectralPeakPicker::addSignalPair(mainRing, mainPeaks, sideRing, sidePeaks, *tables, fft);
+		}
+
+		// 3. Spettri separati, parziali di ciascuno
+		mainPeaks.finishFrame();
+		sidePeaks.finishFrame();
+		numMainPartials = mainPeaks.findPartials(currentSampleRate, mainPartials.data());
+		numSidePartials = sidePeaks.findPartials(currentSampleRate, sidePartials.data());
+
+		dissonanceValue.store(evaluateModel());
+	}
+
+	//============================================================================
+	// 4. Modello scelto una volta per frame, come nel DissonanceAnalyser
+	float evaluateModel() const noexcept
+	{
+		const auto* m = mainPartials.data();
+		const auto* s = sidePartials.data();
+
+		switch ((DissonanceModel)dissonanceModel.load())
+		{
+			case DissonanceModel::Vassilakis:        return computeCrossDissonance<VassilakisModel>(m, numMainPartials, s, numSidePartials);
+			case DissonanceModel::HutchinsonKnopoff: return computeCrossDissonance<HutchinsonKnopoffModel>(m, numMainPartials, s, numSidePartials);
+			case DissonanceModel::Sethares:
+			default:                                 return computeCrossDissonance<SetharesModel>(m, numMainPartials, s, numSidePartials);
+		}
+	}
+
+	//============================================================================
+	AnalysisDecimator mainDecimator, sideDecimator;
+	juce::SharedResourcePointer<SharedAnalysisTables> sharedTables;
+	const SharedAnalysisTables::Configuration* tables;
+	const int leaseHint;
+	int skippedFrames = 0;
+
+	SpectralPeakPicker::Ring mainRing, sideRing;
+	SpectralPeakPicker mainPeaks, sidePeaks;
+
+	int   frameOrder = FFT_ORDER;
+	int   sampleCount = 0;
+	float currentSampleRate = 44100.0f;
+	FrameTimings frameTimings;
+	juce::uint32 frameCount = 0;
+
+	std::array<Partial, MAX_PARTIALS> mainPartials{};
+	std::array<Partial, MAX_PARTIALS> sidePartials{};
+	int numMainPartials = 0;
+	int numSidePartials = 0;
+
+	std::atomic<int>   dissonanceModel{ (int)DissonanceModel::Sethares };
+	std::atomic<int>   frequencyEstimator{ (int)FrequencyEstimator::Parabolic };
+	std::atomic<float> dissonanceValue{ 0.0f };
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CrossDissonanceAnalyser)
+};
@@ -3,16 +3,54 @@
 	DissonanceAnalyser.h
 
 	Calcola la dissonanza percepita in tempo reale usando il modello
-	Plomp-Levelt / Sethares (1993).
+	Plomp-Levelt / Sethares (1993) o, in alternativa, Vassilakis (2001) o
+	Hutchinson-Knopoff (1978).
 
 	Algoritmo:
+		0. Decima l'ingresso a una frequenza di analisi fissa (<= 50 kHz)
+		   con una cascata di half-band polifase (vedi AnalysisDecimator.h)
 		1. Accumula campioni in un buffer circolare di dimensione FFT_SIZE
-		2. Quando il buffer e' pieno applica una finestra di Hann ed esegue la FFT
-		3. Estrae i parziali dominanti (picchi dello spettro di ampiezza)
-		4. Calcola la dissonanza a coppie con la curva di Plomp-Levelt
+		2. Ogni mezzo frame (2^frameOrder campioni, al massimo FFT_SIZE) applica
+		   una finestra di Hann ed esegue la FFT. Con piu' canali (dal mono al
+		   7.1.4 e all'ambisonico di terzo ordine, senza downmix: sommando i
+		   canali prima della FFT il contenuto in opposizione di fase si
+		   cancella) ogni canale ha il suo buffer e gli spettri si sommano in
+		   potenza, due canali per FFT; i passi successivi lavorano sullo
+		   spettro combinato
+		3. Estrae i parziali dominanti (picchi dello spettro di ampiezza); la
+		   frequenza si stima per interpolazione parabolica oppure, con
+		   FrequencyEstimator::Reassignment, con la riassegnazione
+		   tempo-frequenza (accurata anche con frame da 512/1024 punti)
+		4. Calcola la dissonanza a coppie con il modello scelto (Sethares,
+		   Vassilakis o Hutchinson-Knopoff, vedi DissonanceModels.h)
 		5. Normalizza il risultato in [0,1] e lo espone via atomic
-
-	Nessuna allocazione dinamica nel processBlock.
+		6. (opzionale, modalita' a bassa latenza) tra un frame e l'altro un
+		   banco di risonatori sui parziali trovati aggiorna le ampiezze a ogni
+		   campione e updateBetweenFrames() ricalcola la dissonanza a ogni
+		   blocco (vedi PartialResonatorBank.h). Con piu' canali un banco per
+		   canale, ampiezze combinate in potenza come gli spettri
+		7. (opzionale, gate di stazionarieta') se il flusso spettrale rispetto all'ultimo
+		   frame analizzato resta sotto FLUX_THRESHOLD, i passi 3-5 si saltano
+		   e si riusa la dissonanza precedente; dopo STATIONARY_FRAMES frame
+		   stazionari l'hop raddoppia fino a MAX_HOP_MULTIPLE (meno FFT su un
+		   bordone statico o sul silenzio). Un cambiamento riporta subito
+		   l'hop a mezzo frame.
+		8. (opzionale, raggruppamento armonico) dopo il passo 3 i parziali si
+		   raggruppano in serie armoniche, una per nota (vedi
+		   HarmonicGrouper.h): la dissonanza si divide in interna alle note
+		   e tra note diverse e, con InterNoteOnly, le coppie interne a una
+		   nota non si valutano affatto
+		9. (spettro di ruvidita') i contributi delle coppie valutate si
+		   accumulano anche per banda critica della frequenza centrale e le
+		   bande si pubblicano a ogni hop (vedi RoughnessSpectrum.h)
+
+	Buffer circolare, finestra, FFT e ricerca dei picchi (passi 1-3) sono
+	quelli di SpectralPeakPicker.h, in comune con il CrossDissonanceAnalyser.
+	Finestre e piani FFT non appartengono all'analizzatore: sono condivisi da
+	tutto il processo per ogni dimensione del frame (vedi SharedAnalysisTables.h).
+
+	I buffer per canale si allocano in prepare(); nessuna allocazione
+	dinamica nel processBlock.
 	==============================================================================
 */
 #pragma once
@@ -20,164 +58,564 @@
 #include <JuceHeader.h>
 #include <cmath>
 #include <array>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "AnalysisDecimator.h"
+#include "DissonanceModels.h"
+#include "HarmonicGrouper.h"
+#include "PartialResonatorBank.h"
+#include "RoughnessSpectrum.h"
+#include "SharedAnalysisTables.h"
+#include "SpectralPeakPicker.h"
 
 class DissonanceAnalyser
 {
 public:
 	//============================================================================
-	static constexpr int   FFT_SIZE = 2048;
-	static constexpr int   FFT_ORDER = 11;    // 2^11 = 2048
-	static constexpr int   MAX_PARTIALS = 24;
-	static constexpr float AMPLITUDE_THRESHOLD = 0.01f;
-	static constexpr float ALPHA1 = 3.5f;
-	static constexpr float ALPHA2 = 5.75f;
+	static constexpr int   FFT_SIZE = SpectralPeakPicker::FFT_SIZE;
+	static constexpr int   FFT_ORDER = SpectralPeakPicker::FFT_ORDER;
+	static constexpr int   MIN_FFT_ORDER = SpectralPeakPicker::MIN_FFT_ORDER;
+	static constexpr int   MAX_PARTIALS = SpectralPeakPicker::MAX_PARTIALS;
+	static constexpr float AMPLITUDE_THRESHOLD = SpectralPeakPicker::AMPLITUDE_THRESHOLD;
+	static constexpr int   REFINE_WINDOW = FFT_SIZE / 2; // finestra dei risonatori (bassa latenza)
+	static constexpr float FLUX_THRESHOLD = 0.05f;       // flusso relativo sotto cui il frame e' stazionario
+	static constexpr int   STATIONARY_FRAMES = 4;        // frame stazionari prima di allungare l'hop
+	static constexpr int   MAX_HOP_MULTIPLE = 8;         // hop massimo, in mezzi frame
+	static constexpr int   MAX_CHANNELS = 16;            // 7.1.4 = 12, ambisonico 3o ordine = 16
+
+	//============================================================================
+	// Stima della frequenza di ogni picco (vedi SpectralPeakPicker.h)
+	using FrequencyEstimator = SpectralPeakPicker::FrequencyEstimator;
+
+	//============================================================================
+	// Raggruppamento dei parziali in note (passo 8)
+	enum class PartialGrouping
+	{
+		None = 0,           // tutte le coppie, ogni parziale a se'
+		Harmonic = 1,       // tutte le coppie, divise in interne e tra note
+		InterNoteOnly = 2   // solo le coppie tra note diverse
+	};
 
 	//============================================================================
 	DissonanceAnalyser()
-		: fft(FFT_ORDER)
+		: tables(&sharedTables->getConfiguration(FFT_ORDER)),
+		  leaseHint(sharedTables->nextLeaseHint())
 	{
-		juce::dsp::WindowingFunction<float>::fillWindowingTables(
-			window.data(), FFT_SIZE,
-			juce::dsp::WindowingFunction<float>::hann);
+		allocateChannels(1);
 	}
 
 	//============================================================================
-	void prepare(double sampleRate) noexcept
+	// La FFT lavora alla frequenza decimata: la dimensione del frame e l'hop
+	// sono espressi in campioni di analisi, non in campioni dell'host.
+	// frameOrder in [MIN_FFT_ORDER, FFT_ORDER]: frame piu' corti dimezzano o
+	// riducono a un quarto la latenza (da usare con la riassegnazione).
+	// newNumChannels in [1, MAX_CHANNELS]: con piu' di un canale si usa
+	// pushFrame() invece di pushSample().
+	// Puo' allocare (buffer per canale, prima richiesta delle tabelle
+	// condivise per quel frame): non chiamare dal thread audio.
+	void prepare(double sampleRate, int newFrameOrder = FFT_ORDER, int newNumChannels = 1)
 	{
-		currentSampleRate = static_cast<float> (sampleRate);
+		newNumChannels = juce::jlimit(1, MAX_CHANNELS, newNumChannels);
+		if (newNumChannels != numChannels)
+			allocateChannels(newNumChannels);
+
+		for (int ch = 0; ch < numChannels; ++ch)
+			decimators[(size_t)ch].prepare(sampleRate);
+		currentSampleRate = static_cast<float> (decimators[0].getOutputSampleRate());
+
+		newFrameOrder = juce::jlimit(MIN_FFT_ORDER, FFT_ORDER, newFrameOrder);
+		if (newFrameOrder != frameOrder)
+		{
+			frameOrder = newFrameOrder;
+			tables = &sharedTables->getConfiguration(frameOrder);
+		}
+
 		reset();
 	}
 
 	//============================================================================
-	// Chiamato per ogni campione mono — nessuna allocazione
+	void setFrequencyEstimator(FrequencyEstimator e) noexcept { frequencyEstimator.store((int)e); }
+	FrequencyEstimator getFrequencyEstimator() const noexcept { return (FrequencyEstimator)frequencyEstimator.load(); }
+
+	int getFrameSize() const noexcept { return 1 << frameOrder; }
+	int getNumChannels() const noexcept { return numChannels; }
+
+	// Modello a coppie: abilitabile da qualunque thread, applicato al frame
+	// (o al blocco, in bassa latenza) successivo
+	void setDissonanceModel(DissonanceModel m) noexcept { dissonanceModel.store((int)m); }
+	DissonanceModel getDissonanceModel() const noexcept { return (DissonanceModel)dissonanceModel.load(); }
+
+	//============================================================================
+	// Chiamato per ogni campione mono alla frequenza dell'host — nessuna allocazione
 	void pushSample(float sample) noexcept
 	{
-		accumBuffer[writePos] = sample;
-		writePos = (writePos + 1) & (FFT_SIZE - 1);
-		++sampleCount;
+		jassert(numChannels == 1);
 
-		if (sampleCount >= HOP_SIZE)
-		{
-			sampleCount = 0;
-			analyseFrame();
-		}
+		float decimated;
+		if (decimators[0].pushSample(sample, decimated))
+			pushAnalysisFrame(&decimated);
+	}
+
+	// Un campione per canale (numChannels valori) alla frequenza dell'host.
+	// I decimatori sono identici e avanzano insieme, quindi escono in fase.
+	void pushFrame(const float* samples) noexcept
+	{
+		std::array<float, MAX_CHANNELS> decimated;
+		bool ready = false;
+		for (int ch = 0; ch < numChannels; ++ch)
+			ready = decimators[(size_t)ch].pushSample(samples[ch], decimated[(size_t)ch]);
+
+		if (ready)
+			pushAnalysisFrame(decimated.data());
 	}
 
 	//============================================================================
 	// Risultato normalizzato [0,1]: 0 = consonante, 1 = massima dissonanza
 	float getDissonance() const noexcept { return dissonanceValue.load(); }
 
+	// Frequenza a cui gira la FFT (<= AnalysisDecimator::MAX_ANALYSIS_RATE)
+	float getAnalysisSampleRate() const noexcept { return currentSampleRate; }
+
+	//============================================================================
+	// Parziali dell'ultimo frame (spettro combinato dei canali). Da leggere
+	// solo dal thread che chiama pushSample() (o offline, nei test).
+	int   getNumFramePartials() const noexcept { return numFramePartials; }
+	float getFramePartialFrequency(int i) const noexcept { return framePartials[(size_t)i].freq; }
+	float getFramePartialAmplitude(int i) const noexcept { return framePartials[(size_t)i].amp; }
+
+	//============================================================================
+	// Raggruppamento armonico: abilitabile da qualunque thread, applicato al
+	// frame successivo. Con InterNoteOnly getDissonance() conta solo le
+	// coppie tra note diverse.
+	void setPartialGrouping(PartialGrouping g) noexcept { partialGrouping.store((int)g); }
+	PartialGrouping getPartialGrouping() const noexcept { return (PartialGrouping)partialGrouping.load(); }
+
+	// Dissonanza [0,1] delle sole coppie interne a una nota (armoniche della
+	// stessa serie; 0 con InterNoteOnly, che non le valuta) e delle sole
+	// coppie tra note diverse. Senza raggruppamento ogni parziale e' una nota.
+	float getIntraNoteDissonance() const noexcept { return intraNoteDissonance.load(); }
+	float getInterNoteDissonance() const noexcept { return interNoteDissonance.load(); }
+
+	// Gruppi dell'ultimo frame: quanti, a quale appartiene ogni parziale e
+	// la fondamentale stimata. Solo dal thread che chiama pushSample().
+	int   getNumFrameGroups() const noexcept { return grouper.getNumGroups(); }
+	int   getFramePartialGroup(int i) const noexcept { return grouper.getGroupOf(i); }
+	float getFrameGroupFundamental(int g) const noexcept { return grouper.getFundamental(g); }
+
+	//============================================================================
+	// Dissonanza per banda critica dell'ultimo hop (passo 9), normalizzata come
+	// getDissonance(): con InterNoteOnly solo le coppie tra note. Da qualunque
+	// thread; false se la copia non e' stabile (dest invariato).
+	bool getRoughnessSpectrum(RoughnessSpectrum::Bands& dest) const noexcept { return roughnessSpectrum.read(dest); }
+
+	//============================================================================
+	// Modalita' a bassa latenza: abilitabile da qualunque thread, applicata
+	// dal thread audio al frame FFT successivo.
+	void setLowLatencyRefinement(bool shouldBeEnabled) noexcept { lowLatencyRefinement.store(shouldBeEnabled); }
+	bool isLowLatencyRefinementEnabled() const noexcept { return lowLatencyRefinement.load(); }
+
+	// Da chiamare una volta per blocco audio, dopo pushSample(): ricalcola la
+	// dissonanza con le ampiezze correnti dei risonatori (frequenze dell'ultimo
+	// frame). Costo O(parziali^2), nessuna FFT. Senza la modalita' a bassa
+	// latenza non fa nulla e il valore resta quello dell'ultimo frame. Lo
+	// spettro di ruvidita' resta quello dell'ultimo frame completato.
+	void updateBetweenFrames() noexcept
+	{
+		if (! refinementActive || resonators[0].getNumResonators() < 2)
+			return;
+
+		std::array<Partial, MAX_PARTIALS> refined{};
+		const int numRefined = resonators[0].getNumResonators();
+
+		for (int k = 0; k < numRefined; ++k)
+			refined[k] = { framePartials[k].freq, getRefinedAmplitude(k) };
+
+		dissonanceValue.store(evaluateModel(refined.data(), numRefined, false));
+	}
+
+	//============================================================================
+	// Gate di stazionarieta' (passo 7): abilitabile da qualunque thread,
+	// spento di default (allunga l'hop e quindi il tempo di risposta). In
+	// modalita' a bassa latenza l'hop non si allunga (si salta solo il
+	// calcolo delle coppie), per non ritardare la reazione ai cambiamenti.
+	void setStationarityGate(bool shouldBeEnabled) noexcept { stationarityGate.store(shouldBeEnabled); }
+	bool isStationarityGateEnabled() const noexcept { return stationarityGate.load(); }
+
+	// Hop corrente in mezzi frame (1 = nessuna riduzione). Solo thread audio.
+	int getHopMultiple() const noexcept { return hopMultiple; }
+
+	// Frame saltati perche' nessun piano FFT condiviso era libero
+	int getNumSkippedFrames() const noexcept { return skippedFrames; }
+
+	//============================================================================
+	// Intervalli di analyseFrame() (tick ad alta risoluzione) dall'ultimo
+	// clearFrameTimings(): il processor li usa per la profilazione per stadio
+	// e per la timeline di trace. Solo dal thread audio.
+	// Il timer si legge solo con la misura abilitata (profilazione o trace
+	// attivi); altrimenti non si registra nulla. Per sapere se un frame e'
+	// stato prodotto c'e' getFrameCount().
+	struct FrameTimings
+	{
+		static constexpr int MAX_FRAMES = 8;   // oltre, conta solo totalTicks
+
+		juce::int64 totalTicks = 0;
+		int numFrames = 0;
+		std::array<juce::int64, MAX_FRAMES> start{}, end{};
+		bool enabled = false;
+
+		template <typename Function>
+		void measure(Function&& analyse) noexcept
+		{
+			if (! enabled)
+			{
+				analyse();
+				return;
+			}
+
+			const auto frameStart = juce::Time::getHighResolutionTicks();
+			analyse();
+			const auto frameEnd = juce::Time::getHighResolutionTicks();
+
+			totalTicks += frameEnd - frameStart;
+			if (numFrames < MAX_FRAMES)
+			{
+				start[(size_t)numFrames] = frameStart;
+				end[(size_t)numFrames++] = frameEnd;
+			}
+		}
+	};
+
+	const FrameTimings& getFrameTimings() const noexcept { return frameTimings; }
+	void clearFrameTimings() noexcept { frameTimings.totalTicks = 0; frameTimings.numFrames = 0; }
+	void setFrameTimingEnabled(bool shouldBeEnabled) noexcept { frameTimings.enabled = shouldBeEnabled; }
+
+	// Frame prodotti da prepare(): cresce di uno per ogni hop analizzato,
+	// anche quando il gate o un piano FFT occupato fanno valere ancora la
+	// lettura precedente. Chi legge confronta con l'ultimo valore visto.
+	// Solo dal thread che chiama pushSample().
+	juce::uint32 getFrameCount() const noexcept { return frameCount; }
+
 	//============================================================================
 	void reset() noexcept
 	{
-		accumBuffer.fill(0.0f);
-		fftBuffer.fill(0.0f);
-		writePos = 0;
+		for (int ch = 0; ch < numChannels; ++ch)
+		{
+			decimators[(size_t)ch].reset();
+			resonators[(size_t)ch].reset();
+			rings[(size_t)ch].clear();
+		}
+		numFramePartials = 0;
+		refinementActive = false;
 		sampleCount = 0;
+		hopsSinceFrame = 0;
+		hopMultiple = 1;
+		stationaryFrames = 0;
+		hasReferenceSpectrum = false;
+		grouper.ungroup(nullptr, 0);
 		dissonanceValue.store(0.0f);
+		intraNoteDissonance.store(0.0f);
+		interNoteDissonance.store(0.0f);
+		roughnessSpectrum.clear();
 	}
 
 private:
-	static constexpr int HOP_SIZE = FFT_SIZE / 2;
+	using Partial = SpectralPeakPicker::Partial;
+	using Resonators = PartialResonatorBank<MAX_PARTIALS, REFINE_WINDOW>;
+
+	//============================================================================
+	void allocateChannels(int newNumChannels)
+	{
+		numChannels = newNumChannels;
+		decimators = std::make_unique<AnalysisDecimator[]>((size_t)numChannels);
+		rings.assign((size_t)numChannels, {});
+		resonators.assign((size_t)numChannels, {});
+	}
+
+	//============================================================================
+	// Un campione di analisi per canale
+	void pushAnalysisFrame(const float* samples) noexcept
+	{
+		for (int ch = 0; ch < numChannels; ++ch)
+		{
+			auto& ring = rings[(size_t)ch];
+
+			// x(n - REFINE_WINDOW) va letto prima di sovrascrivere il buffer
+			if (refinementActive)
+				resonators[(size_t)ch].pushSample(samples[ch], ring.delayed(REFINE_WINDOW));
+
+			ring.push(samples[ch]);
+		}
+		++sampleCount;
+
+		if (sampleCount < (1 << frameOrder) / 2)
+			return;
+
+		// Con il gate di stazionarieta' si analizza un hop ogni hopMultiple
+		sampleCount = 0;
+		if (++hopsSinceFrame >= hopMultiple)
+		{
+			hopsSinceFrame = 0;
+
+			frameTimings.measure([this] { analyseFrame(); });
+			++frameCount;
+		}
+	}
 
 	//============================================================================
 	void analyseFrame() noexcept
 	{
-		// 1. Copia buffer circolare in ordine cronologico + finestra di Hann
-		for (int i = 0; i < FFT_SIZE; ++i)
+		// Piano FFT condiviso in prestito per questo frame; tutti occupati
+		// (solo con thread sospesi a meta' di una FFT): si salta il frame
+		const auto fft = tables->tryLease(leaseHint);
+		if (! fft)
 		{
-			int idx = (writePos + i) & (FFT_SIZE - 1);
-			fftBuffer[i] = accumBuffer[idx] * window[i];
+			++skippedFrames;
+			return;
 		}
-		for (int i = FFT_SIZE; i < FFT_SIZE * 2; ++i)
-			fftBuffer[i] = 0.0f;
 
-		// 2. FFT forward (risultato: magnitudini in fftBuffer[0..FFT_SIZE/2])
-		fft.performFrequencyOnlyForwardTransform(fftBuffer.data());
+		// 1-2. Finestra e FFT dell'ultimo frame (una trasformata complessa con
+		// la riassegnazione, che porta anche lo spettro della derivata; con
+		// piu' canali, spettri sommati in potenza)
+		peaks.beginFrame(frameOrder);
+		peaks.addSignals(rings.data(), numChannels, *tables, fft, getFrequencyEstimator());
+		peaks.finishFrame();
 
-		const int   numBins = FFT_SIZE / 2;
-		const float normFactor = 2.0f / (float)FFT_SIZE;
+		// 7. Spettro stazionario: si riusa il risultato dell'ultimo frame analizzato
+		if (isStationary(peaks.getNumBins()))
+			return;
 
 		// 3. Estrai parziali dominanti (picchi locali sopra soglia)
-		struct Partial { float freq; float amp; };
-		std::array<Partial, MAX_PARTIALS> partials{};
-		int numPartials = 0;
+		auto& partials = framePartials;
+		const int numPartials = peaks.findPartials(currentSampleRate, partials.data());
+
+		numFramePartials = numPartials;
+
+		// 8. Note: i parziali sono gia' in ordine di frequenza. Tolleranza
+		// minima di un quarto di bin.
+		activeGrouping = getPartialGrouping();
+		std::array<float, MAX_PARTIALS> freqs{}, amps{};
+		for (int k = 0; k < numPartials; ++k)
+		{
+			freqs[k] = partials[k].freq;
+			amps[k] = partials[k].amp;
+		}
+
+		if (activeGrouping == PartialGrouping::None)
+			grouper.ungroup(freqs.data(), numPartials);
+		else
+			grouper.group(freqs.data(), amps.data(), numPartials, 0.25f * currentSampleRate / (float)getFrameSize());
+
+		dissonanceValue.store(evaluateModel(partials.data(), numPartials, true));
 
-		for (int k = 1; k < numBins - 1 && numPartials < MAX_PARTIALS; ++k)
+		// 6. Risintonizza i risonatori sui nuovi parziali (bassa latenza)
+		refinementActive = lowLatencyRefinement.load();
+		for (int ch = 0; ch < numChannels; ++ch)
 		{
-			const float amp = fftBuffer[k] * normFactor;
+			const auto& ring = rings[(size_t)ch];
+			auto& bank = resonators[(size_t)ch];
 
-			if (amp > AMPLITUDE_THRESHOLD
-				&& amp > fftBuffer[k - 1] * normFactor
-				&& amp > fftBuffer[k + 1] * normFactor)
+			if (refinementActive)
+				bank.retune(freqs.data(), numPartials, currentSampleRate, ring.samples.data(), FFT_SIZE - 1, ring.newestIndex());
+			else
+				bank.reset();
+		}
+	}
+
+	// Ampiezza del parziale k dai risonatori, combinata sui canali in
+	// potenza come lo spettro: sqrt(media di a^2)
+	float getRefinedAmplitude(int k) const noexcept
+	{
+		if (numChannels == 1)
+			return resonators[0].getAmplitude(k);
+
+		float power = 0.0f;
+		for (int ch = 0; ch < numChannels; ++ch)
+		{
+			const float a = resonators[(size_t)ch].getAmplitude(k);
+			power += a * a;
+		}
+		return std::sqrt(power / (float)numChannels);
+	}
+
+	//============================================================================
+	// Flusso spettrale relativo rispetto all'ultimo frame analizzato per intero
+	// (non al precedente, cosi' una deriva lenta si accumula e prima o poi
+	// forza l'analisi):  sum|M - R| / max(sum M, sum R)
+	bool isStationary(int numBins) noexcept
+	{
+		const float* magnitudes = peaks.getMagnitudes();
+		float flux = 0.0f, energy = 0.0f, referenceEnergy = 0.0f;
+		for (int k = 0; k < numBins; ++k)
+		{
+			flux += std::abs(magnitudes[k] - referenceSpectrum[k]);
+			energy += magnitudes[k];
+			referenceEnergy += referenceSpectrum[k];
+		}
+
+		// Un cambio di modalita' a bassa latenza (accende o spegne i
+		// risonatori) o di raggruppamento richiede un frame completo
+		const bool lowLatency = lowLatencyRefinement.load();
+		const bool stationary = stationarityGate.load() && hasReferenceSpectrum
+			&& lowLatency == refinementActive
+			&& getPartialGrouping() == activeGrouping
+			&& flux <= FLUX_THRESHOLD * juce::jmax(energy, referenceEnergy);
+
+		if (stationary)
+		{
+			if (! lowLatency && ++stationaryFrames >= STATIONARY_FRAMES)
 			{
-				// Interpolazione parabolica per stima precisa della frequenza
-				const float alpha = fftBuffer[k - 1] * normFactor;
-				const float beta = amp;
-				const float gamma = fftBuffer[k + 1] * normFactor;
-				const float delta = 0.5f * (alpha - gamma)
-					/ (alpha - 2.0f * beta + gamma + 1e-10f);
-				const float freq = ((float)k + delta) * currentSampleRate / (float)FFT_SIZE;
-
-				if (freq > 20.0f && freq < 20000.0f)
-					partials[numPartials++] = { freq, amp };
+				hopMultiple = juce::jmin(hopMultiple * 2, MAX_HOP_MULTIPLE);
+				stationaryFrames = 0;
 			}
+			return true;
 		}
 
-		// 4. Calcola dissonanza Plomp-Levelt su tutte le coppie
-		float totalDissonance = 0.0f;
-		float maxDissonance = 0.0f;
+		std::copy(magnitudes, magnitudes + numBins, referenceSpectrum.begin());
+		hasReferenceSpectrum = true;
+		stationaryFrames = 0;
+		hopMultiple = 1;
+		return false;
+	}
+
+	//============================================================================
+	// Somme del modello e dei pesi, separate tra coppie interne a una nota e
+	// coppie tra note diverse
+	struct PairSums
+	{
+		float intra = 0.0f, intraWeight = 0.0f;
+		float inter = 0.0f, interWeight = 0.0f;
+	};
+
+	// 5. Normalizza in [0,1] dal massimo teorico del modello
+	static float normalise(float total, float weight) noexcept
+	{
+		return weight > 1e-6f ? juce::jlimit(0.0f, 1.0f, total / weight) : 0.0f;
+	}
+
+	//============================================================================
+	// 4. Sceglie il modello una volta per chiamata: ogni ramo e' una
+	// specializzazione di computeDissonance con la coppia valutata inline.
+	// I parziali (in ordine di frequenza) si riordinano per gruppo secondo
+	// l'ultimo raggruppamento: vale anche per le ampiezze dei risonatori,
+	// che hanno le frequenze dell'ultimo frame. Lo spettro per banda si
+	// pubblica solo con publishSpectrum (a ogni frame, non a ogni blocco).
+	float evaluateModel(const Partial* partials, int numPartials, bool publishSpectrum) noexcept
+	{
+		std::array<Partial, MAX_PARTIALS> grouped{};
+		std::array<int, MAX_PARTIALS> groupEnd{};
+		for (int i = 0; i < numPartials; ++i)
+		{
+			grouped[(size_t)i] = partials[grouper.getOrder(i)];
+			groupEnd[(size_t)i] = grouper.getGroupEnd(i);
+		}
+
+		const bool interOnly = activeGrouping == PartialGrouping::InterNoteOnly;
+		RoughnessSpectrum::Bands bands{};
+		PairSums sums;
+
+		switch ((DissonanceModel)dissonanceModel.load())
+		{
+			case DissonanceModel::Vassilakis:        sums = computeDissonance<VassilakisModel>(grouped.data(), groupEnd.data(), numPartials, interOnly, bands.data()); break;
+			case DissonanceModel::HutchinsonKnopoff: sums = computeDissonance<HutchinsonKnopoffModel>(grouped.data(), groupEnd.data(), numPartials, interOnly, bands.data()); break;
+			case DissonanceModel::Sethares:
+			default:                                 sums = computeDissonance<SetharesModel>(grouped.data(), groupEnd.data(), numPartials, interOnly, bands.data()); break;
+		}
+
+		intraNoteDissonance.store(normalise(sums.intra, sums.intraWeight));
+		interNoteDissonance.store(normalise(sums.inter, sums.interWeight));
+
+		// 9. Stesso peso del valore scalare: le bande sommano alla lettura
+		if (publishSpectrum)
+		{
+			const float weight = interOnly ? sums.interWeight : sums.intraWeight + sums.interWeight;
+			roughnessSpectrum.publish(bands, weight > 1e-6f ? 1.0f / weight : 0.0f);
+		}
+
+		return interOnly ? normalise(sums.inter, sums.interWeight)
+		                 : normalise(sums.intra + sums.inter, sums.intraWeight + sums.interWeight);
+	}
+
+	// 4. Dissonanza a coppie sui parziali raggruppati (gruppi contigui,
+	// groupEnd[i] = fine del gruppo di i). Con interOnly j parte dal gruppo
+	// successivo: le coppie interne non si visitano nemmeno. Ogni coppia
+	// visitata si somma anche in bands, alla banda critica del suo centro.
+	template <typename Model>
+	static PairSums computeDissonance(const Partial* partials, const int* groupEnd, int numPartials, bool interOnly, float* bands) noexcept
+	{
+		PairSums sums;
 
 		for (int i = 0; i < numPartials; ++i)
 		{
-			for (int j = i + 1; j < numPartials; ++j)
+			for (int j = interOnly ? groupEnd[i] : i + 1; j < numPartials; ++j)
 			{
 				const float f1 = juce::jmin(partials[i].freq, partials[j].freq);
 				const float f2 = juce::jmax(partials[i].freq, partials[j].freq);
 				const float a1 = partials[i].amp;
 				const float a2 = partials[j].amp;
 
-				totalDissonance += plompLevelt(f1, f2, a1, a2);
-				maxDissonance += a1 * a2; // massimo teorico
+				const float d = Model::pair(f1, f2, a1, a2);
+				const float w = Model::weight(a1, a2); // massimo teorico
+				bands[RoughnessSpectrum::bandOf(0.5f * (f1 + f2))] += d;
+
+				if (j < groupEnd[i])
+				{
+					sums.intra += d;
+					sums.intraWeight += w;
+				}
+				else
+				{
+					sums.inter += d;
+					sums.interWeight += w;
+				}
 			}
 		}
 
-		// 5. Normalizza in [0,1]
-		float normalised = 0.0f;
-		if (maxDissonance > 1e-6f)
-			normalised = juce::jlimit(0.0f, 1.0f, totalDissonance / maxDissonance);
-
-		dissonanceValue.store(normalised);
+		return sums;
 	}
 
 	//============================================================================
-	// Curva di Plomp-Levelt (Sethares 1993):
-	//   d = a1 * a2 * (exp(-alpha1*s*df) - exp(-alpha2*s*df))
-	//   s = 0.24 / (0.0207*f1 + 18.96)   <- scala sulla banda critica
-	static float plompLevelt(float f1, float f2, float a1, float a2) noexcept
-	{
-		const float df = f2 - f1;
-		if (df <= 0.0f) return 0.0f;
-
-		const float s = 0.24f / (0.0207f * f1 + 18.96f);
-		const float x = s * df;
-		const float d = std::exp(-ALPHA1 * x) - std::exp(-ALPHA2 * x);
+	// Per canale, numChannels elementi (allocati in prepare())
+	int numChannels = 0;
+	std::unique_ptr<AnalysisDecimator[]> decimators;
+	std::vector<SpectralPeakPicker::Ring> rings;
+	std::vector<Resonators> resonators;
 
-		return a1 * a2 * juce::jmax(0.0f, d);
-	}
+	juce::SharedResourcePointer<SharedAnalysisTables> sharedTables;
+	const SharedAnalysisTables::Configuration* tables;
+	const int leaseHint;
+	int skippedFrames = 0;
 
-	//============================================================================
-	juce::dsp::FFT fft;
+	SpectralPeakPicker peaks;
 
-	std::array<float, FFT_SIZE>     window{};
-	std::array<float, FFT_SIZE>     accumBuffer{};
-	std::array<float, FFT_SIZE * 2> fftBuffer{};
+	int frameOrder = FFT_ORDER;
+	std::atomic<int> frequencyEstimator{ (int)FrequencyEstimator::Parabolic };
+	std::atomic<int> dissonanceModel{ (int)DissonanceModel::Sethares };
 
-	int   writePos = 0;
 	int   sampleCount = 0;
+	int   hopsSinceFrame = 0;
+	int   hopMultiple = 1;
+	int   stationaryFrames = 0;
+	bool  hasReferenceSpectrum = false;
+	std::array<float, FFT_SIZE / 2> referenceSpectrum{};
+	std::atomic<bool> stationarityGate{ false };
+	FrameTimings frameTimings;
+	juce::uint32 frameCount = 0;
 	float currentSampleRate = 44100.0f;
 
+	std::array<Partial, MAX_PARTIALS> framePartials{};
+	int  numFramePartials = 0;
+	bool refinementActive = false;   // copia di lowLatencyRefinement presa all'ultimo frame
+
+	HarmonicGrouper<MAX_PARTIALS> grouper;
+	std::atomic<int> partialGrouping{ (int)PartialGrouping::None };
+	PartialGrouping  activeGrouping = PartialGrouping::None;   // copia presa all'ultimo frame
+
 	std::atomic<float> dissonanceValue{ 0.0f };
+	std::atomic<float> intraNoteDissonance{ 0.0f };
+	std::atomic<float> interNoteDissonance{ 0.0f };
+	std::atomic<bool>  lowLatencyRefinement{ false };
+	RoughnessSpectrum  roughnessSpectrum;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DissonanceAnalyser)
 };
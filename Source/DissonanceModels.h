@@ -0,0 +1,107 @@
+/*
+	==============================================================================
+	DissonanceModels.h
+
+	Modelli di dissonanza a coppie per il DissonanceAnalyser, come policy a
+	tempo di compilazione: il ciclo sulle coppie e' un template istanziato una
+	volta per modello, quindi la valutazione di ogni coppia e' inline (nessuna
+	chiamata virtuale nel ciclo O(parziali^2)). La scelta a runtime avviene
+	una sola volta per frame tra le specializzazioni gia' istanziate.
+
+	Ogni policy espone:
+		pair(f1, f2, a1, a2)   contributo della coppia (f1 <= f2)
+		weight(a1, a2)         contributo della coppia al massimo teorico,
+		                       usato per normalizzare il totale in [0,1]
+
+	Modelli disponibili:
+		- Sethares (1993): curva di Plomp-Levelt parametrizzata, pesata a1*a2
+		- Vassilakis (2001): stessa curva, pesata per la fluttuazione di
+		  ampiezza (a1*a2)^0.1 * 0.5 * (2 a_min / (a1 + a2))^3.11
+		- Hutchinson-Knopoff (1978): curva standard g(y) sulla banda critica
+		  1.72 * f_media^0.65, con y = df / CB e massimo a y = 0.25
+	==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <cmath>
+
+//==============================================================================
+// Selezione a runtime (vedi DissonanceAnalyser::setDissonanceModel)
+enum class DissonanceModel
+{
+	Sethares = 0,
+	Vassilakis = 1,
+	HutchinsonKnopoff = 2
+};
+
+//==============================================================================
+// Plomp-Levelt / Sethares (1993):
+//   d = a1 * a2 * (exp(-alpha1*s*df) - exp(-alpha2*s*df))
+//   s = 0.24 / (0.0207*f1 + 18.96)   <- scala sulla banda critica
+struct SetharesModel
+{
+	static constexpr float ALPHA1 = 3.5f;
+	static constexpr float ALPHA2 = 5.75f;
+
+	static float curve(float f1, float df) noexcept
+	{
+		const float s = 0.24f / (0.0207f * f1 + 18.96f);
+		const float x = s * df;
+		return juce::jmax(0.0f, std::exp(-ALPHA1 * x) - std::exp(-ALPHA2 * x));
+	}
+
+	static float pair(float f1, float f2, float a1, float a2) noexcept
+	{
+		const float df = f2 - f1;
+		if (df <= 0.0f) return 0.0f;
+
+		return a1 * a2 * curve(f1, df);
+	}
+
+	static float weight(float a1, float a2) noexcept { return a1 * a2; }
+};
+
+//==============================================================================
+// Vassilakis (2001): la curva di Sethares pesata per il grado di
+// fluttuazione d'ampiezza. Due parziali di ampiezza molto diversa battono
+// poco anche se vicini: il termine Y = 2 a_min / (a1 + a2) vale 1 solo per
+// ampiezze uguali.
+//   r = (a1*a2)^0.1 * 0.5 * Y^3.11 * Z(f1, df)
+struct VassilakisModel
+{
+	static float pair(float f1, float f2, float a1, float a2) noexcept
+	{
+		const float df = f2 - f1;
+		const float sum = a1 + a2;
+		if (df <= 0.0f || sum <= 0.0f) return 0.0f;
+
+		const float y = 2.0f * juce::jmin(a1, a2) / sum;
+		return weight(a1, a2) * 0.5f * std::pow(y, 3.11f) * SetharesModel::curve(f1, df);
+	}
+
+	static float weight(float a1, float a2) noexcept { return std::pow(a1 * a2, 0.1f); }
+};
+
+//==============================================================================
+// Hutchinson-Knopoff (1978), con la parametrizzazione della curva standard
+// di Plomp-Levelt di Mashinter (2006):
+//   g(y) = (e * y / 0.25 * exp(-y / 0.25))^2,   y = df / (1.72 * f_media^0.65)
+// g vale 1 a un quarto di banda critica.
+struct HutchinsonKnopoffModel
+{
+	static constexpr float PEAK_Y = 0.25f;
+
+	static float pair(float f1, float f2, float a1, float a2) noexcept
+	{
+		const float df = f2 - f1;
+		if (df <= 0.0f) return 0.0f;
+
+		const float criticalBand = 1.72f * std::pow(0.5f * (f1 + f2), 0.65f);
+		const float r = df / (criticalBand * PEAK_Y);
+		const float g = juce::MathConstants<float>::euler * r * std::exp(-r);
+		return a1 * a2 * g * g;
+	}
+
+	static float weight(float a1, float a2) noexcept { return a1 * a2; }
+};
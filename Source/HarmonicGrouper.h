@@ -0,0 +1,136 @@
+/*
+	==============================================================================
+	HarmonicGrouper.h
+
+	Raggruppa i parziali di un frame in serie armoniche, una per nota: le
+	armoniche di una stessa nota non sono dissonanza tra note diverse, e
+	senza gruppi gonfiano il numero di coppie del modello.
+
+	Stima veloce della fondamentale, in un solo passaggio sui parziali in
+	ordine di frequenza:
+		1. Il parziale piu' basso non ancora assegnato apre un gruppo e ne
+		   e' la prima stima di f0
+		2. Ogni parziale libero piu' alto, vicino a un multiplo k * f0
+		   (k in [2, MAX_HARMONIC], ciascun k una volta sola) entra nel
+		   gruppo; f0 si aggiorna come media di f / k pesata sull'ampiezza,
+		   cosi' le armoniche alte restano agganciate anche se la prima
+		   stima e' imprecisa
+		3. Si ripete finche' restano parziali liberi
+	Tolleranza: HARMONIC_TOLERANCE relativa (circa 10 cent, meno della
+	distanza tra la quinta armonica di una nota e la quarta della sua terza
+	maggiore temperata) ma mai sotto minToleranceHz, legata alla risoluzione
+	della FFT.
+
+	Uscita: gli indici dei parziali riordinati per gruppo (gruppi contigui,
+	in ordine di fondamentale) e, per ogni posizione, la fine del suo
+	gruppo: il ciclo sulle coppie salta quelle interne a una nota partendo
+	da li'.
+
+	Costo O(parziali^2) confronti, nessuna allocazione.
+	==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cmath>
+
+template <int MaxPartials>
+class HarmonicGrouper
+{
+public:
+	//============================================================================
+	static constexpr float HARMONIC_TOLERANCE = 0.006f;
+	static constexpr int   MAX_HARMONIC = 32;
+
+	//============================================================================
+	// freqs in ordine crescente. Restituisce il numero di gruppi.
+	int group(const float* freqs, const float* amps, int numPartials, float minToleranceHz) noexcept
+	{
+		numPartials = juce::jmin(numPartials, MaxPartials);
+		assigned.fill(false);
+		numGroups = 0;
+		int position = 0;
+
+		for (int p = 0; p < numPartials; ++p)
+		{
+			if (assigned[(size_t)p])
+				continue;
+
+			// 1. Nuovo gruppo sul parziale libero piu' basso
+			const int start = position;
+			float fundamental = freqs[p];
+			float weightedSum = amps[p] * freqs[p];
+			float weightSum = amps[p];
+			juce::uint64 usedHarmonics = 1u << 1;
+			add(p, position++);
+
+			// 2. Armoniche libere della stessa serie
+			for (int q = p + 1; q < numPartials; ++q)
+			{
+				if (assigned[(size_t)q])
+					continue;
+
+				const int k = (int)std::lround(freqs[q] / fundamental);
+				if (k < 2 || k > MAX_HARMONIC || (usedHarmonics & ((juce::uint64)1 << k)) != 0)
+					continue;
+
+				const float target = (float)k * fundamental;
+				if (std::abs(freqs[q] - target) > juce::jmax(HARMONIC_TOLERANCE * target, minToleranceHz))
+					continue;
+
+				usedHarmonics |= (juce::uint64)1 << k;
+				weightedSum += amps[q] * freqs[q] / (float)k;
+				weightSum += amps[q];
+				fundamental = weightedSum / juce::jmax(weightSum, 1e-20f);
+				add(q, position++);
+			}
+
+			for (int i = start; i < position; ++i)
+				groupEnd[(size_t)i] = position;
+
+			fundamentals[(size_t)numGroups++] = fundamental;
+		}
+
+		return numGroups;
+	}
+
+	// Ogni parziale un gruppo a se' (nessun raggruppamento): tutte le coppie
+	// sono tra gruppi diversi, nello stesso ordine dei parziali
+	void ungroup(const float* freqs, int numPartials) noexcept
+	{
+		numPartials = juce::jmin(numPartials, MaxPartials);
+		for (int p = 0; p < numPartials; ++p)
+		{
+			order[(size_t)p] = p;
+			groupOf[(size_t)p] = p;
+			groupEnd[(size_t)p] = p + 1;
+			fundamentals[(size_t)p] = freqs[p];
+		}
+		numGroups = numPartials;
+	}
+
+	//============================================================================
+	int   getNumGroups() const noexcept { return numGroups; }
+	float getFundamental(int group) const noexcept { return fundamentals[(size_t)group]; }
+	int   getGroupOf(int partial) const noexcept { return groupOf[(size_t)partial]; }
+
+	// Posizione -> indice del parziale; fine (esclusa) del gruppo della posizione
+	int getOrder(int position) const noexcept { return order[(size_t)position]; }
+	int getGroupEnd(int position) const noexcept { return groupEnd[(size_t)position]; }
+
+private:
+	void add(int partial, int position) noexcept
+	{
+		assigned[(size_t)partial] = true;
+		groupOf[(size_t)partial] = numGroups;
+		order[(size_t)position] = partial;
+	}
+
+	std::array<bool, MaxPartials>  assigned{};
+	std::array<int, MaxPartials>   order{};
+	std::array<int, MaxPartials>   groupEnd{};
+	std::array<int, MaxPartials>   groupOf{};
+	std::array<float, MaxPartials> fundamentals{};
+	int numGroups = 0;
+};
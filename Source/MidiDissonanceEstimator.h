@@ -0,0 +1,504 @@
+/*
+	==============================================================================
+	MidiDissonanceEstimator.h
+
+	Dissonanza simbolica di una traccia MIDI, senza FFT: dalle note che
+	suonano e da uno spettro armonico fisso per nota (timbro scelto tra
+	pochi preset), con lo stesso modello a coppie degli analizzatori (vedi
+	DissonanceModels.h).
+
+	Tabelle precalcolate, condivise da tutto il processo per ogni timbro
+	(juce::SharedResourcePointer, come SharedAnalysisTables) e costruite
+	solo quando servono, fuori dal thread audio (buildTables(), vedi il
+	processor):
+		- lo spettro di ciascuna delle 128 note (fino a NUM_HARMONICS
+		  armoniche tra 20 Hz e 20 kHz, La4 = 440 Hz)
+		- per ogni modello due tabelle 128 x 128: la somma del modello sulle
+		  coppie di armoniche delle due note e la somma dei pesi. La
+		  diagonale e' la dissonanza interna di una nota sola
+	Una coppia di note costa quindi una lettura, qualunque sia il numero di
+	armoniche. Finche' le tabelle del timbro scelto non ci sono, process()
+	resta sulle precedenti (nessuna, all'inizio: le note vengono tenute ma
+	valgono 0, e contano tutte appena le tabelle arrivano).
+
+	Stato (thread audio): le note tenute per canale MIDI, con il pedale di
+	sustain, e i due totali (dissonanza e peso) aggiornati in modo
+	incrementale a ogni nota: aggiungere o togliere una nota tra n costa n
+	letture. La velocity scala le coppie con il peso del modello
+	(v_a * v_b per Sethares e Hutchinson-Knopoff, esatto; (v_a * v_b)^0.1
+	per Vassilakis, che trascura il termine sul rapporto delle ampiezze).
+
+	Aggiornamento a campione esatto: process() applica gli eventi del blocco
+	nell'ordine e registra il valore nuovo al campione dell'evento (vedi
+	getChange()); il processor divide il blocco in segmenti a quei campioni
+	e ogni valore pesa sul meter per il tempo in cui vale. Nessuna
+	allocazione ne' lock in process().
+	==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "DissonanceModels.h"
+
+class MidiDissonanceEstimator
+{
+public:
+	//============================================================================
+	static constexpr int   NUM_NOTES = 128;
+	static constexpr int   NUM_CHANNELS = 16;
+	static constexpr int   NUM_HARMONICS = 12;
+	static constexpr int   NUM_MODELS = 3;
+	static constexpr int   MAX_CHANGES_PER_BLOCK = 64;
+	static constexpr float TUNING_A4_HZ = 440.0f;
+
+	// Spettro armonico di ogni nota
+	enum class Timbre
+	{
+		Sine = 0,          // solo la fondamentale
+		Sawtooth = 1,      // tutte le armoniche, 1/k
+		Square = 2,        // armoniche dispari, 1/k
+		Triangle = 3       // armoniche dispari, 1/k^2
+	};
+	static constexpr int NUM_TIMBRES = 4;
+
+	struct NoteSpectrum
+	{
+		std::array<float, NUM_HARMONICS> freq{};
+		std::array<float, NUM_HARMONICS> amp{};
+		int numHarmonics = 0;
+	};
+
+	// Nuovo valore della dissonanza a partire dal campione indicato del blocco
+	struct Change { int sample; float dissonance; };
+
+	//============================================================================
+	// Tabelle di un timbro: spettri delle note e, per ogni modello, somme
+	// del modello e dei pesi su tutte le coppie di armoniche di due note
+	class PairTable
+	{
+	public:
+		explicit PairTable(Timbre t)
+		{
+			for (int note = 0; note < NUM_NOTES; ++note)
+				spectra[(size_t)note] = makeSpectrum(t, note);
+
+			fill<SetharesModel>(DissonanceModel::Sethares);
+			fill<VassilakisModel>(DissonanceModel::Vassilakis);
+			fill<HutchinsonKnopoffModel>(DissonanceModel::HutchinsonKnopoff);
+		}
+
+		const NoteSpectrum& getSpectrum(int note) const noexcept { return spectra[(size_t)note]; }
+
+		float getDissonance(DissonanceModel m, int a, int b) const noexcept { return dissonance[(size_t)m][(size_t)(a * NUM_NOTES + b)]; }
+		float getWeight(DissonanceModel m, int a, int b) const noexcept { return weights[(size_t)m][(size_t)(a * NUM_NOTES + b)]; }
+
+	private:
+		static NoteSpectrum makeSpectrum(Timbre t, int note)
+		{
+			NoteSpectrum spectrum;
+			const float f0 = TUNING_A4_HZ * std::pow(2.0f, (float)(note - 69) / 12.0f);
+
+			for (int k = 1; k <= NUM_HARMONICS; ++k)
+			{
+				const float freq = f0 * (float)k;
+				const bool odd = (k % 2) == 1;
+				float amp = 0.0f;
+
+				switch (t)
+				{
+					case Timbre::Sine:     amp = k == 1 ? 1.0f : 0.0f; break;
+					case Timbre::Sawtooth: amp = 1.0f / (float)k; break;
+					case Timbre::Square:   amp = odd ? 1.0f / (float)k : 0.0f; break;
+					case Timbre::Triangle: amp = odd ? 1.0f / (float)(k * k) : 0.0f; break;
+				}
+
+				// Stessa banda dei parziali degli analizzatori
+				if (amp > 0.0f && freq > 20.0f && freq < 20000.0f)
+				{
+					spectrum.freq[(size_t)spectrum.numHarmonics] = freq;
+					spectrum.amp[(size_t)spectrum.numHarmonics++] = amp;
+				}
+			}
+
+			return spectrum;
+		}
+
+		template <typename Model>
+		void fill(DissonanceModel m)
+		{
+			auto& d = dissonance[(size_t)m];
+			auto& w = weights[(size_t)m];
+			d.assign((size_t)(NUM_NOTES * NUM_NOTES), 0.0f);
+			w.assign((size_t)(NUM_NOTES * NUM_NOTES), 0.0f);
+
+			for (int a = 0; a < NUM_NOTES; ++a)
+			{
+				for (int b = a; b < NUM_NOTES; ++b)
+				{
+					const auto& p = spectra[(size_t)a];
+					const auto& q = spectra[(size_t)b];
+					float total = 0.0f, weight = 0.0f;
+
+					// Stessa nota: solo le coppie tra armoniche diverse
+					for (int i = 0; i < p.numHarmonics; ++i)
+					{
+						for (int j = a == b ? i + 1 : 0; j < q.numHarmonics; ++j)
+						{
+							const bool pLower = p.freq[(size_t)i] <= q.freq[(size_t)j];
+							total += pLower ? Model::pair(p.freq[(size_t)i], q.freq[(size_t)j], p.amp[(size_t)i], q.amp[(size_t)j])
+							                : Model::pair(q.freq[(size_t)j], p.freq[(size_t)i], q.amp[(size_t)j], p.amp[(size_t)i]);
+							weight += Model::weight(p.amp[(size_t)i], q.amp[(size_t)j]);
+						}
+					}
+
+					d[(size_t)(a * NUM_NOTES + b)] = d[(size_t)(b * NUM_NOTES + a)] = total;
+					w[(size_t)(a * NUM_NOTES + b)] = w[(size_t)(b * NUM_NOTES + a)] = weight;
+				}
+			}
+		}
+
+		std::array<NoteSpectrum, NUM_NOTES> spectra;
+		std::array<std::vector<float>, NUM_MODELS> dissonance, weights;
+
+		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PairTable)
+	};
+
+	//============================================================================
+	// Una PairTable per timbro, costruita alla prima richiesta (qualche
+	// milione di valutazioni del modello: mai dal thread audio), pubblicata
+	// con un puntatore atomico e condivisa fino alla distruzione dell'ultimo
+	// utente
+	class SharedTables
+	{
+	public:
+		// Bloccante: costruisce la tabella se manca
+		void build(Timbre t)
+		{
+			const juce::ScopedLock sl(lock);
+			auto& table = tables[(size_t)t];
+			if (table != nullptr)
+				return;
+
+			table = std::make_unique<PairTable>(t);
+			published[(size_t)t].store(table.get(), std::memory_order_release);
+		}
+
+		// Qualunque thread, senza lock: nullptr finche' build() non e' finita
+		const PairTable* find(Timbre t) const noexcept { return published[(size_t)t].load(std::memory_order_acquire); }
+
+	private:
+		juce::CriticalSection lock;
+		std::array<std::unique_ptr<PairTable>, NUM_TIMBRES> tables;
+		std::array<std::atomic<const PairTable*>, NUM_TIMBRES> published{};
+	};
+
+	//============================================================================
+	MidiDissonanceEstimator() = default;
+
+	// Qualunque thread: process() passa alle tabelle del timbro appena ci sono
+	void setTimbre(Timbre t) noexcept { timbre.store((int)t); }
+	Timbre getTimbre() const noexcept { return (Timbre)timbre.load(); }
+
+	// Costruisce le tabelle di un timbro, se mancano. Bloccante (fino a
+	// qualche decina di ms): da un thread di lavoro, mai dal thread audio.
+	void buildTables(Timbre t) { sharedTables->build(t); }
+	bool hasTables(Timbre t) const noexcept { return sharedTables->find(t) != nullptr; }
+
+	void setDissonanceModel(DissonanceModel m) noexcept { dissonanceModel.store((int)m); }
+
+	//============================================================================
+	// Applica gli eventi del blocco al campione esatto — nessuna allocazione
+	void process(const juce::MidiBuffer& midi, int numSamples) noexcept
+	{
+		numChanges = 0;
+		blockStartValue = dissonanceValue.load();
+
+		const auto* table = sharedTables->find(getTimbre());
+		if (table == nullptr)
+			table = activeTable;
+
+		const auto model = (DissonanceModel)dissonanceModel.load();
+		if (table != activeTable || model != activeModel)
+		{
+			activeTable = table;
+			activeModel = model;
+			recompute();
+			recordChange(0);
+		}
+
+		for (const auto metadata : midi)
+		{
+			// Byte grezzi: un MidiMessage copierebbe i sysex sullo heap
+			if (metadata.numBytes < 1)
+				continue;
+
+			const int sample = juce::jlimit(0, juce::jmax(0, numSamples - 1), metadata.samplePosition);
+			if (handleEvent(metadata.data, metadata.numBytes))
+				recordChange(sample);
+		}
+	}
+
+	// Dissonanza normalizzata [0,1] delle note che suonano alla fine
+	// dell'ultimo blocco (0 senza note o con una sola sinusoide)
+	float getDissonance() const noexcept { return dissonanceValue.load(); }
+
+	// Valore all'inizio dell'ultimo blocco, fino al primo cambio. Solo dal
+	// thread che chiama process() (o offline, nei test).
+	float getBlockStartDissonance() const noexcept { return blockStartValue; }
+
+	// Cambi del valore nell'ultimo blocco, in ordine di campione (piu' eventi
+	// sullo stesso campione danno un solo cambio). Solo dal thread che chiama
+	// process() (o offline, nei test).
+	int getNumChanges() const noexcept { return numChanges; }
+	const Change& getChange(int i) const noexcept { return changes[(size_t)i]; }
+
+	// Note che suonano (tenute o sostenute dal pedale) e loro spettro
+	int   getNumSoundingNotes() const noexcept { return numSounding; }
+	int   getSoundingNote(int i) const noexcept { return soundingNotes[(size_t)i]; }
+	float getNoteGain(int note) const noexcept { return noteGains[(size_t)note]; }
+	// Spettro vuoto finche' non ci sono tabelle
+	const NoteSpectrum& getSpectrum(int note) const noexcept
+	{
+		static const NoteSpectrum none;
+		return activeTable != nullptr ? activeTable->getSpectrum(note) : none;
+	}
+
+	//============================================================================
+	// Tutte le note spente
+	void reset() noexcept
+	{
+		for (auto& channel : keyDown)    channel.fill(false);
+		for (auto& channel : sustained)  channel.fill(false);
+		pedalDown.fill(false);
+		noteGains.fill(0.0f);
+		soundingIndex.fill(-1);
+		numSounding = 0;
+		totalDissonance = 0.0;
+		totalWeight = 0.0;
+		numChanges = 0;
+		blockStartValue = 0.0f;
+		dissonanceValue.store(0.0f);
+	}
+
+private:
+	//============================================================================
+	// true se l'evento ha cambiato le note che suonano
+	bool handleEvent(const juce::uint8* data, int numBytes) noexcept
+	{
+		const int status = data[0] & 0xf0;
+		const int channel = data[0] & 0x0f;
+
+		if (status == 0x90 && numBytes >= 3 && data[2] > 0)
+			return noteOn(channel, data[1] & 0x7f, (float)data[2] / 127.0f);
+
+		if ((status == 0x80 || status == 0x90) && numBytes >= 3)
+			return noteOff(channel, data[1] & 0x7f);
+
+		if (status == 0xb0 && numBytes >= 3)
+		{
+			const int controller = data[1];
+			if (controller == 64)
+				return data[2] >= 64 ? pedalOn(channel) : pedalOff(channel);
+			if (controller == 120 || controller == 123)
+				return allNotesOff(channel);
+		}
+
+		return false;
+	}
+
+	bool noteOn(int channel, int note, float gain) noexcept
+	{
+		keyDown[(size_t)channel][(size_t)note] = true;
+		sustained[(size_t)channel][(size_t)note] = false;
+
+		if (soundingIndex[(size_t)note] >= 0)
+		{
+			if (noteGains[(size_t)note] == gain)
+				return false;
+			removeNote(note);    // ribattuta con un'altra velocity
+		}
+
+		addNote(note, gain);
+		return true;
+	}
+
+	bool noteOff(int channel, int note) noexcept
+	{
+		if (! keyDown[(size_t)channel][(size_t)note])
+			return false;
+
+		keyDown[(size_t)channel][(size_t)note] = false;
+		if (pedalDown[(size_t)channel])
+		{
+			sustained[(size_t)channel][(size_t)note] = true;
+			return false;
+		}
+
+		return releaseIfSilent(note);
+	}
+
+	bool pedalOn(int channel) noexcept
+	{
+		pedalDown[(size_t)channel] = true;
+		return false;
+	}
+
+	bool pedalOff(int channel) noexcept
+	{
+		pedalDown[(size_t)channel] = false;
+
+		bool changed = false;
+		for (int note = 0; note < NUM_NOTES; ++note)
+		{
+			if (sustained[(size_t)channel][(size_t)note])
+			{
+				sustained[(size_t)channel][(size_t)note] = false;
+				changed = releaseIfSilent(note) || changed;
+			}
+		}
+		return changed;
+	}
+
+	bool allNotesOff(int channel) noexcept
+	{
+		bool changed = false;
+		for (int note = 0; note < NUM_NOTES; ++note)
+		{
+			if (keyDown[(size_t)channel][(size_t)note] || sustained[(size_t)channel][(size_t)note])
+			{
+				keyDown[(size_t)channel][(size_t)note] = false;
+				sustained[(size_t)channel][(size_t)note] = false;
+				changed = releaseIfSilent(note) || changed;
+			}
+		}
+		return changed;
+	}
+
+	// Una nota smette di suonare quando nessun canale la tiene piu'
+	bool releaseIfSilent(int note) noexcept
+	{
+		for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+			if (keyDown[(size_t)ch][(size_t)note] || sustained[(size_t)ch][(size_t)note])
+				return false;
+
+		if (soundingIndex[(size_t)note] < 0)
+			return false;
+
+		removeNote(note);
+		return true;
+	}
+
+	//============================================================================
+	// Contributo di una nota con tutte le altre che suonano (e con se stessa):
+	// n letture di tabella
+	void accumulate(int note, float gain, double sign) noexcept
+	{
+		if (activeTable == nullptr)
+			return;
+
+		for (int i = 0; i < numSounding; ++i)
+		{
+			const int other = soundingNotes[(size_t)i];
+			const float scale = velocityScale(gain, noteGains[(size_t)other]);
+			totalDissonance += sign * (double)(scale * activeTable->getDissonance(activeModel, note, other));
+			totalWeight += sign * (double)(scale * activeTable->getWeight(activeModel, note, other));
+		}
+	}
+
+	void addNote(int note, float gain) noexcept
+	{
+		noteGains[(size_t)note] = gain;
+		soundingIndex[(size_t)note] = numSounding;
+		soundingNotes[(size_t)numSounding++] = note;
+		accumulate(note, gain, 1.0);     // la nota e' gia' nell'elenco: conta anche la diagonale
+	}
+
+	void removeNote(int note) noexcept
+	{
+		accumulate(note, noteGains[(size_t)note], -1.0);
+
+		const int index = soundingIndex[(size_t)note];
+		const int last = soundingNotes[(size_t)--numSounding];
+		soundingNotes[(size_t)index] = last;
+		soundingIndex[(size_t)last] = index;
+		soundingIndex[(size_t)note] = -1;
+		noteGains[(size_t)note] = 0.0f;
+
+		// Nessuna nota: si riparte da zero esatto, senza residui di arrotondamento
+		if (numSounding == 0)
+			totalDissonance = totalWeight = 0.0;
+	}
+
+	// Dopo un cambio di timbro o di modello: tutte le coppie da capo
+	void recompute() noexcept
+	{
+		totalDissonance = 0.0;
+		totalWeight = 0.0;
+		const int count = numSounding;
+		numSounding = 0;
+
+		for (int i = 0; i < count; ++i)
+		{
+			const int note = soundingNotes[(size_t)i];
+			++numSounding;
+			accumulate(note, noteGains[(size_t)note], 1.0);
+		}
+	}
+
+	float velocityScale(float a, float b) const noexcept
+	{
+		return activeModel == DissonanceModel::Vassilakis ? VassilakisModel::weight(a, b) : a * b;
+	}
+
+	void recordChange(int sample) noexcept
+	{
+		const float value = totalWeight > 1e-6 ? juce::jlimit(0.0f, 1.0f, (float)(totalDissonance / totalWeight)) : 0.0f;
+		dissonanceValue.store(value);
+
+		// Stesso campione, o elenco pieno: vale l'ultimo
+		if (numChanges > 0 && (changes[(size_t)(numChanges - 1)].sample == sample || numChanges == MAX_CHANGES_PER_BLOCK))
+			changes[(size_t)(numChanges - 1)] = { sample, value };
+		else
+			changes[(size_t)numChanges++] = { sample, value };
+	}
+
+	//============================================================================
+	juce::SharedResourcePointer<SharedTables> sharedTables;
+	std::atomic<int> timbre{ (int)Timbre::Sawtooth };
+	std::atomic<int> dissonanceModel{ (int)DissonanceModel::Sethares };
+
+	// Thread audio
+	const PairTable* activeTable = nullptr;
+	DissonanceModel  activeModel = DissonanceModel::Sethares;
+
+	std::array<std::array<bool, NUM_NOTES>, NUM_CHANNELS> keyDown{};
+	std::array<std::array<bool, NUM_NOTES>, NUM_CHANNELS> sustained{};   // rilasciate col pedale giu'
+	std::array<bool, NUM_CHANNELS> pedalDown{};
+
+	std::array<float, NUM_NOTES> noteGains{};
+	std::array<int, NUM_NOTES>   soundingIndex = makeEmptyIndex();      // posizione in soundingNotes, -1 = spenta
+	std::array<int, NUM_NOTES>   soundingNotes{};
+	int    numSounding = 0;
+	double totalDissonance = 0.0;
+	double totalWeight = 0.0;
+
+	std::array<Change, MAX_CHANGES_PER_BLOCK> changes{};
+	int   numChanges = 0;
+	float blockStartValue = 0.0f;
+
+	std::atomic<float> dissonanceValue{ 0.0f };
+
+	static std::array<int, NUM_NOTES> makeEmptyIndex() noexcept
+	{
+		std::array<int, NUM_NOTES> index;
+		index.fill(-1);
+		return index;
+	}
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiDissonanceEstimator)
+};
@@ -0,0 +1,117 @@
+/*
+	==============================================================================
+	PartialResonatorBank.h
+
+	Banco di risonatori (sliding DFT a frequenza arbitraria) sintonizzati sui
+	parziali rilevati dall'ultimo frame FFT del DissonanceAnalyser.
+
+	Tra un frame FFT e il successivo (HOP_SIZE campioni) aggiorna l'ampiezza
+	di ogni parziale a ogni campione, cosi' la dissonanza puo' essere
+	ricalcolata a ogni blocco audio invece che una volta per hop.
+
+	Per ogni risonatore (finestra rettangolare smorzata di WindowLength campioni):
+		X(n) = x(n) + r*e^{-jw} * X(n-1) - r^L * e^{-jwL} * x(n-L)
+	cioe' la DFT su finestra scorrevole valutata esattamente alla frequenza w
+	(non vincolata ai bin). Lo smorzamento r < 1 rende il ricorsore stabile
+	anche in float: gli errori di arrotondamento decadono invece di accumularsi.
+
+	Costo: O(numero di parziali) per campione, indipendente da FFT_SIZE.
+	Il riallineamento a ogni frame (retune) costa O(parziali * WindowLength).
+
+	Nessuna allocazione dinamica.
+	==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cmath>
+
+template <int MaxResonators, int WindowLength>
+class PartialResonatorBank
+{
+public:
+	//============================================================================
+	static constexpr float DAMPING = 0.9999f;
+
+	//============================================================================
+	// Sintonizza il banco sulle frequenze date e inizializza lo stato con gli
+	// ultimi WindowLength campioni del buffer circolare 'history' (dimensione
+	// potenza di 2, 'newestIndex' = campione piu' recente), cosi' le ampiezze
+	// sono subito valide senza attendere che la finestra si riempia.
+	void retune(const float* frequencies, int numFrequencies, float sampleRate,
+		const float* history, int historyMask, int newestIndex) noexcept
+	{
+		numResonators = juce::jmin(numFrequencies, MaxResonators);
+
+		// Guadagno della finestra smorzata: sum_{m<L} r^m
+		const double rL = std::pow((double)DAMPING, (double)WindowLength);
+		windowGain = (float)((1.0 - rL) / (1.0 - (double)DAMPING));
+
+		for (int k = 0; k < numResonators; ++k)
+		{
+			const double w = juce::MathConstants<double>::twoPi * frequencies[k] / sampleRate;
+
+			rotRe[k] = (float)(DAMPING * std::cos(w));
+			rotIm[k] = (float)(-DAMPING * std::sin(w));
+			tailRe[k] = (float)(rL * std::cos(w * WindowLength));
+			tailIm[k] = (float)(-rL * std::sin(w * WindowLength));
+
+			// X = sum_{m<L} r^m e^{-jwm} x(n-m), fasore aggiornato per ricorsione
+			double pRe = 1.0, pIm = 0.0;
+			double accRe = 0.0, accIm = 0.0;
+			for (int m = 0; m < WindowLength; ++m)
+			{
+				const double x = history[(newestIndex - m) & historyMask];
+				accRe += pRe * x;
+				accIm += pIm * x;
+
+				const double nRe = pRe * rotRe[k] - pIm * rotIm[k];
+				pIm = pRe * rotIm[k] + pIm * rotRe[k];
+				pRe = nRe;
+			}
+
+			stateRe[k] = (float)accRe;
+			stateIm[k] = (float)accIm;
+		}
+	}
+
+	//============================================================================
+	// xNew = x(n), xOld = x(n - WindowLength)
+	void pushSample(float xNew, float xOld) noexcept
+	{
+		for (int k = 0; k < numResonators; ++k)
+		{
+			const float re = xNew + rotRe[k] * stateRe[k] - rotIm[k] * stateIm[k] - tailRe[k] * xOld;
+			const float im =        rotRe[k] * stateIm[k] + rotIm[k] * stateRe[k] - tailIm[k] * xOld;
+			stateRe[k] = re;
+			stateIm[k] = im;
+		}
+	}
+
+	//============================================================================
+	// Ampiezza sulla stessa scala dei picchi FFT del DissonanceAnalyser
+	// (Hann normalizzata a guadagno unitario, fattore 2/N → A per una
+	// sinusoide di ampiezza A): |X| vale A/2 * windowGain
+	float getAmplitude(int k) const noexcept
+	{
+		return 2.0f * std::sqrt(stateRe[k] * stateRe[k] + stateIm[k] * stateIm[k]) / windowGain;
+	}
+
+	int  getNumResonators() const noexcept { return numResonators; }
+
+	void reset() noexcept
+	{
+		numResonators = 0;
+		stateRe.fill(0.0f);
+		stateIm.fill(0.0f);
+	}
+
+private:
+	std::array<float, MaxResonators> rotRe{}, rotIm{};     // r * e^{-jw}
+	std::array<float, MaxResonators> tailRe{}, tailIm{};   // r^L * e^{-jwL}
+	std::array<float, MaxResonators> stateRe{}, stateIm{};
+
+	int   numResonators = 0;
+	float windowGain = (float)WindowLength;
+};
@@ -0,0 +1,229 @@
+/*
+	==============================================================================
+	RoughnessAnalyser.h
+
+	Motore alternativo al DissonanceAnalyser: calcola la ruvidita' (roughness)
+	direttamente nel dominio del tempo, nello spirito di Daniel & Weber (1997)
+	e Vassilakis (2001), senza FFT ne' frame.
+
+	Algoritmo (per ogni banda critica, NUM_BANDS bande spaziate in ERB):
+		1. Filtro passa-banda del 4o ordine (due biquad in cascata, larghezza
+		   di banda = 1 ERB) - approssimazione di un filtro gammatone
+		2. Inviluppo: raddrizzamento a onda intera + passa-basso a un polo
+		3. Pesatura della frequenza di battimento: passa-banda sull'inviluppo
+		   centrato sul battimento di massima dissonanza della curva di
+		   Plomp-Levelt/Sethares per quella banda (~23 Hz a 440 Hz, ~33 Hz a
+		   1 kHz), Q basso
+		4. Profondita' di modulazione m^2 = 2 * <fluttuazione^2> / <inviluppo>^2
+		5. Roughness = media di m^2 pesata per l'energia di ogni banda, in [0,1]
+
+	Gli stati dei filtri sono elaborati in parallelo nelle corsie SIMD
+	(juce::dsp::SIMDRegister): NUM_BANDS / SIMDNumElements iterazioni per
+	campione. L'uscita viene aggiornata ogni OUTPUT_INTERVAL campioni e a ogni
+	updateBetweenFrames(), con la sola latenza di gruppo dei filtri.
+
+	Stessa interfaccia del DissonanceAnalyser (prepare, pushSample,
+	updateBetweenFrames, getDissonance, reset). Nessuna allocazione dinamica
+	in pushSample().
+	==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cmath>
+#include "AnalysisDecimator.h"
+#include "DissonanceModels.h"
+
+class RoughnessAnalyser
+{
+public:
+	//============================================================================
+	using Vec = juce::dsp::SIMDRegister<float>;
+
+	static constexpr int   NUM_BANDS = 24;
+	static constexpr int   LANES = (int)Vec::SIMDNumElements;
+	static constexpr int   NUM_VECS = NUM_BANDS / LANES;
+	static constexpr int   OUTPUT_INTERVAL = 32;           // campioni di analisi
+	static constexpr float LOWEST_BAND_HZ = 100.0f;
+	static constexpr float HIGHEST_BAND_HZ = 12000.0f;
+	static constexpr float BEAT_WEIGHT_Q = 0.5f;
+	static constexpr float ENVELOPE_CUTOFF_HZ = 300.0f;
+	static constexpr float AVERAGING_TIME_S = 0.05f;
+	static constexpr float SILENCE_THRESHOLD = 1e-4f;      // inviluppo medio minimo
+
+	static_assert (NUM_BANDS % LANES == 0, "NUM_BANDS deve essere multiplo delle corsie SIMD");
+
+	//============================================================================
+	RoughnessAnalyser() = default;
+
+	//============================================================================
+	void prepare(double sampleRate) noexcept
+	{
+		decimator.prepare(sampleRate);
+		analysisRate = (float)decimator.getOutputSampleRate();
+
+		// Centri equispaziati sulla scala ERB-rate: E(f) = 21.4 log10(4.37 f / 1000 + 1)
+		const float topHz = juce::jmin(HIGHEST_BAND_HZ, 0.4f * analysisRate);
+		const float eLow = erbRate(LOWEST_BAND_HZ);
+		const float eHigh = erbRate(topHz);
+
+		const float avgCoeff = 1.0f - std::exp(-1.0f / (AVERAGING_TIME_S * analysisRate));
+
+		for (int b = 0; b < NUM_BANDS; ++b)
+		{
+			const float e = eLow + (eHigh - eLow) * (float)b / (float)(NUM_BANDS - 1);
+			const float fc = (std::pow(10.0f, e / 21.4f) - 1.0f) * 1000.0f / 4.37f;
+			const float erb = 24.7f * (4.37f * fc / 1000.0f + 1.0f);
+			const auto  band = bandPass(fc, fc / erb);
+			const auto  beat = bandPass(maxRoughnessBeatHz(fc), BEAT_WEIGHT_Q);
+
+			// L'inviluppo segue al massimo ENVELOPE_CUTOFF_HZ, e comunque meno di
+			// fc/2, per non confondere l'ondulazione a 2 fc con un battimento
+			const float envHz = juce::jmin(ENVELOPE_CUTOFF_HZ, 0.5f * fc);
+
+			const size_t v = (size_t)(b / LANES), l = (size_t)(b % LANES);
+			bandB0[v].set(l, band.b0);
+			bandA1[v].set(l, band.a1);
+			bandA2[v].set(l, band.a2);
+			envCoeff[v].set(l, 1.0f - std::exp(-juce::MathConstants<float>::twoPi * envHz / analysisRate));
+			beatB0[v].set(l, beat.b0);
+			beatA1[v].set(l, beat.a1);
+			beatA2[v].set(l, beat.a2);
+			averaging[v].set(l, avgCoeff);
+			centreFrequencies[(size_t)b] = fc;
+		}
+
+		reset();
+	}
+
+	//============================================================================
+	// Chiamato per ogni campione mono alla frequenza dell'host — nessuna allocazione
+	void pushSample(float sample) noexcept
+	{
+		float decimated;
+		if (! decimator.pushSample(sample, decimated))
+			return;
+
+		const Vec x = Vec::expand(decimated);
+
+		for (int v = 0; v < NUM_VECS; ++v)
+		{
+			// 1. Passa-banda 4o ordine: due biquad TDF-II (b1 = 0, b2 = -b0)
+			Vec y1 = bandB0[v] * x + s1a[v];
+			s1a[v] = s2a[v] - bandA1[v] * y1;
+			s2a[v] = Vec::expand(0.0f) - bandB0[v] * x - bandA2[v] * y1;
+
+			Vec y2 = bandB0[v] * y1 + s1b[v];
+			s1b[v] = s2b[v] - bandA1[v] * y2;
+			s2b[v] = Vec::expand(0.0f) - bandB0[v] * y1 - bandA2[v] * y2;
+
+			// 2. Inviluppo: |y| filtrato passa-basso
+			envelope[v] += envCoeff[v] * (Vec::abs(y2) - envelope[v]);
+
+			// 3. Pesatura del battimento: passa-banda sull'inviluppo
+			Vec f = beatB0[v] * envelope[v] + s1m[v];
+			s1m[v] = s2m[v] - beatA1[v] * f;
+			s2m[v] = Vec::expand(0.0f) - beatB0[v] * envelope[v] - beatA2[v] * f;
+
+			// 4. Medie mobili di inviluppo e potenza della fluttuazione
+			envMean[v] += averaging[v] * (envelope[v] - envMean[v]);
+			fluctPower[v] += averaging[v] * (f * f - fluctPower[v]);
+		}
+
+		if (++sampleCount >= OUTPUT_INTERVAL)
+		{
+			sampleCount = 0;
+			publish();
+		}
+	}
+
+	//============================================================================
+	// Pubblica subito il valore corrente (chiamato una volta per blocco audio)
+	void updateBetweenFrames() noexcept { publish(); }
+
+	// Risultato normalizzato [0,1]: 0 = nessun battimento, 1 = massima ruvidita'
+	float getDissonance() const noexcept { return dissonanceValue.load(); }
+
+	float getAnalysisSampleRate() const noexcept { return analysisRate; }
+	float getBandCentreFrequency(int band) const noexcept { return centreFrequencies[(size_t)band]; }
+
+	//============================================================================
+	void reset() noexcept
+	{
+		decimator.reset();
+
+		for (auto* state : { &s1a, &s2a, &s1b, &s2b, &s1m, &s2m, &envelope, &envMean, &fluctPower })
+			state->fill(Vec::expand(0.0f));
+
+		sampleCount = 0;
+		dissonanceValue.store(0.0f);
+	}
+
+private:
+	//============================================================================
+	struct BandPassCoefficients { float b0, a1, a2; };
+
+	// RBJ band-pass a guadagno unitario al centro: b1 = 0, b2 = -b0
+	BandPassCoefficients bandPass(float fc, float q) const noexcept
+	{
+		const float w0 = juce::MathConstants<float>::twoPi * fc / analysisRate;
+		const float alpha = std::sin(w0) / (2.0f * q);
+		const float a0 = 1.0f + alpha;
+		return { alpha / a0, -2.0f * std::cos(w0) / a0, (1.0f - alpha) / a0 };
+	}
+
+	// Battimento di massima dissonanza nella curva di Sethares (SetharesModel):
+	// il massimo di exp(-a1 x) - exp(-a2 x) e' in x* = ln(a2/a1) / (a2 - a1),
+	// con x = s * df e s = 0.24 / (0.0207 f + 18.96)
+	static float maxRoughnessBeatHz(float fc) noexcept
+	{
+		constexpr float a1 = SetharesModel::ALPHA1, a2 = SetharesModel::ALPHA2;
+		const float xStar = std::log(a2 / a1) / (a2 - a1);
+		return xStar * (0.0207f * fc + 18.96f) / 0.24f;
+	}
+
+	static float erbRate(float hz) noexcept { return 21.4f * std::log10(4.37f * hz / 1000.0f + 1.0f); }
+
+	//============================================================================
+	// 5. m^2 per banda, media pesata per l'energia dell'inviluppo
+	void publish() noexcept
+	{
+		float weighted = 0.0f, totalEnergy = 0.0f;
+
+		for (int b = 0; b < NUM_BANDS; ++b)
+		{
+			const size_t v = (size_t)(b / LANES), l = (size_t)(b % LANES);
+			const float mean = envMean[v][l];
+
+			if (mean < SILENCE_THRESHOLD)
+				continue;
+
+			const float energy = mean * mean;
+			const float depthSq = juce::jmin(1.0f, 2.0f * fluctPower[v][l] / energy);
+
+			weighted += depthSq * energy;
+			totalEnergy += energy;
+		}
+
+		dissonanceValue.store(totalEnergy > 0.0f ? juce::jlimit(0.0f, 1.0f, weighted / totalEnergy) : 0.0f);
+	}
+
+	//============================================================================
+	AnalysisDecimator decimator;
+	float analysisRate = 44100.0f;
+
+	std::array<Vec, NUM_VECS> bandB0{}, bandA1{}, bandA2{};
+	std::array<Vec, NUM_VECS> beatB0{}, beatA1{}, beatA2{};
+	std::array<Vec, NUM_VECS> envCoeff{}, averaging{};
+
+	std::array<Vec, NUM_VECS> s1a{}, s2a{}, s1b{}, s2b{}, s1m{}, s2m{};
+	std::array<Vec, NUM_VECS> envelope{}, envMean{}, fluctPower{};
+
+	std::array<float, NUM_BANDS> centreFrequencies{};
+
+	int sampleCount = 0;
+	std::atomic<float> dissonanceValue{ 0.0f };
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RoughnessAnalyser)
+};
@@ -0,0 +1,133 @@
+/*
+	==============================================================================
+	RoughnessSpectrum.h
+
+	Distribuzione della dissonanza sulle bande critiche (scala Bark di
+	Zwicker, 24 bande tra 0 e 15.5 kHz): ogni coppia di parziali aggiunge
+	il suo contributo alla banda della propria frequenza centrale
+	(f1 + f2) / 2. Con la stessa normalizzazione del valore scalare, la
+	somma delle bande e' la dissonanza del frame (prima del limite a 1).
+
+	Accumulo: bandOf() e' una tabella uniforme da BAND_LUT_STEP Hz (un
+	indice e una lettura, nessuna ricerca), quindi il ciclo sulle coppie
+	aggiunge solo una somma per coppia. La normalizzazione delle 24 bande
+	usa FloatVectorOperations.
+
+	Pubblicazione: il thread di analisi scrive le bande a ogni hop con un
+	seqlock (contatore dispari durante la scrittura, come in
+	SessionDissonanceRegistry.h); la UI legge una copia coerente senza lock
+	e senza mai bloccare il thread audio.
+	==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+class RoughnessSpectrum
+{
+public:
+	//============================================================================
+	static constexpr int   NUM_BANDS = 24;
+	static constexpr int   MAX_READ_ATTEMPTS = 4;
+	static constexpr float BAND_LUT_STEP = 10.0f;      // Hz, risoluzione sui bordi
+	static constexpr int   BAND_LUT_SIZE = 2048;       // fino a 20480 Hz
+
+	using Bands = std::array<float, NUM_BANDS>;
+
+	// Bordi delle bande critiche (Zwicker, 1961), in Hz
+	static constexpr std::array<float, NUM_BANDS + 1> BAND_EDGES{
+		0.0f, 100.0f, 200.0f, 300.0f, 400.0f, 510.0f, 630.0f, 770.0f, 920.0f,
+		1080.0f, 1270.0f, 1480.0f, 1720.0f, 2000.0f, 2320.0f, 2700.0f, 3150.0f,
+		3700.0f, 4400.0f, 5300.0f, 6400.0f, 7700.0f, 9500.0f, 12000.0f, 15500.0f
+	};
+
+	//============================================================================
+	// Banda critica di una frequenza (Hz); sopra l'ultimo bordo, l'ultima banda
+	static int bandOf(float freq) noexcept
+	{
+		const int index = juce::jlimit(0, BAND_LUT_SIZE - 1, (int)(freq * (1.0f / BAND_LUT_STEP)));
+		return (int)bandTable[(size_t)index];
+	}
+
+	static float getBandLowEdge(int band) noexcept  { return BAND_EDGES[(size_t)band]; }
+	static float getBandHighEdge(int band) noexcept { return BAND_EDGES[(size_t)band + 1]; }
+
+	//============================================================================
+	// Thread di analisi (un solo scrittore): pubblica bands * scale
+	void publish(Bands& bands, float scale) noexcept
+	{
+		juce::FloatVectorOperations::multiply(bands.data(), scale, NUM_BANDS);
+
+		const auto sequence = published.sequence.load(std::memory_order_relaxed);
+		published.sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		for (int b = 0; b < NUM_BANDS; ++b)
+			published.bands[(size_t)b].store(bands[(size_t)b], std::memory_order_relaxed);
+
+		published.sequence.store(sequence + 2, std::memory_order_release);
+	}
+
+	void clear() noexcept
+	{
+		Bands silence{};
+		publish(silence, 0.0f);
+	}
+
+	//============================================================================
+	// Qualunque thread: false se la copia non e' stabile entro
+	// MAX_READ_ATTEMPTS tentativi (dest resta quella letta prima)
+	bool read(Bands& dest) const noexcept
+	{
+		for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; ++attempt)
+		{
+			const auto before = published.sequence.load(std::memory_order_acquire);
+			if ((before & 1) != 0)
+				continue;
+
+			Bands copy;
+			for (int b = 0; b < NUM_BANDS; ++b)
+				copy[(size_t)b] = published.bands[(size_t)b].load(std::memory_order_relaxed);
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (published.sequence.load(std::memory_order_relaxed) == before)
+			{
+				dest = copy;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+private:
+	//============================================================================
+	// Frequenza (a passi di BAND_LUT_STEP) -> banda, calcolata a compile time
+	static constexpr std::array<juce::uint8, BAND_LUT_SIZE> makeBandTable() noexcept
+	{
+		std::array<juce::uint8, BAND_LUT_SIZE> table{};
+		int band = 0;
+		for (int i = 0; i < BAND_LUT_SIZE; ++i)
+		{
+			const float freq = (float)i * BAND_LUT_STEP;
+			while (band < NUM_BANDS - 1 && freq >= BAND_EDGES[(size_t)band + 1])
+				++band;
+			table[(size_t)i] = (juce::uint8)band;
+		}
+		return table;
+	}
+
+	static const std::array<juce::uint8, BAND_LUT_SIZE> bandTable;
+
+	struct Published
+	{
+		std::array<std::atomic<float>, NUM_BANDS> bands{};
+		std::atomic<juce::uint32> sequence{ 0 };
+	};
+
+	Published published;
+};
+
+inline const std::array<juce::uint8, RoughnessSpectrum::BAND_LUT_SIZE> RoughnessSpectrum::bandTable = RoughnessSpectrum::makeBandTable();
@@ -0,0 +1,170 @@
+/*
+	==============================================================================
+	SharedAnalysisTables.h
+
+	Tabelle di analisi condivise da tutti gli analizzatori del processo
+	(juce::SharedResourcePointer): per ogni configurazione (ordine della FFT)
+	una sola copia delle finestre - Hann normalizzata e sua derivata - e un
+	piccolo gruppo di piani FFT, invece di un piano e due finestre per ogni
+	analizzatore di ogni istanza.
+
+	I piani non si possono usare da due thread insieme (alcuni motori FFT
+	tengono un buffer di lavoro nel piano, quello di riserva di JUCE uno spin
+	lock), quindi si prendono in prestito per la durata di una trasformata:
+	tryLease() cerca un piano libero con un compare-exchange, senza lock ne'
+	allocazioni. I piani si creano su richiesta: ogni getConfiguration() (una
+	per analizzatore) ne aggiunge uno, fino a PLANS_PER_CORE per core. Piu'
+	prestiti contemporanei di cosi' richiedono thread sospesi a meta' di una
+	FFT, e in quel caso tryLease() restituisce un prestito vuoto e
+	l'analizzatore salta il frame (e lo conta).
+
+	Le configurazioni si creano alla prima richiesta (getConfiguration(),
+	puo' allocare: mai dal thread audio) e restano fino alla distruzione
+	dell'ultimo utente.
+	==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class SharedAnalysisTables
+{
+public:
+	//============================================================================
+	static constexpr int MAX_ORDER = 15;
+	static constexpr int PLANS_PER_CORE = 2;
+
+	//============================================================================
+	class Configuration;
+
+	// Prestito esclusivo di un piano FFT, restituito alla distruzione
+	class Lease
+	{
+	public:
+		Lease() = default;
+		Lease(Lease&& other) noexcept : plan(std::exchange(other.plan, nullptr)), busy(std::exchange(other.busy, nullptr)) {}
+		Lease& operator=(Lease&&) = delete;
+		~Lease() { if (busy != nullptr) busy->store(false, std::memory_order_release); }
+
+		explicit operator bool() const noexcept { return plan != nullptr; }
+		const juce::dsp::FFT* operator->() const noexcept { return plan; }
+
+	private:
+		friend class Configuration;
+		Lease(const juce::dsp::FFT* p, std::atomic<bool>* b) noexcept : plan(p), busy(b) {}
+
+		const juce::dsp::FFT* plan = nullptr;
+		std::atomic<bool>* busy = nullptr;
+	};
+
+	//============================================================================
+	class Configuration
+	{
+	public:
+		explicit Configuration(int fftOrder)
+			: order(fftOrder),
+			  size(1 << fftOrder),
+			  hann((size_t)size),
+			  hannDerivative((size_t)size),
+			  maxPlans(juce::jmax(1, PLANS_PER_CORE * juce::SystemStats::getNumCpus())),
+			  plans((size_t)maxPlans),
+			  busy(new std::atomic<bool>[(size_t)maxPlans])
+		{
+			// Hann normalizzata a guadagno unitario, h[n] = g (0.5 - 0.5 cos(2 pi n / (N-1))),
+			// e la sua derivata per campione dh[n] = g (pi / (N-1)) sin(2 pi n / (N-1))
+			juce::dsp::WindowingFunction<float>::fillWindowingTables(
+				hann.data(), (size_t)size, juce::dsp::WindowingFunction<float>::hann);
+
+			const double step = juce::MathConstants<double>::twoPi / (double)(size - 1);
+			const double gain = (double)size / (0.5 * (double)(size - 1));
+			for (int i = 0; i < size; ++i)
+				hannDerivative[(size_t)i] = (float)(gain * 0.5 * step * std::sin(step * i));
+
+			for (int i = 0; i < maxPlans; ++i)
+				busy[(size_t)i].store(false);
+		}
+
+		// Un piano in piu', fino a maxPlans (sotto il lock delle tabelle). Lo
+		// spazio e' gia' riservato: tryLease() vede il nuovo piano solo dopo
+		// la pubblicazione di numPlans.
+		void addPlan()
+		{
+			const int count = numPlans.load(std::memory_order_relaxed);
+			if (count >= maxPlans)
+				return;
+
+			plans[(size_t)count] = std::make_unique<juce::dsp::FFT>(order);
+			numPlans.store(count + 1, std::memory_order_release);
+		}
+
+		// Nessun lock, nessuna allocazione. La ricerca parte da hint (per
+		// esempio un indice diverso per ogni analizzatore) per distribuire i
+		// prestiti; vuoto se tutti i piani sono in uso.
+		Lease tryLease(int hint) const noexcept
+		{
+			const int count = numPlans.load(std::memory_order_acquire);
+			for (int i = 0; i < count; ++i)
+			{
+				const int index = (hint + i) % count;
+				bool expected = false;
+				if (busy[(size_t)index].compare_exchange_strong(expected, true, std::memory_order_acquire))
+					return Lease(plans[(size_t)index].get(), &busy[(size_t)index]);
+			}
+
+			return {};
+		}
+
+		int getNumPlans() const noexcept { return numPlans.load(std::memory_order_acquire); }
+		int getMaxPlans() const noexcept { return maxPlans; }
+
+		const int order, size;
+		std::vector<float> hann, hannDerivative;
+
+	private:
+		const int maxPlans;
+		std::atomic<int> numPlans{ 0 };
+		std::vector<std::unique_ptr<juce::dsp::FFT>> plans;   // maxPlans posti, i primi numPlans creati
+		std::unique_ptr<std::atomic<bool>[]> busy;
+
+		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Configuration)
+	};
+
+	//============================================================================
+	// Ogni richiesta aggiunge un piano alla configurazione (vedi
+	// Configuration::addPlan()). Alloca: non chiamare dal thread audio.
+	const Configuration& getConfiguration(int order)
+	{
+		order = juce::jlimit(1, MAX_ORDER, order);
+
+		const juce::ScopedLock sl(lock);
+		auto& configuration = configurations[(size_t)order];
+		if (configuration == nullptr)
+			configuration = std::make_unique<Configuration>(order);
+
+		configuration->addPlan();
+		return *configuration;
+	}
+
+	int getNumConfigurations() const
+	{
+		const juce::ScopedLock sl(lock);
+		int count = 0;
+		for (const auto& c : configurations)
+			count += c != nullptr ? 1 : 0;
+		return count;
+	}
+
+	// Indici distinti per distribuire i prestiti tra i piani
+	int nextLeaseHint() noexcept { return leaseHints.fetch_add(1, std::memory_order_relaxed) & 0xffff; }
+
+private:
+	juce::CriticalSection lock;
+	std::array<std::unique_ptr<Configuration>, MAX_ORDER + 1> configurations;
+	std::atomic<int> leaseHints{ 0 };
+};
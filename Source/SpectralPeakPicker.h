@@ -0,0 +1,280 @@
+/*
+	==============================================================================
+	SpectralPeakPicker.h
+
+	Parte comune degli analizzatori a FFT: buffer circolare del segnale,
+	finestra, trasformata e ricerca dei parziali. Usata dal DissonanceAnalyser
+	e dal CrossDissonanceAnalyser, cosi' lo stimatore di frequenza scelto
+	vale per entrambi.
+
+	Per ogni frame:
+		1. beginFrame() azzera l'accumulo per 2^frameOrder campioni
+		2. Uno o piu' segnali (buffer circolari Ring) si finestrano e si
+		   trasformano, accumulando per ogni bin:
+		     P[k] = sum |X_h[k]|^2               (potenza, finestra di Hann h)
+		     R[k] = sum Im(X_dh[k] conj(X_h[k])) (solo con la riassegnazione,
+		                                          dh = derivata della finestra)
+		   - addSignal(): un segnale; con la riassegnazione le due trasformate
+		     reali (h e dh) condividono una FFT complessa, z = x h + j x dh
+		   - addSignalPair(): due segnali con una sola FFT complessa,
+		     z = h (a + j b), separati con
+		       A[k] = (Z[k] + conj(Z[N-k])) / 2
+		       B[k] = (Z[k] - conj(Z[N-k])) / 2j
+		     (solo interpolazione parabolica)
+		   - addSignals(): i canali di un segnale multicanale, a coppie con
+		     la parabolica (C canali, ceil(C / 2) FFT), uno per FFT con la
+		     riassegnazione. Le potenze si sommano: con canali identici lo
+		     spettro e' quello del downmix, con canali in opposizione di fase
+		     non si annulla
+		3. finishFrame(): spettro di ampiezza sqrt(P / numero di segnali)
+		4. findPartials(): picchi locali sopra AMPLITUDE_THRESHOLD; la
+		   frequenza si stima per interpolazione parabolica oppure, se tutti
+		   i segnali del frame sono stati riassegnati, con
+		     w = w_k - R[k] / P[k]   [rad/campione]
+		   (con piu' segnali, media delle frequenze istantanee pesata sulla
+		   potenza)
+
+	Nessuna allocazione: tutti i buffer sono dimensionati per FFT_SIZE.
+	==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include "SharedAnalysisTables.h"
+
+class SpectralPeakPicker
+{
+public:
+	//============================================================================
+	static constexpr int   FFT_SIZE = 2048;
+	static constexpr int   FFT_ORDER = 11;    // 2^11 = 2048
+	static constexpr int   MIN_FFT_ORDER = 9; // 2^9 = 512
+	static constexpr int   MAX_PARTIALS = 24;
+	static constexpr float AMPLITUDE_THRESHOLD = 0.01f;
+
+	// Stima della frequenza di ogni picco
+	enum class FrequencyEstimator
+	{
+		Parabolic = 0,      // interpolazione parabolica sulle magnitudini
+		Reassignment = 1    // riassegnazione con la derivata della finestra
+	};
+
+	struct Partial { float freq; float amp; };
+
+	//============================================================================
+	// Buffer circolare di FFT_SIZE campioni di analisi di un segnale
+	struct Ring
+	{
+		std::array<float, FFT_SIZE> samples{};
+		int writePos = 0;
+
+		void push(float x) noexcept
+		{
+			samples[(size_t)writePos] = x;
+			writePos = (writePos + 1) & (FFT_SIZE - 1);
+		}
+
+		// x(n - delay), con n = prossimo campione da scrivere: va letto
+		// prima di push() (delay = FFT_SIZE e' il campione che verra' sovrascritto)
+		float delayed(int delay) const noexcept { return samples[(size_t)((writePos - delay) & (FFT_SIZE - 1))]; }
+
+		// Campione i (in ordine cronologico) degli ultimi frameSize
+		float frameSample(int frameSize, int i) const noexcept { return samples[(size_t)((writePos - frameSize + i) & (FFT_SIZE - 1))]; }
+
+		int newestIndex() const noexcept { return (writePos - 1) & (FFT_SIZE - 1); }
+
+		void clear() noexcept
+		{
+			samples.fill(0.0f);
+			writePos = 0;
+		}
+	};
+
+	//============================================================================
+	// 1. Nuovo frame di 2^frameOrder campioni
+	void beginFrame(int frameOrder) noexcept
+	{
+		frameSize = 1 << frameOrder;
+		numSignals = 0;
+		reassigned = true;
+		std::fill(power.begin(), power.begin() + frameSize / 2, 0.0f);
+		std::fill(slope.begin(), slope.begin() + frameSize / 2, 0.0f);
+	}
+
+	// 2. Un segnale, una FFT (complessa con la riassegnazione, reale altrimenti)
+	void addSignal(const Ring& ring, const SharedAnalysisTables::Configuration& tables,
+		const SharedAnalysisTables::Lease& fft, FrequencyEstimator estimator) noexcept
+	{
+		const int numBins = frameSize / 2;
+		const float* window = tables.hann.data();
+
+		if (estimator == FrequencyEstimator::Reassignment)
+		{
+			const float* windowDerivative = tables.hannDerivative.data();
+			for (int i = 0; i < frameSize; ++i)
+			{
+				const float x = ring.frameSample(frameSize, i);
+				complexIn[(size_t)i] = { x * window[i], x * windowDerivative[i] };
+			}
+
+			fft->perform(complexIn.data(), complexOut.data(), false);
+
+			for (int k = 0; k < numBins; ++k)
+			{
+				const auto xh = firstSpectrum(k);
+				const auto xdh = secondSpectrum(k);
+				power[(size_t)k] += std::norm(xh);
+				slope[(size_t)k] += (xdh * std::conj(xh)).imag();
+			}
+		}
+		else
+		{
+			reassigned = false;
+
+			for (int i = 0; i < frameSize; ++i)
+				realBuffer[(size_t)i] = ring.frameSample(frameSize, i) * window[i];
+			std::fill(realBuffer.begin() + frameSize, realBuffer.begin() + 2 * frameSize, 0.0f);
+
+			// Magnitudini in realBuffer[0..frameSize/2]
+			fft->performFrequencyOnlyForwardTransform(realBuffer.data());
+
+			for (int k = 0; k < numBins; ++k)
+				power[(size_t)k] += realBuffer[(size_t)k] * realBuffer[(size_t)k];
+		}
+
+		++numSignals;
+	}
+
+	// 2. Due segnali con una sola FFT complessa, ciascuno accumulato nel suo
+	// picker (anche lo stesso: le potenze si sommano). Solo parabolica.
+	static void addSignalPair(const Ring& a, SpectralPeakPicker& pickerA, const Ring& b, SpectralPeakPicker& pickerB,
+		const SharedAnalysisTables::Configuration& tables, const SharedAnalysisTables::Lease& fft) noexcept
+	{
+		const int frameSize = pickerA.frameSize;
+		const float* window = tables.hann.data();
+		auto& scratch = pickerA;
+
+		for (int i = 0; i < frameSize; ++i)
+			scratch.complexIn[(size_t)i] = { a.frameSample(frameSize, i) * window[i], b.frameSample(frameSize, i) * window[i] };
+
+		fft->perform(scratch.complexIn.data(), scratch.complexOut.data(), false);
+
+		for (int k = 0; k < frameSize / 2; ++k)
+		{
+			pickerA.power[(size_t)k] += std::norm(scratch.firstSpectrum(k));
+			pickerB.power[(size_t)k] += std::norm(scratch.secondSpectrum(k));
+		}
+
+		pickerA.reassigned = false;
+		pickerB.reassigned = false;
+		++pickerA.numSignals;
+		++pickerB.numSignals;
+	}
+
+	// 2. Tutti i canali di un segnale, accumulati in questo picker
+	void addSignals(const Ring* rings, int numRings, const SharedAnalysisTables::Configuration& tables,
+		const SharedAnalysisTables::Lease& fft, FrequencyEstimator estimator) noexcept
+	{
+		if (estimator == FrequencyEstimator::Reassignment)
+		{
+			for (int ch = 0; ch < numRings; ++ch)
+				addSignal(rings[ch], tables, fft, estimator);
+			return;
+		}
+
+		int ch = 0;
+		for (; ch + 1 < numRings; ch += 2)
+			addSignalPair(rings[ch], *this, rings[ch + 1], *this, tables, fft);
+
+		if (ch < numRings)
+			addSignal(rings[ch], tables, fft, estimator);
+	}
+
+	// 3. Spettro di ampiezza combinato (con un solo segnale, |X_h|)
+	void finishFrame() noexcept
+	{
+		const float signalNorm = 1.0f / (float)juce::jmax(1, numSignals);
+		for (int k = 0; k < frameSize / 2; ++k)
+			magnitudes[(size_t)k] = std::sqrt(power[(size_t)k] * signalNorm);
+	}
+
+	int getNumBins() const noexcept { return frameSize / 2; }
+	const float* getMagnitudes() const noexcept { return magnitudes.data(); }
+
+	//============================================================================
+	// 4. Parziali in ordine di frequenza (al massimo MAX_PARTIALS), ampiezze
+	// sulla scala di una sinusoide (fattore 2/N, finestra a guadagno unitario)
+	int findPartials(float sampleRate, Partial* partials) const noexcept
+	{
+		const int   numBins = frameSize / 2;
+		const float normFactor = 2.0f / (float)frameSize;
+		const bool  reassign = reassigned && numSignals > 0;
+		int numPartials = 0;
+
+		for (int k = 1; k < numBins - 1 && numPartials < MAX_PARTIALS; ++k)
+		{
+			const float amp = magnitudes[(size_t)k] * normFactor;
+
+			if (amp > AMPLITUDE_THRESHOLD
+				&& amp > magnitudes[(size_t)k - 1] * normFactor
+				&& amp > magnitudes[(size_t)k + 1] * normFactor)
+			{
+				float delta;
+
+				if (reassign)
+				{
+					// Riassegnazione: w = w_k - R / P  [rad/campione]
+					const float im = slope[(size_t)k] / (power[(size_t)k] + 1e-20f);
+					delta = juce::jlimit(-1.0f, 1.0f,
+						-im * (float)frameSize / juce::MathConstants<float>::twoPi);
+				}
+				else
+				{
+					// Interpolazione parabolica per stima precisa della frequenza
+					const float alpha = magnitudes[(size_t)k - 1] * normFactor;
+					const float beta = amp;
+					const float gamma = magnitudes[(size_t)k + 1] * normFactor;
+					delta = 0.5f * (alpha - gamma)
+						/ (alpha - 2.0f * beta + gamma + 1e-10f);
+				}
+
+				const float freq = ((float)k + delta) * sampleRate / (float)frameSize;
+
+				if (freq > 20.0f && freq < 20000.0f)
+					partials[numPartials++] = { freq, amp };
+			}
+		}
+
+		return numPartials;
+	}
+
+private:
+	//============================================================================
+	// Separa le due trasformate reali impacchettate in complexOut
+	std::complex<float> firstSpectrum(int k) const noexcept
+	{
+		return 0.5f * (complexOut[(size_t)k] + std::conj(complexOut[(size_t)((frameSize - k) & (frameSize - 1))]));
+	}
+
+	std::complex<float> secondSpectrum(int k) const noexcept
+	{
+		const auto d = complexOut[(size_t)k] - std::conj(complexOut[(size_t)((frameSize - k) & (frameSize - 1))]);
+		return { 0.5f * d.imag(), -0.5f * d.real() };
+	}
+
+	//============================================================================
+	std::array<float, FFT_SIZE * 2> realBuffer{};
+	std::array<std::complex<float>, FFT_SIZE> complexIn{};
+	std::array<std::complex<float>, FFT_SIZE> complexOut{};
+	std::array<float, FFT_SIZE / 2> power{};
+	std::array<float, FFT_SIZE / 2> slope{};
+	std::array<float, FFT_SIZE / 2> magnitudes{};
+
+	int  frameSize = FFT_SIZE;
+	int  numSignals = 0;
+	bool reassigned = false;
+};
@@ -0,0 +1,65 @@
+/*
+	==============================================================================
+
+		ActivityDetector.h
+
+		Rilevatore di silenzio a blocchi, con isteresi temporale: diventa
+		"silenzioso" solo dopo holdSeconds consecutivi sotto SILENCE_THRESHOLD
+		e torna attivo al primo blocco sopra soglia (risveglio immediato).
+
+		Ogni stadio ne usa uno per mettersi a riposo: l'analizzatore sul
+		segnale d'ingresso, Distortion e BandPass sul proprio ingresso e sul
+		proprio stato interno, cosi' dormono solo dopo che lo stato e' decaduto
+		sotto soglia e il risveglio riparte da uno stato nullo senza click.
+
+	==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+
+class ActivityDetector
+{
+public:
+	//==============================================================================
+	static constexpr float SILENCE_THRESHOLD = 3.1623e-5f;   // -90 dBFS di picco
+
+	//==============================================================================
+	void prepare(double sampleRate, double holdSeconds) noexcept
+	{
+		holdSamples = juce::jmax((juce::int64)1, (juce::int64)std::ceil(sampleRate * holdSeconds));
+		reset();
+	}
+
+	// Da chiamare una volta per blocco con il picco (o lo stato) da
+	// confrontare con la soglia; restituisce true se il blocco e' silenzioso
+	// da almeno holdSeconds
+	bool update(float blockPeak, int numSamples) noexcept
+	{
+		if (blockPeak >= SILENCE_THRESHOLD)
+			silentSamples = 0;
+		else
+			silentSamples = juce::jmin(silentSamples + numSamples, holdSamples);
+
+		return isSilent();
+	}
+
+	bool isSilent() const noexcept { return silentSamples >= holdSamples; }
+
+	void reset() noexcept { silentSamples = 0; }
+
+	//==============================================================================
+	// Picco del blocco in singola o doppia precisione, confrontato in float
+	template <typename SampleType>
+	static float getPeak(const juce::AudioBuffer<SampleType>& buffer, int numChannels, int numSamples) noexcept
+	{
+		float peak = 0.0f;
+		for (int ch = 0; ch < numChannels; ++ch)
+			peak = juce::jmax(peak, (float)buffer.getMagnitude(ch, 0, numSamples));
+		return peak;
+	}
+
+private:
+	juce::int64 holdSamples = 1;
+	juce::int64 silentSamples = 0;
+};
@@ -0,0 +1,442 @@
+/*
+	==============================================================================
+
+		DissonanceMap.h
+
+		Serie temporale della dissonanza di un intero file audio (o di un suo
+		intervallo), calcolata offline con lo stesso DissonanceAnalyser del
+		processBlock: un valore e fino a MAX_PARTIALS parziali per hop.
+
+		Il frame i descrive la finestra di analisi che finisce al campione
+		start + (i + 2) * hop, centrata in start + (i + 1) * hop; l'hop e'
+		mezzo frame FFT in campioni del file. Ogni campione appartiene al frame
+		col centro piu' vicino (i primi e gli ultimi mezzo hop al primo e
+		all'ultimo); in fondo si spinge silenzio finche' l'ultimo frame e'
+		completo.
+
+		analyse() legge da un qualunque juce::AudioFormatReader (nel plugin un
+		ARAAudioSourceReader, su un thread in background): puo' allocare e
+		bloccarsi sul disco, non va chiamato dal thread audio. La mappa finita
+		non cambia piu' e si condivide fra thread con std::shared_ptr.
+
+		In memoria i valori sono gia' quantizzati come nell'archivio ARA
+		(writeTo / readFrom), e si decodificano solo i frame letti:
+			- dissonanza      uint16, passo 1 / 65535
+			- frequenza       uint16, log2(f / 16 Hz) in passi di 1/6000 di
+			                  ottava (0.2 cent)
+			- ampiezza        uint8, passi di 0.5 dB da -100 dB (0 = muto)
+		Nell'archivio i parziali di ogni frame sono ordinati per frequenza e
+		scritti come differenza (varint zig-zag) dal parziale nella stessa
+		posizione del frame precedente: un parziale stabile costa un byte.
+
+		L'hash del contenuto (computeContentHash) riassume formato, lunghezza
+		e NUM_HASH_PROBES blocchi sparsi nel file: permette di riusare una
+		mappa salvata senza rileggere tutto l'audio, e di scartarla se il
+		file e' cambiato.
+
+	==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "../../DissonanceAnalyser.h"
+
+class DissonanceMap
+{
+public:
+	//==============================================================================
+	static constexpr int MAX_PARTIALS = 8;          // parziali piu' forti conservati per frame
+	static constexpr int READ_BLOCK_SIZE = 8192;    // campioni letti per chiamata al reader
+	static constexpr int NUM_HASH_PROBES = 16;      // blocchi letti per l'hash del contenuto
+	static constexpr int HASH_PROBE_SIZE = 512;
+
+	static constexpr juce::uint32 ARCHIVE_MAGIC = 0x70614d44;   // "DMap"
+	static constexpr int ARCHIVE_VERSION = 1;
+	static constexpr int ARCHIVE_HEADER_SIZE = 46;             // byte fino al numero di frame compreso
+	static constexpr int MAX_ARCHIVE_FRAMES = 1 << 24;         // oltre 24 ore a hop 256 e 48 kHz
+
+	struct Partial
+	{
+		float frequency = 0.0f;   // Hz
+		float amplitude = 0.0f;   // lineare, come DissonanceAnalyser
+	};
+
+	//==============================================================================
+	DissonanceMap(double fileSampleRate, int hop, juce::Range<juce::int64> range, juce::uint64 hash = 0)
+		: sampleRate(fileSampleRate), hopSize(juce::jmax(1, hop)), sampleRange(range), contentHash(hash)
+	{
+		const auto numFrames = (size_t)getNumFramesFor(range.getLength(), hopSize);
+		dissonance.reserve(numFrames);
+		partialCounts.reserve(numFrames);
+		partials.reserve(numFrames * MAX_PARTIALS);
+	}
+
+	double getSampleRate() const noexcept { return sampleRate; }
+	int    getHopSize() const noexcept { return hopSize; }
+	juce::Range<juce::int64> getSampleRange() const noexcept { return sampleRange; }
+	int    getNumFrames() const noexcept { return (int)dissonance.size(); }
+	juce::uint64 getContentHash() const noexcept { return contentHash; }
+
+	float getDissonance(int frame) const noexcept { return decodeDissonance(dissonance[(size_t)frame]); }
+	int   getNumPartials(int frame) const noexcept { return partialCounts[(size_t)frame]; }
+
+	// Parziali del frame in ordine di frequenza crescente
+	Partial getPartial(int frame, int index) const noexcept
+	{
+		const auto& packed = partials[(size_t)frame * MAX_PARTIALS + (size_t)index];
+		return { decodeFrequency(packed.pitch), decodeAmplitude(packed.level) };
+	}
+
+	// Frame centrato piu' vicino al campione (del file), -1 fuori intervallo
+	int getFrameForSample(juce::int64 sample) const noexcept
+	{
+		if (dissonance.empty() || ! sampleRange.contains(sample))
+			return -1;
+
+		const auto frame = (sample - sampleRange.getStart() + hopSize / 2) / hopSize - 1;
+		return (int)juce::jlimit((juce::int64)0, (juce::int64)getNumFrames() - 1, frame);
+	}
+
+	float getDissonanceAtSample(juce::int64 sample) const noexcept
+	{
+		const int frame = getFrameForSample(sample);
+		return frame >= 0 ? getDissonance(frame) : 0.0f;
+	}
+
+	// Frame con il centro (start + (i + 1) * hop) entro mezzo hop dalla fine
+	static int getNumFramesFor(juce::int64 length, int hop) noexcept
+	{
+		return (int)countFrames(length, hop);
+	}
+
+	//==============================================================================
+	// Aggiunge un frame; oltre MAX_PARTIALS si tengono i parziali piu' forti
+	void addFrame(float value, const Partial* framePartials, int numFramePartials)
+	{
+		const int count = juce::jmin(numFramePartials, MAX_PARTIALS);
+		std::array<Partial, MAX_PARTIALS> strongest;
+
+		if (numFramePartials <= MAX_PARTIALS)
+		{
+			std::copy(framePartials, framePartials + count, strongest.begin());
+		}
+		else
+		{
+			std::vector<Partial> sorted(framePartials, framePartials + numFramePartials);
+			std::partial_sort(sorted.begin(), sorted.begin() + count, sorted.end(),
+				[](const Partial& a, const Partial& b) { return a.amplitude > b.amplitude; });
+			std::copy(sorted.begin(), sorted.begin() + count, strongest.begin());
+		}
+
+		std::array<PackedPartial, MAX_PARTIALS> packed{};
+		for (int p = 0; p < count; ++p)
+			packed[(size_t)p] = { encodeFrequency(strongest[(size_t)p].frequency), encodeAmplitude(strongest[(size_t)p].amplitude) };
+		std::sort(packed.begin(), packed.begin() + count,
+			[](const PackedPartial& a, const PackedPartial& b) { return a.pitch < b.pitch; });
+
+		dissonance.push_back(encodeDissonance(value));
+		partialCounts.push_back((juce::uint8)count);
+		partials.insert(partials.end(), packed.begin(), packed.end());
+	}
+
+	//==============================================================================
+	// Formato, lunghezza e NUM_HASH_PROBES blocchi equidistanti di 'range'
+	// (FNV-1a a 64 bit sui bit dei campioni). 0 se una lettura fallisce.
+	static juce::uint64 computeContentHash(juce::AudioFormatReader& reader, juce::Range<juce::int64> range)
+	{
+		range = range.getIntersectionWith({ 0, reader.lengthInSamples });
+
+		juce::uint64 hash = 0xcbf29ce484222325ull;
+		auto mix = [&hash](const void* data, size_t numBytes)
+		{
+			for (size_t i = 0; i < numBytes; ++i)
+				hash = (hash ^ static_cast<const juce::uint8*>(data)[i]) * 0x100000001b3ull;
+		};
+
+		auto mixValue = [&mix](auto value) { mix(&value, sizeof(value)); };
+		mixValue(reader.sampleRate);
+		mixValue((juce::int64)reader.numChannels);
+		mixValue(range.getStart());
+		mixValue(range.getLength());
+
+		const int numChannels = (int)reader.numChannels;
+		const int probeSize = (int)juce::jmin((juce::int64)HASH_PROBE_SIZE, range.getLength());
+		if (numChannels <= 0 || probeSize <= 0)
+			return hash;
+
+		juce::AudioBuffer<float> probe(numChannels, probeSize);
+		const auto span = range.getLength() - probeSize;
+
+		for (int i = 0; i < NUM_HASH_PROBES; ++i)
+		{
+			const auto position = range.getStart() + span * i / (NUM_HASH_PROBES - 1);
+			if (! reader.read(probe.getArrayOfWritePointers(), numChannels, position, probeSize))
+				return 0;
+
+			for (int ch = 0; ch < numChannels; ++ch)
+				mix(probe.getReadPointer(ch), sizeof(float) * (size_t)probeSize);
+		}
+
+		return hash;
+	}
+
+	//==============================================================================
+	// Analizza 'range' del reader (mix mono di tutti i canali).
+	// 'progress' riceve l'avanzamento in [0, 1] e restituisce false per
+	// interrompere; restituisce nullptr se interrotto o se una lettura fallisce.
+	static std::unique_ptr<DissonanceMap> analyse(juce::AudioFormatReader& reader,
+		juce::Range<juce::int64> range,
+		const std::function<bool(float)>& progress = {})
+	{
+		range = range.getIntersectionWith({ 0, reader.lengthInSamples });
+		if (reader.sampleRate <= 0.0 || reader.numChannels <= 0)
+			return nullptr;
+
+		auto analyser = std::make_unique<DissonanceAnalyser>();
+		analyser->prepare(reader.sampleRate);
+
+		// Mezzo frame FFT, riportato dalla frequenza di analisi (decimata) a quella del file
+		const int hop = juce::roundToInt(reader.sampleRate * (analyser->getFrameSize() / 2)
+			/ analyser->getAnalysisSampleRate());
+		auto map = std::make_unique<DissonanceMap>(reader.sampleRate, hop, range);
+
+		const int numFrames = getNumFramesFor(range.getLength(), hop);
+		const int numChannels = (int)reader.numChannels;
+		juce::AudioBuffer<float> block(numChannels, READ_BLOCK_SIZE);
+		std::array<Partial, DissonanceAnalyser::MAX_PARTIALS> framePartials;
+
+		// Un frame a ogni mezzo frame FFT (getFrameCount()); il primo
+		// (finestra per meta' prima di 'start') si scarta
+		analyser->setStationarityGate(false);
+		bool skippedFirst = false;
+		auto frameCount = analyser->getFrameCount();
+		auto push = [&](float sample)
+		{
+			analyser->pushSample(sample);
+			if (analyser->getFrameCount() == frameCount)
+				return;
+
+			frameCount = analyser->getFrameCount();
+			if (! std::exchange(skippedFirst, true) || map->getNumFrames() >= numFrames)
+				return;
+
+			const int n = analyser->getNumFramePartials();
+			for (int p = 0; p < n; ++p)
+				framePartials[(size_t)p] = { analyser->getFramePartialFrequency(p), analyser->getFramePartialAmplitude(p) };
+			map->addFrame(analyser->getDissonance(), framePartials.data(), n);
+		};
+
+		for (auto position = range.getStart(); position < range.getEnd(); position += READ_BLOCK_SIZE)
+		{
+			const int numSamples = (int)juce::jmin((juce::int64)READ_BLOCK_SIZE, range.getEnd() - position);
+			if (! reader.read(block.getArrayOfWritePointers(), numChannels, position, numSamples))
+				return nullptr;
+
+			const float scale = 1.0f / (float)numChannels;
+			for (int i = 0; i < numSamples; ++i)
+			{
+				float mono = 0.0f;
+				for (int ch = 0; ch < numChannels; ++ch)
+					mono += block.getSample(ch, i);
+				push(mono * scale);
+			}
+
+			if (progress && ! progress((float)(position + numSamples - range.getStart()) / (float)range.getLength()))
+				return nullptr;
+		}
+
+		while (map->getNumFrames() < numFrames)
+			push(0.0f);
+
+		map->contentHash = computeContentHash(reader, range);
+		if (map->contentHash == 0)
+			return nullptr;
+
+		return map;
+	}
+
+	//==============================================================================
+	// Archivio binario (little endian):
+	//   magic, versione, frequenza, hop, intervallo, hash, numero di frame,
+	//   dissonanza (uint16) e numero di parziali (uint8) per frame,
+	//   poi per ogni frame i parziali: delta di pitch (varint zig-zag) e
+	//   ampiezza (uint8)
+	void writeTo(juce::OutputStream& output) const
+	{
+		output.writeInt((int)ARCHIVE_MAGIC);
+		output.writeShort((short)ARCHIVE_VERSION);
+		output.writeDouble(sampleRate);
+		output.writeInt(hopSize);
+		output.writeInt64(sampleRange.getStart());
+		output.writeInt64(sampleRange.getLength());
+		output.writeInt64((juce::int64)contentHash);
+		output.writeInt(getNumFrames());
+
+		for (auto value : dissonance)
+			output.writeShort((short)value);
+		if (! partialCounts.empty())
+			output.write(partialCounts.data(), partialCounts.size());
+
+		std::array<int, MAX_PARTIALS> previous{};
+		for (int frame = 0; frame < getNumFrames(); ++frame)
+		{
+			for (int p = 0; p < getNumPartials(frame); ++p)
+			{
+				const auto& packed = partials[(size_t)frame * MAX_PARTIALS + (size_t)p];
+				const int delta = (int)packed.pitch - previous[(size_t)p];
+				writeVarint(output, ((juce::uint32)delta << 1) ^ (juce::uint32)(delta >> 31));
+				output.writeByte((char)packed.level);
+				previous[(size_t)p] = packed.pitch;
+			}
+		}
+	}
+
+	// nullptr se l'archivio e' troncato, di un'altra versione o incoerente.
+	// Lo stream deve conoscere la propria lunghezza (MemoryInputStream).
+	static std::unique_ptr<DissonanceMap> readFrom(juce::InputStream& input)
+	{
+		if (input.getNumBytesRemaining() < ARCHIVE_HEADER_SIZE
+			|| (juce::uint32)input.readInt() != ARCHIVE_MAGIC || input.readShort() != ARCHIVE_VERSION)
+			return nullptr;
+
+		const double fileSampleRate = input.readDouble();
+		const int hop = input.readInt();
+		const auto start = input.readInt64();
+		const auto length = input.readInt64();
+		const auto hash = (juce::uint64)input.readInt64();
+		const int numFrames = input.readInt();
+
+		// Il conteggio atteso resta a 64 bit: troncato a int, una lunghezza
+		// enorme darebbe un numero di frame piccolo o negativo
+		if (! (fileSampleRate > 0.0) || hop <= 0 || start < 0 || length < 0
+			|| length > std::numeric_limits<juce::int64>::max() - start
+			|| numFrames < 0 || numFrames > MAX_ARCHIVE_FRAMES
+			|| (juce::int64)numFrames != countFrames(length, hop)
+			|| input.getNumBytesRemaining() < (juce::int64)numFrames * 3)
+			return nullptr;
+
+		auto map = std::make_unique<DissonanceMap>(fileSampleRate, hop, juce::Range<juce::int64>(start, start + length), hash);
+		map->dissonance.resize((size_t)numFrames);
+		map->partialCounts.resize((size_t)numFrames);
+		map->partials.resize((size_t)numFrames * MAX_PARTIALS);
+
+		for (auto& value : map->dissonance)
+			value = (juce::uint16)input.readShort();
+		if (numFrames > 0 && input.read(map->partialCounts.data(), numFrames) != numFrames)
+			return nullptr;
+
+		std::array<int, MAX_PARTIALS> previous{};
+		for (int frame = 0; frame < numFrames; ++frame)
+		{
+			const int count = map->partialCounts[(size_t)frame];
+			if (count > MAX_PARTIALS)
+				return nullptr;
+
+			for (int p = 0; p < count; ++p)
+			{
+				if (input.getNumBytesRemaining() < 2)
+					return nullptr;
+
+				const auto zigzag = readVarint(input);
+				const int pitch = previous[(size_t)p] + ((int)(zigzag >> 1) ^ -(int)(zigzag & 1));
+				if (! juce::isPositiveAndNotGreaterThan(pitch, 0xffff) || input.isExhausted())
+					return nullptr;
+
+				map->partials[(size_t)frame * MAX_PARTIALS + (size_t)p] = { (juce::uint16)pitch, (juce::uint8)input.readByte() };
+				previous[(size_t)p] = pitch;
+			}
+		}
+
+		return map;
+	}
+
+private:
+	//==============================================================================
+	struct PackedPartial
+	{
+		juce::uint16 pitch = 0;
+		juce::uint8  level = 0;
+	};
+
+	static constexpr float MIN_FREQUENCY = 16.0f;         // pitch 0
+	static constexpr float PITCH_STEPS_PER_OCTAVE = 6000.0f;
+	static constexpr float LEVEL_FLOOR_DB = -100.0f;     // level 0 = muto
+	static constexpr float LEVEL_STEP_DB = 0.5f;
+
+	// (length + hop / 2) / hop senza overflow per qualunque lunghezza
+	static juce::int64 countFrames(juce::int64 length, int hop) noexcept
+	{
+		if (length <= 0)
+			return 0;
+
+		return juce::jmax((juce::int64)1, length / hop + (length % hop + hop / 2) / hop);
+	}
+
+	static juce::uint16 encodeDissonance(float value) noexcept
+	{
+		return (juce::uint16)juce::roundToInt(juce::jlimit(0.0f, 1.0f, value) * 65535.0f);
+	}
+
+	static float decodeDissonance(juce::uint16 code) noexcept { return (float)code / 65535.0f; }
+
+	static juce::uint16 encodeFrequency(float frequency) noexcept
+	{
+		const float steps = std::log2(juce::jmax(frequency, MIN_FREQUENCY) / MIN_FREQUENCY) * PITCH_STEPS_PER_OCTAVE;
+		return (juce::uint16)juce::jlimit(0, 0xffff, juce::roundToInt(steps));
+	}
+
+	static float decodeFrequency(juce::uint16 code) noexcept
+	{
+		return MIN_FREQUENCY * std::exp2((float)code / PITCH_STEPS_PER_OCTAVE);
+	}
+
+	static juce::uint8 encodeAmplitude(float amplitude) noexcept
+	{
+		const float db = juce::Decibels::gainToDecibels(amplitude, LEVEL_FLOOR_DB);
+		return (juce::uint8)juce::jlimit(0, 0xff, juce::roundToInt((db - LEVEL_FLOOR_DB) / LEVEL_STEP_DB));
+	}
+
+	static float decodeAmplitude(juce::uint8 code) noexcept
+	{
+		return code == 0 ? 0.0f : juce::Decibels::decibelsToGain(LEVEL_FLOOR_DB + (float)code * LEVEL_STEP_DB);
+	}
+
+	static void writeVarint(juce::OutputStream& output, juce::uint32 value)
+	{
+		for (; value >= 0x80; value >>= 7)
+			output.writeByte((char)((value & 0x7f) | 0x80));
+		output.writeByte((char)value);
+	}
+
+	static juce::uint32 readVarint(juce::InputStream& input)
+	{
+		juce::uint32 value = 0;
+		for (int shift = 0; shift < 32 && ! input.isExhausted(); shift += 7)
+		{
+			const auto byte = (juce::uint8)input.readByte();
+			value |= (juce::uint32)(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0)
+				break;
+		}
+		return value;
+	}
+
+	//==============================================================================
+	double sampleRate;
+	int hopSize;
+	juce::Range<juce::int64> sampleRange;
+	juce::uint64 contentHash = 0;
+
+	std::vector<juce::uint16> dissonance;
+	std::vector<juce::uint8> partialCounts;
+	std::vector<PackedPartial> partials;        // MAX_PARTIALS per frame
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DissonanceMap)
+};
@@ -0,0 +1,251 @@
+/*
+	==============================================================================
+
+		OscillatorBank.h
+
+		Banco di oscillatori per il segnale di prova (calibrazione): fino a
+		MAX_VOICES voci, ognuna una sinusoide o un suono armonico con
+		numPartials parziali di ampiezza 1 / k^rolloff.
+
+		Ogni parziale e' una corsia di un juce::dsp::SIMDRegister<float>:
+			- fase in [0, 1) con accumulatore e riavvolgimento senza salti
+			  condizionali (confronto vettoriale e maschera)
+			- seno con polinomio dispari di grado 11 su un quarto di periodo,
+			  errore < 6e-8 (sotto la risoluzione del float)
+			- glissando lineare dell'incremento di fase fra un cambio di
+			  frequenza e il successivo, come LinearSmoothedValue
+
+		Le ampiezze sono normalizzate sulla somma di tutte le ampiezze, quindi
+		il picco dell'uscita non supera mai 1 e non serve una scansione del
+		blocco per normalizzarlo. I parziali oltre ~Nyquist sono muti.
+
+		Solo thread audio (o prepareToPlay). Nessuna allocazione.
+
+	==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cmath>
+
+class OscillatorBank
+{
+public:
+	//==============================================================================
+	using Vec = juce::dsp::SIMDRegister<float>;
+
+	static constexpr int MAX_VOICES = 8;
+	static constexpr int MAX_PARTIALS = 16;
+	static constexpr int LANES_PER_GROUP = (int)Vec::SIMDNumElements;
+	static constexpr int MAX_GROUPS = (MAX_VOICES * MAX_PARTIALS + LANES_PER_GROUP - 1) / LANES_PER_GROUP;
+
+	struct Voice
+	{
+		float frequency = 440.0f;   // fondamentale (Hz)
+		float gain = 1.0f;          // peso relativo fra le voci
+		int   numPartials = 1;      // 1 = sinusoide pura
+		float rolloff = 1.0f;       // ampiezza del parziale k: 1 / k^rolloff
+	};
+
+	//==============================================================================
+	void prepare(double newSampleRate, double glideSeconds) noexcept
+	{
+		sampleRate = newSampleRate;
+		glideSamples = juce::jmax(1, (int)std::floor(glideSeconds * sampleRate));
+		setVoices(voices.data(), numVoices);
+		reset();
+	}
+
+	// Fasi a zero e frequenze subito sul valore richiesto
+	void reset() noexcept
+	{
+		for (int g = 0; g < MAX_GROUPS; ++g)
+		{
+			phase[(size_t)g] = Vec::expand(0.0f);
+			increment[(size_t)g] = target[(size_t)g];
+			step[(size_t)g] = Vec::expand(0.0f);
+		}
+		glideRemaining = 0;
+	}
+
+	// Nuova configurazione delle voci: timbri, pesi e frequenze cambiano
+	// subito (nessun glissando), le fasi delle corsie restano dove sono
+	void setVoices(const Voice* newVoices, int newNumVoices) noexcept
+	{
+		numVoices = juce::jlimit(0, MAX_VOICES, newNumVoices);
+		numLanes = 0;
+
+		double total = 0.0;
+		for (int v = 0; v < numVoices; ++v)
+		{
+			auto& voice = voices[(size_t)v];
+			if (&voice != newVoices + v)
+				voice = newVoices[v];
+			voice.numPartials = juce::jlimit(1, MAX_PARTIALS, voice.numPartials);
+			voice.gain = juce::jmax(0.0f, voice.gain);
+
+			firstLane[(size_t)v] = numLanes;
+			for (int k = 1; k <= voice.numPartials; ++k)
+			{
+				partialAmplitude[(size_t)numLanes++] = voice.gain * std::pow((float)k, -voice.rolloff);
+				total += partialAmplitude[(size_t)numLanes - 1];
+			}
+		}
+
+		const float norm = total > 0.0 ? (float)(1.0 / total) : 0.0f;
+		for (int lane = 0; lane < numLanes; ++lane)
+			partialAmplitude[(size_t)lane] *= norm;
+
+		numGroups = (numLanes + LANES_PER_GROUP - 1) / LANES_PER_GROUP;
+		for (int g = 0; g < MAX_GROUPS; ++g)
+		{
+			amplitude[(size_t)g] = Vec::expand(0.0f);
+			target[(size_t)g] = Vec::expand(0.0f);
+		}
+
+		for (int v = 0; v < numVoices; ++v)
+			retarget(v, voices[(size_t)v].frequency);
+
+		for (int g = 0; g < MAX_GROUPS; ++g)
+		{
+			increment[(size_t)g] = target[(size_t)g];
+			step[(size_t)g] = Vec::expand(0.0f);
+		}
+		glideRemaining = 0;
+	}
+
+	// Cambio di frequenza di una voce con glissando; nessun effetto se la
+	// frequenza e' quella gia' richiesta
+	void setFrequency(int voiceIndex, float frequency) noexcept
+	{
+		if (! juce::isPositiveAndBelow(voiceIndex, numVoices) || voices[(size_t)voiceIndex].frequency == frequency)
+			return;
+
+		voices[(size_t)voiceIndex].frequency = frequency;
+		retarget(voiceIndex, frequency);
+
+		// Come LinearSmoothedValue: ogni corsia riparte dal valore corrente
+		// e raggiunge il nuovo obiettivo in glideSamples campioni
+		const float scale = 1.0f / (float)glideSamples;
+		for (int g = 0; g < numGroups; ++g)
+			step[(size_t)g] = (target[(size_t)g] - increment[(size_t)g]) * scale;
+		glideRemaining = glideSamples;
+	}
+
+	float getFrequency(int voiceIndex) const noexcept
+	{
+		return juce::isPositiveAndBelow(voiceIndex, numVoices) ? voices[(size_t)voiceIndex].frequency : 0.0f;
+	}
+
+	int getNumVoices() const noexcept { return numVoices; }
+
+	//==============================================================================
+	// Scrive (non somma) numSamples campioni in 'output'
+	template <typename SampleType>
+	void render(SampleType* output, int numSamples) noexcept
+	{
+		const auto one = Vec::expand(1.0f);
+
+		for (int i = 0; i < numSamples; ++i)
+		{
+			auto sum = Vec::expand(0.0f);
+			for (int g = 0; g < numGroups; ++g)
+			{
+				auto& p = phase[(size_t)g];
+				sum = sum + sine(p) * amplitude[(size_t)g];
+
+				p = p + increment[(size_t)g];
+				p = p - (one & Vec::greaterThanOrEqual(p, one));
+			}
+			output[i] = (SampleType)sum.sum();
+
+			if (glideRemaining > 0)
+				advanceGlide(1);
+		}
+	}
+
+	// Avanza il glissando senza generare (ingresso esterno): le fasi restano ferme
+	void skip(int numSamples) noexcept
+	{
+		if (glideRemaining > 0)
+			advanceGlide(juce::jmin(numSamples, glideRemaining));
+	}
+
+	//==============================================================================
+	// sin(2*pi*p) per p in [0, 1): sin(2*pi*p) = -sin(2*pi*x), x = p - 1/2,
+	// ripiegato su z in [-1/4, 1/4] con sin(2*pi*x) = sin(2*pi*z),
+	// z = 2 * clamp(x, -1/4, 1/4) - x
+	static Vec sine(Vec p) noexcept
+	{
+		const auto x = p - 0.5f;
+		const auto clamped = Vec::min(Vec::max(x, Vec::expand(-0.25f)), Vec::expand(0.25f));
+		const auto z = clamped * 2.0f - x;
+		return z * oddPolynomial(z * z) * -1.0f;
+	}
+
+	static float sine(float p) noexcept { return sine(Vec::expand(p)).get(0); }
+
+private:
+	//==============================================================================
+	// Serie di Taylor di sin(2*pi*z)/z fino al termine di grado 10
+	static Vec oddPolynomial(Vec z2) noexcept
+	{
+		constexpr double w = juce::MathConstants<double>::twoPi;
+		constexpr double w2 = w * w;
+		constexpr auto c1  = (float)w;
+		constexpr auto c3  = (float)(-w * w2 / 6.0);
+		constexpr auto c5  = (float)(w * w2 * w2 / 120.0);
+		constexpr auto c7  = (float)(-w * w2 * w2 * w2 / 5040.0);
+		constexpr auto c9  = (float)(w * w2 * w2 * w2 * w2 / 362880.0);
+		constexpr auto c11 = (float)(-w * w2 * w2 * w2 * w2 * w2 / 39916800.0);
+
+		return ((((z2 * c11 + c9) * z2 + c7) * z2 + c5) * z2 + c3) * z2 + c1;
+	}
+
+	// Incremento di fase obiettivo delle corsie di una voce; i parziali oltre
+	// 0.45 * fs sono muti e fermi (il riavvolgimento vale per incrementi < 1)
+	void retarget(int voiceIndex, float frequency) noexcept
+	{
+		const auto& voice = voices[(size_t)voiceIndex];
+		const int first = firstLane[(size_t)voiceIndex];
+
+		for (int k = 1; k <= voice.numPartials; ++k)
+		{
+			const int lane = first + k - 1;
+			const double inc = (double)frequency * k / sampleRate;
+			const bool audible = inc > 0.0 && inc < 0.45;
+
+			target[(size_t)(lane / LANES_PER_GROUP)].set((size_t)(lane % LANES_PER_GROUP), audible ? (float)inc : 0.0f);
+			amplitude[(size_t)(lane / LANES_PER_GROUP)].set((size_t)(lane % LANES_PER_GROUP),
+				audible ? partialAmplitude[(size_t)lane] : 0.0f);
+		}
+	}
+
+	void advanceGlide(int numSamples) noexcept
+	{
+		glideRemaining -= numSamples;
+		for (int g = 0; g < numGroups; ++g)
+			increment[(size_t)g] = glideRemaining > 0 ? increment[(size_t)g] + step[(size_t)g] * (float)numSamples
+			                                          : target[(size_t)g];
+	}
+
+	//==============================================================================
+	std::array<Vec, MAX_GROUPS> phase{};
+	std::array<Vec, MAX_GROUPS> increment{};   // cicli per campione
+	std::array<Vec, MAX_GROUPS> target{};
+	std::array<Vec, MAX_GROUPS> step{};
+	std::array<Vec, MAX_GROUPS> amplitude{};
+
+	std::array<Voice, MAX_VOICES> voices{};
+	std::array<int, MAX_VOICES>   firstLane{};
+	std::array<float, MAX_GROUPS * LANES_PER_GROUP> partialAmplitude{};
+
+	int numVoices = 0;
+	int numLanes = 0;
+	int numGroups = 0;
+
+	double sampleRate = 44100.0;
+	int glideSamples = 1;
+	int glideRemaining = 0;
+};
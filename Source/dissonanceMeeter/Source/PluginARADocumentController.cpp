@@ -11,6 +11,210 @@
 #include "PluginARADocumentController.h"
 #include "PluginARAPlaybackRenderer.h"
 
+//==============================================================================
+/*  Analyses one audio source on the shared analysis pool. The reader is created and
+    destroyed on the message thread (it listens to the audio source), and goes
+    invalid on its own when the host changes the samples or removes the source,
+    which ends the job early. The result is handed back to the message thread,
+    where it's dropped if a newer job has been started in the meantime.
+
+    If the source has a map restored from the archive, the job first decodes it
+    and compares content hashes: only a few blocks of audio are read, and the
+    whole analysis is skipped when they match.
+*/
+class DissonanceMeeterDocumentController::AnalysisJob  : public SharedAnalysisPool::Job
+{
+public:
+    AnalysisJob (DissonanceMeeterDocumentController& owner, juce::ARAAudioSource* source, juce::uint32 id,
+                 juce::MemoryBlock archivedMap)
+        : documentController (&owner),
+          audioSource (source),
+          reader (std::make_unique<juce::ARAAudioSourceReader> (source)),
+          jobId (id),
+          archive (std::move (archivedMap))
+    {
+    }
+
+    void run() override
+    {
+        std::shared_ptr<const DissonanceMap> map;
+
+        if (reader->isValid() && ! archive.isEmpty())
+            map = restoreArchivedMap();
+
+        if (map == nullptr && reader->isValid())
+        {
+            audioSource->notifyAnalysisProgressStarted();
+
+            map = DissonanceMap::analyse (*reader, { 0, reader->lengthInSamples }, [this] (float progress)
+            {
+                audioSource->notifyAnalysisProgressUpdated (progress);
+                return ! shouldExit() && reader->isValid();
+            });
+
+            audioSource->notifyAnalysisProgressCompleted();
+        }
+
+        if (! shouldExit())
+        {
+            juce::MessageManager::callAsync ([owner = documentController, source = audioSource, id = jobId, map]
+            {
+                if (auto* dc = owner.get())
+                    dc->analysisFinished (source, id, map);
+            });
+        }
+    }
+
+    juce::uint32 getJobId() const noexcept    { return jobId; }
+
+private:
+    std::shared_ptr<const DissonanceMap> restoreArchivedMap()
+    {
+        juce::MemoryInputStream input (archive, false);
+        std::shared_ptr<const DissonanceMap> map = DissonanceMap::readFrom (input);
+
+        const juce::Range<juce::int64> wholeSource (0, reader->lengthInSamples);
+
+        if (map == nullptr
+            || map->getSampleRange() != wholeSource
+            || ! juce::exactlyEqual (map->getSampleRate(), reader->sampleRate)
+            || map->getContentHash() != DissonanceMap::computeContentHash (*reader, wholeSource))
+            return nullptr;
+
+        return map;
+    }
+
+    juce::WeakReference<DissonanceMeeterDocumentController> documentController;
+    juce::ARAAudioSource* audioSource;
+    std::unique_ptr<juce::ARAAudioSourceReader> reader;
+    const juce::uint32 jobId;
+    const juce::MemoryBlock archive;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AnalysisJob)
+};
+
+//==============================================================================
+DissonanceMeeterDocumentController::~DissonanceMeeterDocumentController()
+{
+    analysisPool.removeAllJobs();
+    analysisJobs.clear();
+}
+
+//==============================================================================
+std::shared_ptr<const DissonanceMap> DissonanceMeeterDocumentController::getDissonanceMap (const juce::ARAAudioSource* audioSource) const
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    const auto it = dissonanceMaps.find (audioSource);
+    return it != dissonanceMaps.end() ? it->second : nullptr;
+}
+
+bool DissonanceMeeterDocumentController::isAnalysing (const juce::ARAAudioSource* audioSource) const
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    return analysisJobs.find (audioSource) != analysisJobs.end();
+}
+
+//==============================================================================
+void DissonanceMeeterDocumentController::startAnalysis (juce::ARAAudioSource* audioSource)
+{
+    cancelAnalysis (audioSource);
+
+    if (! audioSource->isSampleAccessEnabled() || audioSource->getSampleCount() <= 0)
+        return;
+
+    const auto archived = archivedMaps.find (audioSource);
+
+    auto& job = analysisJobs[audioSource];
+    job = std::make_unique<AnalysisJob> (*this, audioSource, ++nextJobId,
+                                         archived != archivedMaps.end() ? archived->second : juce::MemoryBlock());
+    analysisPool.addJob (*job);
+}
+
+void DissonanceMeeterDocumentController::cancelAnalysis (juce::ARAAudioSource* audioSource)
+{
+    const auto it = analysisJobs.find (audioSource);
+
+    if (it == analysisJobs.end())
+        return;
+
+    // The job checks shouldExit() after every block it reads, so this won't wait long
+    analysisPool.removeJob (*it->second);
+    analysisJobs.erase (it);
+}
+
+void DissonanceMeeterDocumentController::analysisFinished (const juce::ARAAudioSource* audioSource,
+                                                           juce::uint32 jobId,
+                                                           std::shared_ptr<const DissonanceMap> map)
+{
+    const auto it = analysisJobs.find (audioSource);
+
+    if (it == analysisJobs.end() || it->second->getJobId() != jobId)
+        return;
+
+    // run() posts the result just before returning
+    analysisPool.waitForJobToFinish (*it->second);
+    analysisJobs.erase (it);
+
+    // The archived map has either been adopted or found to be stale
+    archivedMaps.erase (audioSource);
+
+    if (map != nullptr)
+        dissonanceMaps[audioSource] = std::move (map);
+    else
+        dissonanceMaps.erase (audioSource);
+
+    analysisBroadcaster.sendChangeMessage();
+}
+
+//==============================================================================
+void DissonanceMeeterDocumentController::willEnableAudioSourceSamplesAccess (juce::ARAAudioSource* audioSource, bool enable)
+{
+    if (! enable)
+        cancelAnalysis (audioSource);
+}
+
+void DissonanceMeeterDocumentController::didEnableAudioSourceSamplesAccess (juce::ARAAudioSource* audioSource, bool enable)
+{
+    // A map computed earlier for the same samples stays valid while access is off
+    if (enable && dissonanceMaps.find (audioSource) == dissonanceMaps.end())
+        startAnalysis (audioSource);
+}
+
+void DissonanceMeeterDocumentController::didUpdateAudioSourceProperties (juce::ARAAudioSource* audioSource)
+{
+    const auto it = dissonanceMaps.find (audioSource);
+
+    if (it != dissonanceMaps.end()
+        && it->second->getSampleRange() == juce::Range<juce::int64> (0, audioSource->getSampleCount())
+        && juce::exactlyEqual (it->second->getSampleRate(), audioSource->getSampleRate()))
+        return;
+
+    dissonanceMaps.erase (audioSource);
+    analysisBroadcaster.sendChangeMessage();
+    startAnalysis (audioSource);
+}
+
+void DissonanceMeeterDocumentController::doUpdateAudioSourceContent (juce::ARAAudioSource* audioSource, juce::ARAContentUpdateScopes scopeFlags)
+{
+    if (! scopeFlags.affectSamples())
+        return;
+
+    archivedMaps.erase (audioSource);
+    dissonanceMaps.erase (audioSource);
+    analysisBroadcaster.sendChangeMessage();
+    startAnalysis (audioSource);
+}
+
+void DissonanceMeeterDocumentController::willDestroyAudioSource (juce::ARAAudioSource* audioSource)
+{
+    cancelAnalysis (audioSource);
+    archivedMaps.erase (audioSource);
+    dissonanceMaps.erase (audioSource);
+    analysisBroadcaster.sendChangeMessage();
+}
+
 //==============================================================================
 juce::ARAPlaybackRenderer* DissonanceMeeterDocumentController::doCreatePlaybackRenderer() noexcept
 {
@@ -18,14 +222,79 @@ juce::ARAPlaybackRenderer* DissonanceMeeterDocumentController::doCreatePlaybackR
 }
 
 //==============================================================================
-bool DissonanceMeeterDocumentController::doRestoreObjectsFromStream (juce::ARAInputStream&, const juce::ARARestoreObjectsFilter*) noexcept
+/*  Archive layout: version, number of entries, then per audio source its
+    persistent ID and the size-prefixed DissonanceMap archive. Maps are copied
+    as-is here and only decoded by the analysis job once the source can be
+    read, so opening a project costs no more than reading the archive.
+*/
+bool DissonanceMeeterDocumentController::doRestoreObjectsFromStream (juce::ARAInputStream& input, const juce::ARARestoreObjectsFilter* filter) noexcept
 {
-    return true;
+    // Archives written before analysis was stored are empty
+    if (input.isExhausted())
+        return true;
+
+    // An unknown (newer) layout is ignored: the sources are simply analysed again
+    if (input.readInt() != ARCHIVE_VERSION)
+        return ! input.failed();
+
+    const auto numEntries = input.readInt();
+
+    for (int i = 0; i < numEntries && ! input.failed(); ++i)
+    {
+        const auto persistentID = input.readString();
+        const auto size = input.readInt();
+
+        if (size < 0 || input.failed())
+            return false;
+
+        juce::MemoryBlock archivedMap;
+        if (input.readIntoMemoryBlock (archivedMap, size) != (size_t) size)
+            return false;
+
+        if (auto* audioSource = filter->getAudioSourceToRestoreStateWithID<juce::ARAAudioSource> (persistentID.getCharPointer()))
+        {
+            cancelAnalysis (audioSource);
+            dissonanceMaps.erase (audioSource);
+            archivedMaps[audioSource] = std::move (archivedMap);
+
+            if (audioSource->isSampleAccessEnabled())
+                startAnalysis (audioSource);
+        }
+    }
+
+    analysisBroadcaster.sendChangeMessage();
+    return ! input.failed();
 }
 
-bool DissonanceMeeterDocumentController::doStoreObjectsToStream (juce::ARAOutputStream&, const juce::ARAStoreObjectsFilter*) noexcept
+bool DissonanceMeeterDocumentController::doStoreObjectsToStream (juce::ARAOutputStream& output, const juce::ARAStoreObjectsFilter* filter) noexcept
 {
-    return true;
+    std::vector<std::pair<const juce::ARAAudioSource*, juce::MemoryBlock>> entries;
+
+    for (auto* audioSource : filter->getAudioSourcesToStore<juce::ARAAudioSource>())
+    {
+        if (const auto map = dissonanceMaps.find (audioSource); map != dissonanceMaps.end())
+        {
+            juce::MemoryOutputStream archivedMap;
+            map->second->writeTo (archivedMap);
+            entries.emplace_back (audioSource, archivedMap.getMemoryBlock());
+        }
+        else if (const auto archived = archivedMaps.find (audioSource); archived != archivedMaps.end())
+        {
+            // Never read in this session: store it back untouched
+            entries.emplace_back (audioSource, archived->second);
+        }
+    }
+
+    bool ok = output.writeInt (ARCHIVE_VERSION) && output.writeInt ((int) entries.size());
+
+    for (const auto& [audioSource, archivedMap] : entries)
+    {
+        ok = ok && output.writeString (juce::String (audioSource->getPersistentID()))
+                && output.writeInt ((int) archivedMap.getSize())
+                && output.write (archivedMap.getData(), archivedMap.getSize());
+    }
+
+    return ok;
 }
 
 //==============================================================================
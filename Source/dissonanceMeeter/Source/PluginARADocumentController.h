@@ -11,15 +11,44 @@
 #pragma once
 
 #include <juce_audio_processors/juce_audio_processors.h>
+#include <map>
+#include <memory>
+#include "DissonanceMap.h"
+#include "SharedAnalysisPool.h"
 
 //==============================================================================
 /**
+    Besides the usual ARA model management, the document controller analyses
+    every audio source in the background as soon as the host enables access to
+    its samples, and again whenever its sample content changes. The result, a
+    DissonanceMap covering the source's whole sample range, is cached per
+    source, so the renderer and editor can show dissonance for the whole
+    timeline without analysing in realtime. The analysis runs on the worker
+    pool shared by every instance in the process (see SharedAnalysisPool.h),
+    which takes turns between document controllers.
+
+    The maps are also stored in the ARA archive. Restored maps are kept
+    encoded until the host enables access to their audio source; they're
+    then checked against the source's content hash and adopted, or
+    re-analysed if the audio has changed.
 */
 class DissonanceMeeterDocumentController  : public juce::ARADocumentControllerSpecialisation
 {
 public:
     //==============================================================================
     using ARADocumentControllerSpecialisation::ARADocumentControllerSpecialisation;
+    ~DissonanceMeeterDocumentController() override;
+
+    static constexpr int ARCHIVE_VERSION = 1;
+
+    //==============================================================================
+    // Message thread only. Returns the cached analysis of the audio source, or
+    // nullptr while it's still being analysed (or couldn't be read).
+    std::shared_ptr<const DissonanceMap> getDissonanceMap (const juce::ARAAudioSource* audioSource) const;
+    bool isAnalysing (const juce::ARAAudioSource* audioSource) const;
+
+    // Notifies (on the message thread) whenever a map is added or removed
+    juce::ChangeBroadcaster& getAnalysisBroadcaster() noexcept   { return analysisBroadcaster; }
 
 protected:
     //==============================================================================
@@ -30,7 +59,31 @@ protected:
     bool doRestoreObjectsFromStream (juce::ARAInputStream& input, const juce::ARARestoreObjectsFilter* filter) noexcept override;
     bool doStoreObjectsToStream (juce::ARAOutputStream& output, const juce::ARAStoreObjectsFilter* filter) noexcept override;
 
+    //==============================================================================
+    void willEnableAudioSourceSamplesAccess (juce::ARAAudioSource* audioSource, bool enable) override;
+    void didEnableAudioSourceSamplesAccess (juce::ARAAudioSource* audioSource, bool enable) override;
+    void didUpdateAudioSourceProperties (juce::ARAAudioSource* audioSource) override;
+    void doUpdateAudioSourceContent (juce::ARAAudioSource* audioSource, juce::ARAContentUpdateScopes scopeFlags) override;
+    void willDestroyAudioSource (juce::ARAAudioSource* audioSource) override;
+
 private:
     //==============================================================================
+    class AnalysisJob;
+
+    void startAnalysis (juce::ARAAudioSource* audioSource);
+    void cancelAnalysis (juce::ARAAudioSource* audioSource);
+    void analysisFinished (const juce::ARAAudioSource* audioSource, juce::uint32 jobId, std::shared_ptr<const DissonanceMap> map);
+
+    SharedAnalysisPool::Client analysisPool;
+
+    // Message thread only
+    std::map<const juce::ARAAudioSource*, std::shared_ptr<const DissonanceMap>> dissonanceMaps;
+    std::map<const juce::ARAAudioSource*, juce::MemoryBlock> archivedMaps;     // restored, not yet verified
+    std::map<const juce::ARAAudioSource*, std::unique_ptr<AnalysisJob>> analysisJobs;
+    juce::uint32 nextJobId = 0;
+    juce::ChangeBroadcaster analysisBroadcaster;
+
+    //==============================================================================
+    JUCE_DECLARE_WEAK_REFERENCEABLE (DissonanceMeeterDocumentController)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DissonanceMeeterDocumentController)
 };
@@ -9,6 +9,7 @@
 */
 
 #include "PluginARAPlaybackRenderer.h"
+#include "RealtimeSafety.h"
 
 //==============================================================================
 void DissonanceMeeterPlaybackRenderer::prepareToPlay (double sampleRateIn, int maximumSamplesPerBlockIn, int numChannelsIn, juce::AudioProcessor::ProcessingPrecision, AlwaysNonRealtime alwaysNonRealtime)
@@ -17,16 +18,88 @@ void DissonanceMeeterPlaybackRenderer::prepareToPlay (double sampleRateIn, int m
     sampleRate = sampleRateIn;
     maximumSamplesPerBlock = maximumSamplesPerBlockIn;
     useBufferedAudioSourceReader = alwaysNonRealtime == AlwaysNonRealtime::no;
+
+    readBuffer.setSize (numChannels, maximumSamplesPerBlock);
+    audioSourceReaders.clear();
+    bufferedReaders.clear();
+
+    const int readAheadSamples = juce::jmax (READ_AHEAD_BLOCKS * maximumSamplesPerBlock, MIN_READ_AHEAD_SAMPLES);
+
+    for (const auto& playbackRegion : getPlaybackRegions())
+    {
+        auto* audioSource = playbackRegion->getAudioModification()->getAudioSource();
+
+        if (audioSourceReaders.find (audioSource) != audioSourceReaders.end())
+            continue;
+
+        auto reader = std::make_unique<juce::ARAAudioSourceReader> (audioSource);
+
+        if (! useBufferedAudioSourceReader)
+        {
+            audioSourceReaders.emplace (audioSource, std::move (reader));
+            continue;
+        }
+
+        auto buffered = std::make_unique<juce::BufferingAudioReader> (reader.release(), *readAheadThread, readAheadSamples);
+        bufferedReaders.emplace (audioSource, buffered.get());
+        audioSourceReaders.emplace (audioSource, std::move (buffered));
+    }
 }
 
 void DissonanceMeeterPlaybackRenderer::releaseResources()
 {
+    bufferedReaders.clear();
+    audioSourceReaders.clear();
+    readBuffer.setSize (0, 0);
 }
 
 //==============================================================================
 bool DissonanceMeeterPlaybackRenderer::processBlock (juce::AudioBuffer<float>& buffer,
                                                        juce::AudioProcessor::Realtime realtime,
                                                        const juce::AudioPlayHead::PositionInfo& positionInfo) noexcept
+{
+    return renderRegions (buffer, realtime, positionInfo);
+}
+
+bool DissonanceMeeterPlaybackRenderer::processBlock (juce::AudioBuffer<double>& buffer,
+                                                       juce::AudioProcessor::Realtime realtime,
+                                                       const juce::AudioPlayHead::PositionInfo& positionInfo) noexcept
+{
+    return renderRegions (buffer, realtime, positionInfo);
+}
+
+//==============================================================================
+// Reads numSamples of the source into readBuffer, one channel per output
+// channel (a mono source is copied to all of them)
+bool DissonanceMeeterPlaybackRenderer::readSource (juce::ARAAudioSource* audioSource, juce::int64 startInSource, int numSamples,
+                                                   juce::AudioProcessor::Realtime realtime) noexcept
+{
+    const auto reader = audioSourceReaders.find (audioSource);
+
+    if (reader == audioSourceReaders.end())
+    {
+        readBuffer.clear (0, numSamples);
+        return false;
+    }
+
+    // Realtime blocks take whatever the read-ahead has buffered; offline
+    // bounces wait for it
+    if (const auto buffered = bufferedReaders.find (audioSource); buffered != bufferedReaders.end())
+        buffered->second->setReadTimeout (realtime == juce::AudioProcessor::Realtime::yes ? 0 : NON_REALTIME_READ_TIMEOUT_MS);
+
+    // BufferingAudioReader only locks to swap in blocks read by its thread
+    RealtimeSafety::ScopedToleratedLocks toleratedLocks;
+
+    // Both readers deliver float data, so the int* overload reads floats,
+    // and unlike the float* one it can fill the leftover channels
+    auto* const* channels = reinterpret_cast<int* const*> (readBuffer.getArrayOfWritePointers());
+    return reader->second->read (channels, readBuffer.getNumChannels(), startInSource, numSamples, true);
+}
+
+template <typename SampleType>
+bool DissonanceMeeterPlaybackRenderer::renderRegions (juce::AudioBuffer<SampleType>& buffer,
+                                                      juce::AudioProcessor::Realtime realtime,
+                                                      const juce::AudioPlayHead::PositionInfo& positionInfo) noexcept
 {
     const auto numSamples = buffer.getNumSamples();
     jassert (numSamples <= maximumSamplesPerBlock);
@@ -34,6 +107,7 @@ bool DissonanceMeeterPlaybackRenderer::processBlock (juce::AudioBuffer<float>& b
     jassert (realtime == juce::AudioProcessor::Realtime::no || useBufferedAudioSourceReader);
     const auto timeInSamples = positionInfo.getTimeInSamples().orFallback (0);
     const auto isPlaying = positionInfo.getIsPlaying();
+    const int channelsToRender = juce::jmin (buffer.getNumChannels(), readBuffer.getNumChannels());
 
     bool success = true;
     bool didRenderAnyRegion = false;
@@ -45,8 +119,7 @@ bool DissonanceMeeterPlaybackRenderer::processBlock (juce::AudioBuffer<float>& b
         for (const auto& playbackRegion : getPlaybackRegions())
         {
             // Evaluate region borders in song time, calculate sample range to render in song time.
-            // Note that this example does not use head- or tailtime, so the includeHeadAndTail
-            // parameter is set to false here - this might need to be adjusted in actual plug-ins.
+            // Head and tail time aren't used: the chain's tail runs on in the processor.
             const auto playbackSampleRange = playbackRegion->getSampleRange (sampleRate,
                                                                              juce::ARAPlaybackRegion::IncludeHeadAndTail::no);
             auto renderRange = blockRange.getIntersectionWith (playbackSampleRange);
@@ -55,8 +128,7 @@ bool DissonanceMeeterPlaybackRenderer::processBlock (juce::AudioBuffer<float>& b
                 continue;
 
             // Evaluate region borders in modification/source time and calculate offset between
-            // song and source samples, then clip song samples accordingly
-            // (if an actual plug-in supports time stretching, this must be taken into account here).
+            // song and source samples, then clip song samples accordingly (no time stretching).
             juce::Range<juce::int64> modificationSampleRange { playbackRegion->getStartInAudioModificationSamples(),
                                                                playbackRegion->getEndInAudioModificationSamples() };
             const auto modificationSampleOffset = modificationSampleRange.getStart() - playbackSampleRange.getStart();
@@ -66,38 +138,38 @@ bool DissonanceMeeterPlaybackRenderer::processBlock (juce::AudioBuffer<float>& b
             if (renderRange.isEmpty())
                 continue;
 
-            // Now calculate the samples in renderRange for this PlaybackRegion based on the ARA model
-            // graph. If didRenderAnyRegion is true, add the region's output samples in renderRange to
-            // the buffer. Otherwise the buffer needs to be initialised so the sample value must be
-            // overwritten.
             const int numSamplesToRead = (int) renderRange.getLength();
             const int startInBuffer = (int) (renderRange.getStart() - blockRange.getStart());
             const auto startInSource = renderRange.getStart() + modificationSampleOffset;
-            juce::ignoreUnused (startInSource);
 
-            for (int c = 0; c < numChannels; ++c)
+            auto* audioSource = playbackRegion->getAudioModification()->getAudioSource();
+            success = readSource (audioSource, startInSource, numSamplesToRead, realtime) && success;
+
+            // The first region overwrites the buffer, the others are mixed in
+            for (int c = 0; c < channelsToRender; ++c)
             {
-                auto* channelData = buffer.getWritePointer (c);
+                auto* channelData = buffer.getWritePointer (c, startInBuffer);
+                const auto* regionData = readBuffer.getReadPointer (c);
 
                 for (int i = 0; i < numSamplesToRead; ++i)
                 {
-                    // Calculate region output sample at index startInSource + i ...
-                    float sample = 0.0f;
-
                     if (didRenderAnyRegion)
-                        channelData[startInBuffer + i] += sample;
+                        channelData[i] += (SampleType) regionData[i];
                     else
-                        channelData[startInBuffer + i] = sample;
+                        channelData[i] = (SampleType) regionData[i];
                 }
             }
 
             // If rendering first region, clear any excess at start or end of the region.
             if (! didRenderAnyRegion)
             {
+                for (int c = channelsToRender; c < buffer.getNumChannels(); ++c)
+                    buffer.clear (c, 0, numSamples);
+
                 if (startInBuffer != 0)
                     buffer.clear (0, startInBuffer);
 
-                const int endInBuffer = startInBuffer + numSamples;
+                const int endInBuffer = startInBuffer + numSamplesToRead;
                 const int remainingSamples = numSamples - endInBuffer;
 
                 if (remainingSamples != 0)
@@ -11,9 +11,23 @@
 #pragma once
 
 #include <juce_audio_processors/juce_audio_processors.h>
+#include <map>
+#include <memory>
 
 //==============================================================================
 /**
+    Renders the playback regions under the play head: each region's audio
+    source is read, and overlapping regions are mixed. The processor then runs
+    the result through its own Distortion/BandPass chain and analysers, exactly
+    like host input, so the ARA and realtime paths share parameters, automation
+    and state.
+
+    For realtime playback every audio source is read through a
+    BufferingAudioReader filled by a shared background thread, with a
+    read-ahead of READ_AHEAD_BLOCKS host blocks; a realtime block never waits
+    for it (samples that aren't buffered yet render as silence and the block
+    reports failure). Non-realtime blocks wait for the read-ahead instead, and
+    a renderer that is never used in realtime reads the sources directly.
 */
 class DissonanceMeeterPlaybackRenderer  : public juce::ARAPlaybackRenderer
 {
@@ -21,6 +35,10 @@ public:
     //==============================================================================
     using juce::ARAPlaybackRenderer::ARAPlaybackRenderer;
 
+    static constexpr int READ_AHEAD_BLOCKS = 16;
+    static constexpr int MIN_READ_AHEAD_SAMPLES = 32768;
+    static constexpr int NON_REALTIME_READ_TIMEOUT_MS = 2000;
+
     //==============================================================================
     void prepareToPlay (double sampleRate,
                         int maximumSamplesPerBlock,
@@ -33,13 +51,40 @@ public:
     bool processBlock (juce::AudioBuffer<float>& buffer,
                        juce::AudioProcessor::Realtime realtime,
                        const juce::AudioPlayHead::PositionInfo& positionInfo) noexcept override;
+    bool processBlock (juce::AudioBuffer<double>& buffer,
+                       juce::AudioProcessor::Realtime realtime,
+                       const juce::AudioPlayHead::PositionInfo& positionInfo) noexcept override;
 
 private:
+    //==============================================================================
+    template <typename SampleType>
+    bool renderRegions (juce::AudioBuffer<SampleType>& buffer,
+                        juce::AudioProcessor::Realtime realtime,
+                        const juce::AudioPlayHead::PositionInfo& positionInfo) noexcept;
+
+    bool readSource (juce::ARAAudioSource* audioSource, juce::int64 startInSource, int numSamples,
+                     juce::AudioProcessor::Realtime realtime) noexcept;
+
+    // One read-ahead thread for all renderers of the plug-in
+    struct ReadAheadThread  : public juce::TimeSliceThread
+    {
+        ReadAheadThread()   : juce::TimeSliceThread ("Dissonance ARA read-ahead")   { startThread (Priority::high); }
+        ~ReadAheadThread() override                                                   { stopThread (1000); }
+    };
+
     //==============================================================================
     double sampleRate = 44100.0;
     int maximumSamplesPerBlock = 4096;
     int numChannels = 1;
     bool useBufferedAudioSourceReader = true;
 
+    juce::SharedResourcePointer<ReadAheadThread> readAheadThread;
+
+    // Created in prepareToPlay(): the set of regions (and so of sources) can't
+    // change while prepared
+    std::map<juce::ARAAudioSource*, std::unique_ptr<juce::AudioFormatReader>> audioSourceReaders;
+    std::map<juce::ARAAudioSource*, juce::BufferingAudioReader*> bufferedReaders;
+    juce::AudioBuffer<float> readBuffer;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DissonanceMeeterPlaybackRenderer)
 };
@@ -9,6 +9,10 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 #include "BuildNumber.h"
+#if JucePlugin_Enable_ARA
+  #include "PluginARADocumentController.h"
+  #include "PluginARAPlaybackRenderer.h"
+#endif
 
 namespace
 {
@@ -162,9 +166,9 @@ DissonanceMeeterAudioProcessorEditor::DissonanceMeeterAudioProcessorEditor(
 
 	// --- Slider BandPass con attachment ---
 	centerFreqAttachment = std::make_unique<AudioProcessorValueTreeState::SliderAttachment>(
-		bandPassProcessor.treeState, "CENTER_FREQ", centerFreqSlider);
+		bandPassProcessor.treeState, BandPassFilter::CENTER_FREQ_ID, centerFreqSlider);
 	qFactorAttachment = std::make_unique<AudioProcessorValueTreeState::SliderAttachment>(
-		bandPassProcessor.treeState, "Q_FACTOR", qFactorSlider);
+		bandPassProcessor.treeState, BandPassFilter::Q_FACTOR_ID, qFactorSlider);
 
 	for (auto* s : { &centerFreqSlider, &qFactorSlider })
 	{
@@ -180,7 +184,7 @@ DissonanceMeeterAudioProcessorEditor::DissonanceMeeterAudioProcessorEditor(
 
 	// --- Slider Distortion con attachment ---
 	aAttachment = std::make_unique<AudioProcessorValueTreeState::SliderAttachment>(
-		distortionProcessor.treeState, "A", aSlider);
+		distortionProcessor.treeState, Distortion::A_ID, aSlider);
 	aSlider.setSliderStyle(Slider::RotaryHorizontalVerticalDrag);
 	aSlider.setRotaryParameters(MathConstants<float>::pi * 1.2f,
 		MathConstants<float>::pi * 2.8f, true);
@@ -191,7 +195,7 @@ DissonanceMeeterAudioProcessorEditor::DissonanceMeeterAudioProcessorEditor(
 	aSlider.setColour(Slider::textBoxTextColourId, UiTheme::text);
 
 	gammaOmegaAttachment = std::make_unique<AudioProcessorValueTreeState::SliderAttachment>(
-		distortionProcessor.treeState, "GAMMA_OMEGA", gammaOmegaSlider);
+		distortionProcessor.treeState, Distortion::GAMMA_OMEGA_ID, gammaOmegaSlider);
 	gammaOmegaSlider.setSliderStyle(Slider::RotaryHorizontalVerticalDrag);
 	gammaOmegaSlider.setRotaryParameters(MathConstants<float>::pi * 1.2f,
 		MathConstants<float>::pi * 2.8f, true);
@@ -201,45 +205,96 @@ DissonanceMeeterAudioProcessorEditor::DissonanceMeeterAudioProcessorEditor(
 	gammaOmegaSlider.setColour(Slider::textBoxOutlineColourId, UiTheme::grid);
 	gammaOmegaSlider.setColour(Slider::textBoxTextColourId, UiTheme::text);
 
-	// --- Oscillatori ---
+	// --- Abilitazione stadi ---
+	distortionEnabledAttachment = std::make_unique<AudioProcessorValueTreeState::ButtonAttachment>(
+		distortionProcessor.treeState, Distortion::ENABLED_ID, distortionEnabledButton);
+	bandPassEnabledAttachment = std::make_unique<AudioProcessorValueTreeState::ButtonAttachment>(
+		bandPassProcessor.treeState, BandPassFilter::ENABLED_ID, bandPassEnabledButton);
+	for (auto* b : { &distortionEnabledButton, &bandPassEnabledButton })
+	{
+		b->setColour(ToggleButton::textColourId, UiTheme::textDim);
+		b->setColour(ToggleButton::tickColourId, UiTheme::accent);
+		b->setColour(ToggleButton::tickDisabledColourId, UiTheme::grid);
+	}
+
+	// --- Oscillatori (parametri del processor, automatizzabili) ---
+	auto& processorState = audioProcessor.getParameterState();
+	oscFreq1Attachment = std::make_unique<AudioProcessorValueTreeState::SliderAttachment>(
+		processorState, DissonanceMeeterAudioProcessor::OSC1_FREQ_ID, oscFreq1Slider);
+	oscFreq2Attachment = std::make_unique<AudioProcessorValueTreeState::SliderAttachment>(
+		processorState, DissonanceMeeterAudioProcessor::OSC2_FREQ_ID, oscFreq2Slider);
 	for (auto* s : { &oscFreq1Slider, &oscFreq2Slider })
 	{
 		s->setSliderStyle(Slider::LinearHorizontal);
 		s->setTextBoxStyle(Slider::TextBoxRight, false, 64, 18);
 		s->setNumDecimalPlacesToDisplay(0);
-		s->setRange(20.0, 20000.0, 1.0);
-		s->setSkewFactorFromMidPoint(440.0);
 		s->setColour(Slider::textBoxBackgroundColourId, UiTheme::panelAlt);
 		s->setColour(Slider::textBoxOutlineColourId, UiTheme::grid);
 		s->setColour(Slider::textBoxTextColourId, UiTheme::text);
 	}
-	auto [f1, f2] = audioProcessor.getOscillatorFrequencies();
-	oscFreq1Slider.setValue(f1, dontSendNotification);
-	oscFreq2Slider.setValue(f2, dontSendNotification);
-
-	oscFreq1Slider.onValueChange = [this] {
-		if (audioProcessor.getInputMode() == DissonanceMeeterAudioProcessor::InputMode::Oscillator)
-			audioProcessor.setOscillatorFrequencies((float)oscFreq1Slider.getValue(),
-				audioProcessor.getOscillatorFrequencies().second);
-		};
-	oscFreq2Slider.onValueChange = [this] {
-		if (audioProcessor.getInputMode() == DissonanceMeeterAudioProcessor::InputMode::Oscillator)
-			audioProcessor.setOscillatorFrequencies(audioProcessor.getOscillatorFrequencies().first,
-				(float)oscFreq2Slider.getValue());
-		};
 	oscFreq1Minus.onClick = [this] { oscFreq1Slider.setValue(oscFreq1Slider.getValue() - 1.0, sendNotification); };
 	oscFreq1Plus.onClick = [this] { oscFreq1Slider.setValue(oscFreq1Slider.getValue() + 1.0, sendNotification); };
 	oscFreq2Minus.onClick = [this] { oscFreq2Slider.setValue(oscFreq2Slider.getValue() - 1.0, sendNotification); };
 	oscFreq2Plus.onClick = [this] { oscFreq2Slider.setValue(oscFreq2Slider.getValue() + 1.0, sendNotification); };
 
+	// --- Voci dell'oscillatore ---
+	numVoicesSelector.addItemList(processorState.getParameter(
+		DissonanceMeeterAudioProcessor::NUM_OSC_VOICES_ID)->getAllValueStrings(), 1);
+	numVoicesAttachment = std::make_unique<AudioProcessorValueTreeState::ComboBoxAttachment>(
+		processorState, DissonanceMeeterAudioProcessor::NUM_OSC_VOICES_ID, numVoicesSelector);
+	for (int v = 0; v < OscillatorBank::MAX_VOICES; ++v)
+		voiceSelector.addItem(juce::String(v + 1), v + 1);
+	voiceSelector.onChange = [this] { attachVoice(voiceSelector.getSelectedId() - 1); };
+
+	for (auto* s : { &voiceFreqSlider, &voiceGainSlider, &voicePartialsSlider, &voiceRolloffSlider })
+	{
+		s->setSliderStyle(Slider::LinearHorizontal);
+		s->setTextBoxStyle(Slider::TextBoxRight, false, 44, 18);
+		s->setColour(Slider::textBoxBackgroundColourId, UiTheme::panelAlt);
+		s->setColour(Slider::textBoxOutlineColourId, UiTheme::grid);
+		s->setColour(Slider::textBoxTextColourId, UiTheme::text);
+	}
+	voiceSelector.setSelectedId(1, dontSendNotification);
+	attachVoice(0);
+
+	// --- Analisi ---
+	{
+		struct Choice { const char* parameterID; const char* caption; };
+		const std::array<Choice, numAnalysisChoices> choices{ {
+			{ DissonanceMeeterAudioProcessor::DISSONANCE_ENGINE_ID,   "ENGINE" },
+			{ DissonanceMeeterAudioProcessor::CHANNEL_ANALYSIS_ID,    "CHANNELS" },
+			{ DissonanceMeeterAudioProcessor::FREQUENCY_ESTIMATOR_ID, "ESTIMATOR" },
+			{ DissonanceMeeterAudioProcessor::DISSONANCE_MODEL_ID,    "MODEL" },
+			{ DissonanceMeeterAudioProcessor::PARTIAL_GROUPING_ID,    "GROUPING" },
+			{ DissonanceMeeterAudioProcessor::ANALYSIS_FRAME_ID,      "FRAME" },
+			{ DissonanceMeeterAudioProcessor::MIDI_TIMBRE_ID,         "MIDI TIMBRE" },
+			{ DissonanceMeeterAudioProcessor::STAGE_ORDER_ID,         "STAGE ORDER" } } };
+
+		for (size_t i = 0; i < choices.size(); ++i)
+		{
+			auto& control = analysisChoices[i];
+			control.label.setText(choices[i].caption, dontSendNotification);
+			control.box.addItemList(processorState.getParameter(choices[i].parameterID)->getAllValueStrings(), 1);
+			control.attachment = std::make_unique<AudioProcessorValueTreeState::ComboBoxAttachment>(
+				processorState, choices[i].parameterID, control.box);
+		}
+	}
+	lowLatencyAttachment = std::make_unique<AudioProcessorValueTreeState::ButtonAttachment>(
+		processorState, DissonanceMeeterAudioProcessor::LOW_LATENCY_ID, lowLatencyButton);
+	stationarityGateAttachment = std::make_unique<AudioProcessorValueTreeState::ButtonAttachment>(
+		processorState, DissonanceMeeterAudioProcessor::STATIONARITY_GATE_ID, stationarityGateButton);
+	for (auto* b : { &lowLatencyButton, &stationarityGateButton })
+	{
+		b->setColour(ToggleButton::textColourId, UiTheme::textDim);
+		b->setColour(ToggleButton::tickColourId, UiTheme::accent);
+		b->setColour(ToggleButton::tickDisabledColourId, UiTheme::grid);
+	}
+
 	// --- Master gain ---
 	masterGainSlider.setSliderStyle(Slider::LinearHorizontal);
 	masterGainSlider.setTextBoxStyle(Slider::TextBoxRight, false, 64, 18);
-	masterGainSlider.setRange(0.0, 20.0, 0.01);
-	masterGainSlider.setValue(audioProcessor.getOutputGain(), dontSendNotification);
-	masterGainSlider.onValueChange = [this] {
-		audioProcessor.setOutputGain((float)masterGainSlider.getValue());
-		};
+	masterGainAttachment = std::make_unique<AudioProcessorValueTreeState::SliderAttachment>(
+		processorState, DissonanceMeeterAudioProcessor::OUTPUT_GAIN_ID, masterGainSlider);
 	masterGainSlider.setColour(Slider::textBoxBackgroundColourId, UiTheme::panelAlt);
 	masterGainSlider.setColour(Slider::textBoxOutlineColourId, UiTheme::grid);
 	masterGainSlider.setColour(Slider::textBoxTextColourId, UiTheme::text);
@@ -247,25 +302,17 @@ DissonanceMeeterAudioProcessorEditor::DissonanceMeeterAudioProcessorEditor(
 	// --- Meter smoothing (dissonance EMA alpha) ---
 	meterSmoothingSlider.setSliderStyle(Slider::LinearHorizontal);
 	meterSmoothingSlider.setTextBoxStyle(Slider::TextBoxRight, false, 64, 18);
-	meterSmoothingSlider.setRange(0.01, 1.0, 0.001);
-	meterSmoothingSlider.setValue(audioProcessor.getMeterSmoothing(), dontSendNotification);
-	meterSmoothingSlider.onValueChange = [this] {
-		audioProcessor.setMeterSmoothing((float)meterSmoothingSlider.getValue());
-		};
+	meterSmoothingAttachment = std::make_unique<AudioProcessorValueTreeState::SliderAttachment>(
+		processorState, DissonanceMeeterAudioProcessor::METER_SMOOTHING_ID, meterSmoothingSlider);
 	meterSmoothingSlider.setColour(Slider::textBoxBackgroundColourId, UiTheme::panelAlt);
 	meterSmoothingSlider.setColour(Slider::textBoxOutlineColourId, UiTheme::grid);
 	meterSmoothingSlider.setColour(Slider::textBoxTextColourId, UiTheme::text);
 
 	// --- Mode selector ---
-	modeSelector.addItem("External Input", 1);
-	modeSelector.addItem("Internal Oscillator", 2);
-	modeSelector.setSelectedId(1);
-	modeSelector.onChange = [this] {
-		audioProcessor.setInputMode(
-			modeSelector.getSelectedId() == 1
-			? DissonanceMeeterAudioProcessor::InputMode::ExternalInput
-			: DissonanceMeeterAudioProcessor::InputMode::Oscillator);
-		};
+	modeSelector.addItemList(processorState.getParameter(
+		DissonanceMeeterAudioProcessor::INPUT_MODE_ID)->getAllValueStrings(), 1);
+	modeAttachment = std::make_unique<AudioProcessorValueTreeState::ComboBoxAttachment>(
+		processorState, DissonanceMeeterAudioProcessor::INPUT_MODE_ID, modeSelector);
 
 	// --- Label setup ---
 	auto setupLabel = [](Label& l, const String& text, Justification just) {
@@ -282,6 +329,14 @@ DissonanceMeeterAudioProcessorEditor::DissonanceMeeterAudioProcessorEditor(
 	setupLabel(osc2Label, "OSC 2 (Hz)", Justification::centredLeft);
 	setupLabel(masterGainLabel, "MASTER GAIN", Justification::centredLeft);
 	setupLabel(meterSmoothingLabel, "METER SPEED", Justification::centredLeft);
+	setupLabel(numVoicesLabel, "VOICES", Justification::centredLeft);
+	setupLabel(voiceLabel, "EDIT VOICE", Justification::centredLeft);
+	setupLabel(voiceFreqLabel, "FREQ", Justification::centredLeft);
+	setupLabel(voiceGainLabel, "GAIN", Justification::centredLeft);
+	setupLabel(voicePartialsLabel, "PARTIALS", Justification::centredLeft);
+	setupLabel(voiceRolloffLabel, "ROLLOFF", Justification::centredLeft);
+	for (auto& control : analysisChoices)
+		setupLabel(control.label, control.label.getText(), Justification::centredLeft);
 
 	// --- Waveform ---
 	audioProcessor.getWaveForm().setColours(UiTheme::panel, UiTheme::accent);
@@ -292,6 +347,8 @@ DissonanceMeeterAudioProcessorEditor::DissonanceMeeterAudioProcessorEditor(
 	addAndMakeVisible(qFactorSlider);    addAndMakeVisible(qFactorLabel);
 	addAndMakeVisible(aSlider);        addAndMakeVisible(aLabel);
 	addAndMakeVisible(gammaOmegaSlider); addAndMakeVisible(gammaOmegaLabel);
+	addAndMakeVisible(distortionEnabledButton);
+	addAndMakeVisible(bandPassEnabledButton);
 	addAndMakeVisible(oscFreq1Slider); addAndMakeVisible(osc1Label);
 	addAndMakeVisible(oscFreq2Slider); addAndMakeVisible(osc2Label);
 	addAndMakeVisible(oscFreq1Minus);  addAndMakeVisible(oscFreq1Plus);
@@ -300,17 +357,60 @@ DissonanceMeeterAudioProcessorEditor::DissonanceMeeterAudioProcessorEditor(
 	addAndMakeVisible(masterGainLabel);
 	addAndMakeVisible(meterSmoothingSlider);
 	addAndMakeVisible(meterSmoothingLabel);
+	addAndMakeVisible(numVoicesLabel);  addAndMakeVisible(numVoicesSelector);
+	addAndMakeVisible(voiceLabel);      addAndMakeVisible(voiceSelector);
+	for (auto* c : std::initializer_list<Component*>{ &voiceFreqSlider, &voiceFreqLabel, &voiceGainSlider, &voiceGainLabel,
+		&voicePartialsSlider, &voicePartialsLabel, &voiceRolloffSlider, &voiceRolloffLabel })
+		addAndMakeVisible(c);
+	for (auto& control : analysisChoices)
+	{
+		addAndMakeVisible(control.label);
+		addAndMakeVisible(control.box);
+	}
+	addAndMakeVisible(lowLatencyButton);
+	addAndMakeVisible(stationarityGateButton);
 	addAndMakeVisible(audioProcessor.getWaveForm());
 
-	setSize(900, 580);
+	setSize(1160, 660);
 	setResizable(true, true);
-	setResizeLimits(820, 560, 30000, 30000);
+	setResizeLimits(1080, 640, 30000, 30000);
 	setOpaque(true);
+	setWantsKeyboardFocus(true);
 	startTimerHz(30);
 }
 
+void DissonanceMeeterAudioProcessorEditor::attachVoice(int voiceIndex)
+{
+	using VoiceParameter = DissonanceMeeterAudioProcessor::VoiceParameter;
+	using Attachment = AudioProcessorValueTreeState::SliderAttachment;
+	auto& state = audioProcessor.getParameterState();
+
+	voiceFreqAttachment.reset();
+	voiceGainAttachment.reset();
+	voicePartialsAttachment.reset();
+	voiceRolloffAttachment.reset();
+
+	voiceFreqAttachment = std::make_unique<Attachment>(state,
+		DissonanceMeeterAudioProcessor::getVoiceParameterID(voiceIndex, VoiceParameter::Frequency), voiceFreqSlider);
+	voiceGainAttachment = std::make_unique<Attachment>(state,
+		DissonanceMeeterAudioProcessor::getVoiceParameterID(voiceIndex, VoiceParameter::Gain), voiceGainSlider);
+	voicePartialsAttachment = std::make_unique<Attachment>(state,
+		DissonanceMeeterAudioProcessor::getVoiceParameterID(voiceIndex, VoiceParameter::Partials), voicePartialsSlider);
+	voiceRolloffAttachment = std::make_unique<Attachment>(state,
+		DissonanceMeeterAudioProcessor::getVoiceParameterID(voiceIndex, VoiceParameter::Rolloff), voiceRolloffSlider);
+
+	voiceFreqSlider.setNumDecimalPlacesToDisplay(0);
+	voiceGainSlider.setNumDecimalPlacesToDisplay(2);
+	voiceRolloffSlider.setNumDecimalPlacesToDisplay(2);
+}
+
 DissonanceMeeterAudioProcessorEditor::~DissonanceMeeterAudioProcessorEditor()
 {
+	updateSessionViewer(false);
+
+	if (showProfilerOverlay)
+		audioProcessor.getProfiler().setEnabled(false);
+
 	setLookAndFeel(nullptr);
 	delete customLookAndFeel;
 }
@@ -329,6 +429,8 @@ void DissonanceMeeterAudioProcessorEditor::drawMeterLabel(juce::Graphics& g, con
 //==============================================================================
 void DissonanceMeeterAudioProcessorEditor::paint(juce::Graphics& g)
 {
+	TraceRecorder::ScopedEvent traceEvent(audioProcessor.getTracer(), "paint");
+
 	g.fillAll(UiTheme::background);
 
 	// Header
@@ -359,7 +461,7 @@ void DissonanceMeeterAudioProcessorEditor::paint(juce::Graphics& g)
 			g.drawRoundedRectangle(area.toFloat(), (float)UiTheme::radius, 1.0f);
 		};
 
-	for (auto area : { sectionMaster, sectionFreq, sectionOsc, sectionViz })
+	for (auto area : { sectionMaster, sectionFreq, sectionOsc, sectionViz, sectionAnalysis })
 		drawCard(area);
 
 	// Section titles — use LOCAL copies so stored rects are never mutated
@@ -381,6 +483,10 @@ void DissonanceMeeterAudioProcessorEditor::paint(juce::Graphics& g)
 		auto r = sectionViz;
 		g.drawText("VISUALIZATION", r.removeFromTop(UiTheme::titleH).reduced(UiTheme::pad, 0), juce::Justification::centredLeft);
 	}
+	{
+		auto r = sectionAnalysis;
+		g.drawText("ANALYSIS", r.removeFromTop(UiTheme::titleH).reduced(UiTheme::pad, 0), juce::Justification::centredLeft);
+	}
 
 	// Dissonance bar
 	{
@@ -485,6 +591,246 @@ void DissonanceMeeterAudioProcessorEditor::paint(juce::Graphics& g)
 		g.drawText(String((int)db), preDistMeterX + meterW + 4, y - 6, UiTheme::meterLabelW, 12,
 			juce::Justification::centredLeft);
 	}
+
+	drawSessionClash(g);
+
+	if (showProfilerOverlay)
+		drawProfilerOverlay(g);
+
+	if (audioProcessor.getTracer().isRecording())
+	{
+		g.setColour(UiTheme::warning);
+		g.setFont(juce::Font(juce::FontOptions().withHeight(10.0f).withStyle("Bold")));
+		g.drawText("TRACE", sectionViz.reduced(UiTheme::pad).removeFromTop(UiTheme::titleH),
+			juce::Justification::centredRight);
+	}
+}
+
+void DissonanceMeeterAudioProcessorEditor::drawProfilerOverlay(juce::Graphics& g) const
+{
+	const auto& profiler = audioProcessor.getProfiler();
+	const int rowH = 13;
+	const int overlayW = 260;
+
+	auto area = sectionViz.reduced(UiTheme::pad);
+	area.removeFromTop(UiTheme::titleH);
+	area = area.removeFromRight(overlayW).removeFromTop(rowH * (StageProfiler::NUM_STAGES + 2) + 8);
+
+	g.setColour(UiTheme::background.withAlpha(0.85f));
+	g.fillRoundedRectangle(area.toFloat(), 4.0f);
+
+	auto rows = area.reduced(6, 4);
+	auto drawRow = [&g, &rows, rowH](const juce::String& name, const juce::String& p50,
+		const juce::String& p99, const juce::String& max)
+		{
+			auto row = rows.removeFromTop(rowH);
+			g.drawText(name, row.removeFromLeft(98), juce::Justification::centredLeft);
+			g.drawText(p50, row.removeFromLeft(50), juce::Justification::centredRight);
+			g.drawText(p99, row.removeFromLeft(50), juce::Justification::centredRight);
+			g.drawText(max, row, juce::Justification::centredRight);
+		};
+
+	g.setFont(juce::Font(juce::FontOptions().withHeight(10.0f).withStyle("Bold")));
+	g.setColour(UiTheme::textDim);
+	drawRow("CPU % deadline", "p50", "p99", "max");
+
+	g.setFont(juce::Font(juce::FontOptions().withHeight(10.0f)));
+	for (int s = 0; s < StageProfiler::NUM_STAGES; ++s)
+	{
+		const auto summary = profiler.getSummary((StageProfiler::Stage)s);
+		g.setColour(summary.p99 > 50.0f ? UiTheme::warning : UiTheme::text);
+		drawRow(StageProfiler::getStageName(s), juce::String(summary.p50, 2),
+			juce::String(summary.p99, 2), juce::String(summary.max, 2));
+	}
+
+	// Frames lost to a fully leased FFT plan pool: the reading went stale
+	const int skipped = audioProcessor.getNumSkippedAnalysisFrames();
+	g.setColour(skipped > 0 ? UiTheme::warning : UiTheme::textDim);
+	drawRow("FFT frames skipped", {}, {}, juce::String(skipped));
+}
+
+void DissonanceMeeterAudioProcessorEditor::drawSessionClash(juce::Graphics& g) const
+{
+	const auto& registry = audioProcessor.getSessionRegistry();
+	std::array<SessionDissonanceRegistry::Clash, SessionDissonanceRegistry::MAX_REPORTED_CLASHES> clashes;
+	const int numClashes = registry.getClashes(clashes);
+	if (numClashes == 0)
+		return;
+
+	// L'elenco e' gia' ordinato dalla peggiore
+	const int slot = audioProcessor.getSessionSlot();
+	auto clash = clashes[0];
+	for (int i = 0; i < numClashes; ++i)
+	{
+		if (clashes[(size_t)i].trackA == slot || clashes[(size_t)i].trackB == slot)
+		{
+			clash = clashes[(size_t)i];
+			break;
+		}
+	}
+
+	const bool involvesThisTrack = clash.trackA == slot || clash.trackB == slot;
+	const auto text = "CLASH  " + registry.getTrackName(clash.trackA) + juce::String::fromUTF8(" \xc3\x97 ")
+		+ registry.getTrackName(clash.trackB) + "  " + juce::String(clash.dissonance, 2);
+
+	g.setColour(involvesThisTrack ? UiTheme::warning : UiTheme::textDim);
+	g.setFont(juce::Font(juce::FontOptions().withHeight(10.0f).withStyle("Bold")));
+	g.drawText(text, sectionViz.reduced(UiTheme::pad).removeFromTop(UiTheme::titleH),
+		juce::Justification::centred, true);
+}
+
+void DissonanceMeeterAudioProcessorEditor::visibilityChanged()
+{
+	updateSessionViewer(isShowing());
+}
+
+void DissonanceMeeterAudioProcessorEditor::parentHierarchyChanged()
+{
+	updateSessionViewer(isShowing());
+}
+
+void DissonanceMeeterAudioProcessorEditor::updateSessionViewer(bool shouldView)
+{
+	if (shouldView == viewingSession)
+		return;
+
+	viewingSession = shouldView;
+	auto& registry = audioProcessor.getSessionRegistry();
+	if (shouldView)
+		registry.addViewer();
+	else
+		registry.removeViewer();
+}
+
+void DissonanceMeeterAudioProcessorEditor::paintOverChildren(juce::Graphics& g)
+{
+	// The waveform covers the viz card, so the spectrum goes on top of it
+	drawRoughnessSpectrum(g);
+#if JucePlugin_Enable_ARA
+	drawAraLookahead(g);
+#endif
+}
+
+#if JucePlugin_Enable_ARA
+void DissonanceMeeterAudioProcessorEditor::updateAraLookahead()
+{
+	hasAraLookahead = false;
+
+	auto* editorView = getARAEditorView();
+	auto* renderer = audioProcessor.getPlaybackRenderer<DissonanceMeeterPlaybackRenderer>();
+	if (editorView == nullptr || renderer == nullptr)
+		return;
+
+	const auto* documentController = juce::ARADocumentControllerSpecialisation::getSpecialisedDocumentController<
+		DissonanceMeeterDocumentController>(editorView->getDocumentController());
+	if (documentController == nullptr)
+		return;
+
+	araLookahead.fill(-1.0f);
+	const double playhead = audioProcessor.getAraPlayheadTime();
+	const double step = araLookaheadSeconds / (double)(araLookaheadPoints - 1);
+
+	for (auto* region : renderer->getPlaybackRegions())
+	{
+		const auto map = documentController->getDissonanceMap(region->getAudioModification()->getAudioSource());
+		if (map == nullptr)
+			continue;
+
+		// Playback time -> source time: the renderer plays regions unstretched
+		const auto playbackRange = region->getTimeRange();
+		const double sourceOffset = region->getStartInAudioModificationTime() - playbackRange.getStart();
+
+		for (int i = 0; i < araLookaheadPoints; ++i)
+		{
+			const double time = playhead + step * (double)i;
+			if (! playbackRange.contains(time))
+				continue;
+
+			const auto sample = (juce::int64)((time + sourceOffset) * map->getSampleRate());
+			if (map->getFrameForSample(sample) < 0)
+				continue;
+
+			// Overlapping regions: the roughest one
+			araLookahead[(size_t)i] = juce::jmax(araLookahead[(size_t)i], map->getDissonanceAtSample(sample));
+			hasAraLookahead = true;
+		}
+	}
+}
+
+void DissonanceMeeterAudioProcessorEditor::drawAraLookahead(juce::Graphics& g) const
+{
+	if (! hasAraLookahead)
+		return;
+
+	auto area = audioProcessor.getWaveForm().getBounds().reduced(4);
+	area = area.removeFromTop(area.getHeight() / 2);
+
+	g.setColour(UiTheme::textDim);
+	g.setFont(juce::Font(juce::FontOptions().withHeight(10.0f).withStyle("Bold")));
+	g.drawText("AHEAD " + juce::String(araLookaheadSeconds, 0) + " s", area.removeFromTop(12),
+		juce::Justification::centredRight);
+
+	const float peak = juce::FloatVectorOperations::findMaximum(araLookahead.data(), araLookaheadPoints);
+	const float scale = (float)area.getHeight() / juce::jmax(peak, 0.05f);
+	const float dx = (float)area.getWidth() / (float)(araLookaheadPoints - 1);
+
+	// One sub-path per stretch covered by analysed regions
+	juce::Path curve;
+	bool inStretch = false;
+	for (int i = 0; i < araLookaheadPoints; ++i)
+	{
+		const float value = araLookahead[(size_t)i];
+		if (value < 0.0f)
+		{
+			inStretch = false;
+			continue;
+		}
+
+		const juce::Point<float> point((float)area.getX() + dx * (float)i,
+			(float)area.getBottom() - juce::jmin((float)area.getHeight(), value * scale));
+		if (inStretch)
+			curve.lineTo(point);
+		else
+			curve.startNewSubPath(point);
+		inStretch = true;
+	}
+
+	g.setColour(UiTheme::accent);
+	g.strokePath(curve, juce::PathStrokeType(1.5f));
+}
+#endif
+
+void DissonanceMeeterAudioProcessorEditor::drawRoughnessSpectrum(juce::Graphics& g) const
+{
+	if (! hasRoughnessSpectrum)
+		return;
+
+	auto area = audioProcessor.getWaveForm().getBounds().reduced(4);
+#if JucePlugin_Enable_ARA
+	// The look-ahead curve owns the top half: the bars keep to the bottom one
+	if (hasAraLookahead)
+		area = area.removeFromBottom(area.getHeight() / 2);
+#endif
+	const float peak = juce::FloatVectorOperations::findMaximum(roughnessBands.data(), RoughnessSpectrum::NUM_BANDS);
+
+	g.setColour(UiTheme::textDim);
+	g.setFont(juce::Font(juce::FontOptions().withHeight(10.0f).withStyle("Bold")));
+	g.drawText("ROUGHNESS / BARK", area.removeFromTop(12), juce::Justification::centredLeft);
+
+	// Bark bands are roughly equal in perceptual width: equal-width bars.
+	// The floor keeps near-consonant material from filling the card.
+	const float scale = 1.0f / juce::jmax(peak, 0.02f);
+	const float barW = (float)area.getWidth() / (float)RoughnessSpectrum::NUM_BANDS;
+	const float bottom = (float)area.getBottom();
+
+	g.setColour(UiTheme::warning.withAlpha(0.55f));
+	for (int b = 0; b < RoughnessSpectrum::NUM_BANDS; ++b)
+	{
+		const float h = juce::jmin(1.0f, roughnessBands[(size_t)b] * scale) * (float)area.getHeight();
+		if (h >= 0.5f)
+			g.fillRect(juce::Rectangle<float>((float)area.getX() + (float)b * barW + 1.0f, bottom - h,
+				juce::jmax(1.0f, barW - 2.0f), h));
+	}
 }
 
 void DissonanceMeeterAudioProcessorEditor::resized()
@@ -500,9 +846,11 @@ void DissonanceMeeterAudioProcessorEditor::resized()
 
 	// Left column wide enough for three vertical meters (OUT, POST CHAIN,
 	// PRE DIST) with labels and dB tick text, plus comfortable controls
-	// (gain slider, mode selector).
+	// (gain slider, mode selector). The analysis options get their own
+	// column on the far right.
 	const int leftColW = 260;
-	const int rightW = contentArea.getWidth() - leftColW - pad;
+	const int analysisColW = 240;
+	const int rightW = contentArea.getWidth() - leftColW - analysisColW - 2 * pad;
 	const int rightX = contentArea.getX() + leftColW + pad;
 
 	// Vertical: viz at the bottom (bigger), params+osc above it.
@@ -527,6 +875,9 @@ void DissonanceMeeterAudioProcessorEditor::resized()
 
 	sectionViz = juce::Rectangle<int>(rightX, sectionOsc.getBottom() + pad, rightW, vizH);
 
+	sectionAnalysis = juce::Rectangle<int>(contentArea.getRight() - analysisColW, contentArea.getY(),
+		analysisColW, contentArea.getHeight());
+
 	// ---- Master section ----
 	{
 		auto inner = sectionMaster.reduced(pad);
@@ -576,6 +927,11 @@ void DissonanceMeeterAudioProcessorEditor::resized()
 		aLabel.setBounds(inner.getX() + (knobSize + pad) * 2, labelY, knobSize, labelH);
 		gammaOmegaLabel.setBounds(inner.getX() + (knobSize + pad) * 3, labelY, knobSize, labelH);
 
+		// Stage enable toggles, right-aligned in the card's title strip
+		auto titleStrip = sectionFreq.reduced(pad, 0).removeFromTop(titleH);
+		distortionEnabledButton.setBounds(titleStrip.removeFromRight(100));
+		bandPassEnabledButton.setBounds(titleStrip.removeFromRight(100));
+
 		centerFreqSlider.setBounds(inner.getX(), sliderY, knobSize, knobSize);
 		qFactorSlider.setBounds(inner.getX() + (knobSize + pad), sliderY, knobSize, knobSize);
 		aSlider.setBounds(inner.getX() + (knobSize + pad) * 2, sliderY, knobSize, knobSize);
@@ -601,6 +957,47 @@ void DissonanceMeeterAudioProcessorEditor::resized()
 		oscFreq2Slider.setBounds(inner.getX() + UiTheme::oscLabelW, row2Y, oscSliderW, 24);
 		oscFreq2Minus.setBounds(inner.getRight() - oscBtnW * 2 - pad, row2Y, oscBtnW, 24);
 		oscFreq2Plus.setBounds(inner.getRight() - oscBtnW, row2Y, oscBtnW, 24);
+
+		// Row 3: number of voices, the voice being edited and its frequency
+		const int row3Y = row2Y + 24 + rowGap;
+		auto row3 = juce::Rectangle<int>(inner.getX(), row3Y, inner.getWidth(), 24);
+		numVoicesLabel.setBounds(row3.removeFromLeft(56));
+		numVoicesSelector.setBounds(row3.removeFromLeft(60));
+		row3.removeFromLeft(pad);
+		voiceLabel.setBounds(row3.removeFromLeft(80));
+		voiceSelector.setBounds(row3.removeFromLeft(60));
+		row3.removeFromLeft(pad);
+		voiceFreqLabel.setBounds(row3.removeFromLeft(44));
+		voiceFreqSlider.setBounds(row3);
+
+		// Row 4: the edited voice's timbre
+		const int row4Y = row3Y + 24 + rowGap;
+		auto row4 = juce::Rectangle<int>(inner.getX(), row4Y, inner.getWidth(), 24);
+		const int cellW = (row4.getWidth() - 2 * pad) / 3;
+		for (auto [label, slider] : { std::pair{ &voiceGainLabel, &voiceGainSlider },
+		                              std::pair{ &voicePartialsLabel, &voicePartialsSlider },
+		                              std::pair{ &voiceRolloffLabel, &voiceRolloffSlider } })
+		{
+			auto cell = row4.removeFromLeft(cellW);
+			row4.removeFromLeft(pad);
+			label->setBounds(cell.removeFromLeft(64));
+			slider->setBounds(cell);
+		}
+	}
+
+	// ---- ANALYSIS section (right column, one labelled control per row) ----
+	{
+		auto inner = sectionAnalysis.reduced(pad);
+		inner.removeFromTop(titleH);
+		for (auto& control : analysisChoices)
+		{
+			control.label.setBounds(inner.removeFromTop(labelH));
+			inner.removeFromTop(2);
+			control.box.setBounds(inner.removeFromTop(UiTheme::controlH));
+			inner.removeFromTop(8);
+		}
+		lowLatencyButton.setBounds(inner.removeFromTop(UiTheme::controlH));
+		stationarityGateButton.setBounds(inner.removeFromTop(UiTheme::controlH));
 	}
 
 	// ---- Waveform: below the title strip in the viz card ----
@@ -610,7 +1007,59 @@ void DissonanceMeeterAudioProcessorEditor::resized()
 		audioProcessor.getWaveForm().setBounds(vizInner);
 	}
 }
+bool DissonanceMeeterAudioProcessorEditor::keyPressed(const juce::KeyPress& key)
+{
+	const auto modifiers = juce::ModifierKeys::commandModifier | juce::ModifierKeys::shiftModifier;
+
+	if (key == juce::KeyPress('t', modifiers, 0))
+	{
+		toggleTraceRecording();
+		return true;
+	}
+
+	const auto toggle = juce::KeyPress('p', modifiers, 0);
+	if (key != toggle)
+		return false;
+
+	// Lo stesso tasto accende la profilazione e azzera le statistiche
+	showProfilerOverlay = ! showProfilerOverlay;
+	auto& profiler = audioProcessor.getProfiler();
+	profiler.reset();
+	profiler.setEnabled(showProfilerOverlay);
+	repaint();
+	return true;
+}
+
+void DissonanceMeeterAudioProcessorEditor::toggleTraceRecording()
+{
+	auto& tracer = audioProcessor.getTracer();
+
+	if (tracer.isRecording())
+	{
+		tracer.stop();
+		DBG("Trace written to " + traceFile.getFullPathName());
+	}
+	else
+	{
+		// Un file nuovo per sessione, da aprire in ui.perfetto.dev o chrome://tracing
+		traceFile = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+			.getNonexistentChildFile("dissonanceMeeter-trace", ".json");
+		tracer.start(traceFile);
+	}
+
+	repaint();
+}
+
 void DissonanceMeeterAudioProcessorEditor::timerCallback()
 {
+	TraceRecorder::ScopedEvent traceEvent(audioProcessor.getTracer(), "timerCallback");
+#if JucePlugin_Enable_ARA
+	updateAraLookahead();
+#endif
+	// On a torn read the previous bands stay on screen for another tick
+	if (audioProcessor.getDissonanceEngine() == DissonanceMeeterAudioProcessor::DissonanceEngine::Spectral)
+		hasRoughnessSpectrum = audioProcessor.getRoughnessSpectrum(roughnessBands) || hasRoughnessSpectrum;
+	else
+		hasRoughnessSpectrum = false;
 	repaint();
 }
\ No newline at end of file
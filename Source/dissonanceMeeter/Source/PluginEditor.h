@@ -27,8 +27,12 @@ public:
 
 	//==============================================================================
 	void paint(juce::Graphics&) override;
+	void paintOverChildren(juce::Graphics& g) override;
 	void resized() override;
 	void timerCallback() override;
+	bool keyPressed(const juce::KeyPress& key) override;
+	void visibilityChanged() override;
+	void parentHierarchyChanged() override;
 
 private:
 	class DissonanceLookAndFeel;
@@ -37,6 +41,54 @@ private:
 	// centred on meterCentreX and clamped within sectionMaster.
 	void drawMeterLabel(juce::Graphics& g, const juce::String& text, int meterCentreX, int labelW) const;
 
+	// Debug overlay with the per-stage CPU load (p50/p99/max of the block
+	// deadline) and the count of skipped FFT frames over the visualization
+	// card; toggled with Cmd/Ctrl+Shift+P.
+	void drawProfilerOverlay(juce::Graphics& g) const;
+	bool showProfilerOverlay = false;
+
+	// Worst track-vs-track clash of the host session (see
+	// SessionDissonanceRegistry.h), in the visualization title strip:
+	// the one involving this track if any, otherwise the session's worst.
+	void drawSessionClash(juce::Graphics& g) const;
+
+	// Counts this editor as a viewer of the session registry while it is
+	// showing: the matrix is only aggregated while someone can see it.
+	void updateSessionViewer(bool shouldView);
+	bool viewingSession = false;
+
+	// Roughness per Bark band (see RoughnessSpectrum.h) as bars over the
+	// waveform, one per critical band, scaled to the roughest band. Read
+	// once per timer tick; hidden while a non-spectral engine is selected.
+	// While the ARA look-ahead curve is shown it takes the top half of the
+	// waveform and the bars the bottom half.
+	void drawRoughnessSpectrum(juce::Graphics& g) const;
+	RoughnessSpectrum::Bands roughnessBands{};
+	bool hasRoughnessSpectrum = false;
+
+#if JucePlugin_Enable_ARA
+	// ARA: dissonance of the regions just ahead of the play head, read from
+	// the maps the document controller computes in the background (see
+	// PluginARADocumentController.h), drawn as a curve over the top half of
+	// the waveform. Rebuilt once per timer tick; a point is negative where
+	// no region plays or its audio source hasn't been analysed yet.
+	static constexpr double araLookaheadSeconds = 4.0;
+	static constexpr int    araLookaheadPoints = 128;
+	void updateAraLookahead();
+	void drawAraLookahead(juce::Graphics& g) const;
+	std::array<float, araLookaheadPoints> araLookahead{};
+	bool hasAraLookahead = false;
+#endif
+
+	// Starts/stops the Chrome trace (Cmd/Ctrl+Shift+T); each recording goes
+	// to a new dissonanceMeeter-trace*.json in the user's documents folder.
+	void toggleTraceRecording();
+	juce::File traceFile;
+
+	// Points the voice sliders of the oscillator card at the parameters of
+	// voice voiceIndex (0-based); the previous attachments are dropped first.
+	void attachVoice(int voiceIndex);
+
 	// This reference is provided as a quick way for your editor to
 	// access the processor object that created it.
 	DissonanceMeeterAudioProcessor& audioProcessor;
@@ -62,6 +114,12 @@ private:
 	juce::Label  gammaOmegaLabel;
 	std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> gammaOmegaAttachment;
 
+	// --- Abilitazione degli stadi (bypass a costo zero) ---
+	juce::ToggleButton distortionEnabledButton{ "DISTORTION" };
+	juce::ToggleButton bandPassEnabledButton{ "BAND-PASS" };
+	std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> distortionEnabledAttachment;
+	std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> bandPassEnabledAttachment;
+
 	// --- Oscillatori ---
 	juce::Slider oscFreq1Slider;
 	juce::Slider oscFreq2Slider;
@@ -69,15 +127,47 @@ private:
 	juce::Label  osc2Label;
 	juce::TextButton oscFreq1Minus{ "-" }, oscFreq1Plus{ "+" };
 	juce::TextButton oscFreq2Minus{ "-" }, oscFreq2Plus{ "+" };
+	std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> oscFreq1Attachment;
+	std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> oscFreq2Attachment;
+
+	// --- Voci dell'oscillatore (numero di voci e timbro della voce selezionata) ---
+	juce::Label    numVoicesLabel, voiceLabel;
+	juce::ComboBox numVoicesSelector; // NUM_OSC_VOICES
+	juce::ComboBox voiceSelector;     // voce mostrata dagli slider, solo nell'editor
+	std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> numVoicesAttachment;
+
+	juce::Slider voiceFreqSlider, voiceGainSlider, voicePartialsSlider, voiceRolloffSlider;
+	juce::Label  voiceFreqLabel, voiceGainLabel, voicePartialsLabel, voiceRolloffLabel;
+	std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> voiceFreqAttachment;
+	std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> voiceGainAttachment;
+	std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> voicePartialsAttachment;
+	std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> voiceRolloffAttachment;
+
+	// --- Analisi (motore, canali, stimatore, modello, raggruppamento, frame, timbro MIDI, ordine degli stadi) ---
+	struct ChoiceControl
+	{
+		juce::Label label;
+		juce::ComboBox box;
+		std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> attachment;
+	};
+	static constexpr int numAnalysisChoices = 8;
+	std::array<ChoiceControl, numAnalysisChoices> analysisChoices;
+	juce::ToggleButton lowLatencyButton{ "LOW LATENCY" };
+	juce::ToggleButton stationarityGateButton{ "STATIONARITY GATE" };
+	std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> lowLatencyAttachment;
+	std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> stationarityGateAttachment;
 
 	// --- Selezione modalità e gain ---
 	juce::ComboBox modeSelector;
 	juce::Slider   masterGainSlider;
 	juce::Label    masterGainLabel;
+	std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> modeAttachment;
+	std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>   masterGainAttachment;
 
 	// --- Meter smoothing (EMA alpha shared by dissonance, OUT and POST CHAIN meters) ---
 	juce::Slider meterSmoothingSlider; // METER_SMOOTHING (alpha)
 	juce::Label  meterSmoothingLabel;
+	std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> meterSmoothingAttachment;
 
 	// --- Meter banda (BandPass intensity) ---
 	// Il meter principale (output RMS) è disegnato in paint()
@@ -89,6 +179,7 @@ private:
 	juce::Rectangle<int> sectionOsc;
 	juce::Rectangle<int> sectionMaster;
 	juce::Rectangle<int> sectionViz;
+	juce::Rectangle<int> sectionAnalysis;
 	juce::Rectangle<int> dissBarBounds;
 
 	static constexpr float meterMinDb = -60.0f;
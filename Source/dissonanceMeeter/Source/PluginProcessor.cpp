@@ -9,6 +9,15 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+#if JucePlugin_Enable_ARA
+  #include "PluginARAPlaybackRenderer.h"
+#endif
+
+// Unica unita' di traduzione che definisce gli hook di RealtimeSafety
+// (operator new/delete, pthread_mutex_lock); attivi solo in Debug
+#define REALTIME_SAFETY_IMPLEMENT_HOOKS 1
+#include "RealtimeSafety.h"
+
 #if defined(JUCE_DEBUG) || defined(DEBUG)
   #include "PluginTests.cpp"
 #endif
@@ -19,39 +28,312 @@ DissonanceMeeterAudioProcessor::DissonanceMeeterAudioProcessor()
 #if ! JucePlugin_IsMidiEffect
 #if ! JucePlugin_IsSynth
 		.withInput("Input", juce::AudioChannelSet::stereo(), true)
+		.withInput("Sidechain", juce::AudioChannelSet::stereo(), false)
 #endif
 		.withOutput("Output", juce::AudioChannelSet::stereo(), true)
 #endif
-	)
+	),
+	parameters(*this, nullptr, "PARAMETERS", createParameterLayout()),
+	processingChain(parameters)
 {
-	mainProcessor = std::make_unique<juce::AudioProcessorGraph>();
+	inputModeParameter      = parameters.getParameter(INPUT_MODE_ID);
+	osc1FreqParameter       = parameters.getParameter(OSC1_FREQ_ID);
+	osc2FreqParameter       = parameters.getParameter(OSC2_FREQ_ID);
+	outputGainParameter     = parameters.getParameter(OUTPUT_GAIN_ID);
+	meterSmoothingParameter = parameters.getParameter(METER_SMOOTHING_ID);
+	numOscVoicesParameter   = parameters.getParameter(NUM_OSC_VOICES_ID);
+	stageOrderParameter     = parameters.getParameter(STAGE_ORDER_ID);
+	channelAnalysisParameter    = parameters.getParameter(CHANNEL_ANALYSIS_ID);
+	analysisFrameParameter      = parameters.getParameter(ANALYSIS_FRAME_ID);
+	frequencyEstimatorParameter = parameters.getParameter(FREQUENCY_ESTIMATOR_ID);
+	dissonanceModelParameter    = parameters.getParameter(DISSONANCE_MODEL_ID);
+	partialGroupingParameter    = parameters.getParameter(PARTIAL_GROUPING_ID);
+	lowLatencyParameter         = parameters.getParameter(LOW_LATENCY_ID);
+	stationarityGateParameter   = parameters.getParameter(STATIONARITY_GATE_ID);
+	midiTimbreParameter         = parameters.getParameter(MIDI_TIMBRE_ID);
+	dissonanceEngineParameter   = parameters.getParameter(DISSONANCE_ENGINE_ID);
+
+	for (int v = 0; v < OscillatorBank::MAX_VOICES; ++v)
+	{
+		auto& voice = voiceParameters[(size_t)v];
+		voice.frequency   = parameters.getParameter(getVoiceParameterID(v, VoiceParameter::Frequency));
+		voice.gain        = parameters.getParameter(getVoiceParameterID(v, VoiceParameter::Gain));
+		voice.numPartials = parameters.getParameter(getVoiceParameterID(v, VoiceParameter::Partials));
+		voice.rolloff     = parameters.getParameter(getVoiceParameterID(v, VoiceParameter::Rolloff));
+	}
+
+	for (int t = 0; t < MidiDissonanceEstimator::NUM_TIMBRES; ++t)
+	{
+		timbreTablesJobs[(size_t)t].estimator = &midiEstimator;
+		timbreTablesJobs[(size_t)t].timbre = (MidiDissonanceEstimator::Timbre)t;
+	}
+
 	waveForm.setRepaintRate(30);
 	waveForm.setBufferSize(256);
 	waveForm.setSamplesPerBlock(512);
 	waveForm.setColours(juce::Colours::black, juce::Colours::lime);
-	initialiseGraph();
+
+	sessionSlot = sessionRegistry->claimSlot();
 
 #if defined(JUCE_DEBUG) || defined(DEBUG)
-	juce::UnitTestRunner runner;
-	runner.setAssertOnFailure(false);
-	runner.runAllTests();
-
-	for (int i = 0; i < runner.getNumResults(); ++i)
-	{
-		auto* result = runner.getResult(i);
-		juce::String msg = "[TEST] " + result->unitTestName
-			+ " | " + result->subcategoryName
-			+ " | Failures: " + juce::String(result->failures);
-		juce::Logger::writeToLog(msg);
-		DBG(msg);
+	// Alcuni test istanziano il processor: non rilanciarli in modo ricorsivo
+	static bool runningTests = false;
+	if (! runningTests)
+	{
+		const juce::ScopedValueSetter<bool> testsGuard(runningTests, true);
+
+		juce::UnitTestRunner runner;
+		runner.setAssertOnFailure(false);
+		runner.runTestsInCategory("DissonanceMeeter");
+
+		// Benchmark (categoria "Benchmark"): lenti, solo su richiesta
+		if (juce::SystemStats::getEnvironmentVariable("DISSONANCE_METER_BENCHMARKS", {}).isNotEmpty())
+			runner.runTestsInCategory("Benchmark");
+
+		for (int i = 0; i < runner.getNumResults(); ++i)
+		{
+			auto* result = runner.getResult(i);
+			juce::String msg = "[TEST] " + result->unitTestName
+				+ " | " + result->subcategoryName
+				+ " | Failures: " + juce::String(result->failures);
+			juce::Logger::writeToLog(msg);
+			DBG(msg);
+		}
 	}
 #endif
 }
 
 DissonanceMeeterAudioProcessor::~DissonanceMeeterAudioProcessor()
 {
-	if (mainProcessor != nullptr)
-		mainProcessor->releaseResources();
+	cancelPendingUpdate();
+	sessionRegistry->releaseSlot(sessionSlot);
+	processingChain.releaseResources();
+}
+
+void DissonanceMeeterAudioProcessor::updateTrackProperties(const TrackProperties& properties)
+{
+	if (properties.name.has_value() && properties.name->isNotEmpty())
+		sessionRegistry->setTrackName(sessionSlot, *properties.name);
+}
+
+juce::AudioProcessorValueTreeState::ParameterLayout DissonanceMeeterAudioProcessor::createParameterLayout()
+{
+	juce::AudioProcessorValueTreeState::ParameterLayout layout;
+
+	Distortion::addParameters(layout);
+	BandPassFilter::addParameters(layout);
+
+	layout.add(std::make_unique<juce::AudioParameterChoice>(
+		INPUT_MODE_ID, "Input Mode", juce::StringArray{ "External Input", "Internal Oscillator" }, 0));
+
+	// Oscillator frequencies: 20..20000 Hz, centred on 440 Hz so sweeps over
+	// the audible range automate evenly
+	juce::NormalisableRange<float> oscRange(20.0f, 20000.0f, 0.01f);
+	oscRange.setSkewForCentre(440.0f);
+	layout.add(std::make_unique<juce::AudioParameterFloat>(OSC1_FREQ_ID, "Osc 1 Freq", oscRange, 150.0f));
+	layout.add(std::make_unique<juce::AudioParameterFloat>(OSC2_FREQ_ID, "Osc 2 Freq", oscRange, 220.0f));
+
+	layout.add(std::make_unique<juce::AudioParameterFloat>(
+		OUTPUT_GAIN_ID, "Output Gain", juce::NormalisableRange<float>(0.0f, 20.0f, 0.01f), 1.0f));
+
+	// EMA alpha of the dissonance, OUT, POST CHAIN and PRE DIST meters
+	layout.add(std::make_unique<juce::AudioParameterFloat>(
+		METER_SMOOTHING_ID, "Meter Smoothing", juce::NormalisableRange<float>(0.01f, 1.0f, 0.001f), 0.05f));
+
+	// Oscillator voices: by default the two sines at OSC1/OSC2; the others
+	// start at A4 until they are enabled
+	layout.add(std::make_unique<juce::AudioParameterInt>(
+		NUM_OSC_VOICES_ID, "Osc Voices", 1, OscillatorBank::MAX_VOICES, 2));
+	for (int v = 0; v < OscillatorBank::MAX_VOICES; ++v)
+	{
+		const auto name = "Osc " + juce::String(v + 1);
+		if (v >= 2)
+			layout.add(std::make_unique<juce::AudioParameterFloat>(
+				getVoiceParameterID(v, VoiceParameter::Frequency), name + " Freq", oscRange, 440.0f));
+		layout.add(std::make_unique<juce::AudioParameterFloat>(
+			getVoiceParameterID(v, VoiceParameter::Gain), name + " Gain", juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f), 1.0f));
+		layout.add(std::make_unique<juce::AudioParameterInt>(
+			getVoiceParameterID(v, VoiceParameter::Partials), name + " Partials", 1, OscillatorBank::MAX_PARTIALS, 1));
+		layout.add(std::make_unique<juce::AudioParameterFloat>(
+			getVoiceParameterID(v, VoiceParameter::Rolloff), name + " Rolloff", juce::NormalisableRange<float>(0.0f, 4.0f, 0.01f), 1.0f));
+	}
+
+	juce::StringArray stageOrders;
+	for (const auto& order : getStageOrders())
+	{
+		juce::StringArray names;
+		for (auto stage : order)
+			names.add(stage == DISTORTION_STAGE ? "Distortion" : "Band-Pass");
+		stageOrders.add(names.joinIntoString(" > "));
+	}
+	layout.add(std::make_unique<juce::AudioParameterChoice>(STAGE_ORDER_ID, "Stage Order", stageOrders, 0));
+
+	// Analysis options; the choice indices are the enums' values
+	layout.add(std::make_unique<juce::AudioParameterChoice>(
+		CHANNEL_ANALYSIS_ID, "Channel Analysis", juce::StringArray{ "Downmix", "Per Channel" }, 0));
+
+	juce::StringArray frameSizes;
+	for (int order = DissonanceAnalyser::MIN_FFT_ORDER; order <= DissonanceAnalyser::FFT_ORDER; ++order)
+		frameSizes.add(juce::String(1 << order));
+	layout.add(std::make_unique<juce::AudioParameterChoice>(
+		ANALYSIS_FRAME_ID, "Analysis Frame", frameSizes, frameSizes.size() - 1));
+
+	layout.add(std::make_unique<juce::AudioParameterChoice>(
+		FREQUENCY_ESTIMATOR_ID, "Frequency Estimator", juce::StringArray{ "Parabolic", "Reassignment" }, 0));
+	layout.add(std::make_unique<juce::AudioParameterChoice>(
+		DISSONANCE_MODEL_ID, "Dissonance Model", juce::StringArray{ "Sethares", "Vassilakis", "Hutchinson-Knopoff" }, 0));
+	layout.add(std::make_unique<juce::AudioParameterChoice>(
+		PARTIAL_GROUPING_ID, "Partial Grouping", juce::StringArray{ "None", "Harmonic", "Inter-Note Only" }, 0));
+	layout.add(std::make_unique<juce::AudioParameterBool>(LOW_LATENCY_ID, "Low Latency", false));
+	layout.add(std::make_unique<juce::AudioParameterBool>(STATIONARITY_GATE_ID, "Stationarity Gate", false));
+	layout.add(std::make_unique<juce::AudioParameterChoice>(
+		MIDI_TIMBRE_ID, "MIDI Timbre", juce::StringArray{ "Sine", "Sawtooth", "Square", "Triangle" },
+		(int)MidiDissonanceEstimator::Timbre::Sawtooth));
+	layout.add(std::make_unique<juce::AudioParameterChoice>(
+		DISSONANCE_ENGINE_ID, "Dissonance Engine", juce::StringArray{ "Spectral", "Time Domain", "Cross (Sidechain)", "MIDI" }, 0));
+
+	return layout;
+}
+
+juce::String DissonanceMeeterAudioProcessor::getVoiceParameterID(int voiceIndex, VoiceParameter parameter)
+{
+	const auto prefix = "OSC" + juce::String(voiceIndex + 1);
+	switch (parameter)
+	{
+		case VoiceParameter::Frequency: return prefix + "_FREQ";
+		case VoiceParameter::Gain:      return prefix + "_GAIN";
+		case VoiceParameter::Partials:  return prefix + "_PARTIALS";
+		case VoiceParameter::Rolloff:   return prefix + "_ROLLOFF";
+	}
+	return {};
+}
+
+void DissonanceMeeterAudioProcessor::setParameter(const char* parameterID, float value)
+{
+	if (auto* parameter = parameters.getParameter(parameterID))
+		setParameter(*parameter, value);
+}
+
+void DissonanceMeeterAudioProcessor::setParameter(juce::RangedAudioParameter& parameter, float value)
+{
+	parameter.setValueNotifyingHost(parameter.convertTo0to1(value));
+}
+
+//==============================================================================
+bool DissonanceMeeterAudioProcessor::scheduleParameterChange(const juce::String& parameterID, float value, juce::int64 timelineSample)
+{
+	auto* parameter = parameters.getParameter(parameterID);
+	if (parameter == nullptr)
+		return false;
+
+	// The stages' own parameters and the stage order go to the chain
+	auto target = AutomationTarget::Chain;
+	if (parameterID == INPUT_MODE_ID || parameterID == NUM_OSC_VOICES_ID || parameterID.startsWith("OSC"))
+		target = AutomationTarget::Oscillator;
+	else if (parameterID == OUTPUT_GAIN_ID)
+		target = AutomationTarget::Output;
+	else if (parameterID == METER_SMOOTHING_ID)
+		target = AutomationTarget::Meters;
+	else if (parameterID == CHANNEL_ANALYSIS_ID || parameterID == ANALYSIS_FRAME_ID || parameterID == FREQUENCY_ESTIMATOR_ID
+		|| parameterID == DISSONANCE_MODEL_ID || parameterID == PARTIAL_GROUPING_ID || parameterID == LOW_LATENCY_ID
+		|| parameterID == STATIONARITY_GATE_ID || parameterID == MIDI_TIMBRE_ID || parameterID == DISSONANCE_ENGINE_ID)
+		target = AutomationTarget::Analysis;
+
+	const auto scope = automationFifo.write(1);
+	if (scope.blockSize1 == 0)
+		return false;
+
+	automationQueue[(size_t)scope.startIndex1] = { timelineSample, 0, parameter, target, parameter->convertTo0to1(value) };
+	return true;
+}
+
+// Moves the events falling inside this block from the queue to blockEvents,
+// as sample offsets. Late events land on the first sample; past
+// MAX_EVENTS_PER_BLOCK the rest wait for the next block.
+void DissonanceMeeterAudioProcessor::collectAutomationEvents(int numSamples) noexcept
+{
+	juce::int64 blockStart = samplesProcessed;
+	if (auto* hostPlayHead = getPlayHead())
+		if (const auto position = hostPlayHead->getPosition())
+			if (const auto time = position->getTimeInSamples())
+				blockStart = *time;
+
+	samplesProcessed += numSamples;
+	numBlockEvents = 0;
+
+	while (numBlockEvents < MAX_EVENTS_PER_BLOCK)
+	{
+		int start1, size1, start2, size2;
+		automationFifo.prepareToRead(1, start1, size1, start2, size2);
+		if (size1 == 0)
+			break;
+
+		auto event = automationQueue[(size_t)start1];
+		if (event.time >= blockStart + numSamples)
+			break;
+
+		event.offset = (int)juce::jlimit((juce::int64)0, (juce::int64)numSamples - 1, event.time - blockStart);
+		blockEvents[(size_t)numBlockEvents++] = event;
+		automationFifo.finishedRead(1);
+	}
+}
+
+// Calls processSegment(start, length) over the block, split at the events
+// for 'target'; each event is applied just before the segment it starts.
+// setValue() alone runs no listener callbacks (no locks, no allocations);
+// the stages and getters read the value back through getValue(), and the
+// host hears of it from handleAsyncUpdate().
+template <typename ProcessSegment>
+void DissonanceMeeterAudioProcessor::processSegments(AutomationTarget target, int numSamples, ProcessSegment&& processSegment)
+{
+	int start = 0;
+	bool applied = false;
+	for (int e = 0; e < numBlockEvents; ++e)
+	{
+		const auto& event = blockEvents[(size_t)e];
+		if (event.target != target)
+			continue;
+
+		if (event.offset > start)
+		{
+			processSegment(start, event.offset - start);
+			start = event.offset;
+		}
+		event.parameter->setValue(event.value);
+
+		// Full (message thread stalled): the host misses this step only
+		const auto scope = appliedFifo.write(1);
+		if (scope.blockSize1 > 0)
+			appliedChanges[(size_t)scope.startIndex1] = { event.parameter, event.value };
+		applied = true;
+	}
+
+	if (start < numSamples)
+		processSegment(start, numSamples - start);
+
+	if (applied)
+	{
+		// Posts one message until it is delivered: a short lock in the
+		// message queue, no wait on the message thread
+		RealtimeSafety::ScopedToleratedLocks toleratedLocks;
+		triggerAsyncUpdate();
+	}
+}
+
+void DissonanceMeeterAudioProcessor::handleAsyncUpdate()
+{
+	// Also posted by the audio thread when the Midi engine lacks its tables
+	requestMidiTables();
+
+	const auto scope = appliedFifo.read(appliedFifo.getNumReady());
+	scope.forEach([this](int index)
+	{
+		// A step already superseded by a later event is skipped: setting it
+		// again would undo the newer value until the next block
+		const auto& change = appliedChanges[(size_t)index];
+		if (change.parameter->getValue() == change.value)
+			change.parameter->setValueNotifyingHost(change.value);
+	});
 }
 
 //==============================================================================
@@ -60,6 +342,9 @@ const juce::String DissonanceMeeterAudioProcessor::getName() const
 	return JucePlugin_Name;
 }
 
+// MIDI in feeds the Midi engine. The AU build keeps its 'aufx' effect type so
+// existing sessions still find it; AU hosts route no MIDI to effects, so the
+// Midi engine is not available there (VST3 and standalone only).
 bool DissonanceMeeterAudioProcessor::acceptsMidi() const
 {
 #if JucePlugin_WantsMidiInput
@@ -119,68 +404,302 @@ void DissonanceMeeterAudioProcessor::changeProgramName(int, const juce::String&)
 //==============================================================================
 void DissonanceMeeterAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-	lastSampleRate = sampleRate;
-	numInputChannels = getMainBusNumInputChannels();
-	numOutputChannels = getMainBusNumOutputChannels();
+	const int newInputChannels = getMainBusNumInputChannels();
+	const int newOutputChannels = getMainBusNumOutputChannels();
+	const int frameOrder = getAnalysisFrameOrder();
 
-	// Rimuove solo le connessioni e le ricrea con il layout canali corretto,
-	// senza distruggere i nodi (l'editor potrebbe tenere riferimenti ai processor)
-	for (auto& c : mainProcessor->getConnections())
-		mainProcessor->removeConnection(c);
+	// Molti host richiamano prepareToPlay a ogni avvio del transport o cambio
+	// di buffer size. Se frequenza, layout e frame di analisi non cambiano
+	// basta azzerare lo stato: nessun ricalcolo di coefficienti, finestre o
+	// piani FFT. La dimensione del blocco non conta: nessuno stadio ne dipende
+	// e lo stato e' preallocato per ProcessorBase::MAX_CHANNELS.
+	const bool unchanged = preparedFrameOrder == frameOrder
+		&& sampleRate == lastSampleRate
+		&& newInputChannels == numInputChannels
+		&& newOutputChannels == numOutputChannels;
 
-	connectAudioNodes();
+	if (unchanged)
+	{
+		processingChain.reset();
+		dissonanceAnalyser.reset();
+		roughnessAnalyser.reset();
+		crossAnalyser.reset();
+		multichannelAnalyser.reset();
+		inputActivity.reset();
+	}
+	else
+	{
+		lastSampleRate = sampleRate;
+		numInputChannels = newInputChannels;
+		numOutputChannels = newOutputChannels;
+		preparedFrameOrder = frameOrder;
 
-	mainProcessor->setPlayConfigDetails(numInputChannels, numOutputChannels, sampleRate, samplesPerBlock);
-	mainProcessor->prepareToPlay(sampleRate, samplesPerBlock);
+		// Gli stadi sono membri della catena: nessun nodo o connessione da
+		// ricreare, l'editor continua a puntare agli stessi processor
+		processingChain.prepareToPlay(sampleRate, samplesPerBlock, numOutputChannels);
 
-	dissonanceAnalyser.prepare(sampleRate);
+		dissonanceAnalyser.prepare(sampleRate, frameOrder);
+		roughnessAnalyser.prepare(sampleRate);
+		crossAnalyser.prepare(sampleRate, frameOrder);
+		multichannelAnalyser.prepare(sampleRate, frameOrder, numOutputChannels);
+
+		// The analysers sleep after a full FFT frame of silence (or a few
+		// roughness averaging times, whichever is longer)
+		const double frameSeconds = dissonanceAnalyser.getFrameSize() / (double)dissonanceAnalyser.getAnalysisSampleRate();
+		inputActivity.prepare(sampleRate, juce::jmax(frameSeconds, 5.0 * RoughnessAnalyser::AVERAGING_TIME_S) + 0.05);
+	}
+	analysisAsleep.store(false);
+	midiEstimator.reset();
+
+	// Pending events are dropped by consuming them as the audio thread would:
+	// reset() would race with a scheduleParameterChange() writing meanwhile
+	automationFifo.finishedRead(automationFifo.getNumReady());
+	numBlockEvents = 0;
+	samplesProcessed = 0;
+
+	profiler.prepare(sampleRate);
+	applyAnalysisParameters();
+	requestMidiTables();
+	activeEngine = (int)getDissonanceEngine();
+	activeChannelAnalysis = (int)getChannelAnalysis();
 	initialiseOscillator();
+
+#if JucePlugin_Enable_ARA
+	prepareToPlayForARA(sampleRate, samplesPerBlock, getMainBusNumOutputChannels(), getProcessingPrecision());
+#endif
 }
 
 void DissonanceMeeterAudioProcessor::releaseResources()
 {
-	oscPhase1 = 0.0;
-	oscPhase2 = 0.0;
-	if (mainProcessor != nullptr)
-		mainProcessor->releaseResources();
+	oscillatorBank.reset();
+	processingChain.releaseResources();
+
+#if JucePlugin_Enable_ARA
+	releaseResourcesForARA();
+#endif
 }
 
-void DissonanceMeeterAudioProcessor::initialiseOscillator() noexcept
+void DissonanceMeeterAudioProcessor::setDissonanceEngine(DissonanceEngine e)
+{
+	setParameter(*dissonanceEngineParameter, (float)e);
+	requestMidiTables();
+}
+
+void DissonanceMeeterAudioProcessor::setMidiTimbre(MidiDissonanceEstimator::Timbre t)
 {
-	oscPhase1 = 0.0;
-	oscPhase2 = 0.0;
+	setParameter(*midiTimbreParameter, (float)t);
+	requestMidiTables();
 }
 
-void DissonanceMeeterAudioProcessor::initialiseGraph()
+// The tables take tens of milliseconds for the richer timbres: built on a
+// pool thread so neither the audio thread nor the UI waits, and only for a
+// timbre actually used by the Midi engine
+void DissonanceMeeterAudioProcessor::requestMidiTables()
 {
-	if (mainProcessor == nullptr)
-		mainProcessor = std::make_unique<juce::AudioProcessorGraph>();
+	if (getDissonanceEngine() != DissonanceEngine::Midi)
+		return;
+
+	const auto timbre = getMidiTimbre();
+	auto& job = timbreTablesJobs[(size_t)timbre];
+	if (job.submitted || midiEstimator.hasTables(timbre))
+		return;
+
+	job.submitted = true;
+	analysisPool.addJob(job);
+}
+
+void DissonanceMeeterAudioProcessor::setOscillatorVoice(int index, const OscillatorBank::Voice& voice)
+{
+	if (! juce::isPositiveAndBelow(index, OscillatorBank::MAX_VOICES))
+		return;
 
-	if (audioInputNode == nullptr)
-		audioInputNode = mainProcessor->addNode(std::make_unique<AudioGraphIOProcessor>(AudioGraphIOProcessor::audioInputNode));
-	if (distortionNode == nullptr)
-		distortionNode = mainProcessor->addNode(std::make_unique<Distortion>());
-	if (bandPassNode == nullptr)
-		bandPassNode = mainProcessor->addNode(std::make_unique<BandPassFilter>());
-	if (audioOutputNode == nullptr)
-		audioOutputNode = mainProcessor->addNode(std::make_unique<AudioGraphIOProcessor>(AudioGraphIOProcessor::audioOutputNode));
+	const auto& voiceParameter = voiceParameters[(size_t)index];
+	setParameter(*voiceParameter.frequency, voice.frequency);
+	setParameter(*voiceParameter.gain, voice.gain);
+	setParameter(*voiceParameter.numPartials, (float)voice.numPartials);
+	setParameter(*voiceParameter.rolloff, voice.rolloff);
 }
 
-void DissonanceMeeterAudioProcessor::connectAudioNodes()
+OscillatorBank::Voice DissonanceMeeterAudioProcessor::getOscillatorVoice(int index) const noexcept
 {
-	for (auto* node : mainProcessor->getNodes())
-		node->getProcessor()->enableAllBuses();
+	if (! juce::isPositiveAndBelow(index, OscillatorBank::MAX_VOICES))
+		return {};
 
-	// Stereo: Input -> Distortion -> BandPass -> Output
-	for (int ch = 0; ch < juce::jmin(2, numOutputChannels); ++ch)
+	const auto& voiceParameter = voiceParameters[(size_t)index];
+	OscillatorBank::Voice voice;
+	voice.frequency   = ProcessorBase::getParameterValue(*voiceParameter.frequency);
+	voice.gain        = ProcessorBase::getParameterValue(*voiceParameter.gain);
+	voice.numPartials = getChoice(*voiceParameter.numPartials);
+	voice.rolloff     = ProcessorBase::getParameterValue(*voiceParameter.rolloff);
+	return voice;
+}
+
+void DissonanceMeeterAudioProcessor::setNumOscillatorVoices(int numVoices)
+{
+	setParameter(*numOscVoicesParameter, (float)juce::jlimit(1, OscillatorBank::MAX_VOICES, numVoices));
+}
+
+bool DissonanceMeeterAudioProcessor::setStageOrder(const ProcessingChain::StageOrder& order)
+{
+	const auto orders = getStageOrders();
+	for (size_t i = 0; i < orders.size(); ++i)
+	{
+		if (orders[i] == order)
+		{
+			setParameter(*stageOrderParameter, (float)i);
+			return true;
+		}
+	}
+	return false;
+}
+
+void DissonanceMeeterAudioProcessor::applyAnalysisParameters() noexcept
+{
+	const bool lowLatency = getLowLatencyMode();
+	dissonanceAnalyser.setLowLatencyRefinement(lowLatency);
+	multichannelAnalyser.setLowLatencyRefinement(lowLatency);
+
+	const auto estimator = getFrequencyEstimator();
+	dissonanceAnalyser.setFrequencyEstimator(estimator);
+	multichannelAnalyser.setFrequencyEstimator(estimator);
+	crossAnalyser.setFrequencyEstimator(estimator);
+
+	const auto model = getDissonanceModel();
+	dissonanceAnalyser.setDissonanceModel(model);
+	multichannelAnalyser.setDissonanceModel(model);
+	crossAnalyser.setDissonanceModel(model);
+	midiEstimator.setDissonanceModel(model);
+
+	const bool gate = getStationarityGate();
+	dissonanceAnalyser.setStationarityGate(gate);
+	multichannelAnalyser.setStationarityGate(gate);
+
+	const auto grouping = getPartialGrouping();
+	dissonanceAnalyser.setPartialGrouping(grouping);
+	multichannelAnalyser.setPartialGrouping(grouping);
+
+	// A timbre picked by the host: its tables are requested from the message thread
+	const auto timbre = getMidiTimbre();
+	midiEstimator.setTimbre(timbre);
+	if (getDissonanceEngine() == DissonanceEngine::Midi && ! midiEstimator.hasTables(timbre))
+	{
+		RealtimeSafety::ScopedToleratedLocks toleratedLocks;
+		triggerAsyncUpdate();
+	}
+}
+
+// Hands this track's latest partials to the session registry (lock-free,
+// see SessionDissonanceRegistry.h): the spectral engine's frame partials, or
+// the main input's in cross mode. The time-domain engine has no partials, so
+// the track drops out of the matrix once its last set goes stale.
+void DissonanceMeeterAudioProcessor::publishSessionPartials(bool silent) noexcept
+{
+	std::array<SessionDissonanceRegistry::Partial, DissonanceAnalyser::MAX_PARTIALS> partials{};
+	int numPartials = 0;
+
+	if (! silent && activeEngine == (int)DissonanceEngine::Spectral
+		&& activeChannelAnalysis == (int)ChannelAnalysis::PerChannel)
+	{
+		numPartials = multichannelAnalyser.getNumFramePartials();
+		for (int i = 0; i < numPartials; ++i)
+			partials[(size_t)i] = { multichannelAnalyser.getFramePartialFrequency(i), multichannelAnalyser.getFramePartialAmplitude(i) };
+	}
+	else if (! silent && activeEngine == (int)DissonanceEngine::Spectral)
 	{
-		mainProcessor->addConnection({ { audioInputNode->nodeID,  ch }, { distortionNode->nodeID, ch } });
-		mainProcessor->addConnection({ { distortionNode->nodeID,  ch }, { bandPassNode->nodeID,   ch } });
-		mainProcessor->addConnection({ { bandPassNode->nodeID,    ch }, { audioOutputNode->nodeID,ch } });
+		numPartials = dissonanceAnalyser.getNumFramePartials();
+		for (int i = 0; i < numPartials; ++i)
+			partials[(size_t)i] = { dissonanceAnalyser.getFramePartialFrequency(i), dissonanceAnalyser.getFramePartialAmplitude(i) };
+	}
+	else if (! silent && activeEngine == (int)DissonanceEngine::Cross)
+	{
+		numPartials = crossAnalyser.getNumMainPartials();
+		for (int i = 0; i < numPartials; ++i)
+			partials[(size_t)i] = { crossAnalyser.getMainPartialFrequency(i), crossAnalyser.getMainPartialAmplitude(i) };
+	}
+	else if (activeEngine == (int)DissonanceEngine::Midi)
+	{
+		// The notes' harmonics, lowest harmonic number first across all notes
+		const int numNotes = midiEstimator.getNumSoundingNotes();
+		for (int k = 0; k < MidiDissonanceEstimator::NUM_HARMONICS; ++k)
+		{
+			for (int i = 0; i < numNotes && numPartials < (int)partials.size(); ++i)
+			{
+				const int note = midiEstimator.getSoundingNote(i);
+				const auto& spectrum = midiEstimator.getSpectrum(note);
+				if (k < spectrum.numHarmonics)
+					partials[(size_t)numPartials++] = { spectrum.freq[(size_t)k], spectrum.amp[(size_t)k] * midiEstimator.getNoteGain(note) };
+			}
+		}
 	}
 
+	sessionRegistry->publish(sessionSlot, partials.data(), numPartials, dissonanceAnalyser.getDissonanceModel());
 }
 
+// One meter EMA step per block for the Midi engine, split at the block's
+// note changes: each segment takes the step of its share of the block, so a
+// chord struck late in the block moves the meter less than one struck at its
+// start, and a block without changes is exactly the usual block step.
+float DissonanceMeeterAudioProcessor::smoothMidiDissonance(float smoothed, float alpha, int numSamples) const noexcept
+{
+	if (numSamples <= 0)
+		return smoothed;
+
+	const float retainPerBlock = 1.0f - alpha;
+	float value = midiEstimator.getBlockStartDissonance();
+	int start = 0;
+
+	for (int i = 0; i <= midiEstimator.getNumChanges(); ++i)
+	{
+		const bool last = i == midiEstimator.getNumChanges();
+		const int end = last ? numSamples : midiEstimator.getChange(i).sample;
+
+		if (end > start)
+		{
+			const float retain = std::pow(retainPerBlock, (float)(end - start) / (float)numSamples);
+			smoothed = value + retain * (smoothed - value);
+			start = end;
+		}
+
+		if (! last)
+			value = midiEstimator.getChange(i).dissonance;
+	}
+
+	return smoothed;
+}
+
+// Audio thread (or prepareToPlay): rebuilds the bank when the number of
+// voices or a voice's timbre changed, otherwise glides to the frequencies
+void DissonanceMeeterAudioProcessor::updateOscillatorVoices() noexcept
+{
+	std::array<OscillatorBank::Voice, OscillatorBank::MAX_VOICES> voices;
+	const int numVoices = getNumOscillatorVoices();
+	bool rebuild = numVoices != numBankVoices;
+	for (int v = 0; v < numVoices; ++v)
+	{
+		voices[(size_t)v] = getOscillatorVoice(v);
+		const auto& current = bankVoices[(size_t)v];
+		rebuild = rebuild || voices[(size_t)v].gain != current.gain || voices[(size_t)v].numPartials != current.numPartials
+			|| voices[(size_t)v].rolloff != current.rolloff;
+	}
+
+	if (rebuild)
+	{
+		oscillatorBank.setVoices(voices.data(), numVoices);
+		bankVoices = voices;
+		numBankVoices = numVoices;
+		return;
+	}
+
+	for (int v = 0; v < numVoices; ++v)
+		oscillatorBank.setFrequency(v, voices[(size_t)v].frequency);
+}
+
+void DissonanceMeeterAudioProcessor::initialiseOscillator() noexcept
+{
+	numBankVoices = 0;
+	updateOscillatorVoices();
+	oscillatorBank.prepare(lastSampleRate, 0.02);
+}
 
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool DissonanceMeeterAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
@@ -189,18 +708,27 @@ bool DissonanceMeeterAudioProcessor::isBusesLayoutSupported(const BusesLayout& l
 	juce::ignoreUnused(layouts);
 	return true;
 #else
-	// This is the place where you check if the layout is supported.
-	// In this template code we only support mono or stereo.
-	// Some plugin hosts, such as certain GarageBand versions, will only
-	// load plugins that support stereo bus layouts.
-	if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-		&& layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+	// Any main layout up to ProcessorBase::MAX_CHANNELS: mono, stereo,
+	// surround up to 7.1.4, ambisonics up to third order. The stages hold
+	// their state for that many channels.
+	const auto mainOutput = layouts.getMainOutputChannelSet();
+	if (mainOutput.isDisabled() || mainOutput.size() > ProcessorBase::MAX_CHANNELS)
 		return false;
 
 	// This checks if the input layout matches the output layout
 #if ! JucePlugin_IsSynth
 	if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
 		return false;
+
+	// The sidechain only feeds the cross-dissonance engine: off, mono or stereo
+	if (layouts.inputBuses.size() > 1)
+	{
+		const auto sidechain = layouts.getChannelSet(true, 1);
+		if (! sidechain.isDisabled()
+			&& sidechain != juce::AudioChannelSet::mono()
+			&& sidechain != juce::AudioChannelSet::stereo())
+			return false;
+	}
 #endif
 
 	return true;
@@ -209,131 +737,385 @@ bool DissonanceMeeterAudioProcessor::isBusesLayoutSupported(const BusesLayout& l
 #endif
 
 void DissonanceMeeterAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+	processSamples(buffer, midiMessages);
+}
+
+void DissonanceMeeterAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+	processSamples(buffer, midiMessages);
+}
+
+// One implementation for both precisions: the oscillator, the chain, gain,
+// clip and output meter run in the host's sample type; the analysers and
+// the waveform display are fed float samples.
+template <typename SampleType>
+void DissonanceMeeterAudioProcessor::processSamples(juce::AudioBuffer<SampleType>& hostBuffer, juce::MidiBuffer& midiMessages)
 {
 	juce::ScopedNoDenormals noDenormals;
 
+	// Debug: any allocation or lock below is counted per stage and asserted
+	// when the block ends (see RealtimeSafety.h). No-op in Release.
+	RealtimeSafety::ScopedAudioThreadGuard realtimeGuard(RealtimeSafety::Mode::Assert);
+
+	// Per-stage CPU load as a fraction of the block deadline (see StageProfiler.h);
+	// no timer reads while profiling is disabled.
+	const int numBlockSamples = hostBuffer.getNumSamples();
+	StageProfiler::ScopedTimer totalTimer(profiler, StageProfiler::Total, numBlockSamples);
+
+	// Opt-in Chrome trace timeline (see TraceRecorder.h); one flag check when off.
+	TraceRecorder::ScopedEvent blockEvent(tracer, "processBlock");
+
 	for (int ch = getTotalNumInputChannels(); ch < getTotalNumOutputChannels(); ++ch)
-		buffer.clear(ch, 0, buffer.getNumSamples());
+		hostBuffer.clear(ch, 0, hostBuffer.getNumSamples());
+
+	// Everything below runs on the main bus; the sidechain channels that
+	// follow it in the host buffer are only read by the cross engine. Both
+	// refer to the host's channel data (no allocation up to 32 channels).
+	auto buffer = getBusBuffer(hostBuffer, false, 0);
+	const auto sidechain = getBusCount(true) > 1 ? getBusBuffer(hostBuffer, true, 1)
+	                                             : juce::AudioBuffer<SampleType>();
 
-	if (getInputMode() != InputMode::ExternalInput)
+	// Automation events due in this block; each part below applies its own
+	// at their exact sample (see processSegments()).
+	collectAutomationEvents(numBlockSamples);
+	processSegments(AutomationTarget::Meters, numBlockSamples, [](int, int) {});
+	processSegments(AutomationTarget::Analysis, numBlockSamples, [](int, int) {});
+	applyAnalysisParameters();
+
+#if JucePlugin_Enable_ARA
+	// ARA: the playback regions under the play head replace the host input;
+	// from here on they go through the oscillator switch, the analysers and
+	// the chain like any other input
+	if (auto* renderer = getPlaybackRenderer<DissonanceMeeterPlaybackRenderer>())
 	{
-		// Modalità oscillatore: genera due sinusoidi miscelate
-		const int    numSamples = buffer.getNumSamples();
-		const int    numCh = buffer.getNumChannels();
-		const double sr = lastSampleRate > 0.0 ? lastSampleRate : 44100.0;
-		const float  f1 = oscFreq1.load();
-		const float  f2 = oscFreq2.load();
+		RealtimeSafety::ScopedStage stage("ara");
+		TraceRecorder::ScopedEvent event(tracer, "ara");
 
-		// Genera i campioni sul canale 0 avanzando la fase una sola volta per campione
+		auto* hostPlayHead = getPlayHead();
+		const auto position = hostPlayHead != nullptr ? hostPlayHead->getPosition().orFallback(juce::AudioPlayHead::PositionInfo{})
+		                                              : juce::AudioPlayHead::PositionInfo{};
+		renderer->processBlock(buffer, isNonRealtime() ? juce::AudioProcessor::Realtime::no : juce::AudioProcessor::Realtime::yes,
+		                       position);
+		araPlayheadSeconds.store(position.getTimeInSeconds().orFallback(0.0));
+	}
+#endif
+
+	processSegments(AutomationTarget::Oscillator, numBlockSamples, [&](int start, int numSamples)
+	{
+		updateOscillatorVoices();
+
+		if (getInputMode() == InputMode::ExternalInput)
 		{
-			float* data = buffer.getWritePointer(0);
-			for (int i = 0; i < numSamples; ++i)
-			{
-				data[i] = 0.5f * (float)std::sin(oscPhase1)
-					+ 0.5f * (float)std::sin(oscPhase2);
-				oscPhase1 += juce::MathConstants<double>::twoPi * (f1 / sr);
-				oscPhase2 += juce::MathConstants<double>::twoPi * (f2 / sr);
-				if (oscPhase1 > juce::MathConstants<double>::twoPi) oscPhase1 -= juce::MathConstants<double>::twoPi;
-				if (oscPhase2 > juce::MathConstants<double>::twoPi) oscPhase2 -= juce::MathConstants<double>::twoPi;
-			}
+			oscillatorBank.skip(numSamples);
+			return;
 		}
-		// Copia il segnale generato sugli altri canali
-		for (int ch = 1; ch < numCh; ++ch)
-			buffer.copyFrom(ch, 0, buffer, 0, 0, numSamples);
 
-		// Normalizzazione peak (identica all'input esterno)
-		float peak = 0.0f;
-		for (int ch = 0; ch < numCh; ++ch)
-			peak = juce::jmax(peak, buffer.getMagnitude(ch, 0, numSamples));
-		if (peak > 1e-6f)
-			buffer.applyGain(1.0f / peak);
-	}
+		RealtimeSafety::ScopedStage stage("oscillator");
+		TraceRecorder::ScopedEvent event(tracer, "oscillator");
+
+		// Modalità oscillatore: il banco genera le voci sul canale 0, gia'
+		// normalizzate (picco <= 1), poi il segnale va sugli altri canali
+		oscillatorBank.render(buffer.getWritePointer(0, start), numSamples);
+		for (int ch = 1; ch < buffer.getNumChannels(); ++ch)
+			buffer.copyFrom(ch, start, buffer, 0, start, numSamples);
+	});
 
 	// DissonanceAnalyser receives the clean input signal (pre-distortion,
 	// pre-bandpass) — raw external input, or the generated/normalised
 	// oscillator signal — not anything that has passed through Distortion or
 	// BandPass. The same clean signal also feeds the PRE DIST level meter.
+	// Only the selected engine is fed; on a switch the newly active one is
+	// reset so it doesn't start from stale state.
+	const int engine = (int)getDissonanceEngine();
+	const int channels = (int)getChannelAnalysis();
+	if (engine != activeEngine || channels != activeChannelAnalysis)
 	{
+		if (engine == (int)DissonanceEngine::TimeDomain)
+			roughnessAnalyser.reset();
+		else if (engine == (int)DissonanceEngine::Cross)
+			crossAnalyser.reset();
+		else if (engine == (int)DissonanceEngine::Spectral && channels == (int)ChannelAnalysis::PerChannel)
+			multichannelAnalyser.reset();
+		else if (engine == (int)DissonanceEngine::Spectral)
+			dissonanceAnalyser.reset();
+		// The MIDI notes are never reset here: they are still held
+		activeEngine = engine;
+		activeChannelAnalysis = channels;
+	}
+	const bool timeDomain = activeEngine == (int)DissonanceEngine::TimeDomain;
+	const bool cross = activeEngine == (int)DissonanceEngine::Cross;
+	const bool midi = activeEngine == (int)DissonanceEngine::Midi;
+	const bool perChannel = ! timeDomain && ! cross && ! midi && activeChannelAnalysis == (int)ChannelAnalysis::PerChannel;
+
+	{
+		RealtimeSafety::ScopedStage stage("analyser");
+		TraceRecorder::ScopedEvent event(tracer, "analyser");
+		const bool profiling = profiler.isEnabled();
+		const auto feedStart = profiling ? juce::Time::getHighResolutionTicks() : 0;
+
+		// The analysers only read the timer around their frames while someone
+		// looks at the timings
+		const bool timeFrames = profiling || tracer.isRecording();
+		dissonanceAnalyser.setFrameTimingEnabled(timeFrames);
+		crossAnalyser.setFrameTimingEnabled(timeFrames);
+		multichannelAnalyser.setFrameTimingEnabled(timeFrames);
+
 		const int numSamples = buffer.getNumSamples();
 		const int numCh = buffer.getNumChannels();
-		double sumSq = 0.0;
-		for (int i = 0; i < numSamples; ++i)
+
+		// Note on/off at their exact sample; no FFT involved
+		midiEstimator.process(midiMessages, numSamples);
+
+		auto cleanInput = [&buffer, numCh](int i)
 		{
-			float monoSum = 0.0f;
+			SampleType monoSum = 0;
 			for (int ch = 0; ch < numCh; ++ch)
 				monoSum += buffer.getSample(ch, i);
-			const float cleanInputSample = numCh > 0 ? monoSum / (float)numCh : 0.0f;
+			return numCh > 0 ? (float)(monoSum / (SampleType)numCh) : 0.0f;
+		};
+		const int numSidechainCh = sidechain.getNumChannels();
+		auto sidechainInput = [&sidechain, numSidechainCh](int i)
+		{
+			SampleType monoSum = 0;
+			for (int ch = 0; ch < numSidechainCh; ++ch)
+				monoSum += sidechain.getSample(ch, i);
+			return numSidechainCh > 0 ? (float)(monoSum / (SampleType)numSidechainCh) : 0.0f;
+		};
+		// Per-channel analysis takes one frame across the main bus channels
+		const int numAnalysedCh = juce::jmin(numCh, multichannelAnalyser.getNumChannels());
+		std::array<float, DissonanceAnalyser::MAX_CHANNELS> channelFrame{};
+		auto feed = [&](int i, float cleanInputSample)
+		{
+			if (midi)
+				return;
+			if (timeDomain)
+				roughnessAnalyser.pushSample(cleanInputSample);
+			else if (cross)
+				crossAnalyser.pushSample(cleanInputSample, sidechainInput(i));
+			else if (perChannel)
+			{
+				for (int ch = 0; ch < numAnalysedCh; ++ch)
+					channelFrame[(size_t)ch] = (float)buffer.getSample(ch, i);
+				multichannelAnalyser.pushFrame(channelFrame.data());
+			}
+			else
+				dissonanceAnalyser.pushSample(cleanInputSample);
+		};
 
-			dissonanceAnalyser.pushSample(cleanInputSample);
+		// While asleep the analysers aren't fed; the level and peak are still
+		// measured so the PRE DIST meter keeps moving and activity is detected.
+		const bool wasAsleep = analysisAsleep.load();
+		double sumSq = 0.0;
+		float  peak = 0.0f;
+		for (int i = 0; i < numSamples; ++i)
+		{
+			const float cleanInputSample = cleanInput(i);
+			if (! wasAsleep)
+				feed(i, cleanInputSample);
 			sumSq += (double)cleanInputSample * (double)cleanInputSample;
+			peak = juce::jmax(peak, std::abs(cleanInputSample));
 		}
 
+		// Per channel, content that cancels in the downmix still counts as activity
+		if (perChannel)
+			peak = juce::jmax(peak, (float)buffer.getMagnitude(0, numSamples));
+
+		// Sleep once the input has been silent for a whole analysis window,
+		// i.e. once the analysers have already decayed to their silent result:
+		// resetting them then only zeroes state that silence would have zeroed.
+		// The block that wakes them up is fed in full, so no onset is lost.
+		// A silent main input has no cross pairs, so the sidechain alone
+		// doesn't keep the cross engine awake.
+		const bool silent = inputActivity.update(peak, numSamples);
+		if (silent && ! wasAsleep)
+		{
+			dissonanceAnalyser.reset();
+			roughnessAnalyser.reset();
+			crossAnalyser.reset();
+			multichannelAnalyser.reset();
+		}
+		else if (wasAsleep && ! silent)
+		{
+			for (int i = 0; i < numSamples; ++i)
+				feed(i, cleanInput(i));
+		}
+		analysisAsleep.store(silent);
+
+		// Low-latency mode: refresh the dissonance between FFT frames from the
+		// resonator bank tracking the last frame's partials (no-op otherwise).
+		// The roughness engine publishes its running value once per block.
+		if (! silent)
+		{
+			if (timeDomain)
+				roughnessAnalyser.updateBetweenFrames();
+			else if (perChannel)
+				multichannelAnalyser.updateBetweenFrames();
+			else if (! midi)
+				dissonanceAnalyser.updateBetweenFrames();
+		}
+
+		// analyseFrame() is reported on its own, so the feed stage excludes it;
+		// each frame shows up in the trace nested inside "analyser".
+		const auto& frames = cross      ? crossAnalyser.getFrameTimings()
+		                   : perChannel ? multichannelAnalyser.getFrameTimings()
+		                                : dissonanceAnalyser.getFrameTimings();
+		// The MIDI engine has no frames and doesn't depend on the audio: its
+		// notes are published every block
+		const auto frameCount = cross      ? crossAnalyser.getFrameCount()
+		                      : perChannel ? multichannelAnalyser.getFrameCount()
+		                                   : dissonanceAnalyser.getFrameCount();
+		if (midi || frameCount != lastPublishedFrame || (silent && ! wasAsleep))
+			publishSessionPartials(silent && ! midi);
+		lastPublishedFrame = frameCount;
+
+		if (profiling)
+		{
+			const auto elapsed = juce::Time::getHighResolutionTicks() - feedStart;
+			profiler.record(StageProfiler::AnalyserFeed, elapsed - frames.totalTicks, numSamples);
+			profiler.record(StageProfiler::AnalyseFrame, frames.totalTicks, numSamples);
+		}
+		if (tracer.isRecording())
+		{
+			for (int f = 0; f < frames.numFrames; ++f)
+			{
+				tracer.begin("analyseFrame", frames.start[(size_t)f]);
+				tracer.end("analyseFrame", frames.end[(size_t)f]);
+			}
+		}
+		dissonanceAnalyser.clearFrameTimings();
+		crossAnalyser.clearFrameTimings();
+		multichannelAnalyser.clearFrameTimings();
+
+		skippedAnalysisFrames.store(dissonanceAnalyser.getNumSkippedFrames() + crossAnalyser.getNumSkippedFrames()
+			+ multichannelAnalyser.getNumSkippedFrames(), std::memory_order_relaxed);
+
 		const float rms  = numSamples > 0 ? (float)std::sqrt(sumSq / numSamples) : 0.0f;
 		const float dbfs = rms > 1e-9f ? 20.0f * std::log10(rms) : -100.0f;
-		const float alpha = meterSmoothingAlpha.load();
+		const float alpha = getMeterSmoothing();
 		const float prev   = preDistIntensityDb.load();
 		preDistIntensityDb.store(alpha * dbfs + (1.0f - alpha) * prev);
 	}
 
-	if (mainProcessor != nullptr)
-		mainProcessor->processBlock(buffer, midiMessages);
-
-	// Smooth the post-chain (Distortion -> BandPass) level with the same
-	// METER_SMOOTHING alpha as the dissonance/OUT meters, so the POST CHAIN
-	// meter doesn't flicker rapidly on beating/close frequencies.
-	if (bandPassNode != nullptr)
 	{
-		const float rawBandDb = static_cast<BandPassFilter*>(bandPassNode->getProcessor())->getBandIntensityDb();
-		const float alpha     = meterSmoothingAlpha.load();
-		const float prev      = smoothedBandLevelDb.load();
-		smoothedBandLevelDb.store(alpha * rawBandDb + (1.0f - alpha) * prev);
-	}
+		RealtimeSafety::ScopedStage stage("chain");
+		TraceRecorder::ScopedEvent event(tracer, "chain");
+		StageProfiler::ScopedTimer timer(profiler, StageProfiler::Chain, numBlockSamples);
 
-	// Guadagno master
-	const float gain = juce::jlimit(0.0f, 20.0f, getOutputGain());
-	if (gain != 1.0f)
-		for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-			buffer.applyGain(ch, 0, buffer.getNumSamples(), gain);
+		// The stages read their parameters once per call, so each segment
+		// starts their smoothers on the automation event's sample
+		processSegments(AutomationTarget::Chain, numBlockSamples, [&](int start, int numSamples)
+		{
+			processingChain.setStageOrder(getStageOrder());
+
+			if (start == 0 && numSamples == numBlockSamples)
+			{
+				processingChain.process(buffer, midiMessages);
+				return;
+			}
+
+			// Refers to the block's own channel data (no allocation up to 32 channels)
+			juce::AudioBuffer<SampleType> segment(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, numSamples);
+			processingChain.process(segment, midiMessages);
+		});
+	}
 
-	// Soft clip (tanh): keeps the chain from hard-clipping when the master gain
-	// (up to 20x) pushes the signal past 0 dBFS, without cancelling out the
-	// gain the way a peak-renormalisation step would (that previously made the
-	// master gain knob appear to do nothing above unity).
 	{
+		RealtimeSafety::ScopedStage stage("gain/clip");
+		TraceRecorder::ScopedEvent event(tracer, "gain/clip");
+		StageProfiler::ScopedTimer timer(profiler, StageProfiler::GainClip, numBlockSamples);
+
+		// Guadagno master
+		processSegments(AutomationTarget::Output, numBlockSamples, [&](int start, int numSamples)
+		{
+			const float gain = juce::jlimit(0.0f, 20.0f, getOutputGain());
+			if (gain != 1.0f)
+				buffer.applyGain(start, numSamples, (SampleType)gain);
+		});
+
+		// Soft clip (tanh): keeps the chain from hard-clipping when the master gain
+		// (up to 20x) pushes the signal past 0 dBFS, without cancelling out the
+		// gain the way a peak-renormalisation step would (that previously made the
+		// master gain knob appear to do nothing above unity).
 		const int numCh = buffer.getNumChannels();
 		const int numS  = buffer.getNumSamples();
 		for (int ch = 0; ch < numCh; ++ch)
 		{
-			float* d = buffer.getWritePointer(ch);
+			SampleType* d = buffer.getWritePointer(ch);
 			for (int i = 0; i < numS; ++i)
 				d[i] = std::tanh(d[i]);
 		}
 	}
 
-	// Calcolo RMS → dBFS per il meter principale
-	double sumSq = 0.0;
-	const int totalSamples = buffer.getNumSamples() * buffer.getNumChannels();
-	for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
 	{
-		const float* d = buffer.getReadPointer(ch);
-		for (int i = 0; i < buffer.getNumSamples(); ++i)
-			sumSq += (double)d[i] * (double)d[i];
-	}
-	float rms = totalSamples > 0 ? (float)std::sqrt(sumSq / totalSamples) : 0.0f;
-	float dbfs = rms > 1e-9f ? 20.0f * std::log10(rms) : -100.0f;
-	updateOutputLevelRms(dbfs);
-
-	// Exponential moving average smoothing of the dissonance value, so the UI
-	// meter doesn't oscillate erratically on closely-spaced frequencies.
-	// smoothedDissonance is read by the UI timer callback (see getDissonance()).
-	{
-		const float alpha = meterSmoothingAlpha.load();
-		const float raw   = dissonanceAnalyser.getDissonance();
-		const float prev  = smoothedDissonance.load();
-		smoothedDissonance.store(alpha * raw + (1.0f - alpha) * prev);
+		RealtimeSafety::ScopedStage stage("meters");
+		TraceRecorder::ScopedEvent event(tracer, "meters");
+		StageProfiler::ScopedTimer timer(profiler, StageProfiler::Meters, numBlockSamples);
+
+		// Smooth the post-chain (Distortion -> BandPass) level with the same
+		// METER_SMOOTHING alpha as the dissonance/OUT meters, so the POST CHAIN
+		// meter doesn't flicker rapidly on beating/close frequencies.
+		{
+			const float rawBandDb = getBandPass().getBandIntensityDb();
+			const float alpha     = getMeterSmoothing();
+			const float prev      = smoothedBandLevelDb.load();
+			smoothedBandLevelDb.store(alpha * rawBandDb + (1.0f - alpha) * prev);
+		}
+
+		// Calcolo RMS → dBFS per il meter principale
+		double sumSq = 0.0;
+		const int totalSamples = buffer.getNumSamples() * buffer.getNumChannels();
+		for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+		{
+			const SampleType* d = buffer.getReadPointer(ch);
+			for (int i = 0; i < buffer.getNumSamples(); ++i)
+				sumSq += (double)d[i] * (double)d[i];
+		}
+		float rms = totalSamples > 0 ? (float)std::sqrt(sumSq / totalSamples) : 0.0f;
+		float dbfs = rms > 1e-9f ? 20.0f * std::log10(rms) : -100.0f;
+		updateOutputLevelRms(dbfs);
+
+		// Exponential moving average smoothing of the dissonance value, so the UI
+		// meter doesn't oscillate erratically on closely-spaced frequencies.
+		// smoothedDissonance is read by the UI timer callback (see getDissonance()).
+		{
+			const float alpha = getMeterSmoothing();
+			const float prev  = smoothedDissonance.load();
+
+			if (midi)
+			{
+				smoothedDissonance.store(smoothMidiDissonance(prev, alpha, numBlockSamples));
+			}
+			else
+			{
+				const float raw = timeDomain ? roughnessAnalyser.getDissonance()
+				                : cross      ? crossAnalyser.getDissonance()
+				                : perChannel ? multichannelAnalyser.getDissonance()
+				                             : dissonanceAnalyser.getDissonance();
+				smoothedDissonance.store(alpha * raw + (1.0f - alpha) * prev);
+			}
+		}
 	}
 
-	waveForm.pushBuffer(buffer);
+	RealtimeSafety::ScopedStage waveformStage("waveform");
+	StageProfiler::ScopedTimer waveformTimer(profiler, StageProfiler::Waveform, numBlockSamples);
+	TraceRecorder::ScopedEvent waveformEvent(tracer, "waveform");
+	if constexpr (std::is_same_v<SampleType, float>)
+	{
+		waveForm.pushBuffer(buffer);
+	}
+	else
+	{
+		// The display only takes float: convert one frame at a time on the stack
+		const int numCh = juce::jmin(buffer.getNumChannels(), ProcessorBase::MAX_CHANNELS);
+		std::array<float, ProcessorBase::MAX_CHANNELS> frame{};
+		for (int i = 0; i < buffer.getNumSamples(); ++i)
+		{
+			for (int ch = 0; ch < numCh; ++ch)
+				frame[(size_t)ch] = (float)buffer.getSample(ch, i);
+			waveForm.pushSample(frame.data(), numCh);
+		}
+	}
 }
 
 //==============================================================================
@@ -344,63 +1126,61 @@ bool DissonanceMeeterAudioProcessor::hasEditor() const
 
 juce::AudioProcessorEditor* DissonanceMeeterAudioProcessor::createEditor()
 {
-	jassert(bandPassNode != nullptr && bandPassNode->getProcessor() != nullptr);
-	jassert(distortionNode != nullptr && distortionNode->getProcessor() != nullptr);
-	return new DissonanceMeeterAudioProcessorEditor(
-		*this,
-		static_cast<BandPassFilter&> (*bandPassNode->getProcessor()),
-		static_cast<Distortion&>     (*distortionNode->getProcessor()));
+	return new DissonanceMeeterAudioProcessorEditor(*this, getBandPass(), getDistortion());
 }
 
 //==============================================================================
 void DissonanceMeeterAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-	// Recupera i processor dai nodi
-	auto* bp = dynamic_cast<BandPassFilter*>(bandPassNode->getProcessor());
-	auto* dist = dynamic_cast<Distortion*>(distortionNode->getProcessor());
-
-	if (bp == nullptr || dist == nullptr)
-		return;
-
-	// Crea un XML radice che contiene lo stato di entrambi
-	juce::XmlElement root("DissonanceMeeterState");
-
-	// Salva BandPassFilter
-	if (auto xmlBP = bp->treeState.copyState().createXml())
-	{
-		xmlBP->setTagName("BandPass");
-		root.addChildElement(xmlBP.release());
-	}
-
-	// Salva Distortion
-	if (auto xmlDist = dist->treeState.copyState().createXml())
-	{
-		xmlDist->setTagName("Distortion");
-		root.addChildElement(xmlDist.release());
-	}
+	// Tutti i parametri (stadi compresi) stanno nell'unico albero del processor.
+	// I cambi programmati arrivano ai parametri con setValue(), senza passare
+	// dall'albero: i valori si rileggono dai parametri stessi.
+	auto state = parameters.copyState();
+	for (auto* parameter : getParameters())
+		if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+		{
+			auto child = state.getChildWithProperty("id", ranged->paramID);
+			if (child.isValid())
+				child.setProperty("value", ProcessorBase::getParameterValue(*ranged), nullptr);
+		}
 
-	copyXmlToBinary(root, destData);
+	if (auto xml = state.createXml())
+		copyXmlToBinary(*xml, destData);
 }
 
 void DissonanceMeeterAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
-	auto* bp = dynamic_cast<BandPassFilter*>(bandPassNode->getProcessor());
-	auto* dist = dynamic_cast<Distortion*>(distortionNode->getProcessor());
+	// Legge l'XML salvato
+	auto xmlState = getXmlFromBinary(data, sizeInBytes);
+	if (xmlState == nullptr)
+		return;
+
+	if (xmlState->hasTagName(parameters.state.getType()))
+	{
+		parameters.replaceState(juce::ValueTree::fromXml(*xmlState));
+		return;
+	}
 
-	if (bp == nullptr || dist == nullptr)
+	// Formato precedente: un albero per stadio ("BandPass", "Distortion")
+	// dentro "DissonanceMeeterState", con l'abilitazione salvata come "ENABLED"
+	if (! xmlState->hasTagName("DissonanceMeeterState"))
 		return;
 
-	// Legge l'XML salvato
-	if (auto xmlState = getXmlFromBinary(data, sizeInBytes))
+	auto restoreStage = [this, &xmlState](const char* tagName, const char* enabledID)
 	{
-		// Ripristina BandPassFilter
-		if (auto* xmlBP = xmlState->getChildByName("BandPass"))
-			bp->treeState.replaceState(juce::ValueTree::fromXml(*xmlBP));
+		if (auto* xmlStage = xmlState->getChildByName(tagName))
+		{
+			for (auto* param : xmlStage->getChildWithTagNameIterator("PARAM"))
+			{
+				const auto id = param->getStringAttribute("id");
+				if (auto* parameter = parameters.getParameter(id == "ENABLED" ? juce::String(enabledID) : id))
+					parameter->setValueNotifyingHost(parameter->convertTo0to1((float)param->getDoubleAttribute("value")));
+			}
+		}
+	};
 
-		// Ripristina Distortion
-		if (auto* xmlDist = xmlState->getChildByName("Distortion"))
-			dist->treeState.replaceState(juce::ValueTree::fromXml(*xmlDist));
-	}
+	restoreStage("BandPass", BandPassFilter::ENABLED_ID);
+	restoreStage("Distortion", Distortion::ENABLED_ID);
 }
 
 //==============================================================================
@@ -10,86 +10,230 @@
 
 #include <JuceHeader.h>
 #include <vector>
+#include <array>
+#include <memory>
 #include "ProcessorBase.h"
+#include "ActivityDetector.h"
+#include "OscillatorBank.h"
+#include "StaticProcessorChain.h"
+#include "StageProfiler.h"
+#include "TraceRecorder.h"
+#include "SessionDissonanceRegistry.h"
+#include "SharedAnalysisPool.h"
 #include <atomic>
 #include <cmath>
 #include "../../DissonanceAnalyser.h"
+#include "../../RoughnessAnalyser.h"
+#include "../../CrossDissonanceAnalyser.h"
+#include "../../MidiDissonanceEstimator.h"
 
 
-class BandPassFilter : public ProcessorBase
+class BandPassFilter final : public ProcessorBase
 {
+	// Solo per lo stadio usato da solo (test): altrimenti i parametri vivono
+	// nel layout unico del DissonanceMeeterAudioProcessor
+	std::unique_ptr<juce::AudioProcessorValueTreeState> ownState;
+
 public:
-	BandPassFilter() : treeState(*this, nullptr, "BP_PARAMS", createLayout()) {}
+	static constexpr const char* CENTER_FREQ_ID = "CENTER_FREQ";
+	static constexpr const char* Q_FACTOR_ID = "Q_FACTOR";
+	static constexpr const char* ENABLED_ID = "BANDPASS_ENABLED";
+
+	// Stadio autonomo, con un albero di parametri proprio
+	BandPassFilter()
+		: ownState(std::make_unique<juce::AudioProcessorValueTreeState>(*this, nullptr, "BP_PARAMS", createLayout())),
+		  treeState(*ownState)
+	{
+		bindParameters();
+	}
+
+	// Stadio del plugin: i parametri sono quelli aggiunti da addParameters()
+	// al layout del processor
+	explicit BandPassFilter(juce::AudioProcessorValueTreeState& sharedState) : treeState(sharedState)
+	{
+		bindParameters();
+	}
+
+	static void addParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout)
+	{
+		// Abilitazione dello stadio (false = bypass con dissolvenza)
+		layout.add(std::make_unique<juce::AudioParameterBool>(ENABLED_ID, "Band-Pass On", true));
+
+		// Frequenza centrale del filtro band-pass: 10..20000 Hz, default 30 Hz
+		layout.add(std::make_unique<juce::AudioParameterFloat>(
+			CENTER_FREQ_ID, "Center Freq",
+			juce::NormalisableRange<float>(10.0f, 20000.0f, 0.01f, 0.25f), 30.0f));
+
+		// Fattore di qualità del filtro: 0.1..30, default 1.0
+		layout.add(std::make_unique<juce::AudioParameterFloat>(
+			Q_FACTOR_ID, "Q Factor",
+			juce::NormalisableRange<float>(0.1f, 30.0f, 0.01f, 0.5f), 1.0f));
+	}
 
 	void prepareToPlay(double sampleRate, int samplesPerBlock) override
 	{
-		currentSampleRate = static_cast<float> (sampleRate);
-		const int numChannels = juce::jmax(1, getTotalNumOutputChannels());
+		currentSampleRate = sampleRate;
 
 		juce::dsp::ProcessSpec spec{ sampleRate,
 																	static_cast<juce::uint32> (samplesPerBlock),
 																	1 };
 
-		filters.clear();
-		filters.resize(numChannels);
-		for (auto& f : filters)
-		{
-			f.prepare(spec);  // ← prepara ogni filtro
-			f.reset();
-		}
-
 		centerFreqSmooth.reset(sampleRate, 0.02);
 		qFactorSmooth.reset(sampleRate, 0.02);
+		activity.prepare(sampleRate, SLEEP_HOLD_SECONDS);
+		lastOutputPeak = 0.0f;
+		sleeping = false;
+		enabledMix.reset(sampleRate, 0.02);
+		enabledMix.setCurrentAndTargetValue(isEnabledParameterOn() ? 1.0f : 0.0f);
 		// Imposta i target dagli attuali valori dei parametri prima di calcolare i coefficienti
-		centerFreqSmooth.setTargetValue(*treeState.getRawParameterValue("CENTER_FREQ"));
-		qFactorSmooth.setTargetValue(*treeState.getRawParameterValue("Q_FACTOR"));
-		updateCoefficients();
+		centerFreqSmooth.setTargetValue(getParameterValue(*centerFreqParameter));
+		qFactorSmooth.setTargetValue(getParameterValue(*qFactorParameter));
+		updateCoefficients<float>();
+		setCoefficients<double>(centerFreqSmooth.getCurrentValue(), qFactorSmooth.getCurrentValue());
+
+		// Dopo i coefficienti del 2o ordine: reset() alloca lo stato del filtro
+		// qui, non al primo processSample() sul thread audio
+		for (auto& f : floatFilters)
+			f.prepare(spec);  // ← prepara ogni filtro
+		for (auto& f : doubleFilters)
+			f.prepare(spec);
 	}
 
-	void processBlock(juce::AudioSampleBuffer& buffer, juce::MidiBuffer&) override
+	// Stesso percorso in singola e doppia precisione (vedi process())
+	void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) override  { process(buffer); }
+	void processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer&) override { process(buffer); }
+	bool supportsDoublePrecisionProcessing() const override { return true; }
+
+	void reset() override
 	{
-		const int numSamples = buffer.getNumSamples();
-		const int numChannels = buffer.getNumChannels();
+		resetFilters();
+		bandIntensityDb.store(-100.0f);
+		activity.reset();
+		lastOutputPeak = 0.0f;
+		sleeping = false;
+		enabledMix.setCurrentAndTargetValue(isEnabledParameterOn() ? 1.0f : 0.0f);
+	}
 
-		// Ridimensiona se necessario
-		if ((int)filters.size() < numChannels)
-		{
-			juce::dsp::ProcessSpec spec{ currentSampleRate,
-					static_cast<juce::uint32>(buffer.getNumSamples()),
-					1 };
+	// Vero mentre lo stadio e' a riposo per silenzio (solo thread audio)
+	bool isSleeping() const noexcept { return sleeping; }
+
+	// Vero a bypass concluso, quando i biquad non girano (solo thread audio)
+	bool isBypassed() const noexcept { return bypassed; }
 
-			const int oldSize = (int)filters.size(); // ← salva PRIMA del resize
-			filters.resize(numChannels);
+	const juce::String getName() const override { return "BandPass"; }
 
-			for (int ch = oldSize; ch < numChannels; ++ch) // ← itera solo sui nuovi
+	// Leggi l'intensità della banda dal processore / editor
+	float getBandIntensityDb() const noexcept { return bandIntensityDb.load(); }
+
+	juce::AudioProcessorValueTreeState& treeState;
+	juce::LinearSmoothedValue<float> centerFreqSmooth{ 30.0f };
+	juce::LinearSmoothedValue<float> qFactorSmooth{ 1.0f };
+
+private:
+	// Gli smoother dei parametri restano in float; biquad e campioni sono
+	// nel tipo del buffer
+	template <typename SampleType>
+	void process(juce::AudioBuffer<SampleType>& buffer)
+	{
+		const int numSamples = buffer.getNumSamples();
+		const int numChannels = juce::jmin(buffer.getNumChannels(), MAX_CHANNELS);
+		jassert(buffer.getNumChannels() <= MAX_CHANNELS);
+
+		// 1. Aggiorna coefficienti: il processor divide il blocco agli eventi di
+		// automazione, quindi le rampe partono dal campione dell'evento
+		centerFreqSmooth.setTargetValue(getParameterValue(*centerFreqParameter));
+		qFactorSmooth.setTargetValue(getParameterValue(*qFactorParameter));
+		enabledMix.setTargetValue(isEnabledParameterOn() ? 1.0f : 0.0f);
+
+		// Bypass a costo zero: a dissolvenza conclusa il segnale passa intatto
+		// e i biquad non girano. Lo stato si azzera all'ingresso nel bypass,
+		// cosi' alla riattivazione il filtro riparte da fermo mentre una
+		// dissolvenza di 20 ms passa dal segnale diretto a quello filtrato.
+		// Il livello della banda resta misurato.
+		if (! enabledMix.isSmoothing() && enabledMix.getTargetValue() == 0.0f)
+		{
+			if (! bypassed)
 			{
-				filters[ch].prepare(spec);
-				filters[ch].reset();
+				resetFilters();
+				activity.reset();
+				lastOutputPeak = 0.0f;
+				sleeping = false;
+				bypassed = true;
 			}
+
+			centerFreqSmooth.skip(numSamples);
+			qFactorSmooth.skip(numSamples);
+			measureBand(buffer, numChannels, numSamples);
+			return;
 		}
+		bypassed = false;
+
+		// 0. Riposo: ingresso e uscita (quindi lo stato dei biquad) sotto soglia
+		// da SLEEP_HOLD_SECONDS. Lo stato decaduto si azzera e il blocco esce
+		// muto; gli smoother avanzano comunque, cosi' al risveglio i
+		// coefficienti sono quelli correnti e il filtro riparte da zero.
+		const float inputPeak = ActivityDetector::getPeak(buffer, numChannels, numSamples);
+		if (activity.update(juce::jmax(inputPeak, lastOutputPeak), numSamples) && ! enabledMix.isSmoothing())
+		{
+			if (! sleeping)
+			{
+				resetFilters();
+				sleeping = true;
+			}
 
-		// 1. Aggiorna coefficienti
-		centerFreqSmooth.setTargetValue(*treeState.getRawParameterValue("CENTER_FREQ"));
-		qFactorSmooth.setTargetValue(*treeState.getRawParameterValue("Q_FACTOR"));
+			centerFreqSmooth.skip(numSamples);
+			qFactorSmooth.skip(numSamples);
+			buffer.clear();
+			bandIntensityDb.store(-100.0f);
+			return;
+		}
+		sleeping = false;
 
 		// Aggiorna coefficienti per ogni campione → smoothing reale a sample rate
-		for (int i = 0; i < numSamples; ++i)
+		auto& filters = getFilters<SampleType>();
+		if (! enabledMix.isSmoothing())
 		{
-			updateCoefficients(); // avanza smoother di 1 campione
-
-			for (int ch = 0; ch < numChannels; ++ch)
+			for (int i = 0; i < numSamples; ++i)
 			{
-				float* data = buffer.getWritePointer(ch);
-				// Processa un singolo campione per canale
-				data[i] = filters[ch].processSample(data[i]); // ← sample by sample
+				updateCoefficients<SampleType>(); // avanza smoother di 1 campione
+
+				for (int ch = 0; ch < numChannels; ++ch)
+				{
+					SampleType* data = buffer.getWritePointer(ch);
+					// Processa un singolo campione per canale
+					data[i] = filters[ch].processSample(data[i]); // ← sample by sample
+				}
 			}
 		}
+		else
+		{
+			// Dissolvenza abilitato/bypass: diretto + e * (filtrato - diretto)
+			for (int i = 0; i < numSamples; ++i)
+			{
+				updateCoefficients<SampleType>();
+				const auto e = (SampleType)enabledMix.getNextValue();
+
+				for (int ch = 0; ch < numChannels; ++ch)
+				{
+					SampleType* data = buffer.getWritePointer(ch);
+					const SampleType dry = data[i];
+					data[i] = dry + e * (filters[ch].processSample(dry) - dry);
+				}
+			}
+		}
+
+		measureBand(buffer, numChannels, numSamples);
+		lastOutputPeak = ActivityDetector::getPeak(buffer, numChannels, numSamples);
+	}
 
-		// 3. RMS sul mid channel per la misurazione
+	// 3. RMS sul mid channel per la misurazione
+	template <typename SampleType>
+	void measureBand(const juce::AudioBuffer<SampleType>& buffer, int numChannels, int numSamples) noexcept
+	{
 		double sumSq = 0.0;
 		for (int ch = 0; ch < numChannels; ++ch)
 		{
-			const float* data = buffer.getReadPointer(ch);
+			const SampleType* data = buffer.getReadPointer(ch);
 			for (int i = 0; i < numSamples; ++i)
 				sumSq += (double)data[i] * (double)data[i];
 		}
@@ -100,54 +244,79 @@ public:
 		bandIntensityDb.store(juce::jlimit(-100.0f, 0.0f, db));
 	}
 
-	void reset() override
+	bool isEnabledParameterOn() const noexcept { return getParameterValue(*enabledParameter) > 0.5f; }
+
+	static juce::AudioProcessorValueTreeState::ParameterLayout createLayout()
 	{
-		for (auto& f : filters)
-			f.reset();
-		bandIntensityDb.store(-100.0f);
+		juce::AudioProcessorValueTreeState::ParameterLayout layout;
+		addParameters(layout);
+		return layout;
 	}
 
-	const juce::String getName() const override { return "BandPass"; }
-
-	// Leggi l'intensità della banda dal processore / editor
-	float getBandIntensityDb() const noexcept { return bandIntensityDb.load(); }
-
-	juce::AudioProcessorValueTreeState treeState;
-	juce::LinearSmoothedValue<float> centerFreqSmooth{ 30.0f };
-	juce::LinearSmoothedValue<float> qFactorSmooth{ 1.0f };
-
-private:
-	juce::AudioProcessorValueTreeState::ParameterLayout createLayout()
+	// Parametri letti dal thread audio: nessuna ricerca per nome nel processBlock
+	void bindParameters()
 	{
-		std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
-
-		// Frequenza centrale del filtro band-pass: 10..20000 Hz, default 30 Hz
-		params.push_back(std::make_unique<juce::AudioParameterFloat>(
-			"CENTER_FREQ", "Center Freq",
-			juce::NormalisableRange<float>(10.0f, 20000.0f, 0.01f, 0.25f), 30.0f));
-
-		// Fattore di qualità del filtro: 0.1..30, default 1.0
-		params.push_back(std::make_unique<juce::AudioParameterFloat>(
-			"Q_FACTOR", "Q Factor",
-			juce::NormalisableRange<float>(0.1f, 30.0f, 0.01f, 0.5f), 1.0f));
-
-		return { params.begin(), params.end() };
+		centerFreqParameter = treeState.getParameter(CENTER_FREQ_ID);
+		qFactorParameter    = treeState.getParameter(Q_FACTOR_ID);
+		enabledParameter    = treeState.getParameter(ENABLED_ID);
+		jassert(centerFreqParameter != nullptr && qFactorParameter != nullptr && enabledParameter != nullptr);
 	}
 
+	juce::RangedAudioParameter* centerFreqParameter = nullptr;
+	juce::RangedAudioParameter* qFactorParameter = nullptr;
+	juce::RangedAudioParameter* enabledParameter = nullptr;
+
+	template <typename SampleType>
 	void updateCoefficients()
 	{
 		const float center = juce::jlimit(10.0f, 20000.0f, centerFreqSmooth.getNextValue());
 		const float q      = juce::jlimit(0.1f, 30.0f, qFactorSmooth.getNextValue());
+		setCoefficients<SampleType>(center, q);
+	}
 
-		for (auto& f : filters)
-			*f.coefficients = *juce::dsp::IIR::Coefficients<float>::makeBandPass(
-				currentSampleRate, center, q);
+	// ArrayCoefficients: niente oggetto Coefficients allocato per campione,
+	// i valori vengono copiati nello storage gia' esistente di ogni filtro
+	template <typename SampleType>
+	void setCoefficients(float center, float q)
+	{
+		const auto c = juce::dsp::IIR::ArrayCoefficients<SampleType>::makeBandPass(
+			(SampleType)currentSampleRate, (SampleType)center, (SampleType)q);
+		for (auto& f : getFilters<SampleType>())
+			*f.coefficients = c;
 	}
 
-	float currentSampleRate = 44100.0f;
+	// Un banco di biquad per precisione: l'host sceglie la precisione prima
+	// di prepareToPlay(), che li prepara entrambi
+	template <typename SampleType>
+	auto& getFilters() noexcept
+	{
+		if constexpr (std::is_same_v<SampleType, double>)
+			return doubleFilters;
+		else
+			return floatFilters;
+	}
+
+	void resetFilters() noexcept
+	{
+		for (auto& f : floatFilters)
+			f.reset();
+		for (auto& f : doubleFilters)
+			f.reset();
+	}
+
+	double currentSampleRate = 44100.0;
 	std::atomic<float> bandIntensityDb{ -100.0f };
 
-	std::vector<juce::dsp::IIR::Filter<float>> filters;
+	std::array<juce::dsp::IIR::Filter<float>, MAX_CHANNELS>  floatFilters;
+	std::array<juce::dsp::IIR::Filter<double>, MAX_CHANNELS> doubleFilters;
+
+	static constexpr double SLEEP_HOLD_SECONDS = 0.1;
+	ActivityDetector activity;
+	float lastOutputPeak = 0.0f;
+	bool  sleeping = false;
+
+	juce::LinearSmoothedValue<float> enabledMix{ 1.0f };   // 1 = filtrato, 0 = bypass
+	bool bypassed = false;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BandPassFilter)
 };
@@ -174,129 +343,266 @@ private:
 //   - A·x² term generates intermodulation products and beating
 //
 // Processing: Parallel mix of clean signal + ODE output
-//   - A=0 → bypass (100% clean signal, no ODE contribution)
+//   - A=0 → bypass (100% clean signal, ODE not integrated at all)
 //   - A>0 → blend clean + ODE nonlinear response (battimenti/intermodulation)
 //   - Output compensated (×stiffness) to match input level at low frequencies
 //==============================================================================
-class Distortion : public ProcessorBase
+class Distortion final : public ProcessorBase
 {
+	// Only for a stage used on its own (tests); otherwise the parameters live
+	// in the DissonanceMeeterAudioProcessor's single layout
+	std::unique_ptr<juce::AudioProcessorValueTreeState> ownState;
+
 public:
-	Distortion() : treeState(*this, nullptr, "DIST_PARAMS", createLayout()) {}
+	static constexpr const char* A_ID = "A";
+	static constexpr const char* GAMMA_OMEGA_ID = "GAMMA_OMEGA";
+	static constexpr const char* ENABLED_ID = "DISTORTION_ENABLED";
+
+	// Standalone stage, with its own parameter tree
+	Distortion()
+		: ownState(std::make_unique<juce::AudioProcessorValueTreeState>(*this, nullptr, "DIST_PARAMS", createLayout())),
+		  treeState(*ownState)
+	{
+		bindParameters();
+	}
+
+	// Plugin stage: binds to the parameters addParameters() put in the
+	// processor's layout
+	explicit Distortion(juce::AudioProcessorValueTreeState& sharedState) : treeState(sharedState)
+	{
+		bindParameters();
+	}
+
+	static void addParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout)
+	{
+		// Stage enable (false = bypass, with a 20 ms crossfade)
+		layout.add(std::make_unique<juce::AudioParameterBool>(ENABLED_ID, "Distortion On", true));
+		layout.add(std::make_unique<juce::AudioParameterFloat>(
+			A_ID, "A (Non-linearity)",
+			juce::NormalisableRange<float>(0.0f, 5000.0f, 0.1f, 0.5f), 0.0f));
+		// γ = ω expressed directly in rad/s; default 188.4 rad/s = 2π·30 Hz
+		layout.add(std::make_unique<juce::AudioParameterFloat>(
+			GAMMA_OMEGA_ID, "Gamma/Omega",
+			juce::NormalisableRange<float>(6.28f, 1256.6f, 0.1f, 0.5f), 188.4f));
+	}
 
 	void prepareToPlay(double sampleRate, int samplesPerBlock) override
 	{
 		currentSampleRate = static_cast<float>(sampleRate);
-		dt = 1.0f / static_cast<float>(sampleRate); // time step for Euler integration
+		dt = 1.0 / sampleRate; // time step for Euler integration
 		drive.reset(sampleRate, 0.02);
 		gammaOmega.reset(sampleRate, 0.02);
-		gammaOmega.setTargetValue(*treeState.getRawParameterValue("GAMMA_OMEGA"));
+		gammaOmega.setTargetValue(getParameterValue(*gammaOmegaParameter));
 		(void)samplesPerBlock;
 
-		const int channels = juce::jmax(1, getTotalNumOutputChannels());
-		x.assign(channels, 0.0f);      // oscillator position per channel
-		xDot.assign(channels, 0.0f);   // oscillator velocity per channel
+		x.fill(0.0);      // oscillator position per channel
+		xDot.fill(0.0);   // oscillator velocity per channel
+		activity.prepare(sampleRate, SLEEP_HOLD_SECONDS);
+		sleeping = false;
+		enabledMix.reset(sampleRate, 0.02);
+		enabledMix.setCurrentAndTargetValue(isEnabledParameterOn() ? 1.0f : 0.0f);
+		bypassed = false;
 	}
 
-	void processBlock(juce::AudioSampleBuffer& buffer, juce::MidiBuffer&) override
+	// Both precisions share one implementation, see process()
+	void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) override  { process(buffer); }
+	void processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer&) override { process(buffer); }
+	bool supportsDoublePrecisionProcessing() const override { return true; }
+
+	void reset() override
+	{
+		x.fill(0.0);
+		xDot.fill(0.0);
+		drive.reset(currentSampleRate > 0.0f ? currentSampleRate : 44100.0, 0.02);
+		gammaOmega.reset(currentSampleRate > 0.0f ? currentSampleRate : 44100.0, 0.02);
+		activity.reset();
+		sleeping = false;
+		enabledMix.setCurrentAndTargetValue(isEnabledParameterOn() ? 1.0f : 0.0f);
+	}
+
+	// True while the stage is asleep on silence (audio thread only)
+	bool isSleeping() const noexcept { return sleeping; }
+
+	// True once bypassed (disabled, or A = 0) and the ODE is skipped (audio thread only)
+	bool isBypassed() const noexcept { return bypassed; }
+
+	const juce::String getName() const override { return "Distortion"; }
+
+	juce::AudioProcessorValueTreeState& treeState;
+	juce::LinearSmoothedValue<float> drive{ 0.0f };        // parametro A (nonlinearity)
+	juce::LinearSmoothedValue<float> gammaOmega{ 188.4f };  // parametro γ = ω (rad/s)
+
+private:
+	static juce::AudioProcessorValueTreeState::ParameterLayout createLayout()
 	{
-		drive.setTargetValue(*treeState.getRawParameterValue("A"));
-		gammaOmega.setTargetValue(*treeState.getRawParameterValue("GAMMA_OMEGA"));
+		juce::AudioProcessorValueTreeState::ParameterLayout layout;
+		addParameters(layout);
+		return layout;
+	}
 
-		const int numChannels = buffer.getNumChannels();
+	// Cached parameter pointers: no lookups by name on the audio thread
+	void bindParameters()
+	{
+		driveParameter      = treeState.getParameter(A_ID);
+		gammaOmegaParameter = treeState.getParameter(GAMMA_OMEGA_ID);
+		enabledParameter    = treeState.getParameter(ENABLED_ID);
+		jassert(driveParameter != nullptr && gammaOmegaParameter != nullptr && enabledParameter != nullptr);
+	}
+
+	juce::RangedAudioParameter* driveParameter = nullptr;
+	juce::RangedAudioParameter* gammaOmegaParameter = nullptr;
+	juce::RangedAudioParameter* enabledParameter = nullptr;
+
+	float currentSampleRate = 44100.0f;
+	bool isEnabledParameterOn() const noexcept { return getParameterValue(*enabledParameter) > 0.5f; }
+
+	// The ODE runs in the buffer's precision. Its state is kept in double:
+	// a float state round-trips exactly, so the float path is unchanged.
+	// Parameter smoothers stay in float.
+	template <typename SampleType>
+	void process(juce::AudioBuffer<SampleType>& buffer)
+	{
+		// The processor splits the block at automation events, so these ramps
+		// start on the event's sample
+		drive.setTargetValue(getParameterValue(*driveParameter));
+		gammaOmega.setTargetValue(getParameterValue(*gammaOmegaParameter));
+		enabledMix.setTargetValue(isEnabledParameterOn() ? 1.0f : 0.0f);
+
+		const int numChannels = juce::jmin(buffer.getNumChannels(), MAX_CHANNELS);
 		const int numSamples  = buffer.getNumSamples();
+		jassert(buffer.getNumChannels() <= MAX_CHANNELS);
+
+		// Zero-cost bypass: once the stage is disabled (fade finished), or A
+		// has settled at 0 (wet = 0), the output is exactly the input, so the
+		// ODE isn't integrated at all. Its state is zeroed on entering bypass:
+		// a stale state would resume a response to long-gone input, while a
+		// state at rest matches the dry signal the fade-in starts from.
+		const bool disabled = ! enabledMix.isSmoothing() && enabledMix.getTargetValue() == 0.0f;
+		const bool noDrive  = ! drive.isSmoothing() && drive.getTargetValue() == 0.0f;
+		if (disabled || noDrive)
+		{
+			if (! bypassed)
+			{
+				x.fill(0.0);
+				xDot.fill(0.0);
+				activity.reset();
+				sleeping = false;
+				bypassed = true;
+			}
 
-		if ((int)x.size() < numChannels)
+			drive.skip(numSamples);
+			gammaOmega.skip(numSamples);
+			enabledMix.skip(numSamples);
+			return;
+		}
+		bypassed = false;
+
+		// Sleep on sustained silence, once the ODE state has decayed too: its
+		// contribution to the output, (|x| + |x'|·dt)·stiffness, is below the
+		// silence threshold. The state is then zeroed, so waking up continues
+		// from rest with no discontinuity; meanwhile the output is just the
+		// dry path, with the same linear wet ramp the smoother would apply.
+		if (activity.update(juce::jmax(ActivityDetector::getPeak(buffer, numChannels, numSamples),
+		                               odeOutputBound(numChannels)), numSamples)
+			&& ! enabledMix.isSmoothing())
 		{
-			x.resize(numChannels, 0.0f);
-			xDot.resize(numChannels, 0.0f);
+			if (! sleeping)
+			{
+				x.fill(0.0);
+				xDot.fill(0.0);
+				sleeping = true;
+			}
+
+			const float wetStart = juce::jlimit(0.0f, 1.0f, drive.getCurrentValue() / 5000.0f);
+			drive.skip(numSamples);
+			gammaOmega.skip(numSamples);
+			const float wetEnd = juce::jlimit(0.0f, 1.0f, drive.getCurrentValue() / 5000.0f);
+
+			if (wetStart != 0.0f || wetEnd != 0.0f)
+				for (int ch = 0; ch < numChannels; ++ch)
+					buffer.applyGainRamp(ch, 0, numSamples, (SampleType)(1.0f - wetStart), (SampleType)(1.0f - wetEnd));
+			return;
 		}
+		sleeping = false;
 
+		const auto step = (SampleType)dt;
 		for (int i = 0; i < numSamples; ++i)
 		{
-			const float A = drive.getNextValue();
-			const float wet = juce::jlimit(0.0f, 1.0f, A / 5000.0f); // wet mix ratio [0,1]
+			const auto A = (SampleType)drive.getNextValue();
+			// wet mix ratio [0,1], scaled by the enable/bypass fade
+			const auto wet = (SampleType)(enabledMix.getNextValue() * juce::jlimit(0.0f, 1.0f, (float)A / 5000.0f));
 
 			// GAMMA_OMEGA is the angular frequency ω₀ (rad/s) directly.
 			// γ = ω (critically damped, ζ = 1): damping = 2·ω₀, stiffness = ω₀²
-			const float omega        = gammaOmega.getNextValue();
-			const float damping      = 2.0f * omega;
-			const float stiffness    = omega * omega;
-			const float gainComp     = stiffness; // compensate DC attenuation (1/stiffness)
+			const auto omega         = (SampleType)gammaOmega.getNextValue();
+			const SampleType damping   = 2 * omega;
+			const SampleType stiffness = omega * omega;
+			const SampleType gainComp  = stiffness; // compensate DC attenuation (1/stiffness)
 
 			for (int ch = 0; ch < numChannels; ++ch)
 			{
-				float* data = buffer.getWritePointer(ch);
-				const float rawInput = data[i];
+				SampleType* data = buffer.getWritePointer(ch);
+				const SampleType rawInput = data[i];
 				// Full-wave rectification: driving the ODE with |f(t)| makes the
 				// forcing term contain the beat frequency |f1-f2| as a direct
 				// component (from |sin(2πf1t)+sin(2πf2t)|). The ODE resonates
 				// when |f1-f2| ≈ ω, so it responds more to dissonant intervals
 				// (slow beats, small |f1-f2|) than consonant ones (fast beats).
-				const float input = std::abs(rawInput);
+				const SampleType input = std::abs(rawInput);
 
 				// ── ODE numerical integration (Explicit Euler) ──────────────
 				// x''(t-1) = |f(t)| - damping·x'(t-1) - stiffness·x(t-1) - A·x²(t-1)
-				const float xPrev    = x[ch];
-				const float xDotPrev = xDot[ch];
-				const float xDotDot = input
+				const auto xPrev    = (SampleType)x[ch];
+				const auto xDotPrev = (SampleType)xDot[ch];
+				const SampleType xDotDot = input
 					- damping * xDotPrev
 					- stiffness * xPrev
 					- A * xPrev * xPrev; // nonlinearity → intermodulation
 
 				// x'(t) = x'(t-1) + x''(t-1) · dt
-				xDot[ch] = xDotPrev + xDotDot * dt;
+				const SampleType xDotNext = xDotPrev + xDotDot * step;
 
 				// x(t) = x(t-1) + x'(t-1) · dt
-				x[ch] = xPrev + xDotPrev * dt;
+				const SampleType xNext = xPrev + xDotPrev * step;
 
 				// Numerical-stability safety bounds: with A up to 5000 the
 				// -A·x² term can overwhelm the linear restoring force and
 				// drive explicit Euler to diverge. Clamp state, not the ODE.
-				x[ch]    = juce::jlimit (-2.0f,   2.0f,   x[ch]);
-				xDot[ch] = juce::jlimit (-200.0f, 200.0f, xDot[ch]);
+				const SampleType xClamped = juce::jlimit ((SampleType)-2,   (SampleType)2,   xNext);
+				x[ch]    = xClamped;
+				xDot[ch] = juce::jlimit ((SampleType)-200, (SampleType)200, xDotNext);
 
 				// ── Parallel Processing: clean + ODE ────────────────────────
 				// Amplify ODE output to match input level at low freq
-				const float odeOut = x[ch] * gainComp;
+				const SampleType odeOut = xClamped * gainComp;
 
 				// Dry mix uses original audio (not rectified); wet adds ODE response.
-				data[i] = rawInput * (1.0f - wet) + odeOut * wet;
+				data[i] = rawInput * (1 - wet) + odeOut * wet;
 			}
 		}
 	}
 
-	void reset() override
+
+	// Largest ODE contribution to the next output sample, across channels
+	float odeOutputBound(int numChannels) const noexcept
 	{
-		std::fill(x.begin(), x.end(), 0.0f);
-		std::fill(xDot.begin(), xDot.end(), 0.0f);
-		drive.reset(currentSampleRate > 0.0f ? currentSampleRate : 44100.0, 0.02);
-		gammaOmega.reset(currentSampleRate > 0.0f ? currentSampleRate : 44100.0, 0.02);
+		const float omega = gammaOmega.getCurrentValue();
+		float bound = 0.0f;
+		for (int ch = 0; ch < numChannels; ++ch)
+			bound = juce::jmax(bound, (float)(std::abs(x[(size_t)ch]) + std::abs(xDot[(size_t)ch]) * dt));
+		return bound * omega * omega;
 	}
 
-	const juce::String getName() const override { return "Distortion"; }
+	double dt = 1.0 / 44100.0; // time step for integration
+	std::array<double, MAX_CHANNELS> x{};       // oscillator position per channel
+	std::array<double, MAX_CHANNELS> xDot{};    // oscillator velocity per channel
 
-	juce::AudioProcessorValueTreeState treeState;
-	juce::LinearSmoothedValue<float> drive{ 0.0f };        // parametro A (nonlinearity)
-	juce::LinearSmoothedValue<float> gammaOmega{ 188.4f };  // parametro γ = ω (rad/s)
+	static constexpr double SLEEP_HOLD_SECONDS = 0.1;
+	ActivityDetector activity;
+	bool sleeping = false;
 
-private:
-	juce::AudioProcessorValueTreeState::ParameterLayout createLayout()
-	{
-		std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
-		params.push_back(std::make_unique<juce::AudioParameterFloat>(
-			"A", "A (Non-linearity)",
-			juce::NormalisableRange<float>(0.0f, 5000.0f, 0.1f, 0.5f), 0.0f));
-		// γ = ω expressed directly in rad/s; default 188.4 rad/s = 2π·30 Hz
-		params.push_back(std::make_unique<juce::AudioParameterFloat>(
-			"GAMMA_OMEGA", "Gamma/Omega",
-			juce::NormalisableRange<float>(6.28f, 1256.6f, 0.1f, 0.5f), 188.4f));
-		return { params.begin(), params.end() };
-	}
-
-	float currentSampleRate = 44100.0f;
-	float dt = 1.0f / 44100.0f; // time step for integration
-	std::vector<float> x;       // oscillator position per channel
-	std::vector<float> xDot;    // oscillator velocity per channel
+	juce::LinearSmoothedValue<float> enabledMix{ 1.0f };   // 1 = processed, 0 = bypass
+	bool bypassed = false;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Distortion)
 };
@@ -309,11 +615,15 @@ class DissonanceMeeterAudioProcessor : public juce::AudioProcessor
 #if JucePlugin_Enable_ARA
 	, public juce::AudioProcessorARAExtension
 #endif
+	, private juce::AsyncUpdater
 {
 public:
 
-	using AudioGraphIOProcessor = juce::AudioProcessorGraph::AudioGraphIOProcessor;
-	using Node = juce::AudioProcessorGraph::Node;
+	// Input -> Distortion -> BandPass -> Output, composed at compile time and
+	// processed in place (see StaticProcessorChain.h).
+	using ProcessingChain = StaticProcessorChain<Distortion, BandPassFilter>;
+	static constexpr int DISTORTION_STAGE = 0;
+	static constexpr int BANDPASS_STAGE = 1;
 
 	//==============================================================================
 	DissonanceMeeterAudioProcessor();
@@ -326,6 +636,11 @@ public:
 	bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
 
 	void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+	void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+	bool supportsDoublePrecisionProcessing() const override { return true; }
+
+	// The host's track name labels this instance in the session matrix
+	void updateTrackProperties(const TrackProperties& properties) override;
 
 	//==============================================================================
 	juce::AudioProcessorEditor* createEditor() override;
@@ -350,31 +665,92 @@ public:
 	void getStateInformation(juce::MemoryBlock& destData) override;
 	void setStateInformation(const void* data, int sizeInBytes) override;
 
+	//==============================================================================
+	// Every control is a host parameter in this single layout: the stages'
+	// own (see addParameters()) plus the processor's below. The setters are
+	// for the message thread and notify the host like a UI gesture would.
+	static constexpr const char* INPUT_MODE_ID = "INPUT_MODE";
+	static constexpr const char* OSC1_FREQ_ID = "OSC1_FREQ";
+	static constexpr const char* OSC2_FREQ_ID = "OSC2_FREQ";
+	static constexpr const char* OUTPUT_GAIN_ID = "OUTPUT_GAIN";
+	static constexpr const char* METER_SMOOTHING_ID = "METER_SMOOTHING";
+	static constexpr const char* NUM_OSC_VOICES_ID = "NUM_OSC_VOICES";
+	static constexpr const char* STAGE_ORDER_ID = "STAGE_ORDER";
+	static constexpr const char* CHANNEL_ANALYSIS_ID = "CHANNEL_ANALYSIS";
+	static constexpr const char* ANALYSIS_FRAME_ID = "ANALYSIS_FRAME";
+	static constexpr const char* FREQUENCY_ESTIMATOR_ID = "FREQUENCY_ESTIMATOR";
+	static constexpr const char* DISSONANCE_MODEL_ID = "DISSONANCE_MODEL";
+	static constexpr const char* PARTIAL_GROUPING_ID = "PARTIAL_GROUPING";
+	static constexpr const char* LOW_LATENCY_ID = "LOW_LATENCY";
+	static constexpr const char* STATIONARITY_GATE_ID = "STATIONARITY_GATE";
+	static constexpr const char* MIDI_TIMBRE_ID = "MIDI_TIMBRE";
+	static constexpr const char* DISSONANCE_ENGINE_ID = "DISSONANCE_ENGINE";
+
+	// Per-voice oscillator parameters: OSC<n>_FREQ, OSC<n>_GAIN,
+	// OSC<n>_PARTIALS and OSC<n>_ROLLOFF, n = voice index + 1 (so voices 0
+	// and 1 take OSC1_FREQ and OSC2_FREQ).
+	enum class VoiceParameter { Frequency, Gain, Partials, Rolloff };
+	static juce::String getVoiceParameterID(int voiceIndex, VoiceParameter parameter);
+
+	static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+	juce::AudioProcessorValueTreeState& getParameterState() noexcept { return parameters; }
+
 	enum class InputMode { ExternalInput = 0, Oscillator = 1 };
 
-	void setInputMode(InputMode m) noexcept { inputMode.store((int)m); }
-	InputMode getInputMode() const noexcept { return static_cast<InputMode> (inputMode.load()); }
+	void setInputMode(InputMode m) { setParameter(INPUT_MODE_ID, (float)m); }
+	InputMode getInputMode() const noexcept { return static_cast<InputMode> (juce::roundToInt(ProcessorBase::getParameterValue(*inputModeParameter))); }
+
 
+	void setOscillatorFrequencies(float f1, float f2) { setParameter(OSC1_FREQ_ID, f1); setParameter(OSC2_FREQ_ID, f2); }
+	std::pair<float, float> getOscillatorFrequencies() const noexcept
+	{
+		return { ProcessorBase::getParameterValue(*osc1FreqParameter), ProcessorBase::getParameterValue(*osc2FreqParameter) };
+	}
 
-	void setOscillatorFrequencies(float f1, float f2) noexcept { oscFreq1.store(f1); oscFreq2.store(f2); }
-	std::pair<float, float> getOscillatorFrequencies() const noexcept { return { oscFreq1.load(), oscFreq2.load() }; }
+	// Oscillator mode voices (see OscillatorBank.h): by default two sines at
+	// OSC1/OSC2. Each field is a host parameter (see getVoiceParameterID());
+	// frequency changes glide, the rest rebuild the bank on the next block.
+	void setOscillatorVoice(int index, const OscillatorBank::Voice& voice);
+	OscillatorBank::Voice getOscillatorVoice(int index) const noexcept;
+	void setNumOscillatorVoices(int numVoices);
+	int  getNumOscillatorVoices() const noexcept { return juce::roundToInt(ProcessorBase::getParameterValue(*numOscVoicesParameter)); }
 
 	void  initialiseOscillator() noexcept;
 
-	void  setOutputGain(float g) noexcept { outputGain.store(g); }
-	float getOutputGain() const noexcept { return outputGain.load(); }
+	void  setOutputGain(float g) { setParameter(OUTPUT_GAIN_ID, g); }
+	float getOutputGain() const noexcept { return ProcessorBase::getParameterValue(*outputGainParameter); }
+
+	//==============================================================================
+	// Sample-accurate automation, for offline renders: 'value' (in the
+	// parameter's own units) is applied exactly at 'timelineSample' - the
+	// host timeline position when the play head reports one, otherwise the
+	// samples processed since prepareToPlay(). The block is split there, so
+	// the smoothers start on that sample whatever the host block size.
+	// Message thread only (single producer), in increasing time order; the
+	// queue is emptied by prepareToPlay(). Returns false for an unknown
+	// parameter or a full queue.
+	static constexpr int AUTOMATION_QUEUE_SIZE = 1024;
+	static constexpr int MAX_EVENTS_PER_BLOCK = 64;
+
+	bool scheduleParameterChange(const juce::String& parameterID, float value, juce::int64 timelineSample);
+
+	// The audio thread applies the scheduled changes with setValue() alone;
+	// this reports them to the host and the editor's attachments with
+	// setValueNotifyingHost(). Runs on the message thread after each block
+	// that applied some; can be called there directly to flush them.
+	void handleAsyncUpdate() override;
 
 	// Smooths the raw dBFS reading with the METER_SMOOTHING alpha before storing,
 	// so the OUT meter doesn't flicker rapidly on beating/close frequencies.
 	void updateOutputLevelRms(float dbfs) noexcept
 	{
-		const float alpha = meterSmoothingAlpha.load();
+		const float alpha = getMeterSmoothing();
 		const float prev  = outputLevelRms.load();
 		outputLevelRms.store(alpha * dbfs + (1.0f - alpha) * prev);
 	}
 	float getOutputLevelRms() const noexcept { return outputLevelRms.load(); }
 
-	// Returns the EMA-smoothed dissonance value (see meterSmoothingAlpha).
+	// Returns the EMA-smoothed dissonance value (see METER_SMOOTHING_ID).
 	float getDissonance() const noexcept { return smoothedDissonance.load(); }
 
 	// Returns the EMA-smoothed post-chain (Distortion -> BandPass) level, in dB.
@@ -384,43 +760,296 @@ public:
 	// the same signal that feeds the DissonanceAnalyser.
 	float getPreDistIntensityDb() const noexcept { return preDistIntensityDb.load(); }
 
-	void  setMeterSmoothing(float alpha) noexcept { meterSmoothingAlpha.store(juce::jlimit(0.01f, 1.0f, alpha)); }
-	float getMeterSmoothing() const noexcept { return meterSmoothingAlpha.load(); }
+	// The analysis options below are host parameters like the rest: the
+	// setters notify the host (message thread), the getters read the
+	// parameter, and processBlock() hands the values to the analysers at the
+	// start of each block.
+
+	// Block-rate dissonance updates between FFT frames (see DissonanceAnalyser),
+	// downmix or per channel.
+	void setLowLatencyMode(bool enabled) { setParameter(*lowLatencyParameter, enabled ? 1.0f : 0.0f); }
+	bool getLowLatencyMode() const noexcept { return ProcessorBase::getParameterValue(*lowLatencyParameter) >= 0.5f; }
+
+	// Analysis frame size (2^order analysis-rate samples); applied on the next
+	// prepareToPlay(). Smaller frames cut latency and are meant to be paired
+	// with the reassignment frequency estimator.
+	void setAnalysisFrameOrder(int order)
+	{
+		setParameter(*analysisFrameParameter, (float)(juce::jlimit(DissonanceAnalyser::MIN_FFT_ORDER, DissonanceAnalyser::FFT_ORDER, order) - DissonanceAnalyser::MIN_FFT_ORDER));
+	}
+	int  getAnalysisFrameOrder() const noexcept { return DissonanceAnalyser::MIN_FFT_ORDER + getChoice(*analysisFrameParameter); }
+
+	// Peak frequency estimator of the spectral and cross engines.
+	void setFrequencyEstimator(DissonanceAnalyser::FrequencyEstimator e) { setParameter(*frequencyEstimatorParameter, (float)e); }
+	DissonanceAnalyser::FrequencyEstimator getFrequencyEstimator() const noexcept { return (DissonanceAnalyser::FrequencyEstimator)getChoice(*frequencyEstimatorParameter); }
+
+	// Pair model used by every engine but the time-domain one (see DissonanceModels.h).
+	void setDissonanceModel(DissonanceModel m) { setParameter(*dissonanceModelParameter, (float)m); }
+	DissonanceModel getDissonanceModel() const noexcept { return (DissonanceModel)getChoice(*dissonanceModelParameter); }
+
+	// Skips the pair model on a stationary spectrum and lengthens the FFT hop
+	// while it stays stationary (see DissonanceAnalyser). Off by default: it
+	// trades response time (hop up to 8 half-frames) for CPU.
+	void setStationarityGate(bool enabled) { setParameter(*stationarityGateParameter, enabled ? 1.0f : 0.0f); }
+	bool getStationarityGate() const noexcept { return ProcessorBase::getParameterValue(*stationarityGateParameter) >= 0.5f; }
+
+	// Groups the spectral engine's partials into notes (harmonic series).
+	// Harmonic splits the reading into intra-note and inter-note dissonance;
+	// InterNoteOnly also makes the meter count the inter-note pairs only
+	// and skips the rest (see DissonanceAnalyser). Off by default.
+	void setPartialGrouping(DissonanceAnalyser::PartialGrouping g) { setParameter(*partialGroupingParameter, (float)g); }
+	DissonanceAnalyser::PartialGrouping getPartialGrouping() const noexcept { return (DissonanceAnalyser::PartialGrouping)getChoice(*partialGroupingParameter); }
+	float getIntraNoteDissonance() const noexcept { return spectralAnalyser().getIntraNoteDissonance(); }
+	float getInterNoteDissonance() const noexcept { return spectralAnalyser().getInterNoteDissonance(); }
+
+	// True while the input has been silent long enough for the analysers to
+	// be put to sleep (they are reset and no longer fed until it returns).
+	bool isAnalysisAsleep() const noexcept { return analysisAsleep.load(); }
+
+	// Selects which analyser drives the dissonance meter: the FFT partial-pair
+	// model (Spectral), the time-domain filterbank roughness (TimeDomain), or
+	// the pairs between the main input and the sidechain only (Cross; silent
+	// sidechain, or none connected, reads 0), or the notes of the MIDI input
+	// with no audio analysis at all (Midi, see MidiDissonanceEstimator.h;
+	// the meter takes each note change from its own sample in the block).
+	// The AU build is an audio effect that receives no MIDI: there the Midi
+	// engine has no notes and reads 0.
+	// A host parameter (DISSONANCE_ENGINE) applied at block start like the
+	// analysis options below. Only the active engine is fed; switching
+	// resets the newly active one.
+	// The MIDI notes are tracked whatever the engine, so switching to Midi
+	// reads the held notes at once - once the timbre's tables, built in the
+	// background on first selection, are there (see setMidiTimbre()).
+	enum class DissonanceEngine { Spectral = 0, TimeDomain = 1, Cross = 2, Midi = 3 };
+	void setDissonanceEngine(DissonanceEngine e);
+	DissonanceEngine getDissonanceEngine() const noexcept { return (DissonanceEngine)getChoice(*dissonanceEngineParameter); }
+
+	// How the spectral engine sees the main bus: a mono downmix (one FFT;
+	// out-of-phase content cancels), or one spectrum per channel combined in
+	// the power domain (ceil(channels / 2) FFTs, see DissonanceAnalyser).
+	// Any layout up to 16 channels; every spectral option above applies to
+	// both. Switching resets the newly active analyser.
+	enum class ChannelAnalysis { Downmix = 0, PerChannel = 1 };
+	void setChannelAnalysis(ChannelAnalysis c) { setParameter(*channelAnalysisParameter, (float)c); }
+	ChannelAnalysis getChannelAnalysis() const noexcept { return (ChannelAnalysis)getChoice(*channelAnalysisParameter); }
+
+	// Roughness over the 24 Bark critical bands, each pair counted at its
+	// centre frequency and normalised like the meter reading (see
+	// RoughnessSpectrum.h). Published once per analysis hop by the spectral
+	// engine, downmix or per channel. Any thread; false when another engine
+	// is selected or no stable copy could be read (dest is left untouched).
+	bool getRoughnessSpectrum(RoughnessSpectrum::Bands& dest) const noexcept
+	{
+		if (getDissonanceEngine() != DissonanceEngine::Spectral)
+			return false;
+
+		return spectralAnalyser().getRoughnessSpectrum(dest);
+	}
+
+	// Harmonic spectrum assumed for every MIDI note by the Midi engine. The
+	// timbre's pair tables are built on the shared analysis pool the first
+	// time it is selected with the Midi engine; until they are published the
+	// engine keeps the previous timbre (or reads 0). Message thread only.
+	void setMidiTimbre(MidiDissonanceEstimator::Timbre t);
+	MidiDissonanceEstimator::Timbre getMidiTimbre() const noexcept { return (MidiDissonanceEstimator::Timbre)getChoice(*midiTimbreParameter); }
+
+	// Sounding notes and the last block's sample-accurate changes; audio
+	// thread only (or offline, in the tests).
+	const MidiDissonanceEstimator& getMidiEstimator() const noexcept { return midiEstimator; }
+
+	void  setMeterSmoothing(float alpha) { setParameter(METER_SMOOTHING_ID, juce::jlimit(0.01f, 1.0f, alpha)); }
+	float getMeterSmoothing() const noexcept { return ProcessorBase::getParameterValue(*meterSmoothingParameter); }
 
 	juce::AudioVisualiserComponent& getWaveForm() noexcept { return waveForm; }
 
-	std::atomic<float> outputGain{ 1.0f };
+	// Per-stage CPU load histograms (p50/p99/max of the block deadline), read
+	// by the editor's debug overlay and the benchmarks. Disabled by default.
+	StageProfiler& getProfiler() noexcept { return profiler; }
+
+	// FFT frames the spectral analysers skipped because every shared plan
+	// was leased (see SharedAnalysisTables.h), since construction; shown in
+	// the profiler overlay.
+	int getNumSkippedAnalysisFrames() const noexcept { return skippedAnalysisFrames.load(); }
+
+	// Opt-in Chrome trace of processBlock, its stages and analyseFrame, plus
+	// the editor's paint()/timerCallback(); written by a background thread.
+	TraceRecorder& getTracer() noexcept { return tracer; }
+
+	// Registry shared by every instance in the host process: this instance
+	// publishes its partials and pair model into its own slot (-1 once
+	// MAX_TRACKS are taken) and the editor reads the track-by-track clashes
+	// back. The matrix is only computed while an editor is registered as a
+	// viewer (SessionDissonanceRegistry::addViewer()).
+	SessionDissonanceRegistry& getSessionRegistry() noexcept { return *sessionRegistry; }
+	int getSessionSlot() const noexcept { return sessionSlot; }
+
+#if JucePlugin_Enable_ARA
+	// Host play head (seconds) seen by the last ARA block; the editor shows
+	// the analysed dissonance of the regions just ahead of it
+	double getAraPlayheadTime() const noexcept { return araPlayheadSeconds.load(); }
+#endif
+
+	Distortion&      getDistortion() noexcept { return processingChain.get<DISTORTION_STAGE>(); }
+	BandPassFilter&  getBandPass() noexcept { return processingChain.get<BANDPASS_STAGE>(); }
+
+	// Stage order, a permutation of DISTORTION_STAGE/BANDPASS_STAGE: the
+	// STAGE_ORDER choice lists them all (see getStageOrders()). Message
+	// thread; false (nothing changed) for anything but a permutation.
+	bool setStageOrder(const ProcessingChain::StageOrder& order);
+	ProcessingChain::StageOrder getStageOrder() const noexcept { return getStageOrders()[(size_t)getChoice(*stageOrderParameter)]; }
+
+	// Every stage order, the identity first
+	static constexpr int NUM_STAGE_ORDERS = 2;
+	static_assert (ProcessingChain::NUM_STAGES == 2, "STAGE_ORDER lists the orders of a two-stage chain");
+	static std::array<ProcessingChain::StageOrder, NUM_STAGE_ORDERS> getStageOrders() noexcept
+	{
+		return { { { DISTORTION_STAGE, BANDPASS_STAGE }, { BANDPASS_STAGE, DISTORTION_STAGE } } };
+	}
+
 	std::atomic<float> outputLevelRms{ -100.0f };
 
 private:
-	DissonanceAnalyser dissonanceAnalyser;
+	//==============================================================================
+	// Which part of processBlock() consumes a parameter: each part walks the
+	// block's events for its own parameters and splits its work at them.
+	// Meters and Analysis are applied at the start of the block.
+	enum class AutomationTarget { Oscillator, Chain, Output, Meters, Analysis };
+
+	struct AutomationEvent
+	{
+		juce::int64 time = 0;                          // timeline sample (in the queue)
+		int offset = 0;                                // sample in the block (once collected)
+		juce::RangedAudioParameter* parameter = nullptr;
+		AutomationTarget target = AutomationTarget::Chain;
+		float value = 0.0f;                            // normalised
+	};
+
+	// A change applied by processSegments(), on its way to the message thread
+	struct AppliedChange
+	{
+		juce::RangedAudioParameter* parameter = nullptr;
+		float value = 0.0f;                            // normalised
+	};
+
+	void setParameter(const char* parameterID, float value);
+	static void setParameter(juce::RangedAudioParameter& parameter, float value);
+	static int  getChoice(const juce::RangedAudioParameter& parameter) noexcept { return juce::roundToInt(ProcessorBase::getParameterValue(parameter)); }
+	void collectAutomationEvents(int numSamples) noexcept;
+
+	// Audio thread, once per block: the analysis parameters to the analysers
+	void applyAnalysisParameters() noexcept;
 
-	// EMA smoothing factor shared by the dissonance, OUT, POST CHAIN and PRE DIST
-	// meters. Applied on the audio thread each processBlock(); read by the UI for display.
-	std::atomic<float> meterSmoothingAlpha{ 0.05f };
+	// The spectral engine's analyser selected by setChannelAnalysis(); any thread.
+	const DissonanceAnalyser& spectralAnalyser() const noexcept
+	{
+		return getChannelAnalysis() == ChannelAnalysis::PerChannel ? multichannelAnalyser : dissonanceAnalyser;
+	}
+
+	template <typename SampleType>
+	void processSamples(juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages);
+
+	template <typename ProcessSegment>
+	void processSegments(AutomationTarget target, int numSamples, ProcessSegment&& processSegment);
+
+	juce::AudioProcessorValueTreeState parameters;
+	juce::RangedAudioParameter* inputModeParameter = nullptr;
+	juce::RangedAudioParameter* osc1FreqParameter = nullptr;
+	juce::RangedAudioParameter* osc2FreqParameter = nullptr;
+	juce::RangedAudioParameter* outputGainParameter = nullptr;
+	juce::RangedAudioParameter* meterSmoothingParameter = nullptr;
+	juce::RangedAudioParameter* numOscVoicesParameter = nullptr;
+	juce::RangedAudioParameter* stageOrderParameter = nullptr;
+	juce::RangedAudioParameter* channelAnalysisParameter = nullptr;
+	juce::RangedAudioParameter* analysisFrameParameter = nullptr;
+	juce::RangedAudioParameter* frequencyEstimatorParameter = nullptr;
+	juce::RangedAudioParameter* dissonanceModelParameter = nullptr;
+	juce::RangedAudioParameter* partialGroupingParameter = nullptr;
+	juce::RangedAudioParameter* lowLatencyParameter = nullptr;
+	juce::RangedAudioParameter* stationarityGateParameter = nullptr;
+	juce::RangedAudioParameter* midiTimbreParameter = nullptr;
+	juce::RangedAudioParameter* dissonanceEngineParameter = nullptr;
+
+	struct VoiceParameters
+	{
+		juce::RangedAudioParameter* frequency = nullptr;
+		juce::RangedAudioParameter* gain = nullptr;
+		juce::RangedAudioParameter* numPartials = nullptr;
+		juce::RangedAudioParameter* rolloff = nullptr;
+	};
+	std::array<VoiceParameters, OscillatorBank::MAX_VOICES> voiceParameters;
+
+	juce::AbstractFifo automationFifo{ AUTOMATION_QUEUE_SIZE };
+	std::array<AutomationEvent, AUTOMATION_QUEUE_SIZE> automationQueue;
+	std::array<AutomationEvent, MAX_EVENTS_PER_BLOCK> blockEvents;     // audio thread only
+	int         numBlockEvents = 0;
+	juce::int64 samplesProcessed = 0;
+
+	juce::AbstractFifo appliedFifo{ MAX_EVENTS_PER_BLOCK };   // audio thread -> handleAsyncUpdate()
+	std::array<AppliedChange, MAX_EVENTS_PER_BLOCK> appliedChanges;
+
+	DissonanceAnalyser dissonanceAnalyser;
+	RoughnessAnalyser  roughnessAnalyser;
+	CrossDissonanceAnalyser crossAnalyser;
+	int                activeEngine = (int)DissonanceEngine::Spectral;   // audio thread only
+	DissonanceAnalyser multichannelAnalyser;                              // one channel per output channel
+	int                activeChannelAnalysis = (int)ChannelAnalysis::Downmix;  // audio thread only
+	MidiDissonanceEstimator midiEstimator;
+	ActivityDetector   inputActivity;                                     // audio thread only
+	std::atomic<bool>  analysisAsleep{ false };
+	std::atomic<int>   skippedAnalysisFrames{ 0 };
+
+	// Meters EMA-smoothed with the METER_SMOOTHING alpha, shared by the
+	// dissonance, OUT, POST CHAIN and PRE DIST meters; read by the UI.
 	std::atomic<float> smoothedDissonance{ 0.0f };
 	std::atomic<float> smoothedBandLevelDb{ -100.0f };
 	std::atomic<float> preDistIntensityDb{ -100.0f };
-	void initialiseGraph();
-	void connectAudioNodes();
 
 	juce::AudioVisualiserComponent waveForm{ 2 };
 
 	double lastSampleRate = 44100.0;
 	int    numInputChannels = 2;
 	int    numOutputChannels = 2;
+	int    preparedFrameOrder = 0;   // 0 = not prepared yet
+
+	ProcessingChain processingChain;
+	StageProfiler   profiler;
+	TraceRecorder   tracer;
+
+	juce::SharedResourcePointer<SessionDissonanceRegistry> sessionRegistry;
+	int sessionSlot = -1;
+	juce::uint32 lastPublishedFrame = 0;   // audio thread only
+
+	// Builds one timbre's pair tables for the Midi engine; submitted at most
+	// once, the tables then stay for the life of the estimator
+	struct TimbreTablesJob : public SharedAnalysisPool::Job
+	{
+		void run() override { estimator->buildTables(timbre); }
+
+		MidiDissonanceEstimator* estimator = nullptr;
+		MidiDissonanceEstimator::Timbre timbre = MidiDissonanceEstimator::Timbre::Sine;
+		bool submitted = false;   // message thread
+	};
+	std::array<TimbreTablesJob, MidiDissonanceEstimator::NUM_TIMBRES> timbreTablesJobs;
+	SharedAnalysisPool::Client analysisPool;   // declared after the jobs: removes them first
+
+	// Message thread: queues the selected timbre's tables if the Midi engine needs them
+	void requestMidiTables();
+
+	void publishSessionPartials(bool silent) noexcept;
+	float smoothMidiDissonance(float smoothed, float alpha, int numSamples) const noexcept;
+
+#if JucePlugin_Enable_ARA
+	std::atomic<double> araPlayheadSeconds{ 0.0 };
+#endif
+
+	// Audio thread: the voices the bank was last built with. A change of
+	// count or timbre rebuilds it; frequencies glide with setFrequency().
+	std::array<OscillatorBank::Voice, OscillatorBank::MAX_VOICES> bankVoices{};
+	int numBankVoices = 0;   // 0 = rebuild on the next block
+
+	void updateOscillatorVoices() noexcept;
 
-	std::unique_ptr<juce::AudioProcessorGraph> mainProcessor;
-	Node::Ptr audioInputNode;
-	Node::Ptr bandPassNode;
-	Node::Ptr distortionNode;
-	Node::Ptr audioOutputNode;
-
-	std::atomic<int>   inputMode{ 0 };
-	std::atomic<float> oscFreq1{ 150.0f };
-	std::atomic<float> oscFreq2{ 220.0f };
-	double oscPhase1 = 0.0;
-	double oscPhase2 = 0.0;
+	OscillatorBank oscillatorBank;   // audio thread only; glides between automation steps
 	//==============================================================================
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DissonanceMeeterAudioProcessor)
 };
@@ -12,6 +12,12 @@
 #include "PluginProcessor.h"
 #include "../../DissonanceAnalyser.h"
 
+#include "RealtimeSafety.h"
+#include "DissonanceMap.h"
+#include "SharedAnalysisPool.h"
+#include <map>
+#include <numeric>
+
 //==============================================================================
 // TEST 1 â€” DissonanceAnalyser: sinusoide singola â†’ dissonanza minima
 //==============================================================================
@@ -466,9 +472,11 @@ public:
 //==============================================================================
 // TEST 12 - Catena completa: Distortion + BandPass + DissonanceAnalyser
 //
-// Verifica che la catena ordini gli intervalli correttamente senza istanziare
-// DissonanceMeeterAudioProcessor (il cui costruttore auto-esegue i test in Debug
-// causando ricorsione infinita).
+// Verifica che la catena ordini gli intervalli correttamente con gli stadi e
+// l'analizzatore da soli, senza il processor attorno. Altri test istanziano
+// DissonanceMeeterAudioProcessor: il suo costruttore lancia i test solo in
+// Debug, e il flag statico runningTests evita che li rilanci mentre sono in
+// corso.
 //==============================================================================
 class ProcessorChainDissonanceTest : public juce::UnitTest
 {
@@ -533,6 +541,3744 @@ public:
     }
 };
 
+//==============================================================================
+// TEST 13 - DissonanceAnalyser: decimazione ad alta frequenza di campionamento
+//
+// A 96 e 192 kHz l'analisi deve girare a 48 kHz (stessa risoluzione di una
+// sessione a 48 kHz) e mantenere l'ordinamento terza > quinta.
+//==============================================================================
+class DissonanceAnalyserHighRateTest : public juce::UnitTest
+{
+public:
+    DissonanceAnalyserHighRateTest()
+        : juce::UnitTest ("DissonanceAnalyser - Decimazione alta frequenza", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        auto measure = [] (double sr, float f1, float f2) -> float
+        {
+            DissonanceAnalyser a;
+            a.prepare (sr);
+            const int numSamples = (int) (8192.0 * sr / 44100.0);
+            for (int i = 0; i < numSamples; ++i)
+                a.pushSample (0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * f1 * i / sr)
+                            + 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * f2 * i / sr));
+            return a.getDissonance();
+        };
+
+        for (double sr : { 96000.0, 192000.0 })
+        {
+            beginTest ("Frequenza di analisi a " + juce::String (sr) + " Hz");
+            {
+                DissonanceAnalyser a;
+                a.prepare (sr);
+                expectEquals (a.getAnalysisSampleRate(), 48000.0f);
+            }
+
+            beginTest ("Terza maggiore piu' dissonante della quinta a " + juce::String (sr) + " Hz");
+            const float dThird = measure (sr, 440.0f, 550.0f);
+            const float dFifth = measure (sr, 440.0f, 660.0f);
+            expect (dThird > dFifth,
+                "Terza=" + juce::String (dThird) + " Quinta=" + juce::String (dFifth));
+
+            beginTest ("Un tono ultrasonico (30 kHz) non deve generare coppie a " + juce::String (sr) + " Hz");
+            expectLessThan (measure (sr, 440.0f, 30000.0f), 0.05f);
+        }
+
+        beginTest ("A 44.1 kHz il decimatore e' un pass-through");
+        {
+            DissonanceAnalyser a;
+            a.prepare (44100.0);
+            expectEquals (a.getAnalysisSampleRate(), 44100.0f);
+        }
+    }
+};
+
+//==============================================================================
+// TEST 14 - DissonanceAnalyser: modalita' a bassa latenza (risonatori)
+//
+// Su un segnale stazionario i risonatori devono riprodurre il valore del frame
+// FFT; quando il segnale si interrompe devono azzerarsi dopo REFINE_WINDOW
+// campioni, mentre il solo percorso FFT resta fermo sull'ultimo frame.
+//==============================================================================
+class DissonanceAnalyserLowLatencyTest : public juce::UnitTest
+{
+public:
+    DissonanceAnalyserLowLatencyTest()
+        : juce::UnitTest ("DissonanceAnalyser - Bassa latenza", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        constexpr double sr        = 44100.0;
+        constexpr int    blockSize = 64;
+
+        DissonanceAnalyser fftOnly, refined;
+        fftOnly.prepare (sr);
+        refined.prepare (sr);
+        refined.setLowLatencyRefinement (true);
+
+        auto feed = [&] (int numBlocks, bool silent, int& n)
+        {
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                for (int i = 0; i < blockSize; ++i, ++n)
+                {
+                    const float s = silent ? 0.0f
+                        : 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * 440.0 * n / sr)
+                        + 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * 550.0 * n / sr);
+                    fftOnly.pushSample (s);
+                    refined.pushSample (s);
+                }
+                fftOnly.updateBetweenFrames();
+                refined.updateBetweenFrames();
+            }
+        };
+
+        int n = 0;
+        feed (8192 / blockSize, false, n);
+
+        beginTest ("Segnale stazionario: i risonatori seguono il valore del frame FFT");
+        expectWithinAbsoluteError (refined.getDissonance(), fftOnly.getDissonance(), 0.01f);
+
+        feed ((DissonanceAnalyser::REFINE_WINDOW + 2 * blockSize) / blockSize, true, n);
+
+        beginTest ("Dopo REFINE_WINDOW campioni di silenzio la dissonanza a bassa latenza e' ~0");
+        expectLessThan (refined.getDissonance(), 0.01f);
+        expectGreaterThan (fftOnly.getDissonance(), 0.01f);
+
+        beginTest ("Tra un frame e l'altro lo spettro di ruvidita' resta quello del frame");
+        {
+            DissonanceAnalyser analyser;
+            analyser.prepare (sr);
+            analyser.setLowLatencyRefinement (true);
+
+            RoughnessSpectrum::Bands atFrame{}, bands{};
+            int blocksBetweenFrames = 0;
+            bool dissonanceMoved = false;
+            float dissonanceAtFrame = 0.0f;
+
+            for (int b = 0, m = 0; b < 16384 / blockSize; ++b)
+            {
+                const auto framesBefore = analyser.getFrameCount();
+                for (int i = 0; i < blockSize; ++i, ++m)
+                {
+                    // Semitono stabile e una quinta in dissolvenza: il peso delle coppie
+                    // (e quindi la dissonanza dei risonatori) cambia tra i frame
+                    const float gain = m < 8192 ? 0.3f : 0.3f * std::exp (-(float) (m - 8192) / 2000.0f);
+                    analyser.pushSample (0.3f * (float) std::sin (juce::MathConstants<double>::twoPi * 440.0 * m / sr)
+                                         + 0.3f * (float) std::sin (juce::MathConstants<double>::twoPi * 466.16 * m / sr)
+                                         + gain * (float) std::sin (juce::MathConstants<double>::twoPi * 660.0 * m / sr));
+                }
+
+                if (analyser.getFrameCount() != framesBefore)
+                {
+                    expect (analyser.getRoughnessSpectrum (atFrame));
+                    analyser.updateBetweenFrames();
+                    dissonanceAtFrame = analyser.getDissonance();
+                    continue;
+                }
+
+                analyser.updateBetweenFrames();
+                if (m <= 8192)
+                    continue;
+
+                ++blocksBetweenFrames;
+                dissonanceMoved = dissonanceMoved || std::abs (analyser.getDissonance() - dissonanceAtFrame) > 1.0e-4f;
+                expect (analyser.getRoughnessSpectrum (bands));
+                expect (bands == atFrame, "spettro ripubblicato al blocco " + juce::String (b));
+            }
+
+            expectGreaterThan (blocksBetweenFrames, 0);
+            expect (dissonanceMoved, "la dissonanza a bassa latenza dovrebbe muoversi tra i frame");
+        }
+    }
+};
+
+//==============================================================================
+// TEST 15 - DissonanceAnalyser: riassegnazione tempo-frequenza
+//
+// Con frame da 512 e 1024 punti la riassegnazione deve stimare la frequenza
+// di un tono fuori bin con errore < 0.5 Hz, meglio dell'interpolazione
+// parabolica, e mantenere l'ordinamento terza > quinta.
+//==============================================================================
+class DissonanceAnalyserReassignmentTest : public juce::UnitTest
+{
+public:
+    DissonanceAnalyserReassignmentTest()
+        : juce::UnitTest ("DissonanceAnalyser - Riassegnazione", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        constexpr double sr = 44100.0;
+
+        auto run = [&] (DissonanceAnalyser& a, int order, DissonanceAnalyser::FrequencyEstimator e,
+                        float f1, float f2)
+        {
+            a.prepare (sr, order);
+            a.setFrequencyEstimator (e);
+            for (int i = 0; i < 8192; ++i)
+                a.pushSample (0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * f1 * i / sr)
+                            + (f2 > 0.0f ? 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * f2 * i / sr) : 0.0f));
+        };
+
+        auto firstPartialError = [] (const DissonanceAnalyser& a, float expected) -> float
+        {
+            return a.getNumFramePartials() > 0 ? std::abs (a.getFramePartialFrequency (0) - expected) : 1.0e6f;
+        };
+
+        for (int order : { 9, 10 })
+        {
+            const float f = 443.7f;
+
+            DissonanceAnalyser parabolic, reassigned;
+            run (parabolic,  order, DissonanceAnalyser::FrequencyEstimator::Parabolic,    f, 0.0f);
+            run (reassigned, order, DissonanceAnalyser::FrequencyEstimator::Reassignment, f, 0.0f);
+
+            const float errParabolic  = firstPartialError (parabolic, f);
+            const float errReassigned = firstPartialError (reassigned, f);
+
+            beginTest ("Frame da " + juce::String (1 << order) + " punti: errore di frequenza < 0.5 Hz");
+            expectLessThan (errReassigned, 0.5f);
+
+            beginTest ("Frame da " + juce::String (1 << order) + " punti: riassegnazione piu' precisa della parabola");
+            expect (errReassigned < errParabolic,
+                "Riassegnazione=" + juce::String (errReassigned) + " Parabola=" + juce::String (errParabolic));
+        }
+
+        beginTest ("Frame da 1024 punti con riassegnazione: terza maggiore piu' dissonante della quinta");
+        {
+            DissonanceAnalyser third, fifth;
+            run (third, 10, DissonanceAnalyser::FrequencyEstimator::Reassignment, 440.0f, 550.0f);
+            run (fifth, 10, DissonanceAnalyser::FrequencyEstimator::Reassignment, 440.0f, 660.0f);
+            expect (third.getDissonance() > fifth.getDissonance(),
+                "Terza=" + juce::String (third.getDissonance()) + " Quinta=" + juce::String (fifth.getDissonance()));
+        }
+    }
+};
+
+//==============================================================================
+// TEST 16 - RoughnessAnalyser: motore nel dominio del tempo
+//
+// Un tono puro e il silenzio non devono dare ruvidita'; semitono e terza
+// maggiore (battimenti nella zona di massima roughness) devono superare la
+// quinta, anche con decimazione a 96 kHz.
+//==============================================================================
+class RoughnessAnalyserTest : public juce::UnitTest
+{
+public:
+    RoughnessAnalyserTest()
+        : juce::UnitTest ("RoughnessAnalyser - Dominio del tempo", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        auto measure = [] (double sr, float f1, float f2) -> float
+        {
+            RoughnessAnalyser a;
+            a.prepare (sr);
+            const int numSamples = (int) (sr * 0.5);
+            for (int i = 0; i < numSamples; ++i)
+                a.pushSample (0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * f1 * i / sr)
+                            + (f2 > 0.0f ? 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * f2 * i / sr) : 0.0f));
+            a.updateBetweenFrames();
+            return a.getDissonance();
+        };
+
+        beginTest ("Silenzio: ruvidita' nulla");
+        {
+            RoughnessAnalyser a;
+            a.prepare (44100.0);
+            for (int i = 0; i < 22050; ++i)
+                a.pushSample (0.0f);
+            a.updateBetweenFrames();
+            expectEquals (a.getDissonance(), 0.0f);
+        }
+
+        for (double sr : { 44100.0, 96000.0 })
+        {
+            const juce::String at = " a " + juce::String (sr) + " Hz";
+
+            beginTest ("Tono puro: ruvidita' trascurabile" + at);
+            expectLessThan (measure (sr, 440.0f, 0.0f), 0.05f);
+
+            const float dSemitone = measure (sr, 440.0f, 466.16f);
+            const float dThird    = measure (sr, 440.0f, 550.0f);
+            const float dFifth    = measure (sr, 440.0f, 660.0f);
+
+            beginTest ("Semitono piu' ruvido della quinta" + at);
+            expect (dSemitone > dFifth,
+                "Semitono=" + juce::String (dSemitone) + " Quinta=" + juce::String (dFifth));
+
+            beginTest ("Terza maggiore piu' ruvida della quinta" + at);
+            expect (dThird > dFifth,
+                "Terza=" + juce::String (dThird) + " Quinta=" + juce::String (dFifth));
+        }
+    }
+};
+
+//==============================================================================
+// TEST 17 - Modelli di dissonanza (policy)
+//
+// Ogni modello deve ordinare semitono > quinta; Sethares deve coincidere con
+// la formula chiusa, Vassilakis deve attenuare le coppie di ampiezza diversa
+// e Hutchinson-Knopoff deve avere il massimo a un quarto di banda critica.
+//==============================================================================
+class DissonanceModelsTest : public juce::UnitTest
+{
+public:
+    DissonanceModelsTest()
+        : juce::UnitTest ("DissonanceAnalyser - Modelli a coppie", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        beginTest ("Sethares: formula chiusa");
+        {
+            const float s = 0.24f / (0.0207f * 440.0f + 18.96f);
+            const float expected = 0.5f * 0.25f * (std::exp (-3.5f * s * 26.0f) - std::exp (-5.75f * s * 26.0f));
+            expectWithinAbsoluteError (SetharesModel::pair (440.0f, 466.0f, 0.5f, 0.25f), expected, 1.0e-6f);
+        }
+
+        beginTest ("Vassilakis: ampiezze diverse battono meno di ampiezze uguali");
+        {
+            const float equal   = VassilakisModel::pair (440.0f, 466.0f, 0.5f, 0.5f)  / VassilakisModel::weight (0.5f, 0.5f);
+            const float unequal = VassilakisModel::pair (440.0f, 466.0f, 0.5f, 0.05f) / VassilakisModel::weight (0.5f, 0.05f);
+            expect (unequal < 0.1f * equal,
+                "Uguali=" + juce::String (equal) + " Diverse=" + juce::String (unequal));
+        }
+
+        beginTest ("Hutchinson-Knopoff: massimo a un quarto di banda critica");
+        {
+            // df = 0.25 * 1.72 * f_media^0.65, risolto per punto fisso
+            float f2 = 500.0f;
+            for (int i = 0; i < 20; ++i)
+                f2 = 440.0f + HutchinsonKnopoffModel::PEAK_Y * 1.72f * std::pow (0.5f * (440.0f + f2), 0.65f);
+
+            expectWithinAbsoluteError (HutchinsonKnopoffModel::pair (440.0f, f2, 1.0f, 1.0f), 1.0f, 1.0e-3f);
+            expectLessThan (HutchinsonKnopoffModel::pair (440.0f, 440.0f + 2.0f * (f2 - 440.0f), 1.0f, 1.0f), 1.0f);
+        }
+
+        constexpr double sr = 44100.0;
+
+        auto measure = [&] (DissonanceModel m, float f1, float f2) -> float
+        {
+            DissonanceAnalyser a;
+            a.prepare (sr);
+            a.setDissonanceModel (m);
+            for (int i = 0; i < 8192; ++i)
+                a.pushSample (0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * f1 * i / sr)
+                            + 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * f2 * i / sr));
+            return a.getDissonance();
+        };
+
+        const std::pair<DissonanceModel, const char*> models[] = {
+            { DissonanceModel::Sethares,          "Sethares" },
+            { DissonanceModel::Vassilakis,        "Vassilakis" },
+            { DissonanceModel::HutchinsonKnopoff, "Hutchinson-Knopoff" }
+        };
+
+        for (const auto& [model, modelName] : models)
+        {
+            beginTest (juce::String (modelName) + ": terza maggiore piu' dissonante della quinta");
+            const float dThird = measure (model, 440.0f, 550.0f);
+            const float dFifth = measure (model, 440.0f, 660.0f);
+            expect (dThird > dFifth,
+                "Terza=" + juce::String (dThird) + " Quinta=" + juce::String (dFifth));
+        }
+
+        beginTest ("La scelta del modello cambia il valore sullo stesso segnale");
+        expect (std::abs (measure (DissonanceModel::Sethares, 440.0f, 550.0f)
+                        - measure (DissonanceModel::HutchinsonKnopoff, 440.0f, 550.0f)) > 1.0e-3f);
+    }
+};
+
+//==============================================================================
+// TEST 18 - StaticProcessorChain: catena composta a tempo di compilazione
+//
+// La catena deve dare lo stesso risultato di Distortion -> BandPass chiamati
+// a mano, seguire l'ordine impostato con setStageOrder() e rifiutare le
+// tabelle che non sono permutazioni.
+//==============================================================================
+class StaticProcessorChainTest : public juce::UnitTest
+{
+public:
+    StaticProcessorChainTest()
+        : juce::UnitTest ("StaticProcessorChain - Routing", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        using Chain = StaticProcessorChain<Distortion, BandPassFilter>;
+
+        constexpr double sr        = 44100.0;
+        constexpr int    blockSize = 256;
+
+        auto fill = [&] (juce::AudioBuffer<float>& buf, int block)
+        {
+            for (int ch = 0; ch < buf.getNumChannels(); ++ch)
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    const double n = block * blockSize + i;
+                    buf.setSample (ch, i, 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * 440.0 * n / sr)
+                                        + 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * 550.0 * n / sr));
+                }
+        };
+
+        auto maxDifference = [] (const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+        {
+            float diff = 0.0f;
+            for (int ch = 0; ch < a.getNumChannels(); ++ch)
+                for (int i = 0; i < a.getNumSamples(); ++i)
+                    diff = juce::jmax (diff, std::abs (a.getSample (ch, i) - b.getSample (ch, i)));
+            return diff;
+        };
+
+        // Confronta la catena con gli stessi stadi chiamati a mano nell'ordine dato
+        auto compare = [&] (bool bandPassFirst) -> float
+        {
+            Chain chain;
+            chain.get<0>().treeState.getParameter ("A")->setValueNotifyingHost (0.3f);
+            chain.get<1>().treeState.getParameter ("CENTER_FREQ")->setValueNotifyingHost (0.4f);
+            if (bandPassFirst)
+                expect (chain.setStageOrder ({ 1, 0 }));
+            chain.prepareToPlay (sr, blockSize, 2);
+
+            Distortion dist;
+            BandPassFilter bp;
+            dist.treeState.getParameter ("A")->setValueNotifyingHost (0.3f);
+            bp.treeState.getParameter ("CENTER_FREQ")->setValueNotifyingHost (0.4f);
+            for (juce::AudioProcessor* p : { (juce::AudioProcessor*) &dist, (juce::AudioProcessor*) &bp })
+            {
+                p->setPlayConfigDetails (2, 2, sr, blockSize);
+                p->prepareToPlay (sr, blockSize);
+            }
+
+            juce::AudioBuffer<float> viaChain (2, blockSize), manual (2, blockSize);
+            juce::MidiBuffer midi;
+            float diff = 0.0f;
+
+            for (int block = 0; block < 16; ++block)
+            {
+                fill (viaChain, block);
+                fill (manual, block);
+
+                chain.process (viaChain, midi);
+                if (bandPassFirst) { bp.processBlock (manual, midi); dist.processBlock (manual, midi); }
+                else               { dist.processBlock (manual, midi); bp.processBlock (manual, midi); }
+
+                diff = juce::jmax (diff, maxDifference (viaChain, manual));
+            }
+
+            return diff;
+        };
+
+        beginTest ("Ordine predefinito: identica a Distortion -> BandPass");
+        expectEquals (compare (false), 0.0f);
+
+        beginTest ("Ordine invertito: identica a BandPass -> Distortion");
+        expectEquals (compare (true), 0.0f);
+
+        beginTest ("Tabelle di routing non valide vengono rifiutate");
+        {
+            Chain chain;
+            expect (! chain.setStageOrder ({ 0, 0 }));
+            expect (! chain.setStageOrder ({ 0, 2 }));
+            expect (chain.getStageOrder() == Chain::identityOrder());
+        }
+    }
+};
+
+//==============================================================================
+// TEST 19 - Processor: riconfigurazione incrementale in prepareToPlay
+//
+// Una seconda prepareToPlay con la stessa configurazione (anche con un altro
+// buffer size) deve solo azzerare lo stato: nessuna allocazione (i tempi
+// si stampano soltanto, come nei benchmark). Dopo la preparazione processBlock non deve mai allocare ne'
+// prendere lock, con entrambi gli ingressi e entrambi i motori di analisi.
+//==============================================================================
+class ProcessorReconfigurationTest : public juce::UnitTest
+{
+public:
+    ProcessorReconfigurationTest()
+        : juce::UnitTest ("Processor - Riconfigurazione", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        constexpr int maxBlockSize = 512;
+
+        DissonanceMeeterAudioProcessor processor;
+
+        auto timePrepare = [&] (double sr, int blockSize, int& allocations) -> double
+        {
+            RealtimeSafety::ScopedAudioThreadGuard guard;
+            const auto start = juce::Time::getHighResolutionTicks();
+            processor.prepareToPlay (sr, blockSize);
+            const auto end = juce::Time::getHighResolutionTicks();
+            allocations = guard.getTotal().allocations;
+            return juce::Time::highResolutionTicksToSeconds (end - start) * 1000.0;
+        };
+
+        int allocations = 0;
+
+        beginTest ("Prima prepareToPlay");
+        const double firstMs = timePrepare (48000.0, maxBlockSize, allocations);
+        logMessage ("prepareToPlay iniziale: " + juce::String (firstMs, 3) + " ms");
+
+        beginTest ("Stessa configurazione: solo reset, nessuna allocazione");
+        {
+            const double againMs = timePrepare (48000.0, maxBlockSize, allocations);
+            logMessage ("prepareToPlay ripetuta: " + juce::String (againMs, 3) + " ms");
+            expectEquals (allocations, 0);
+        }
+
+        beginTest ("Cambio di buffer size: nessuna allocazione");
+        timePrepare (48000.0, maxBlockSize / 2, allocations);
+        expectEquals (allocations, 0);
+
+        juce::AudioBuffer<float> buffer (2, maxBlockSize);
+        juce::MidiBuffer midi;
+        int n = 0;
+
+        // Violazioni totali (allocazioni, deallocazioni, lock) con il dettaglio
+        // per stadio di processBlock
+        juce::String violatingStages;
+        auto processBlocks = [&] (double sr, int numBlocks) -> int
+        {
+            RealtimeSafety::ScopedAudioThreadGuard guard;
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                    for (int i = 0; i < maxBlockSize; ++i)
+                        buffer.setSample (ch, i, 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * 440.0 * (n + i) / sr)
+                                               + 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * 550.0 * (n + i) / sr));
+                n += maxBlockSize;
+                processor.processBlock (buffer, midi);
+            }
+
+            const int total = guard.getTotal().total();
+            violatingStages.clear();
+            for (int s = 0; s < guard.getNumStages(); ++s)
+                violatingStages << guard.getStageName (s) << " ";
+            return total;
+        };
+
+        using Engine = DissonanceMeeterAudioProcessor::DissonanceEngine;
+        using Mode   = DissonanceMeeterAudioProcessor::InputMode;
+
+        for (double sr : { 48000.0, 96000.0 })
+        {
+            processor.prepareToPlay (sr, maxBlockSize);
+
+            for (auto mode : { Mode::ExternalInput, Mode::Oscillator })
+                for (auto engine : { Engine::Spectral, Engine::TimeDomain })
+                {
+                    processor.setInputMode (mode);
+                    processor.setDissonanceEngine (engine);
+
+                    beginTest ("processBlock realtime-safe a " + juce::String (sr) + " Hz"
+                               + (mode == Mode::Oscillator ? " (oscillatore" : " (ingresso esterno")
+                               + (engine == Engine::TimeDomain ? ", dominio del tempo)" : ", spettrale)"));
+                    expectEquals (processBlocks (sr, 40), 0, "Stadi: " + violatingStages);
+                }
+        }
+
+        processor.releaseResources();
+    }
+};
+
+//==============================================================================
+// TEST 20 - RealtimeSafety: rilevatore di allocazioni e lock
+//
+// Il guard deve contare allocazioni, deallocazioni e (su Linux) lock per
+// stadio, ignorare tutto quando non e' attivo e propagare i conteggi dei
+// guard annidati a quello esterno.
+//==============================================================================
+class RealtimeSafetyGuardTest : public juce::UnitTest
+{
+public:
+    RealtimeSafetyGuardTest()
+        : juce::UnitTest ("RealtimeSafety - Rilevatore", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        using namespace RealtimeSafety;
+
+        beginTest ("Allocazioni e deallocazioni contate per stadio");
+        {
+            ScopedAudioThreadGuard guard;
+            {
+                // Chiamate esplicite: una new-expression seguita da delete
+                // potrebbe essere eliminata dal compilatore
+                ScopedStage stage ("allocating");
+                ::operator delete (::operator new (16));
+            }
+            {
+                ScopedStage stage ("clean");
+                volatile int x = 0;
+                x = x + 1;
+            }
+
+            const auto allocating = guard.getStage ("allocating");
+            expectEquals (allocating.allocations, 1);
+            expectEquals (allocating.deallocations, 1);
+            expectEquals (guard.getStage ("clean").total(), 0);
+        }
+
+        beginTest ("Nessun conteggio senza guard attivo");
+        {
+            ScopedAudioThreadGuard guard;
+            Violations before = guard.getTotal();
+            {
+                // Guard annidato e distrutto prima dell'allocazione: i conteggi
+                // tornano a quello esterno
+                ScopedAudioThreadGuard inner;
+            }
+            std::vector<float> v (128);
+            expectEquals (guard.getTotal().allocations, before.allocations + 1);
+        }
+
+        beginTest ("I guard annidati propagano i conteggi");
+        {
+            ScopedAudioThreadGuard outer;
+            {
+                ScopedAudioThreadGuard inner;
+                ScopedStage stage ("inner stage");
+                ::operator delete (::operator new (16));
+            }
+            expectEquals (outer.getStage ("inner stage").allocations, 1);
+            expectEquals (outer.getStage ("inner stage").deallocations, 1);
+        }
+
+       #if REALTIME_SAFETY_DETECT_LOCKS
+        beginTest ("Lock rilevati (std::mutex e juce::CriticalSection)");
+        {
+            std::mutex mutex;
+            juce::CriticalSection section;
+
+            ScopedAudioThreadGuard guard;
+            {
+                ScopedStage stage ("locking");
+                { std::lock_guard<std::mutex> lock (mutex); }
+                { const juce::ScopedLock lock (section); }
+            }
+            expectEquals (guard.getStage ("locking").locks, 2);
+
+            {
+                ScopedStage stage ("tolerated");
+                ScopedToleratedLocks tolerated;
+                const juce::ScopedLock lock (section);
+            }
+            expectEquals (guard.getStage ("tolerated").locks, 0);
+            expectEquals (guard.getStage ("tolerated").toleratedLocks, 1);
+            expectEquals (guard.getStage ("tolerated").total(), 0);
+        }
+       #endif
+    }
+};
+
+//==============================================================================
+// TEST 21 - StageProfiler: istogrammi e percentili
+//
+// Con carichi noti p50/p99/max devono cadere nel bin giusto (risoluzione di
+// 1/8 di ottava); da disattivato lo ScopedTimer non registra nulla.
+//==============================================================================
+class StageProfilerTest : public juce::UnitTest
+{
+public:
+    StageProfilerTest()
+        : juce::UnitTest ("StageProfiler - Percentili", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        constexpr double sr        = 48000.0;
+        constexpr int    blockSize = 480;   // scadenza 10 ms
+
+        StageProfiler profiler;
+        profiler.prepare (sr);
+
+        const double ticksPerSecond = (double) juce::Time::getHighResolutionTicksPerSecond();
+        auto ticksForPercent = [&] (double percent)
+        {
+            return (juce::int64) std::llround (percent / 100.0 * blockSize / sr * ticksPerSecond);
+        };
+
+        beginTest ("p50 / p99 / max di una distribuzione nota");
+        {
+            for (int i = 0; i < 985; ++i)
+                profiler.record (StageProfiler::Chain, ticksForPercent (10.0), blockSize);
+            for (int i = 0; i < 15; ++i)
+                profiler.record (StageProfiler::Chain, ticksForPercent (80.0), blockSize);
+
+            const auto summary = profiler.getSummary (StageProfiler::Chain);
+            const float binTolerance = std::exp2 (1.0f / StageProfiler::BINS_PER_OCTAVE);
+
+            expectEquals ((int) summary.count, 1000);
+            expectWithinAbsoluteError (summary.max, 80.0f, 0.01f);
+            expect (summary.p50 > 10.0f / binTolerance && summary.p50 < 10.0f * binTolerance,
+                "p50=" + juce::String (summary.p50));
+            expect (summary.p99 > 80.0f / binTolerance && summary.p99 <= 80.0f,
+                "p99=" + juce::String (summary.p99));
+            expectEquals ((int) profiler.getSummary (StageProfiler::Meters).count, 0);
+        }
+
+        beginTest ("reset() azzera gli istogrammi");
+        profiler.reset();
+        expectEquals ((int) profiler.getSummary (StageProfiler::Chain).count, 0);
+        expectEquals (profiler.getSummary (StageProfiler::Chain).max, 0.0f);
+
+        beginTest ("Disattivato: ScopedTimer non registra");
+        {
+            { StageProfiler::ScopedTimer timer (profiler, StageProfiler::Total, blockSize); }
+            expectEquals ((int) profiler.getSummary (StageProfiler::Total).count, 0);
+
+            profiler.setEnabled (true);
+            { StageProfiler::ScopedTimer timer (profiler, StageProfiler::Total, blockSize); }
+            expectEquals ((int) profiler.getSummary (StageProfiler::Total).count, 1);
+        }
+
+        beginTest ("Analizzatore: tick dei frame solo con la misura abilitata");
+        {
+            DissonanceAnalyser analyser;
+            analyser.prepare (48000.0);
+            auto feed = [&analyser]
+            {
+                for (int n = 0; n < 4800; ++n)
+                    analyser.pushSample (0.3f * (float) std::sin (0.0576 * n));
+            };
+
+            feed();
+            expectGreaterThan ((int) analyser.getFrameCount(), 0);
+            expectEquals (analyser.getFrameTimings().numFrames, 0);
+            expectEquals ((juce::int64) analyser.getFrameTimings().totalTicks, (juce::int64) 0);
+
+            analyser.clearFrameTimings();
+            analyser.setFrameTimingEnabled (true);
+            feed();
+            expectGreaterThan (analyser.getFrameTimings().numFrames, 0);
+            expectGreaterThan ((juce::int64) analyser.getFrameTimings().totalTicks, (juce::int64) 0);
+        }
+    }
+};
+
+//==============================================================================
+// TEST 22 - TraceRecorder: export Chrome trace
+//
+// Il file prodotto deve essere JSON valido con coppie B/E ordinate per
+// thread; la registrazione sul thread audio non deve allocare.
+//==============================================================================
+class TraceRecorderTest : public juce::UnitTest
+{
+public:
+    TraceRecorderTest()
+        : juce::UnitTest ("TraceRecorder - Chrome trace", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        juce::TemporaryFile temp (".json");
+
+        beginTest ("Eventi di due thread, JSON valido");
+        {
+            TraceRecorder tracer;
+            expect (tracer.start (temp.getFile()));
+
+            for (int i = 0; i < 10; ++i)
+                TraceRecorder::ScopedEvent e (tracer, "outer");
+
+            juce::Thread::launch ([&tracer]
+            {
+                TraceRecorder::ScopedEvent e (tracer, "worker");
+            });
+            juce::Thread::sleep (100);
+            tracer.stop();
+
+            const auto json = juce::JSON::parse (temp.getFile());
+            const auto* events = json["traceEvents"].getArray();
+            expect (events != nullptr, "traceEvents mancante");
+
+            if (events != nullptr)
+            {
+                int begins = 0, ends = 0, workers = 0, names = 0;
+                std::map<int, double> lastTs;
+                bool ordered = true;
+
+                for (const auto& e : *events)
+                {
+                    const auto phase = e["ph"].toString();
+                    const int tid = (int) e["tid"];
+                    if (phase == "M")  { ++names; continue; }
+                    if (phase == "B")  ++begins;
+                    if (phase == "E")  ++ends;
+                    if (e["name"].toString() == "worker") ++workers;
+
+                    const double ts = (double) e["ts"];
+                    if (lastTs.count (tid) != 0 && ts < lastTs[tid])
+                        ordered = false;
+                    lastTs[tid] = ts;
+                }
+
+                expectEquals (begins, 11);
+                expectEquals (ends, 11);
+                expectEquals (workers, 2);
+                expectEquals (names, 2);
+                expect (ordered, "timestamp non monotoni su un thread");
+            }
+            expectEquals (json["otherData"]["droppedEvents"].toString(), juce::String ("0"));
+        }
+
+        beginTest ("Ring pieno: eventi scartati e contati");
+        {
+            TraceRecorder tracer;
+            expect (tracer.start (temp.getFile()));
+            for (int i = 0; i < TraceRecorder::RING_SIZE; ++i)
+                TraceRecorder::ScopedEvent e (tracer, "burst");
+            tracer.stop();
+
+            // Il writer puo' aver svuotato il ring a meta': niente scarti in
+            // quel caso, ma mai eventi persi senza conteggio
+            const auto json = juce::JSON::parse (temp.getFile());
+            const int written = json["traceEvents"].getArray()->size() - 1;   // - thread_name
+            const int dropped = json["otherData"]["droppedEvents"].toString().getIntValue();
+            expectEquals (written + dropped, 2 * TraceRecorder::RING_SIZE);
+        }
+
+        beginTest ("Ring liberati a ogni stop(): thread sempre nuovi non esauriscono i ring");
+        {
+            TraceRecorder tracer;
+            for (int recording = 0; recording < 3; ++recording)
+            {
+                expect (tracer.start (temp.getFile()));
+
+                // MAX_THREADS thread diversi per registrazione, come un pool che ruota
+                std::vector<std::unique_ptr<juce::Thread>> threads;
+                for (int t = 0; t < TraceRecorder::MAX_THREADS; ++t)
+                {
+                    threads.push_back (std::make_unique<EventThread> (tracer));
+                    threads.back()->startThread();
+                }
+                for (auto& t : threads)
+                    t->stopThread (1000);
+
+                tracer.stop();
+
+                const auto json = juce::JSON::parse (temp.getFile());
+                expectEquals (json["otherData"]["droppedEvents"].toString().getIntValue(), 0);
+                int workerEvents = 0;
+                for (auto& e : *json["traceEvents"].getArray())
+                    workerEvents += e["name"].toString() == "worker" ? 1 : 0;
+                expectEquals (workerEvents, TraceRecorder::MAX_THREADS * 2);
+            }
+        }
+
+        beginTest ("Sessioni: un evento a cavallo di stop() e start() resta fuori dalla traccia nuova");
+        {
+            juce::TemporaryFile second (".json");
+            TraceRecorder tracer;
+            expect (tracer.start (temp.getFile()));
+            {
+                TraceRecorder::ScopedEvent stale (tracer, "stale");
+                tracer.stop();
+                expect (tracer.start (second.getFile()));
+                TraceRecorder::ScopedEvent fresh (tracer, "fresh");
+            }
+            tracer.stop();
+
+            const auto text = second.getFile().loadFileAsString();
+            expect (! text.contains ("\"stale\""), "evento della sessione precedente nella traccia nuova");
+            expect (text.contains ("\"name\":\"fresh\",\"ph\":\"B\""));
+            expect (text.contains ("\"name\":\"fresh\",\"ph\":\"E\""));
+            expect (temp.getFile().loadFileAsString().contains ("\"name\":\"stale\",\"ph\":\"B\""));
+        }
+
+        beginTest ("processBlock: stadi e analyseFrame, senza allocazioni ne' lock");
+        {
+            DissonanceMeeterAudioProcessor processor;
+            processor.prepareToPlay (48000.0, 512);
+            processor.setInputMode (DissonanceMeeterAudioProcessor::InputMode::Oscillator);
+
+            juce::AudioBuffer<float> buffer (2, 512);
+            juce::MidiBuffer midi;
+
+            auto& tracer = processor.getTracer();
+            expect (tracer.start (temp.getFile()));
+
+            RealtimeSafety::Violations violations;
+            {
+                RealtimeSafety::ScopedAudioThreadGuard guard (RealtimeSafety::Mode::Count);
+                for (int b = 0; b < 20; ++b)
+                    processor.processBlock (buffer, midi);
+                violations = guard.getTotal();
+            }
+            expectEquals (violations.total(), 0, "allocazioni o lock sul thread audio");
+
+            tracer.stop();
+            processor.releaseResources();
+
+            const auto text = temp.getFile().loadFileAsString();
+            for (auto* eventName : { "processBlock", "oscillator", "analyser", "analyseFrame",
+                                     "chain", "gain/clip", "meters", "waveform" })
+                expect (text.contains ("\"name\":\"" + juce::String (eventName) + "\""),
+                        juce::String ("evento mancante: ") + eventName);
+        }
+    }
+
+private:
+    // Un evento B/E e termina
+    struct EventThread  : public juce::Thread
+    {
+        explicit EventThread (TraceRecorder& t) : juce::Thread ("trace test"), tracer (t) {}
+        void run() override { TraceRecorder::ScopedEvent e (tracer, "worker"); }
+        TraceRecorder& tracer;
+    };
+};
+
+//==============================================================================
+// TEST 23 - Riposo sul silenzio e gate di stazionarieta'
+//
+// Gli stadi dormono solo dopo che il loro stato e' decaduto e al risveglio
+// si comportano come un'istanza appena preparata (nessun click); il gate
+// spettrale allunga l'hop su un bordone statico senza cambiare il valore.
+//==============================================================================
+class SilenceAndStationarityTest : public juce::UnitTest
+{
+public:
+    SilenceAndStationarityTest()
+        : juce::UnitTest ("Silenzio e stazionarieta' - Riposo degli stadi", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        constexpr double sr        = 48000.0;
+        constexpr int    blockSize = 512;
+
+        beginTest ("ActivityDetector: isteresi e risveglio immediato");
+        {
+            ActivityDetector detector;
+            detector.prepare (sr, 0.1);   // 4800 campioni
+
+            bool silent = false;
+            for (int b = 0; b < 9; ++b)
+                silent = detector.update (0.0f, blockSize);
+            expect (! silent, "silenzioso prima del tempo di tenuta");
+            expect (detector.update (0.0f, blockSize), "non silenzioso dopo il tempo di tenuta");
+            expect (! detector.update (0.01f, blockSize), "nessun risveglio al primo blocco attivo");
+        }
+
+        beginTest ("Distortion: riposo dopo il decadimento dell'ODE, risveglio senza click");
+        {
+            Distortion sleeper, fresh;
+            for (auto* d : { &sleeper, &fresh })
+            {
+                d->setPlayConfigDetails (2, 2, sr, blockSize);
+                d->prepareToPlay (sr, blockSize);
+                d->treeState.getParameter ("A")->setValueNotifyingHost (0.6f);
+            }
+
+            runBlocks (sleeper, sr, (int) sr / 2, 220.0f);
+            runBlocks (sleeper, sr, (int) sr * 3, 0.0f);
+            expect (sleeper.isSleeping(), "Distortion non a riposo dopo 3 s di silenzio");
+
+            // Istanza di riferimento: stato nullo, drive gia' a regime
+            runBlocks (fresh, sr, blockSize * 4, 0.0f);
+            expect (! fresh.isSleeping());
+
+            expectLessThan (maxDifferenceAfterWake (sleeper, fresh, sr), 1.0e-4f);
+            expect (! sleeper.isSleeping(), "Distortion non risvegliata dal segnale");
+        }
+
+        beginTest ("BandPass: riposo dopo il decadimento dei biquad, risveglio senza click");
+        {
+            BandPassFilter sleeper, fresh;
+            for (auto* f : { &sleeper, &fresh })
+            {
+                f->setPlayConfigDetails (2, 2, sr, blockSize);
+                f->prepareToPlay (sr, blockSize);
+            }
+
+            runBlocks (sleeper, sr, (int) sr / 2, 40.0f);
+            runBlocks (sleeper, sr, (int) sr * 2, 0.0f);
+            expect (sleeper.isSleeping(), "BandPass non a riposo dopo 2 s di silenzio");
+            expectEquals (sleeper.getBandIntensityDb(), -100.0f);
+
+            runBlocks (fresh, sr, blockSize, 0.0f);
+            expectLessThan (maxDifferenceAfterWake (sleeper, fresh, sr), 1.0e-4f);
+            expect (! sleeper.isSleeping(), "BandPass non risvegliato dal segnale");
+        }
+
+        beginTest ("DissonanceAnalyser: hop allungato su spettro stazionario, stesso valore");
+        {
+            DissonanceAnalyser gated, ungated;
+            gated.prepare (sr);
+            ungated.prepare (sr);
+            expect (! ungated.isStationarityGateEnabled(), "gate attivo di default");
+            gated.setStationarityGate (true);
+
+            auto feed = [&] (float f1, float f2, int numSamples, int offset)
+            {
+                for (int n = 0; n < numSamples; ++n)
+                {
+                    const double t = (double) (offset + n) / sr;
+                    const float x = 0.4f * (float) std::sin (juce::MathConstants<double>::twoPi * f1 * t)
+                                  + 0.4f * (float) std::sin (juce::MathConstants<double>::twoPi * f2 * t);
+                    gated.pushSample (x);
+                    ungated.pushSample (x);
+                }
+            };
+
+            // Quinta: parziali risolti, spettro d'ampiezza costante da frame a frame
+            feed (440.0f, 660.0f, (int) sr * 2, 0);
+            expectEquals (gated.getHopMultiple(), DissonanceAnalyser::MAX_HOP_MULTIPLE);
+            expectWithinAbsoluteError (gated.getDissonance(), ungated.getDissonance(), 0.02f);
+
+            // Cambio di intervallo (battimento a 26 Hz, non stazionario): l'hop
+            // torna a mezzo frame e il valore segue
+            feed (440.0f, 466.0f, (int) sr / 4, (int) sr * 2);
+            expectLessThan (gated.getHopMultiple(), DissonanceAnalyser::MAX_HOP_MULTIPLE);
+            expectWithinAbsoluteError (gated.getDissonance(), ungated.getDissonance(), 0.02f);
+        }
+
+        beginTest ("Processor: analizzatori a riposo sul silenzio, risveglio nel blocco");
+        {
+            DissonanceMeeterAudioProcessor processor;
+            processor.prepareToPlay (sr, blockSize);
+            processor.setInputMode (DissonanceMeeterAudioProcessor::InputMode::ExternalInput);
+
+            juce::AudioBuffer<float> buffer (2, blockSize);
+            juce::MidiBuffer midi;
+            for (int b = 0; b < (int) sr / blockSize; ++b)
+            {
+                buffer.clear();
+                processor.processBlock (buffer, midi);
+            }
+            expect (processor.isAnalysisAsleep(), "analizzatori non a riposo dopo 1 s di silenzio");
+
+            for (int ch = 0; ch < 2; ++ch)
+                for (int n = 0; n < blockSize; ++n)
+                    buffer.setSample (ch, n, 0.5f * (float) std::sin (0.05 * n));
+            processor.processBlock (buffer, midi);
+            expect (! processor.isAnalysisAsleep(), "analizzatori non risvegliati dal segnale");
+            processor.releaseResources();
+        }
+    }
+
+private:
+    // Blocchi stereo di una sinusoide (0 Hz = silenzio)
+    template <typename Stage>
+    static void runBlocks (Stage& stage, double sr, int numSamples, float freq)
+    {
+        constexpr int blockSize = 512;
+        juce::AudioBuffer<float> buffer (2, blockSize);
+        juce::MidiBuffer midi;
+
+        for (int start = 0; start < numSamples; start += blockSize)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                for (int n = 0; n < blockSize; ++n)
+                    buffer.setSample (ch, n, freq > 0.0f
+                        ? 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * freq * (start + n) / sr)
+                        : 0.0f);
+            stage.processBlock (buffer, midi);
+        }
+    }
+
+    // Stesso segnale su due stadi: massima differenza d'uscita
+    template <typename Stage>
+    static float maxDifferenceAfterWake (Stage& a, Stage& b, double sr)
+    {
+        constexpr int blockSize = 512;
+        juce::AudioBuffer<float> bufA (2, blockSize), bufB (2, blockSize);
+        juce::MidiBuffer midi;
+        float maxDiff = 0.0f;
+
+        for (int block = 0; block < 8; ++block)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                for (int n = 0; n < blockSize; ++n)
+                    bufA.setSample (ch, n, 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi
+                                                                     * 330.0 * (block * blockSize + n) / sr));
+            bufB.makeCopyOf (bufA);
+            a.processBlock (bufA, midi);
+            b.processBlock (bufB, midi);
+
+            for (int ch = 0; ch < 2; ++ch)
+                for (int n = 0; n < blockSize; ++n)
+                    maxDiff = juce::jmax (maxDiff, std::abs (bufA.getSample (ch, n) - bufB.getSample (ch, n)));
+        }
+        return maxDiff;
+    }
+};
+
+//==============================================================================
+// TEST 24 - Bypass a costo zero di Distortion e BandPass
+//
+// A dissolvenza conclusa l'uscita e' identica all'ingresso e lo stadio non
+// elabora; la dissolvenza non produce salti e dopo la riattivazione lo
+// stadio converge all'uscita di un'istanza mai bypassata.
+//==============================================================================
+class StageBypassTest : public juce::UnitTest
+{
+public:
+    StageBypassTest()
+        : juce::UnitTest ("Bypass - Distortion e BandPass", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        beginTest ("Distortion disabilitata: uscita identica all'ingresso, ODE ferma");
+        {
+            Distortion dist;
+            prepare (dist);
+            dist.treeState.getParameter ("A")->setValueNotifyingHost (0.6f);
+            process (dist, 0, 4);
+            dist.treeState.getParameter (Distortion::ENABLED_ID)->setValueNotifyingHost (0.0f);
+
+            const float maxStep = process (dist, 4, 4);   // dissolvenza di 20 ms
+            expectLessThan (maxStep, 0.2f);
+            expectEquals (maxDeviationFromInput (dist, 8, 4), 0.0f);
+            expect (dist.isBypassed(), "Distortion non in bypass a dissolvenza conclusa");
+        }
+
+        beginTest ("Distortion con A = 0: bypass senza integrare l'ODE");
+        {
+            Distortion dist;
+            prepare (dist);
+            expectEquals (maxDeviationFromInput (dist, 0, 4), 0.0f);
+            expect (dist.isBypassed(), "ODE integrata con A = 0");
+        }
+
+        beginTest ("Distortion riattivata: converge a un'istanza mai bypassata");
+        {
+            Distortion toggled, reference;
+            for (auto* d : { &toggled, &reference })
+            {
+                prepare (*d);
+                d->treeState.getParameter ("A")->setValueNotifyingHost (0.6f);
+            }
+            toggled.treeState.getParameter (Distortion::ENABLED_ID)->setValueNotifyingHost (0.0f);
+            toggled.reset();
+            process (toggled, 0, 8);
+            process (reference, 0, 8);
+            expect (toggled.isBypassed());
+
+            toggled.treeState.getParameter (Distortion::ENABLED_ID)->setValueNotifyingHost (1.0f);
+            float maxStep = 0.0f, lastDiff = 0.0f;
+            for (int b = 8; b < 40; ++b)
+            {
+                auto [step, diff] = processPair (toggled, reference, b);
+                maxStep = juce::jmax (maxStep, step);
+                lastDiff = diff;
+            }
+            expect (! toggled.isBypassed());
+            expectLessThan (maxStep, 0.2f);
+            expectLessThan (lastDiff, 1.0e-3f);
+        }
+
+        beginTest ("BandPass disabilitato: uscita identica, biquad fermi, livello misurato");
+        {
+            BandPassFilter filter;
+            prepare (filter);
+            process (filter, 0, 4);
+            filter.treeState.getParameter (BandPassFilter::ENABLED_ID)->setValueNotifyingHost (0.0f);
+
+            const float maxStep = process (filter, 4, 4);
+            expectLessThan (maxStep, 0.2f);
+            expectEquals (maxDeviationFromInput (filter, 8, 4), 0.0f);
+            expect (filter.isBypassed(), "BandPass non in bypass a dissolvenza conclusa");
+            expectGreaterThan (filter.getBandIntensityDb(), -20.0f);
+        }
+
+        beginTest ("BandPass riattivato: converge a un'istanza mai bypassata");
+        {
+            BandPassFilter toggled, reference;
+            prepare (toggled);
+            prepare (reference);
+            toggled.treeState.getParameter (BandPassFilter::ENABLED_ID)->setValueNotifyingHost (0.0f);
+            toggled.reset();
+            process (toggled, 0, 8);
+            process (reference, 0, 8);
+
+            toggled.treeState.getParameter (BandPassFilter::ENABLED_ID)->setValueNotifyingHost (1.0f);
+            float maxStep = 0.0f, lastDiff = 0.0f;
+            for (int b = 8; b < 60; ++b)
+            {
+                auto [step, diff] = processPair (toggled, reference, b);
+                maxStep = juce::jmax (maxStep, step);
+                lastDiff = diff;
+            }
+            expectLessThan (maxStep, 0.2f);
+            expectLessThan (lastDiff, 1.0e-3f);
+        }
+    }
+
+private:
+    static constexpr double sr        = 48000.0;
+    static constexpr int    blockSize = 256;
+
+    template <typename Stage>
+    static void prepare (Stage& stage)
+    {
+        stage.setPlayConfigDetails (2, 2, sr, blockSize);
+        stage.prepareToPlay (sr, blockSize);
+    }
+
+    // Blocco 'index' di una sinusoide a 200 Hz, identico su due canali
+    static void fill (juce::AudioBuffer<float>& buffer, int index)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int n = 0; n < blockSize; ++n)
+                buffer.setSample (ch, n, 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi
+                                                                  * 200.0 * (index * blockSize + n) / sr));
+    }
+
+    // Elabora 'count' blocchi; restituisce il massimo salto fra campioni consecutivi
+    template <typename Stage>
+    static float process (Stage& stage, int first, int count)
+    {
+        juce::AudioBuffer<float> buffer (2, blockSize);
+        juce::MidiBuffer midi;
+        float maxStep = 0.0f, previous = 0.0f;
+        bool  hasPrevious = false;
+
+        for (int b = first; b < first + count; ++b)
+        {
+            fill (buffer, b);
+            stage.processBlock (buffer, midi);
+            for (int n = 0; n < blockSize; ++n)
+            {
+                const float y = buffer.getSample (0, n);
+                if (hasPrevious)
+                    maxStep = juce::jmax (maxStep, std::abs (y - previous));
+                previous = y;
+                hasPrevious = true;
+            }
+        }
+        return maxStep;
+    }
+
+    template <typename Stage>
+    static float maxDeviationFromInput (Stage& stage, int first, int count)
+    {
+        juce::AudioBuffer<float> buffer (2, blockSize), input (2, blockSize);
+        juce::MidiBuffer midi;
+        float maxDeviation = 0.0f;
+
+        for (int b = first; b < first + count; ++b)
+        {
+            fill (buffer, b);
+            input.makeCopyOf (buffer);
+            stage.processBlock (buffer, midi);
+            for (int ch = 0; ch < 2; ++ch)
+                for (int n = 0; n < blockSize; ++n)
+                    maxDeviation = juce::jmax (maxDeviation, std::abs (buffer.getSample (ch, n) - input.getSample (ch, n)));
+        }
+        return maxDeviation;
+    }
+
+    // Stesso blocco su due stadi: {salto massimo in 'a', differenza massima a - b}
+    template <typename Stage>
+    static std::pair<float, float> processPair (Stage& a, Stage& b, int index)
+    {
+        juce::AudioBuffer<float> bufA (2, blockSize), bufB (2, blockSize);
+        juce::MidiBuffer midi;
+        fill (bufA, index);
+        bufB.makeCopyOf (bufA);
+        a.processBlock (bufA, midi);
+        b.processBlock (bufB, midi);
+
+        float maxStep = 0.0f, maxDiff = 0.0f;
+        for (int n = 0; n < blockSize; ++n)
+        {
+            if (n > 0)
+                maxStep = juce::jmax (maxStep, std::abs (bufA.getSample (0, n) - bufA.getSample (0, n - 1)));
+            maxDiff = juce::jmax (maxDiff, std::abs (bufA.getSample (0, n) - bufB.getSample (0, n)));
+        }
+        return { maxStep, maxDiff };
+    }
+};
+
+//==============================================================================
+// TEST 25 - Layout unico dei parametri e automazione a campione esatto
+//
+// Tutti i controlli sono parametri del processor; un cambio programmato al
+// campione N da' la stessa uscita di un blocco spezzato a mano in N, con
+// qualunque dimensione dei blocchi dell'host. Lo stato si salva in un unico
+// albero e il formato precedente (un albero per stadio) si ricarica.
+//==============================================================================
+class SampleAccurateAutomationTest : public juce::UnitTest
+{
+public:
+    SampleAccurateAutomationTest()
+        : juce::UnitTest ("Automazione - parametri a campione esatto", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        beginTest ("Layout unico: parametri di stadi e processor, setter e getter");
+        {
+            DissonanceMeeterAudioProcessor processor;
+            auto& state = processor.getParameterState();
+
+            for (auto* id : { BandPassFilter::CENTER_FREQ_ID, BandPassFilter::Q_FACTOR_ID, BandPassFilter::ENABLED_ID,
+                              Distortion::A_ID, Distortion::GAMMA_OMEGA_ID, Distortion::ENABLED_ID,
+                              DissonanceMeeterAudioProcessor::INPUT_MODE_ID, DissonanceMeeterAudioProcessor::OSC1_FREQ_ID,
+                              DissonanceMeeterAudioProcessor::OSC2_FREQ_ID, DissonanceMeeterAudioProcessor::OUTPUT_GAIN_ID,
+                              DissonanceMeeterAudioProcessor::METER_SMOOTHING_ID, DissonanceMeeterAudioProcessor::NUM_OSC_VOICES_ID,
+                              DissonanceMeeterAudioProcessor::STAGE_ORDER_ID, DissonanceMeeterAudioProcessor::CHANNEL_ANALYSIS_ID,
+                              DissonanceMeeterAudioProcessor::ANALYSIS_FRAME_ID, DissonanceMeeterAudioProcessor::FREQUENCY_ESTIMATOR_ID,
+                              DissonanceMeeterAudioProcessor::DISSONANCE_MODEL_ID, DissonanceMeeterAudioProcessor::PARTIAL_GROUPING_ID,
+                              DissonanceMeeterAudioProcessor::LOW_LATENCY_ID, DissonanceMeeterAudioProcessor::STATIONARITY_GATE_ID,
+                              DissonanceMeeterAudioProcessor::MIDI_TIMBRE_ID, DissonanceMeeterAudioProcessor::DISSONANCE_ENGINE_ID })
+                expect (state.getParameter (id) != nullptr, juce::String ("parametro mancante: ") + id);
+
+            // Voci 1 e 2: la frequenza e' OSC1/OSC2_FREQ; le altre hanno la propria
+            for (int v = 0; v < OscillatorBank::MAX_VOICES; ++v)
+                for (auto voiceParameter : { DissonanceMeeterAudioProcessor::VoiceParameter::Frequency,
+                                             DissonanceMeeterAudioProcessor::VoiceParameter::Gain,
+                                             DissonanceMeeterAudioProcessor::VoiceParameter::Partials,
+                                             DissonanceMeeterAudioProcessor::VoiceParameter::Rolloff })
+                    expect (state.getParameter (DissonanceMeeterAudioProcessor::getVoiceParameterID (v, voiceParameter)) != nullptr);
+
+            expectEquals (processor.getParameters().size(), 52);
+            expect (&processor.getDistortion().treeState == &state, "Distortion non legata al layout del processor");
+            expect (&processor.getBandPass().treeState == &state, "BandPass non legato al layout del processor");
+
+            processor.setOscillatorFrequencies (440.0f, 466.0f);
+            processor.setInputMode (DissonanceMeeterAudioProcessor::InputMode::Oscillator);
+            processor.setOutputGain (2.5f);
+            processor.setMeterSmoothing (0.2f);
+            expectWithinAbsoluteError (processor.getOscillatorFrequencies().first, 440.0f, 0.01f);
+            expectWithinAbsoluteError (processor.getOscillatorFrequencies().second, 466.0f, 0.01f);
+            expect (processor.getInputMode() == DissonanceMeeterAudioProcessor::InputMode::Oscillator);
+            expectWithinAbsoluteError (processor.getOutputGain(), 2.5f, 1.0e-4f);
+            expectWithinAbsoluteError (processor.getMeterSmoothing(), 0.2f, 1.0e-4f);
+        }
+
+        beginTest ("Cambi programmati: uscita identica al blocco spezzato a mano, per ogni dimensione di blocco");
+        {
+            const auto reference = renderSplitByHand();
+
+            for (int blockSize : { 512, 37, 4096 })
+            {
+                DissonanceMeeterAudioProcessor processor;
+                setUp (processor);
+                expect (processor.scheduleParameterChange (Distortion::A_ID, 3000.0f, 1000));
+                expect (processor.scheduleParameterChange (BandPassFilter::CENTER_FREQ_ID, 500.0f, 1500));
+                expect (processor.scheduleParameterChange (DissonanceMeeterAudioProcessor::OUTPUT_GAIN_ID, 2.0f, 3001));
+
+                const auto output = render (processor, blockSize);
+                expectEquals (maxDifference (output, reference), 0.0f,
+                              "uscita diversa con blocchi da " + juce::String (blockSize));
+                expectWithinAbsoluteError (processor.getOutputGain(), 2.0f, 1.0e-4f);
+                processor.releaseResources();
+            }
+        }
+
+        beginTest ("Sweep degli oscillatori automatizzabile");
+        {
+            DissonanceMeeterAudioProcessor processor;
+            setUp (processor);
+            processor.setInputMode (DissonanceMeeterAudioProcessor::InputMode::Oscillator);
+            expect (! processor.scheduleParameterChange ("NON_ESISTE", 1.0f, 0));
+
+            for (int step = 0; step <= 16; ++step)
+                expect (processor.scheduleParameterChange (DissonanceMeeterAudioProcessor::OSC1_FREQ_ID,
+                                                           200.0f + 12.5f * (float) step, 240 * step));
+
+            render (processor, 512);
+            expectWithinAbsoluteError (processor.getOscillatorFrequencies().first, 400.0f, 0.01f);
+            expectWithinAbsoluteError (processor.getOscillatorFrequencies().second, 220.0f, 0.01f);
+            processor.releaseResources();
+
+            // Lo stato salvato vede il valore applicato dal thread audio
+            juce::MemoryBlock data;
+            processor.getStateInformation (data);
+            DissonanceMeeterAudioProcessor restored;
+            restored.setStateInformation (data.getData(), (int) data.getSize());
+            expectWithinAbsoluteError (restored.getOscillatorFrequencies().first, 400.0f, 0.01f);
+        }
+
+        beginTest ("Motore, opzioni di analisi, ordine degli stadi e voci: parametri salvati nello stato");
+        {
+            DissonanceMeeterAudioProcessor processor;
+            processor.setDissonanceEngine (DissonanceMeeterAudioProcessor::DissonanceEngine::Cross);
+            processor.setChannelAnalysis (DissonanceMeeterAudioProcessor::ChannelAnalysis::PerChannel);
+            processor.setAnalysisFrameOrder (DissonanceAnalyser::MIN_FFT_ORDER);
+            processor.setFrequencyEstimator (DissonanceAnalyser::FrequencyEstimator::Reassignment);
+            processor.setDissonanceModel (DissonanceModel::Vassilakis);
+            processor.setPartialGrouping (DissonanceAnalyser::PartialGrouping::Harmonic);
+            processor.setLowLatencyMode (true);
+            processor.setStationarityGate (true);
+            processor.setMidiTimbre (MidiDissonanceEstimator::Timbre::Square);
+            expect (processor.setStageOrder ({ DissonanceMeeterAudioProcessor::BANDPASS_STAGE,
+                                               DissonanceMeeterAudioProcessor::DISTORTION_STAGE }));
+            processor.setNumOscillatorVoices (3);
+            OscillatorBank::Voice third;
+            third.frequency = 660.0f;
+            third.gain = 0.5f;
+            third.numPartials = 6;
+            third.rolloff = 1.5f;
+            processor.setOscillatorVoice (2, third);
+
+            juce::MemoryBlock data;
+            processor.getStateInformation (data);
+            DissonanceMeeterAudioProcessor restored;
+            restored.setStateInformation (data.getData(), (int) data.getSize());
+
+            expect (restored.getDissonanceEngine() == DissonanceMeeterAudioProcessor::DissonanceEngine::Cross);
+            expect (restored.getChannelAnalysis() == DissonanceMeeterAudioProcessor::ChannelAnalysis::PerChannel);
+            expectEquals (restored.getAnalysisFrameOrder(), (int) DissonanceAnalyser::MIN_FFT_ORDER);
+            expect (restored.getFrequencyEstimator() == DissonanceAnalyser::FrequencyEstimator::Reassignment);
+            expect (restored.getDissonanceModel() == DissonanceModel::Vassilakis);
+            expect (restored.getPartialGrouping() == DissonanceAnalyser::PartialGrouping::Harmonic);
+            expect (restored.getLowLatencyMode());
+            expect (restored.getStationarityGate());
+            expect (restored.getMidiTimbre() == MidiDissonanceEstimator::Timbre::Square);
+            expect (restored.getStageOrder() == DissonanceMeeterAudioProcessor::getStageOrders()[1]);
+            expectEquals (restored.getNumOscillatorVoices(), 3);
+            const auto voice = restored.getOscillatorVoice (2);
+            expectWithinAbsoluteError (voice.frequency, 660.0f, 0.01f);
+            expectWithinAbsoluteError (voice.gain, 0.5f, 1.0e-3f);
+            expectEquals (voice.numPartials, 6);
+            expectWithinAbsoluteError (voice.rolloff, 1.5f, 0.01f);
+
+            // Un'opzione di analisi programmata vale dall'inizio del blocco che la contiene
+            setUp (restored);
+            expect (restored.scheduleParameterChange (DissonanceMeeterAudioProcessor::DISSONANCE_MODEL_ID,
+                                                      (float) DissonanceModel::HutchinsonKnopoff, 700));
+            render (restored, 512);
+            expect (restored.getDissonanceModel() == DissonanceModel::HutchinsonKnopoff);
+            restored.releaseResources();
+        }
+
+        beginTest ("Cambi programmati: l'host li vede dal thread dei messaggi, l'ultimo vince");
+        {
+            struct HostListener  : public juce::AudioProcessorListener
+            {
+                void audioProcessorParameterChanged (juce::AudioProcessor*, int index, float value) override
+                {
+                    if (index == watched)
+                        values.push_back (value);
+                }
+                void audioProcessorChanged (juce::AudioProcessor*, const ChangeDetails&) override {}
+
+                int watched = -1;
+                std::vector<float> values;
+            };
+
+            DissonanceMeeterAudioProcessor processor;
+            setUp (processor);
+            auto* gain = processor.getParameterState().getParameter (DissonanceMeeterAudioProcessor::OUTPUT_GAIN_ID);
+
+            HostListener host;
+            host.watched = gain->getParameterIndex();
+            processor.addListener (&host);
+
+            expect (processor.scheduleParameterChange (DissonanceMeeterAudioProcessor::OUTPUT_GAIN_ID, 3.0f, 100));
+            expect (processor.scheduleParameterChange (DissonanceMeeterAudioProcessor::OUTPUT_GAIN_ID, 5.0f, 1100));
+            juce::AudioBuffer<float> block (2, 512);
+            juce::MidiBuffer midi;
+            block.clear();
+            processor.processBlock (block, midi);
+
+            // Il thread audio applica senza notificare
+            expect (host.values.empty());
+            processor.handleAsyncUpdate();
+            expectEquals ((int) host.values.size(), 1);
+            expectWithinAbsoluteError (host.values.back(), gain->convertTo0to1 (3.0f), 1.0e-6f);
+
+            // 5 e 7 applicati in due blocchi prima della notifica: il passo
+            // superato non viene riportato (ne' rimesso)
+            expect (processor.scheduleParameterChange (DissonanceMeeterAudioProcessor::OUTPUT_GAIN_ID, 7.0f, 1600));
+            for (int b = 0; b < 3; ++b)
+                processor.processBlock (block, midi);
+            processor.handleAsyncUpdate();
+            expectEquals ((int) host.values.size(), 2);
+            expectWithinAbsoluteError (host.values.back(), gain->convertTo0to1 (7.0f), 1.0e-6f);
+            expectWithinAbsoluteError (processor.getOutputGain(), 7.0f, 1.0e-4f);
+
+            processor.removeListener (&host);
+            processor.releaseResources();
+        }
+
+        beginTest ("Stato: un solo albero, ricarica del formato per stadio");
+        {
+            DissonanceMeeterAudioProcessor saved;
+            saved.setOscillatorFrequencies (300.0f, 310.0f);
+            saved.getParameterState().getParameter (Distortion::A_ID)->setValueNotifyingHost (0.5f);
+            juce::MemoryBlock data;
+            saved.getStateInformation (data);
+
+            DissonanceMeeterAudioProcessor restored;
+            restored.setStateInformation (data.getData(), (int) data.getSize());
+            expectWithinAbsoluteError (restored.getOscillatorFrequencies().first, 300.0f, 0.01f);
+            expectWithinAbsoluteError (restored.getParameterState().getParameter (Distortion::A_ID)->getValue(), 0.5f, 1.0e-3f);
+
+            juce::XmlElement legacy ("DissonanceMeeterState");
+            auto addParam = [] (juce::XmlElement& stage, const char* id, double value)
+            {
+                auto* param = stage.createNewChildElement ("PARAM");
+                param->setAttribute ("id", id);
+                param->setAttribute ("value", value);
+            };
+            auto* bandPass = legacy.createNewChildElement ("BandPass");
+            addParam (*bandPass, "CENTER_FREQ", 1000.0);
+            addParam (*bandPass, "ENABLED", 0.0);
+            auto* distortion = legacy.createNewChildElement ("Distortion");
+            addParam (*distortion, "A", 250.0);
+
+            juce::MemoryBlock legacyData;
+            juce::AudioProcessor::copyXmlToBinary (legacy, legacyData);
+
+            DissonanceMeeterAudioProcessor loaded;
+            loaded.setStateInformation (legacyData.getData(), (int) legacyData.getSize());
+            auto& state = loaded.getParameterState();
+            expectWithinAbsoluteError (state.getRawParameterValue (BandPassFilter::CENTER_FREQ_ID)->load(), 1000.0f, 0.01f);
+            expectEquals (state.getRawParameterValue (BandPassFilter::ENABLED_ID)->load(), 0.0f);
+            expectEquals (state.getRawParameterValue (Distortion::ENABLED_ID)->load(), 1.0f);
+            expectWithinAbsoluteError (state.getRawParameterValue (Distortion::A_ID)->load(), 250.0f, 0.1f);
+        }
+    }
+
+private:
+    static constexpr double sr = 44100.0;
+    static constexpr int numRenderSamples = 4096;
+
+    static void setUp (DissonanceMeeterAudioProcessor& processor)
+    {
+        processor.setInputMode (DissonanceMeeterAudioProcessor::InputMode::ExternalInput);
+        processor.getParameterState().getParameter (Distortion::A_ID)->setValueNotifyingHost (0.6f);
+        processor.prepareToPlay (sr, 512);
+    }
+
+    static float input (int n)
+    {
+        return 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * 220.0 * n / sr);
+    }
+
+    // Processa numRenderSamples campioni a blocchi di lunghezza data
+    static juce::AudioBuffer<float> render (DissonanceMeeterAudioProcessor& processor, int blockSize)
+    {
+        std::vector<int> lengths;
+        for (int done = 0; done < numRenderSamples; done += blockSize)
+            lengths.push_back (juce::jmin (blockSize, numRenderSamples - done));
+        return render (processor, lengths, [] (int) {});
+    }
+
+    template <typename BeforeBlock>
+    static juce::AudioBuffer<float> render (DissonanceMeeterAudioProcessor& processor,
+                                            const std::vector<int>& lengths, BeforeBlock&& beforeBlock)
+    {
+        juce::AudioBuffer<float> output (2, numRenderSamples);
+        juce::MidiBuffer midi;
+        int done = 0;
+
+        for (size_t b = 0; b < lengths.size(); ++b)
+        {
+            beforeBlock ((int) b);
+            juce::AudioBuffer<float> block (2, lengths[b]);
+            for (int ch = 0; ch < 2; ++ch)
+                for (int n = 0; n < lengths[b]; ++n)
+                    block.setSample (ch, n, input (done + n));
+
+            processor.processBlock (block, midi);
+            for (int ch = 0; ch < 2; ++ch)
+                output.copyFrom (ch, done, block, ch, 0, lengths[b]);
+            done += lengths[b];
+        }
+        return output;
+    }
+
+    // Riferimento: blocchi che finiscono esattamente sui campioni dei cambi,
+    // con i parametri impostati tra un blocco e l'altro
+    static juce::AudioBuffer<float> renderSplitByHand()
+    {
+        DissonanceMeeterAudioProcessor processor;
+        setUp (processor);
+        auto& state = processor.getParameterState();
+
+        auto output = render (processor, { 1000, 500, 1501, numRenderSamples - 3001 }, [&] (int block)
+        {
+            if (block == 1)
+                state.getParameter (Distortion::A_ID)->setValueNotifyingHost (
+                    state.getParameter (Distortion::A_ID)->convertTo0to1 (3000.0f));
+            else if (block == 2)
+                state.getParameter (BandPassFilter::CENTER_FREQ_ID)->setValueNotifyingHost (
+                    state.getParameter (BandPassFilter::CENTER_FREQ_ID)->convertTo0to1 (500.0f));
+            else if (block == 3)
+                processor.setOutputGain (2.0f);
+        });
+        processor.releaseResources();
+        return output;
+    }
+
+    static float maxDifference (const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+    {
+        float diff = 0.0f;
+        for (int ch = 0; ch < a.getNumChannels(); ++ch)
+            for (int i = 0; i < a.getNumSamples(); ++i)
+                diff = juce::jmax (diff, std::abs (a.getSample (ch, i) - b.getSample (ch, i)));
+        return diff;
+    }
+};
+
+//==============================================================================
+// TEST 26 - Percorso in doppia precisione
+//
+// Processor e stadi accettano buffer double: stesso algoritmo del percorso
+// float, quindi stessa uscita entro l'errore di arrotondamento del float;
+// l'analizzatore riceve lo stesso segnale e misura la stessa dissonanza.
+//==============================================================================
+class DoublePrecisionTest : public juce::UnitTest
+{
+public:
+    DoublePrecisionTest()
+        : juce::UnitTest ("Doppia precisione - catena e analizzatore", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        beginTest ("Il processor e gli stadi dichiarano la doppia precisione");
+        {
+            DissonanceMeeterAudioProcessor processor;
+            expect (processor.supportsDoublePrecisionProcessing());
+            expect (processor.getDistortion().supportsDoublePrecisionProcessing());
+            expect (processor.getBandPass().supportsDoublePrecisionProcessing());
+        }
+
+        beginTest ("Stadi: uscita double = uscita float entro l'arrotondamento");
+        {
+            Distortion distF, distD;
+            for (auto* d : { &distF, &distD })
+                d->treeState.getParameter (Distortion::A_ID)->setValueNotifyingHost (0.6f);
+            expectLessThan (maxStageDifference (distF, distD), 1.0e-4f);
+
+            BandPassFilter bpF, bpD;
+            for (auto* b : { &bpF, &bpD })
+            {
+                auto* center = b->treeState.getParameter (BandPassFilter::CENTER_FREQ_ID);
+                center->setValueNotifyingHost (center->convertTo0to1 (250.0f));
+            }
+            expectLessThan (maxStageDifference (bpF, bpD), 1.0e-4f);
+        }
+
+        beginTest ("Processor: oscillatore -> catena -> uscita e dissonanza in doppia precisione");
+        {
+            DissonanceMeeterAudioProcessor floatProcessor, doubleProcessor;
+            for (auto* p : { &floatProcessor, &doubleProcessor })
+            {
+                p->setInputMode (DissonanceMeeterAudioProcessor::InputMode::Oscillator);
+                p->setOscillatorFrequencies (440.0f, 466.0f);
+                p->getParameterState().getParameter (Distortion::A_ID)->setValueNotifyingHost (0.4f);
+                p->setProcessingPrecision (p == &doubleProcessor ? juce::AudioProcessor::doublePrecision
+                                                                 : juce::AudioProcessor::singlePrecision);
+                p->prepareToPlay (sr, blockSize);
+            }
+            expect (doubleProcessor.isUsingDoublePrecision());
+
+            juce::AudioBuffer<float>  floatBuffer (2, blockSize);
+            juce::AudioBuffer<double> doubleBuffer (2, blockSize);
+            juce::MidiBuffer midi;
+            float maxDiff = 0.0f;
+            bool  finite = true;
+
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                floatBuffer.clear();
+                doubleBuffer.clear();
+                floatProcessor.processBlock (floatBuffer, midi);
+                doubleProcessor.processBlock (doubleBuffer, midi);
+
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int n = 0; n < blockSize; ++n)
+                    {
+                        const double y = doubleBuffer.getSample (ch, n);
+                        finite = finite && std::isfinite (y);
+                        maxDiff = juce::jmax (maxDiff, (float) std::abs (y - floatBuffer.getSample (ch, n)));
+                    }
+            }
+
+            expect (finite, "NaN/Inf nel percorso double");
+            expectLessThan (maxDiff, 1.0e-3f);
+            expectGreaterThan (doubleProcessor.getOutputLevelRms(), -60.0f);
+            expectWithinAbsoluteError (doubleProcessor.getOutputLevelRms(), floatProcessor.getOutputLevelRms(), 0.01f);
+            expectGreaterThan (doubleProcessor.getDissonance(), 0.0f);
+            expectWithinAbsoluteError (doubleProcessor.getDissonance(), floatProcessor.getDissonance(),
+                                       1.0e-3f * juce::jmax (1.0f, floatProcessor.getDissonance()));
+        }
+
+        beginTest ("Processor: ingresso esterno in double, blocco spezzato dall'automazione");
+        {
+            DissonanceMeeterAudioProcessor floatProcessor, doubleProcessor;
+            for (auto* p : { &floatProcessor, &doubleProcessor })
+            {
+                p->getParameterState().getParameter (Distortion::A_ID)->setValueNotifyingHost (0.4f);
+                p->setProcessingPrecision (p == &doubleProcessor ? juce::AudioProcessor::doublePrecision
+                                                                 : juce::AudioProcessor::singlePrecision);
+                p->prepareToPlay (sr, blockSize);
+                expect (p->scheduleParameterChange (DissonanceMeeterAudioProcessor::OUTPUT_GAIN_ID, 4.0f, 100));
+                expect (p->scheduleParameterChange (BandPassFilter::CENTER_FREQ_ID, 400.0f, 300));
+            }
+
+            juce::AudioBuffer<float>  floatBuffer (2, blockSize);
+            juce::AudioBuffer<double> doubleBuffer (2, blockSize);
+            for (int ch = 0; ch < 2; ++ch)
+                for (int n = 0; n < blockSize; ++n)
+                {
+                    const auto x = (float) (0.5 * std::sin (juce::MathConstants<double>::twoPi * 300.0 * n / sr));
+                    floatBuffer.setSample (ch, n, x);
+                    doubleBuffer.setSample (ch, n, (double) x);
+                }
+
+            juce::MidiBuffer midi;
+            floatProcessor.processBlock (floatBuffer, midi);
+            doubleProcessor.processBlock (doubleBuffer, midi);
+
+            float maxDiff = 0.0f;
+            for (int ch = 0; ch < 2; ++ch)
+                for (int n = 0; n < blockSize; ++n)
+                    maxDiff = juce::jmax (maxDiff, (float) std::abs (doubleBuffer.getSample (ch, n) - floatBuffer.getSample (ch, n)));
+            expectLessThan (maxDiff, 1.0e-3f);
+            expectWithinAbsoluteError (doubleProcessor.getOutputGain(), 4.0f, 1.0e-4f);
+        }
+    }
+
+private:
+    static constexpr double sr        = 48000.0;
+    static constexpr int    blockSize = 512;
+    static constexpr int    numBlocks = 40;
+
+    // Stessa sinusoide a 200 Hz nei due stadi, uno in float e uno in double
+    template <typename Stage>
+    static float maxStageDifference (Stage& floatStage, Stage& doubleStage)
+    {
+        for (auto* stage : { &floatStage, &doubleStage })
+        {
+            stage->setPlayConfigDetails (2, 2, sr, blockSize);
+            stage->prepareToPlay (sr, blockSize);
+        }
+
+        juce::AudioBuffer<float>  floatBuffer (2, blockSize);
+        juce::AudioBuffer<double> doubleBuffer (2, blockSize);
+        juce::MidiBuffer midi;
+        float maxDiff = 0.0f;
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                for (int n = 0; n < blockSize; ++n)
+                {
+                    const double x = 0.5 * std::sin (juce::MathConstants<double>::twoPi * 200.0 * (b * blockSize + n) / sr);
+                    floatBuffer.setSample (ch, n, (float) x);
+                    doubleBuffer.setSample (ch, n, (double) (float) x);
+                }
+
+            floatStage.processBlock (floatBuffer, midi);
+            doubleStage.processBlock (doubleBuffer, midi);
+
+            for (int ch = 0; ch < 2; ++ch)
+                for (int n = 0; n < blockSize; ++n)
+                    maxDiff = juce::jmax (maxDiff, (float) std::abs (doubleBuffer.getSample (ch, n) - floatBuffer.getSample (ch, n)));
+        }
+        return maxDiff;
+    }
+};
+
+//==============================================================================
+// TEST 27 - Banco di oscillatori del segnale di prova
+//
+// Seno polinomiale accurato quanto std::sin in float, voci sinusoidali e
+// armoniche con le ampiezze attese, picco mai sopra 1 senza normalizzazione
+// a blocchi, parziali oltre Nyquist muti; il processor genera accordi.
+//==============================================================================
+class OscillatorBankTest : public juce::UnitTest
+{
+public:
+    OscillatorBankTest()
+        : juce::UnitTest ("Oscillatore - banco di voci vettoriale", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        beginTest ("Seno polinomiale su tutto il periodo");
+        {
+            float maxError = 0.0f;
+            for (int i = 0; i < 10000; ++i)
+            {
+                const float p = (float) i / 10000.0f;
+                maxError = juce::jmax (maxError, std::abs (OscillatorBank::sine (p)
+                                                           - (float) std::sin (juce::MathConstants<double>::twoPi * p)));
+            }
+            expectLessThan (maxError, 1.0e-6f);
+        }
+
+        beginTest ("Due sinusoidi: 0.5 sin + 0.5 sin, come l'oscillatore precedente");
+        {
+            OscillatorBank bank;
+            const OscillatorBank::Voice voices[] = { { 440.0f, 1.0f, 1, 1.0f }, { 466.0f, 1.0f, 1, 1.0f } };
+            bank.setVoices (voices, 2);
+            bank.prepare (sr, 0.02);
+
+            std::vector<float> out (4800);
+            bank.render (out.data(), (int) out.size());
+
+            float maxError = 0.0f;
+            for (size_t n = 0; n < out.size(); ++n)
+                maxError = juce::jmax (maxError, std::abs (out[n] - (float) (0.5 * tone (440.0, n) + 0.5 * tone (466.0, n))));
+            expectLessThan (maxError, 1.0e-3f);
+        }
+
+        beginTest ("Voce armonica: parziali 1/k^rolloff, normalizzati sulla somma");
+        {
+            OscillatorBank bank;
+            const OscillatorBank::Voice voice { 200.0f, 1.0f, 3, 1.0f };
+            bank.setVoices (&voice, 1);
+            bank.prepare (sr, 0.02);
+
+            std::vector<double> out (2400);
+            bank.render (out.data(), (int) out.size());
+
+            const double norm = 1.0 + 1.0 / 2.0 + 1.0 / 3.0;
+            double maxError = 0.0;
+            for (size_t n = 0; n < out.size(); ++n)
+            {
+                const double expected = (tone (200.0, n) + tone (400.0, n) / 2.0 + tone (600.0, n) / 3.0) / norm;
+                maxError = juce::jmax (maxError, std::abs (out[n] - expected));
+            }
+            expectLessThan (maxError, 1.0e-3);
+        }
+
+        beginTest ("Accordo di suoni armonici: picco <= 1; parziali oltre Nyquist muti");
+        {
+            OscillatorBank bank;
+            const OscillatorBank::Voice chord[] = { { 261.63f, 1.0f, 8, 1.0f },
+                                                    { 329.63f, 1.0f, 8, 1.0f },
+                                                    { 392.00f, 1.0f, 8, 1.0f } };
+            bank.setVoices (chord, 3);
+            bank.prepare (sr, 0.02);
+
+            std::vector<float> out ((size_t) sr);
+            bank.render (out.data(), (int) out.size());
+            float peak = 0.0f;
+            for (auto y : out)
+                peak = juce::jmax (peak, std::abs (y));
+            expectLessOrEqual (peak, 1.0f + 1.0e-5f);
+            expectGreaterThan (peak, 0.3f);
+
+            // 15 kHz a 44.1 kHz: solo la fondamentale e' sotto 0.45 * fs
+            const OscillatorBank::Voice high { 15000.0f, 1.0f, 4, 0.0f };
+            bank.setVoices (&high, 1);
+            bank.prepare (44100.0, 0.02);
+            bank.render (out.data(), 4410);
+            peak = 0.0f;
+            for (int n = 0; n < 4410; ++n)
+                peak = juce::jmax (peak, std::abs (out[(size_t) n]));
+            expectWithinAbsoluteError (peak, 0.25f, 1.0e-3f);
+        }
+
+        beginTest ("Glissando: la nuova frequenza e' raggiunta in 20 ms");
+        {
+            OscillatorBank bank, reference;
+            const OscillatorBank::Voice from { 300.0f, 1.0f, 1, 1.0f }, to { 600.0f, 1.0f, 1, 1.0f };
+            bank.setVoices (&from, 1);
+            bank.prepare (sr, 0.02);
+            reference.setVoices (&to, 1);
+            reference.prepare (sr, 0.02);
+
+            // Nessun salto durante il glissando (passo massimo di un seno a 600 Hz),
+            // poi la stessa frequenza del riferimento
+            std::vector<float> glide (960), a (4096), b (4096);
+            bank.setFrequency (0, 600.0f);
+            bank.render (glide.data(), (int) glide.size());
+            reference.render (b.data(), (int) glide.size());
+
+            float maxStep = 0.0f;
+            for (size_t n = 1; n < glide.size(); ++n)
+                maxStep = juce::jmax (maxStep, std::abs (glide[n] - glide[n - 1]));
+            expectLessThan (maxStep, (float) (juce::MathConstants<double>::twoPi * 600.0 / sr));
+
+            bank.render (a.data(), (int) a.size());
+            reference.render (b.data(), (int) b.size());
+            expectWithinAbsoluteError (bank.getFrequency (0), 600.0f, 1.0e-6f);
+            expect (std::abs (countZeroCrossings (a) - countZeroCrossings (b)) <= 1);
+        }
+
+        beginTest ("Processor: accordo di tre voci nel modo oscillatore");
+        {
+            DissonanceMeeterAudioProcessor processor;
+            processor.setInputMode (DissonanceMeeterAudioProcessor::InputMode::Oscillator);
+            processor.setOscillatorVoice (0, { 261.63f, 1.0f, 6, 1.0f });
+            processor.setOscillatorVoice (1, { 277.18f, 1.0f, 6, 1.0f });
+            processor.setOscillatorVoice (2, { 329.63f, 0.5f, 1, 1.0f });
+            processor.setNumOscillatorVoices (3);
+            processor.setMeterSmoothing (1.0f);
+            expectWithinAbsoluteError (processor.getOscillatorFrequencies().second, 277.18f, 0.01f);
+            expectEquals (processor.getOscillatorVoice (0).numPartials, 6);
+            expectEquals (processor.getNumOscillatorVoices(), 3);
+
+            processor.prepareToPlay (sr, 512);
+            juce::AudioBuffer<float> buffer (2, 512);
+            juce::MidiBuffer midi;
+            for (int b = 0; b < 40; ++b)
+            {
+                buffer.clear();
+                processor.processBlock (buffer, midi);
+            }
+
+            // Livello dell'ingresso pulito (PRE DIST): l'accordo, non la catena
+            expectGreaterThan (processor.getPreDistIntensityDb(), -20.0f);
+            expectLessThan (processor.getPreDistIntensityDb(), 0.0f);
+            expectGreaterThan (processor.getDissonance(), 0.0f);
+        }
+    }
+
+private:
+    static constexpr double sr = 48000.0;
+
+    static double tone (double frequency, size_t n)
+    {
+        return std::sin (juce::MathConstants<double>::twoPi * frequency * (double) n / sr);
+    }
+
+    static int countZeroCrossings (const std::vector<float>& x)
+    {
+        int count = 0;
+        for (size_t n = 1; n < x.size(); ++n)
+            count += (x[n - 1] < 0.0f) != (x[n] < 0.0f) ? 1 : 0;
+        return count;
+    }
+};
+
+//==============================================================================
+// TEST 28 - Mappa di dissonanza di un intero file (analisi ARA in background)
+//
+// Un file stereo con una terza e poi una quinta, letto da un
+// AudioFormatReader in memoria: un frame ogni mezzo frame FFT, dissonanza
+// piu' alta nella terza, parziali giusti, interruzione dal progresso e
+// letture fallite che non producono mappe.
+//==============================================================================
+class DissonanceMapTest : public juce::UnitTest
+{
+public:
+    DissonanceMapTest()
+        : juce::UnitTest ("DissonanceMap - analisi di un file intero", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        // 2 s di 440 + 550 Hz, poi 2 s di 440 + 660 Hz (una nota per canale);
+        // df = 110 Hz, risolto dall'FFT come in DissonanceAnalyserSemitoneTest
+        const int length = (int) (4.0 * sr);
+        juce::AudioBuffer<float> file (2, length);
+        for (int n = 0; n < length; ++n)
+        {
+            const bool third = n < length / 2;
+            file.setSample (0, n, 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * 440.0 * n / sr));
+            file.setSample (1, n, 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * (third ? 550.0 : 660.0) * n / sr));
+        }
+
+        beginTest ("Un frame ogni hop su tutto il file, allineati ai campioni");
+        {
+            BufferReader reader (file);
+            std::vector<float> progress;
+            const auto map = DissonanceMap::analyse (reader, { 0, length },
+                                                     [&] (float p) { progress.push_back (p); return true; });
+            expect (map != nullptr);
+            if (map == nullptr)
+                return;
+
+            expect (map->getSampleRange() == juce::Range<juce::int64> (0, length));
+            expectEquals (map->getSampleRate(), sr);
+            expectGreaterThan (map->getHopSize(), 0);
+            expectEquals (map->getNumFrames(), DissonanceMap::getNumFramesFor (length, map->getHopSize()));
+            expectEquals (map->getNumFrames(), (length + map->getHopSize() / 2) / map->getHopSize());
+
+            expect (! progress.empty() && std::is_sorted (progress.begin(), progress.end()));
+            expectWithinAbsoluteError (progress.back(), 1.0f, 1.0e-6f);
+
+            const int hop = map->getHopSize();
+            expectEquals (map->getFrameForSample (0), 0);
+            expectEquals (map->getFrameForSample (10 * hop), 9);
+            expectEquals (map->getFrameForSample (length - 1), map->getNumFrames() - 1);
+            expectEquals (map->getFrameForSample ((juce::int64) map->getNumFrames() * hop - hop / 2), map->getNumFrames() - 1);
+            expectEquals (map->getFrameForSample ((juce::int64) map->getNumFrames() * hop - hop / 2 - 1), map->getNumFrames() - 2);
+            expectEquals (map->getFrameForSample (length), -1);
+            expectEquals (map->getFrameForSample (-1), -1);
+        }
+
+        beginTest ("Terza piu' dissonante della quinta, con i suoi parziali");
+        {
+            BufferReader reader (file);
+            const auto map = DissonanceMap::analyse (reader, { 0, length });
+            expect (map != nullptr);
+            if (map == nullptr)
+                return;
+
+            // Mezzo secondo al centro di ogni segmento, lontano dal cambio
+            auto average = [&] (double from, double to)
+            {
+                const int first = map->getFrameForSample ((juce::int64) (from * sr));
+                const int last = map->getFrameForSample ((juce::int64) (to * sr));
+                float sum = 0.0f;
+                for (int f = first; f <= last; ++f)
+                    sum += map->getDissonance (f);
+                return sum / (float) (last - first + 1);
+            };
+
+            const float third = average (0.75, 1.25);
+            const float fifth = average (2.75, 3.25);
+            expectGreaterThan (third, fifth);
+            expectGreaterThan (map->getDissonanceAtSample ((juce::int64) sr), fifth);
+
+            const int frame = map->getFrameForSample ((juce::int64) sr);
+            expect (map->getNumPartials (frame) >= 2);
+            expect (hasPartialNear (*map, frame, 440.0f));
+            expect (hasPartialNear (*map, frame, 550.0f));
+
+            const int later = map->getFrameForSample ((juce::int64) (3.0 * sr));
+            expect (hasPartialNear (*map, later, 660.0f));
+            expect (! hasPartialNear (*map, later, 550.0f));
+        }
+
+        beginTest ("Intervallo parziale: solo la quinta");
+        {
+            BufferReader reader (file);
+            const juce::Range<juce::int64> second (length / 2, length);
+            const auto map = DissonanceMap::analyse (reader, second);
+            expect (map != nullptr);
+            if (map == nullptr)
+                return;
+
+            expect (map->getSampleRange() == second);
+            expectEquals (map->getFrameForSample (0), -1);
+            const int frame = map->getFrameForSample ((juce::int64) (3.0 * sr));
+            expectEquals (frame, (int) (((juce::int64) (3.0 * sr) - second.getStart() + map->getHopSize() / 2) / map->getHopSize()) - 1);
+            expect (hasPartialNear (*map, frame, 660.0f));
+        }
+
+        beginTest ("Interruzione e letture fallite: nessuna mappa");
+        {
+            BufferReader reader (file);
+            int calls = 0;
+            expect (DissonanceMap::analyse (reader, { 0, length }, [&] (float) { return ++calls < 3; }) == nullptr);
+            expectEquals (calls, 3);
+
+            BufferReader failing (file, DissonanceMap::READ_BLOCK_SIZE * 2);
+            expect (DissonanceMap::analyse (failing, { 0, length }) == nullptr);
+        }
+
+        beginTest ("Oltre MAX_PARTIALS restano i parziali piu' forti");
+        {
+            DissonanceMap map (sr, 512, { 0, 512 });
+            std::vector<DissonanceMap::Partial> partials;
+            for (int k = 1; k <= DissonanceMap::MAX_PARTIALS + 4; ++k)
+                partials.push_back ({ 100.0f * (float) k, (float) k });
+            map.addFrame (0.5f, partials.data(), (int) partials.size());
+
+            expectEquals (map.getNumFrames(), 1);
+            expectEquals (map.getNumPartials (0), DissonanceMap::MAX_PARTIALS);
+            for (int p = 0; p < map.getNumPartials (0); ++p)
+                expectGreaterThan (map.getPartial (0, p).amplitude, 4.0f);
+        }
+    }
+
+private:
+    static constexpr double sr = 44100.0;
+
+    // Reader su un AudioBuffer; le letture oltre 'failFrom' falliscono
+    struct BufferReader : public juce::AudioFormatReader
+    {
+        BufferReader (const juce::AudioBuffer<float>& source, juce::int64 failAt = -1)
+            : juce::AudioFormatReader (nullptr, "Buffer"), buffer (source), failFrom (failAt)
+        {
+            sampleRate = sr;
+            bitsPerSample = 32;
+            usesFloatingPointData = true;
+            numChannels = (unsigned int) source.getNumChannels();
+            lengthInSamples = source.getNumSamples();
+        }
+
+        bool readSamples (int* const* destChannels, int numDestChannels, int startOffsetInDestBuffer,
+                          juce::int64 startSampleInFile, int numSamples) override
+        {
+            if (failFrom >= 0 && startSampleInFile + numSamples > failFrom)
+                return false;
+
+            for (int ch = 0; ch < numDestChannels; ++ch)
+                if (destChannels[ch] != nullptr)
+                    juce::FloatVectorOperations::copy (reinterpret_cast<float*> (destChannels[ch]) + startOffsetInDestBuffer,
+                                                       buffer.getReadPointer (ch, (int) startSampleInFile), numSamples);
+            return true;
+        }
+
+        const juce::AudioBuffer<float>& buffer;
+        juce::int64 failFrom;
+    };
+
+    static bool hasPartialNear (const DissonanceMap& map, int frame, float frequency)
+    {
+        for (int p = 0; p < map.getNumPartials (frame); ++p)
+            if (std::abs (map.getPartial (frame, p).frequency - frequency) < 5.0f)
+                return true;
+        return false;
+    }
+};
+
+//==============================================================================
+// TEST 29 - Archivio binario delle mappe di dissonanza (persistenza ARA)
+//
+// Andata e ritorno entro la quantizzazione, pochi byte per frame su toni
+// stabili, archivi troncati o di un'altra versione rifiutati, hash del
+// contenuto che riconosce un file modificato.
+//==============================================================================
+class DissonanceMapArchiveTest : public juce::UnitTest
+{
+public:
+    DissonanceMapArchiveTest()
+        : juce::UnitTest ("DissonanceMap - archivio binario", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        const int length = (int) (3.0 * sr);
+        juce::AudioBuffer<float> file (1, length);
+        for (int n = 0; n < length; ++n)
+            file.setSample (0, n, 0.4f * (float) (std::sin (juce::MathConstants<double>::twoPi * 440.0 * n / sr)
+                                                  + std::sin (juce::MathConstants<double>::twoPi * 550.0 * n / sr)));
+
+        MemoryReader reader (file);
+        const auto map = DissonanceMap::analyse (reader, { 0, length });
+        expect (map != nullptr);
+        if (map == nullptr)
+            return;
+
+        juce::MemoryOutputStream archive;
+        map->writeTo (archive);
+
+        beginTest ("Andata e ritorno: stessi frame, entro il passo di quantizzazione");
+        {
+            juce::MemoryInputStream input (archive.getData(), archive.getDataSize(), false);
+            const auto restored = DissonanceMap::readFrom (input);
+            expect (restored != nullptr);
+            if (restored == nullptr)
+                return;
+
+            expect (input.isExhausted());
+            expect (restored->getSampleRange() == map->getSampleRange());
+            expectEquals (restored->getSampleRate(), map->getSampleRate());
+            expectEquals (restored->getHopSize(), map->getHopSize());
+            expect (restored->getContentHash() == map->getContentHash());
+            expectEquals (restored->getNumFrames(), map->getNumFrames());
+
+            for (int f = 0; f < map->getNumFrames(); ++f)
+            {
+                expectEquals (restored->getDissonance (f), map->getDissonance (f));
+                expectEquals (restored->getNumPartials (f), map->getNumPartials (f));
+                for (int p = 0; p < map->getNumPartials (f); ++p)
+                {
+                    expectEquals (restored->getPartial (f, p).frequency, map->getPartial (f, p).frequency);
+                    expectEquals (restored->getPartial (f, p).amplitude, map->getPartial (f, p).amplitude);
+                }
+            }
+        }
+
+        beginTest ("Quantizzazione: 0.2 cent, 0.25 dB, 1/65535");
+        {
+            DissonanceMap quantised (sr, 512, { 0, 512 });
+            const DissonanceMap::Partial partials[] = { { 440.0f, 0.5f }, { 27.5f, 0.011f }, { 15000.0f, 2.0f } };
+            quantised.addFrame (0.123456f, partials, 3);
+
+            expectWithinAbsoluteError (quantised.getDissonance (0), 0.123456f, 0.5f / 65535.0f);
+
+            // In ordine di frequenza
+            const float expectedFrequencies[] = { 27.5f, 440.0f, 15000.0f };
+            const float expectedAmplitudes[] = { 0.011f, 0.5f, 2.0f };
+            for (int p = 0; p < 3; ++p)
+            {
+                const auto partial = quantised.getPartial (0, p);
+                expectLessThan (std::abs (1200.0f * std::log2 (partial.frequency / expectedFrequencies[p])), 0.11f);
+                expectLessThan (std::abs (juce::Decibels::gainToDecibels (partial.amplitude / expectedAmplitudes[p])), 0.26f);
+            }
+        }
+
+        beginTest ("Compatto: parziali stabili in pochi byte per frame");
+        {
+            const double bytesPerFrame = (double) archive.getDataSize() / map->getNumFrames();
+            logMessage ("Archivio: " + juce::String (archive.getDataSize()) + " byte, "
+                        + juce::String (bytesPerFrame, 2) + " byte per frame");
+            expectLessThan (bytesPerFrame, 10.0);
+        }
+
+        beginTest ("Archivi troncati, corrotti o di un'altra versione rifiutati");
+        {
+            for (size_t size = 0; size < archive.getDataSize(); size += 1 + size / 4)
+            {
+                juce::MemoryInputStream truncated (archive.getData(), size, false);
+                expect (DissonanceMap::readFrom (truncated) == nullptr, "troncato a " + juce::String (size));
+            }
+
+            juce::MemoryBlock newer (archive.getData(), archive.getDataSize());
+            static_cast<char*> (newer.getData())[4] = (char) (DissonanceMap::ARCHIVE_VERSION + 1);
+            juce::MemoryInputStream newerInput (newer, false);
+            expect (DissonanceMap::readFrom (newerInput) == nullptr);
+
+            juce::MemoryBlock garbage (64, true);
+            juce::MemoryInputStream garbageInput (garbage, false);
+            expect (DissonanceMap::readFrom (garbageInput) == nullptr);
+
+            // Intestazioni con una lunghezza che, troncata a int, darebbe un
+            // numero di frame piccolo o negativo, e numeri di frame fuori misura
+            auto header = [] (juce::int64 archivedLength, int numFrames)
+            {
+                juce::MemoryOutputStream output;
+                output.writeInt ((int) DissonanceMap::ARCHIVE_MAGIC);
+                output.writeShort ((short) DissonanceMap::ARCHIVE_VERSION);
+                output.writeDouble (48000.0);
+                output.writeInt (1);
+                output.writeInt64 (0);
+                output.writeInt64 (archivedLength);
+                output.writeInt64 (0);
+                output.writeInt (numFrames);
+                output.writeRepeatedByte (0, 64);
+                return output.getMemoryBlock();
+            };
+            for (const auto& [archivedLength, numFrames] : { std::pair<juce::int64, int> { ((juce::int64) 1 << 32) + 5, 5 },
+                                                     std::pair<juce::int64, int> { (juce::int64) 1 << 31, std::numeric_limits<int>::min() },
+                                                     std::pair<juce::int64, int> { 0, -1 },
+                                                     std::pair<juce::int64, int> { std::numeric_limits<juce::int64>::max(), 1 },
+                                                     std::pair<juce::int64, int> { (juce::int64) DissonanceMap::MAX_ARCHIVE_FRAMES + 1,
+                                                                                   DissonanceMap::MAX_ARCHIVE_FRAMES + 1 } })
+            {
+                const auto block = header (archivedLength, numFrames);
+                juce::MemoryInputStream input (block, false);
+                expect (DissonanceMap::readFrom (input) == nullptr, "lunghezza " + juce::String (archivedLength));
+            }
+        }
+
+        beginTest ("Hash del contenuto: stesso audio, stesso hash; audio cambiato, hash diverso");
+        {
+            MemoryReader again (file);
+            expect (DissonanceMap::computeContentHash (again, { 0, length }) == map->getContentHash());
+
+            juce::AudioBuffer<float> edited (file);
+            edited.applyGain (length / 2, length / 2, 0.5f);
+            MemoryReader editedReader (edited);
+            expect (DissonanceMap::computeContentHash (editedReader, { 0, length }) != map->getContentHash());
+
+            juce::AudioBuffer<float> shorter (1, length - 1);
+            shorter.copyFrom (0, 0, file, 0, 0, length - 1);
+            MemoryReader shorterReader (shorter);
+            expect (DissonanceMap::computeContentHash (shorterReader, { 0, length - 1 }) != map->getContentHash());
+        }
+    }
+
+private:
+    static constexpr double sr = 44100.0;
+
+    struct MemoryReader : public juce::AudioFormatReader
+    {
+        explicit MemoryReader (const juce::AudioBuffer<float>& source)
+            : juce::AudioFormatReader (nullptr, "Memory"), buffer (source)
+        {
+            sampleRate = sr;
+            bitsPerSample = 32;
+            usesFloatingPointData = true;
+            numChannels = (unsigned int) source.getNumChannels();
+            lengthInSamples = source.getNumSamples();
+        }
+
+        bool readSamples (int* const* destChannels, int numDestChannels, int startOffsetInDestBuffer,
+                          juce::int64 startSampleInFile, int numSamples) override
+        {
+            for (int ch = 0; ch < numDestChannels; ++ch)
+                if (destChannels[ch] != nullptr)
+                    juce::FloatVectorOperations::copy (reinterpret_cast<float*> (destChannels[ch]) + startOffsetInDestBuffer,
+                                                       buffer.getReadPointer (ch, (int) startSampleInFile), numSamples);
+            return true;
+        }
+
+        const juce::AudioBuffer<float>& buffer;
+    };
+};
+
+//==============================================================================
+// TEST 30 - Dissonanza incrociata tra ingresso principale e sidechain
+//
+// Gli spettri dei due ingressi escono separati dalla stessa FFT complessa
+// (con la riassegnazione, una FFT per ingresso e la stessa stima di
+// frequenza del DissonanceAnalyser); contano solo le coppie miste (un accordo sul solo ingresso principale non
+// e' dissonanza incrociata). Il processor accetta una sidechain mono o
+// stereo, la usa solo per l'analisi e non la lascia passare in uscita.
+//==============================================================================
+class CrossDissonanceTest : public juce::UnitTest
+{
+public:
+    CrossDissonanceTest()
+        : juce::UnitTest ("CrossDissonanceAnalyser - ingresso e sidechain", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        beginTest ("Spettri separati: un parziale per ingresso, nessuna perdita tra i due");
+        {
+            CrossDissonanceAnalyser analyser;
+            analyser.prepare (sr);
+            feed (analyser, { 440.0f }, { 550.0f });
+
+            expectEquals (analyser.getNumMainPartials(), 1);
+            expectEquals (analyser.getNumSidePartials(), 1);
+            expectWithinAbsoluteError (analyser.getMainPartialFrequency (0), 440.0f, 2.0f);
+            expectWithinAbsoluteError (analyser.getSidePartialFrequency (0), 550.0f, 2.0f);
+        }
+
+        beginTest ("Solo coppie miste: terza maggiore tra i due > quinta tra i due > accordo su un solo ingresso");
+        {
+            const float third = measure ({ 440.0f }, { 550.0f });
+            const float fifth = measure ({ 440.0f }, { 660.0f });
+            const float mainOnly = measure ({ 440.0f, 550.0f }, {});
+            const float unison = measure ({ 440.0f }, { 440.0f });
+
+            expectGreaterThan (third, 0.01f);
+            expectGreaterThan (third, fifth);
+            expectEquals (mainOnly, 0.0f);
+            expectLessThan (unison, 0.005f);
+        }
+
+        beginTest ("Stimatore condiviso con il DissonanceAnalyser: frame da 512 punti, riassegnazione piu' precisa");
+        {
+            const float f = 443.7f, g = 557.3f;
+            auto worstError = [&] (CrossDissonanceAnalyser::FrequencyEstimator e)
+            {
+                CrossDissonanceAnalyser analyser;
+                analyser.prepare (sr, 9);
+                analyser.setFrequencyEstimator (e);
+                feed (analyser, { f }, { g });
+
+                if (analyser.getNumMainPartials() != 1 || analyser.getNumSidePartials() != 1)
+                    return 1.0e6f;
+
+                return juce::jmax (std::abs (analyser.getMainPartialFrequency (0) - f),
+                                   std::abs (analyser.getSidePartialFrequency (0) - g));
+            };
+
+            const float errParabolic = worstError (CrossDissonanceAnalyser::FrequencyEstimator::Parabolic);
+            const float errReassigned = worstError (CrossDissonanceAnalyser::FrequencyEstimator::Reassignment);
+
+            expectLessThan (errReassigned, 0.5f);
+            expect (errReassigned < errParabolic,
+                "Riassegnazione=" + juce::String (errReassigned) + " Parabola=" + juce::String (errParabolic));
+        }
+
+        beginTest ("Layout: sidechain disattivata, mono o stereo; nient'altro");
+        {
+            DissonanceMeeterAudioProcessor processor;
+            expectEquals (processor.getBusCount (true), 2);
+
+            auto layout = processor.getBusesLayout();
+            expect (layout.getChannelSet (true, 1).isDisabled());
+
+            for (auto set : { juce::AudioChannelSet::mono(), juce::AudioChannelSet::stereo() })
+            {
+                layout.inputBuses.getReference (1) = set;
+                expect (processor.checkBusesLayoutSupported (layout));
+            }
+
+            layout.inputBuses.getReference (1) = juce::AudioChannelSet::create5point1();
+            expect (! processor.checkBusesLayoutSupported (layout));
+        }
+
+        beginTest ("Processor: il meter riporta la dissonanza incrociata, l'uscita e' solo il principale");
+        {
+            DissonanceMeeterAudioProcessor withSidechain, withoutSidechain;
+
+            auto layout = withSidechain.getBusesLayout();
+            layout.inputBuses.getReference (1) = juce::AudioChannelSet::mono();
+            expect (withSidechain.setBusesLayout (layout));
+
+            for (auto* processor : { &withSidechain, &withoutSidechain })
+            {
+                processor->prepareToPlay (sr, blockSize);
+                processor->setInputMode (DissonanceMeeterAudioProcessor::InputMode::ExternalInput);
+                processor->setDissonanceEngine (DissonanceMeeterAudioProcessor::DissonanceEngine::Cross);
+            }
+
+            // Principale stereo a 440 Hz sui canali 0-1, sidechain a 550 Hz sul canale 2
+            juce::AudioBuffer<float> buffer (3, blockSize), reference (2, blockSize);
+            juce::MidiBuffer midi;
+            bool sameOutput = true;
+
+            for (int start = 0; start < (int) sr; start += blockSize)
+            {
+                for (int n = 0; n < blockSize; ++n)
+                {
+                    const float x = 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * 440.0 * (start + n) / sr);
+                    buffer.setSample (0, n, x);
+                    buffer.setSample (1, n, x);
+                    buffer.setSample (2, n, 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * 550.0 * (start + n) / sr));
+                    reference.setSample (0, n, x);
+                    reference.setSample (1, n, x);
+                }
+
+                withSidechain.processBlock (buffer, midi);
+                withoutSidechain.processBlock (reference, midi);
+
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int n = 0; n < blockSize; ++n)
+                        sameOutput = sameOutput && buffer.getSample (ch, n) == reference.getSample (ch, n);
+            }
+
+            expect (sameOutput, "la sidechain e' arrivata in uscita");
+            expectGreaterThan (withSidechain.getDissonance(), 0.01f);
+            expectEquals (withoutSidechain.getDissonance(), 0.0f);
+
+            withSidechain.releaseResources();
+            withoutSidechain.releaseResources();
+        }
+    }
+
+private:
+    static constexpr double sr = 44100.0;
+    static constexpr int blockSize = 512;
+
+    // 1 s di somme di sinusoidi (ampiezza 0.4 ciascuna) sui due ingressi
+    static void feed (CrossDissonanceAnalyser& analyser,
+                      std::initializer_list<float> mainFreqs, std::initializer_list<float> sideFreqs)
+    {
+        auto tones = [] (std::initializer_list<float> freqs, int n)
+        {
+            float sum = 0.0f;
+            for (auto f : freqs)
+                sum += 0.4f * (float) std::sin (juce::MathConstants<double>::twoPi * f * n / sr);
+            return sum;
+        };
+
+        for (int n = 0; n < (int) sr; ++n)
+            analyser.pushSample (tones (mainFreqs, n), tones (sideFreqs, n));
+    }
+
+    static float measure (std::initializer_list<float> mainFreqs, std::initializer_list<float> sideFreqs)
+    {
+        CrossDissonanceAnalyser analyser;
+        analyser.prepare (sr);
+        feed (analyser, mainFreqs, sideFreqs);
+        return analyser.getDissonance();
+    }
+};
+
+//==============================================================================
+// TEST 31 - Matrice di dissonanza della sessione tra istanze
+//
+// Tre istanze nello stesso processo pubblicano i parziali nel registro
+// condiviso; l'aggregatore mette in cima la coppia di tracce a un semitono
+// e lascia fuori l'ottava, ricalcolando solo le righe delle tracce che hanno
+// pubblicato, con il modello di ciascuna traccia, e gira in background
+// solo con un editor visibile. Gli slot sono limitati e si liberano con
+// l'istanza; una traccia ferma esce dalla matrice.
+//==============================================================================
+class SessionDissonanceRegistryTest : public juce::UnitTest
+{
+public:
+    SessionDissonanceRegistryTest()
+        : juce::UnitTest ("SessionDissonanceRegistry - matrice tra istanze", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        using Registry = SessionDissonanceRegistry;
+
+        beginTest ("Tre tracce: il semitono si scontra, l'ottava no");
+        {
+            DissonanceMeeterAudioProcessor a, b, c;
+            auto& registry = a.getSessionRegistry();
+            expect (&registry == &b.getSessionRegistry(), "registro non condiviso tra le istanze");
+            expect (a.getSessionSlot() >= 0 && b.getSessionSlot() >= 0 && c.getSessionSlot() >= 0);
+
+            juce::AudioProcessor::TrackProperties properties;
+            properties.name = "Basso";
+            a.updateTrackProperties (properties);
+            properties.name = "Tastiere";
+            b.updateTrackProperties (properties);
+
+            run (a, 440.0);
+            run (b, 466.0);
+            run (c, 880.0);
+            registry.aggregate();
+
+            const float semitone = registry.getCrossDissonance (a.getSessionSlot(), b.getSessionSlot());
+            const float octave = registry.getCrossDissonance (a.getSessionSlot(), c.getSessionSlot());
+            expectEquals (semitone, registry.getCrossDissonance (b.getSessionSlot(), a.getSessionSlot()));
+            expectGreaterThan (semitone, 0.1f);
+            expectLessThan (octave, Registry::CLASH_THRESHOLD);
+            expect (registry.isTrackActive (c.getSessionSlot()));
+
+            std::array<Registry::Clash, Registry::MAX_REPORTED_CLASHES> clashes;
+            const int numClashes = registry.getClashes (clashes);
+            expectGreaterThan (numClashes, 0);
+            expect (juce::jmin (clashes[0].trackA, clashes[0].trackB) == juce::jmin (a.getSessionSlot(), b.getSessionSlot())
+                    && juce::jmax (clashes[0].trackA, clashes[0].trackB) == juce::jmax (a.getSessionSlot(), b.getSessionSlot()));
+            expectEquals (registry.getTrackName (clashes[0].trackA) + "/" + registry.getTrackName (clashes[0].trackB),
+                          juce::String ("Basso/Tastiere"));
+
+            for (int i = 0; i < numClashes; ++i)
+                expect (clashes[(size_t) i].trackA != c.getSessionSlot() && clashes[(size_t) i].trackB != c.getSessionSlot());
+
+            // Solo le righe delle tracce che hanno pubblicato dall'ultimo passo
+            registry.aggregate();
+            expectEquals (registry.getNumEvaluatedPairs(), 0);
+            expectEquals (registry.getCrossDissonance (a.getSessionSlot(), b.getSessionSlot()), semitone);
+
+            run (c, 880.0);
+            registry.aggregate();
+            expectEquals (registry.getNumEvaluatedPairs(), 2);
+            expectEquals (registry.getCrossDissonance (a.getSessionSlot(), b.getSessionSlot()), semitone);
+
+            // Una traccia che smette di pubblicare esce dalla matrice
+            juce::Thread::sleep ((int) Registry::STALE_MS + 50);
+            registry.aggregate();
+            expect (! registry.isTrackActive (a.getSessionSlot()));
+            expectEquals (registry.getCrossDissonance (a.getSessionSlot(), b.getSessionSlot()), 0.0f);
+        }
+
+        beginTest ("Modello della traccia: la cella usa quello pubblicato, media se le due tracce differiscono");
+        {
+            juce::SharedResourcePointer<Registry> registry;
+            const int a = registry->claimSlot(), b = registry->claimSlot();
+            expect (a >= 0 && b >= 0);
+
+            const std::array<Registry::Partial, 2> low { { { 440.0f, 0.5f }, { 880.0f, 0.3f } } };
+            const std::array<Registry::Partial, 2> high { { { 466.0f, 0.5f }, { 932.0f, 0.3f } } };
+            const float sethares = CrossDissonanceAnalyser::computeCrossDissonance<SetharesModel> (low.data(), 2, high.data(), 2);
+            const float vassilakis = CrossDissonanceAnalyser::computeCrossDissonance<VassilakisModel> (low.data(), 2, high.data(), 2);
+
+            registry->publish (a, low.data(), 2, DissonanceModel::Vassilakis);
+            registry->publish (b, high.data(), 2, DissonanceModel::Vassilakis);
+            registry->aggregate();
+            expectWithinAbsoluteError (registry->getCrossDissonance (a, b), vassilakis, 1.0e-6f);
+
+            registry->publish (b, high.data(), 2, DissonanceModel::Sethares);
+            registry->aggregate();
+            expectWithinAbsoluteError (registry->getCrossDissonance (a, b), 0.5f * (sethares + vassilakis), 1.0e-6f);
+
+            registry->releaseSlot (a);
+            registry->releaseSlot (b);
+        }
+
+        beginTest ("Aggregatore in background solo con un editor visibile");
+        {
+            juce::SharedResourcePointer<Registry> registry;
+            expectEquals (registry->getNumViewers(), 0);
+
+            const int a = registry->claimSlot(), b = registry->claimSlot();
+            registry->aggregate();   // slot appena presi: fuori dalla matrice
+
+            const std::array<Registry::Partial, 1> low { { { 440.0f, 0.5f } } };
+            const std::array<Registry::Partial, 1> high { { { 466.0f, 0.5f } } };
+            registry->publish (a, low.data(), 1);
+            registry->publish (b, high.data(), 1);
+
+            // Nessun viewer: il thread dorme e la matrice non cambia
+            juce::Thread::sleep (4 * Registry::AGGREGATION_INTERVAL_MS);
+            expect (! registry->isTrackActive (a));
+
+            registry->addViewer();
+            bool aggregated = false;
+            for (int attempt = 0; attempt < 50 && ! aggregated; ++attempt)
+            {
+                juce::Thread::sleep (Registry::AGGREGATION_INTERVAL_MS);
+                aggregated = registry->isTrackActive (a) && registry->isTrackActive (b);
+            }
+            registry->removeViewer();
+
+            expect (aggregated, "l'aggregatore non e' ripartito con un viewer");
+            expectGreaterThan (registry->getCrossDissonance (a, b), Registry::CLASH_THRESHOLD);
+
+            registry->releaseSlot (a);
+            registry->releaseSlot (b);
+        }
+
+        beginTest ("Memoria limitata: MAX_TRACKS slot, poi -1; liberati con l'istanza");
+        {
+            juce::SharedResourcePointer<Registry> registry;
+            std::vector<int> claimed;
+            for (int slot = registry->claimSlot(); slot >= 0; slot = registry->claimSlot())
+                claimed.push_back (slot);
+
+            expectLessOrEqual ((int) claimed.size(), Registry::MAX_TRACKS);
+            expectEquals (registry->claimSlot(), -1);
+
+            // Un'istanza senza slot elabora comunque, fuori dalla matrice
+            {
+                DissonanceMeeterAudioProcessor unregistered;
+                expectEquals (unregistered.getSessionSlot(), -1);
+                run (unregistered, 440.0);
+            }
+
+            registry->releaseSlot (claimed.back());
+            DissonanceMeeterAudioProcessor late;
+            expectEquals (late.getSessionSlot(), claimed.back());
+            claimed.pop_back();
+
+            for (auto slot : claimed)
+                registry->releaseSlot (slot);
+        }
+    }
+
+private:
+    static constexpr double sr = 44100.0;
+    static constexpr int blockSize = 512;
+
+    // 0.5 s di una sinusoide in ingresso, motore spettrale
+    static void run (DissonanceMeeterAudioProcessor& processor, double freq)
+    {
+        processor.prepareToPlay (sr, blockSize);
+        processor.setInputMode (DissonanceMeeterAudioProcessor::InputMode::ExternalInput);
+
+        juce::AudioBuffer<float> buffer (2, blockSize);
+        juce::MidiBuffer midi;
+        for (int start = 0; start < (int) sr / 2; start += blockSize)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                for (int n = 0; n < blockSize; ++n)
+                    buffer.setSample (ch, n, 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * freq * (start + n) / sr));
+            processor.processBlock (buffer, midi);
+        }
+    }
+};
+
+//==============================================================================
+// TEST 32 - Tabelle e pool di analisi condivisi tra istanze
+//
+// 150 analizzatori usano le stesse finestre e gli stessi piani FFT (una
+// configurazione per dimensione del frame); i piani si creano su richiesta
+// fino al limite per core e si prestano in modo esclusivo. Il pool ha un thread per core qualunque sia il numero di
+// utenti, serve le code a turno e rispetta rimozione e interruzione.
+//==============================================================================
+class SharedAnalysisResourcesTest : public juce::UnitTest
+{
+public:
+    SharedAnalysisResourcesTest()
+        : juce::UnitTest ("SharedAnalysis - tabelle e pool condivisi", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        beginTest ("150 analizzatori, una configurazione per dimensione del frame");
+        {
+            juce::SharedResourcePointer<SharedAnalysisTables> tables;
+            std::vector<std::unique_ptr<DissonanceAnalyser>> analysers;
+            for (int i = 0; i < 150; ++i)
+            {
+                analysers.push_back (std::make_unique<DissonanceAnalyser>());
+                analysers.back()->prepare (44100.0, i % 2 == 0 ? DissonanceAnalyser::FFT_ORDER : DissonanceAnalyser::MIN_FFT_ORDER);
+            }
+
+            expectLessOrEqual (tables->getNumConfigurations(), 3);
+            expect (&tables->getConfiguration (DissonanceAnalyser::FFT_ORDER) == &tables->getConfiguration (DissonanceAnalyser::FFT_ORDER));
+
+            // Ogni analizzatore continua a funzionare con le tabelle condivise
+            for (int n = 0; n < 8192; ++n)
+                analysers.front()->pushSample (0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * 440.0 * n / 44100.0));
+            expectEquals (analysers.front()->getNumFramePartials(), 1);
+            expectEquals (analysers.front()->getNumSkippedFrames(), 0);
+        }
+
+        beginTest ("Piani FFT creati su richiesta, uno per analizzatore fino al limite");
+        {
+            SharedAnalysisTables tables;
+            const auto& configuration = tables.getConfiguration (DissonanceAnalyser::FFT_ORDER);
+            const int maxPlans = configuration.getMaxPlans();
+            expectEquals (configuration.getNumPlans(), 1);
+            expectEquals (maxPlans, juce::jmax (1, SharedAnalysisTables::PLANS_PER_CORE * juce::SystemStats::getNumCpus()));
+
+            // Un'istanza: analizzatore mono, incrociato e multicanale
+            tables.getConfiguration (DissonanceAnalyser::FFT_ORDER);
+            tables.getConfiguration (DissonanceAnalyser::FFT_ORDER);
+            expectEquals (configuration.getNumPlans(), juce::jmin (3, maxPlans));
+            logMessage ("Piani da 2048 punti per un'istanza: " + juce::String (configuration.getNumPlans())
+                        + " (prima, tutti subito: " + juce::String (maxPlans) + ")");
+
+            for (int i = 0; i < 4 * maxPlans; ++i)
+                tables.getConfiguration (DissonanceAnalyser::FFT_ORDER);
+            expectEquals (configuration.getNumPlans(), maxPlans);
+        }
+
+        beginTest ("Prestito esclusivo dei piani FFT");
+        {
+            juce::SharedResourcePointer<SharedAnalysisTables> tables;
+            tables->getConfiguration (DissonanceAnalyser::FFT_ORDER);
+            const auto& configuration = tables->getConfiguration (DissonanceAnalyser::FFT_ORDER);
+            expectGreaterOrEqual (configuration.getNumPlans(), 2);
+
+            {
+                std::vector<SharedAnalysisTables::Lease> leases;
+                for (int i = 0; i < configuration.getNumPlans(); ++i)
+                {
+                    leases.push_back (configuration.tryLease (i * 7));
+                    expect ((bool) leases.back());
+                }
+
+                expect (! configuration.tryLease (0), "piano prestato due volte");
+            }
+
+            expect ((bool) configuration.tryLease (0), "piano non restituito");
+        }
+
+        beginTest ("Un thread per core per qualunque numero di utenti");
+        {
+            std::vector<std::unique_ptr<SharedAnalysisPool::Client>> clients;
+            for (int i = 0; i < 150; ++i)
+                clients.push_back (std::make_unique<SharedAnalysisPool::Client>());
+
+            expectEquals (clients.front()->getNumWorkers(), juce::jmax (1, juce::SystemStats::getNumCpus()));
+            expectEquals (clients.back()->getNumWorkers(), clients.front()->getNumWorkers());
+        }
+
+        beginTest ("Code servite a turno: un utente con molti lavori non affama gli altri");
+        {
+            SharedAnalysisPool::Client busy, other;
+            const int numWorkers = busy.getNumWorkers();
+            std::atomic<int> started { 0 };
+
+            std::vector<std::unique_ptr<RecordingJob>> busyJobs;
+            for (int i = 0; i < 4 * numWorkers + 4; ++i)
+            {
+                busyJobs.push_back (std::make_unique<RecordingJob> (started));
+                busy.addJob (*busyJobs.back());
+            }
+
+            RecordingJob otherJob (started);
+            other.addJob (otherJob);
+            other.waitForJobToFinish (otherJob);
+
+            // In FIFO partirebbe dopo tutti i lavori di "busy"
+            expectLessOrEqual (otherJob.startIndex, 2 * numWorkers + 1);
+            busy.removeAllJobs();
+        }
+
+        beginTest ("Rimozione: un lavoro in coda non parte, uno in corso si interrompe");
+        {
+            SharedAnalysisPool::Client client;
+            std::atomic<int> started { 0 };
+
+            // Un lavoro per thread che resta in corso finche' non viene interrotto
+            std::vector<std::unique_ptr<RecordingJob>> blockers;
+            for (int i = 0; i < client.getNumWorkers(); ++i)
+            {
+                blockers.push_back (std::make_unique<RecordingJob> (started, true));
+                client.addJob (*blockers.back());
+            }
+
+            while (started.load() < client.getNumWorkers())
+                juce::Thread::sleep (1);
+
+            RecordingJob queued (started);
+            client.addJob (queued);
+            client.removeJob (queued);
+            expectEquals (queued.startIndex, -1);
+
+            for (auto& blocker : blockers)
+                client.removeJob (*blocker);
+            for (auto& blocker : blockers)
+                expect (blocker->wasInterrupted);
+        }
+    }
+
+private:
+    struct RecordingJob  : public SharedAnalysisPool::Job
+    {
+        RecordingJob (std::atomic<int>& counter, bool untilInterrupted = false)
+            : started (counter), waitForExit (untilInterrupted) {}
+
+        void run() override
+        {
+            startIndex = started++;
+            if (waitForExit)
+            {
+                while (! shouldExit())
+                    juce::Thread::sleep (1);
+                wasInterrupted = true;
+                return;
+            }
+            juce::Thread::sleep (5);
+        }
+
+        std::atomic<int>& started;
+        const bool waitForExit;
+        int startIndex = -1;
+        bool wasInterrupted = false;
+    };
+};
+
+//==============================================================================
+// TEST 33 - Analisi multicanale e surround
+//
+// Con il downmix un contenuto in opposizione di fase tra i canali si
+// cancella e la dissonanza sparisce; per canale, con gli spettri combinati
+// in potenza, resta. Con canali identici le due letture coincidono, e
+// stimatore, bassa latenza, gate e raggruppamento valgono come nel mono. Il
+// processor accetta qualsiasi layout fino a 16 canali (7.1.4, ambisonico
+// di terzo ordine) con ingresso uguale all'uscita.
+//==============================================================================
+class MultichannelAnalysisTest : public juce::UnitTest
+{
+public:
+    MultichannelAnalysisTest()
+        : juce::UnitTest ("DissonanceAnalyser per canale - layout surround", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        beginTest ("Stereo in opposizione di fase: il downmix si annulla, l'analisi per canale no");
+        {
+            DissonanceAnalyser downmix;
+            DissonanceAnalyser perChannel;
+            downmix.prepare (sr);
+            perChannel.prepare (sr, DissonanceAnalyser::FFT_ORDER, 2);
+
+            for (int n = 0; n < (int) sr; ++n)
+            {
+                const float x = tones (n);
+                const float frame[] = { x, -x };
+                downmix.pushSample (0.5f * (frame[0] + frame[1]));
+                perChannel.pushFrame (frame);
+            }
+
+            expectEquals (downmix.getDissonance(), 0.0f);
+            expectGreaterThan (perChannel.getDissonance(), 0.01f);
+            expectEquals (perChannel.getNumFramePartials(), 2);
+        }
+
+        beginTest ("Canali identici: stessa lettura del mono, qualunque sia il numero di canali");
+        {
+            DissonanceAnalyser mono;
+            mono.prepare (sr);
+            for (int n = 0; n < (int) sr; ++n)
+                mono.pushSample (tones (n));
+
+            for (int numChannels : { 1, 2, 5, 12, 16 })
+            {
+                DissonanceAnalyser analyser;
+                analyser.prepare (sr, DissonanceAnalyser::FFT_ORDER, numChannels);
+                expectEquals (analyser.getNumChannels(), numChannels);
+
+                std::array<float, DissonanceAnalyser::MAX_CHANNELS> frame{};
+                for (int n = 0; n < (int) sr; ++n)
+                {
+                    frame.fill (tones (n));
+                    analyser.pushFrame (frame.data());
+                }
+
+                expectWithinAbsoluteError (analyser.getDissonance(), mono.getDissonance(), 1e-3f,
+                                           juce::String (numChannels) + " canali");
+            }
+        }
+
+        beginTest ("Per canale: riassegnazione, raggruppamento, bassa latenza e gate come nel mono");
+        {
+            // Canali in opposizione di fase: stessa lettura del mono su un canale
+            auto compare = [&] (const juce::String& caseName, int frameOrder, auto&& configure, auto&& signal, auto&& check)
+            {
+                DissonanceAnalyser mono, perChannel;
+                mono.prepare (sr, frameOrder);
+                perChannel.prepare (sr, frameOrder, 2);
+                configure (mono);
+                configure (perChannel);
+
+                float worstDifference = 0.0f;
+                for (int start = 0; start < (int) sr; start += blockSize)
+                {
+                    for (int n = start; n < start + blockSize; ++n)
+                    {
+                        const float x = signal (n);
+                        const float frame[] { x, -x };
+                        mono.pushSample (x);
+                        perChannel.pushFrame (frame);
+                    }
+
+                    mono.updateBetweenFrames();
+                    perChannel.updateBetweenFrames();
+                    worstDifference = juce::jmax (worstDifference, std::abs (mono.getDissonance() - perChannel.getDissonance()));
+                }
+
+                expectLessThan (worstDifference, 1e-3f, caseName);
+                expectWithinAbsoluteError (perChannel.getIntraNoteDissonance(), mono.getIntraNoteDissonance(), 1e-3f, caseName);
+                expectWithinAbsoluteError (perChannel.getInterNoteDissonance(), mono.getInterNoteDissonance(), 1e-3f, caseName);
+                expectEquals (perChannel.getNumFramePartials(), mono.getNumFramePartials(), caseName);
+                expectEquals (perChannel.getHopMultiple(), mono.getHopMultiple(), caseName);
+                check (perChannel);
+            };
+
+            compare ("riassegnazione, 512 punti", 9,
+                     [] (DissonanceAnalyser& a) { a.setFrequencyEstimator (DissonanceAnalyser::FrequencyEstimator::Reassignment); },
+                     [] (int n) { return 0.4f * tone (443.7f, n) + 0.4f * tone (1337.3f, n); },
+                     [&] (const DissonanceAnalyser& a)
+                     {
+                         expectEquals (a.getNumFramePartials(), 2);
+                         expectWithinAbsoluteError (a.getFramePartialFrequency (0), 443.7f, 0.5f);
+                         expectWithinAbsoluteError (a.getFramePartialFrequency (1), 1337.3f, 0.5f);
+                     });
+
+            // Seconda maggiore a tre armoniche: intra e tra note separate
+            compare ("raggruppamento armonico", DissonanceAnalyser::FFT_ORDER,
+                     [] (DissonanceAnalyser& a) { a.setPartialGrouping (DissonanceAnalyser::PartialGrouping::Harmonic); },
+                     [] (int n)
+                     {
+                         float x = 0.0f;
+                         for (int h = 1; h <= 3; ++h)
+                             x += (0.3f / (float) h) * (tone (440.0f * (float) h, n) + tone (493.88f * (float) h, n));
+                         return x;
+                     },
+                     [&] (const DissonanceAnalyser& a)
+                     {
+                         expectEquals (a.getNumFrameGroups(), 2);
+                         expectGreaterThan (a.getInterNoteDissonance(), a.getIntraNoteDissonance());
+                     });
+
+            // Ampiezza che cresce: i risonatori di ogni canale la seguono tra un frame e l'altro
+            compare ("bassa latenza", DissonanceAnalyser::FFT_ORDER,
+                     [] (DissonanceAnalyser& a) { a.setLowLatencyRefinement (true); },
+                     [] (int n) { return 0.4f * tone (440.0f, n) + (0.1f + 0.5f * (float) (n / sr)) * tone (466.16f, n); },
+                     [&] (const DissonanceAnalyser& a) { expect (a.isLowLatencyRefinementEnabled()); });
+
+            // Bordone statico: l'hop si allunga
+            compare ("gate di stazionarieta'", DissonanceAnalyser::FFT_ORDER,
+                     [] (DissonanceAnalyser& a) { a.setStationarityGate (true); },
+                     [] (int n) { return tones (n); },
+                     [&] (const DissonanceAnalyser& a) { expectGreaterThan (a.getHopMultiple(), 1); });
+        }
+
+        beginTest ("Layout: fino a 16 canali con ingresso uguale all'uscita");
+        {
+            DissonanceMeeterAudioProcessor processor;
+            auto layout = processor.getBusesLayout();
+
+            for (auto set : { juce::AudioChannelSet::create5point1(),
+                              juce::AudioChannelSet::create7point1point4(),
+                              juce::AudioChannelSet::ambisonic (3) })
+            {
+                layout.inputBuses.getReference (0) = set;
+                layout.outputBuses.getReference (0) = set;
+                expect (processor.checkBusesLayoutSupported (layout), set.getDescription());
+            }
+
+            layout.inputBuses.getReference (0) = juce::AudioChannelSet::stereo();
+            expect (! processor.checkBusesLayoutSupported (layout));
+
+            layout.inputBuses.getReference (0) = juce::AudioChannelSet::discreteChannels (18);
+            layout.outputBuses.getReference (0) = juce::AudioChannelSet::discreteChannels (18);
+            expect (! processor.checkBusesLayoutSupported (layout));
+        }
+
+        beginTest ("Processor 7.1.4: i canali in opposizione di fase restano nel meter");
+        {
+            DissonanceMeeterAudioProcessor downmix, perChannel;
+
+            for (auto* processor : { &downmix, &perChannel })
+            {
+                auto layout = processor->getBusesLayout();
+                layout.inputBuses.getReference (0) = juce::AudioChannelSet::create7point1point4();
+                layout.outputBuses.getReference (0) = juce::AudioChannelSet::create7point1point4();
+                expect (processor->setBusesLayout (layout));
+
+                processor->prepareToPlay (sr, blockSize);
+                processor->setInputMode (DissonanceMeeterAudioProcessor::InputMode::ExternalInput);
+            }
+            perChannel.setChannelAnalysis (DissonanceMeeterAudioProcessor::ChannelAnalysis::PerChannel);
+            expectEquals (perChannel.getTotalNumOutputChannels(), 12);
+
+            // Canali pari e dispari con segno opposto: somma nulla
+            juce::AudioBuffer<float> buffer (12, blockSize);
+            juce::MidiBuffer midi;
+            for (int start = 0; start < (int) sr; start += blockSize)
+            {
+                for (auto* processor : { &downmix, &perChannel })
+                {
+                    for (int ch = 0; ch < 12; ++ch)
+                        for (int n = 0; n < blockSize; ++n)
+                            buffer.setSample (ch, n, (ch % 2 == 0 ? 1.0f : -1.0f) * tones (start + n));
+
+                    processor->processBlock (buffer, midi);
+                }
+            }
+
+            expectLessThan (downmix.getDissonance(), 0.001f);
+            expectGreaterThan (perChannel.getDissonance(), 0.01f);
+
+            downmix.releaseResources();
+            perChannel.releaseResources();
+        }
+    }
+
+private:
+    static constexpr double sr = 44100.0;
+    static constexpr int blockSize = 512;
+
+    static float tone (float freq, int n)
+    {
+        return (float) std::sin (juce::MathConstants<double>::twoPi * freq * n / sr);
+    }
+
+    // Terza maggiore 440 + 550 Hz, ampiezza 0.4 per sinusoide
+    static float tones (int n)
+    {
+        return 0.4f * (float) std::sin (juce::MathConstants<double>::twoPi * 440.0 * n / sr)
+             + 0.4f * (float) std::sin (juce::MathConstants<double>::twoPi * 550.0 * n / sr);
+    }
+};
+
+//==============================================================================
+// TEST 34 - Dissonanza simbolica dalle note MIDI
+//
+// Nessuna FFT: le note che suonano e le tabelle 128 x 128 del timbro. Con
+// il timbro sinusoidale un bicordo vale quanto la misura spettrale dello
+// stesso segnale; i cambi cadono sul campione dell'evento, il pedale tiene
+// le note rilasciate e l'aggiornamento incrementale non accumula errori.
+//==============================================================================
+class MidiDissonanceEstimatorTest : public juce::UnitTest
+{
+public:
+    MidiDissonanceEstimatorTest()
+        : juce::UnitTest ("MidiDissonanceEstimator - note MIDI", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        using Timbre = MidiDissonanceEstimator::Timbre;
+
+        beginTest ("Tabelle su richiesta: il costruttore non le crea, senza tabelle le note valgono 0");
+        {
+            // Le tabelle sono condivise dal processo: triangolo e quadra non li usa
+            // nessun test precedente
+            MidiDissonanceEstimator estimator;
+            expect (! estimator.hasTables (Timbre::Triangle));
+            estimator.setTimbre (Timbre::Triangle);
+
+            juce::MidiBuffer midi;
+            midi.addEvent (juce::MidiMessage::noteOn (1, 60, (juce::uint8) 127), 0);
+            midi.addEvent (juce::MidiMessage::noteOn (1, 61, (juce::uint8) 127), 0);
+            estimator.process (midi, blockSize);
+            expectEquals (estimator.getNumSoundingNotes(), 2);
+            expectEquals (estimator.getDissonance(), 0.0f);
+            expectEquals (estimator.getSpectrum (60).numHarmonics, 0);
+
+            // Le tabelle pubblicate: le note gia' tenute contano subito
+            estimator.buildTables (Timbre::Triangle);
+            expect (estimator.hasTables (Timbre::Triangle));
+            estimator.process (juce::MidiBuffer(), blockSize);
+            expectGreaterThan (estimator.getDissonance(), 0.05f);
+        }
+
+        beginTest ("Processor: le tabelle del timbro si costruiscono in background solo col motore Midi");
+        {
+            DissonanceMeeterAudioProcessor processor;
+            processor.setMidiTimbre (Timbre::Square);
+            processor.prepareToPlay (sr, blockSize);
+            expect (! processor.getMidiEstimator().hasTables (Timbre::Square));
+
+            processor.setDissonanceEngine (DissonanceMeeterAudioProcessor::DissonanceEngine::Midi);
+            expect (waitForTables (processor.getMidiEstimator(), Timbre::Square));
+            processor.releaseResources();
+        }
+
+        beginTest ("Intervalli: semitono > terza maggiore > ottava; una nota sinusoidale vale 0");
+        {
+            expectEquals (measure (Timbre::Sine, { 60 }), 0.0f);
+            expectGreaterThan (measure (Timbre::Sawtooth, { 60 }), 0.0f);
+
+            for (auto timbre : { Timbre::Sine, Timbre::Sawtooth, Timbre::Square, Timbre::Triangle })
+            {
+                const float semitone = measure (timbre, { 60, 61 });
+                const float third = measure (timbre, { 60, 64 });
+                const float octave = measure (timbre, { 60, 72 });
+                expectGreaterThan (semitone, third);
+                expectGreaterThan (third, octave);
+            }
+        }
+
+        beginTest ("Timbro sinusoidale: stessa lettura dell'analisi spettrale");
+        {
+            DissonanceAnalyser spectral;
+            spectral.prepare (sr);
+
+            const double f1 = 440.0, f2 = 440.0 * std::pow (2.0, 4.0 / 12.0);
+            for (int n = 0; n < (int) sr; ++n)
+                spectral.pushSample (0.4f * (float) std::sin (juce::MathConstants<double>::twoPi * f1 * n / sr)
+                                     + 0.4f * (float) std::sin (juce::MathConstants<double>::twoPi * f2 * n / sr));
+
+            const float symbolic = measure (Timbre::Sine, { 69, 73 });
+            expectGreaterThan (symbolic, 0.01f);
+            expectWithinAbsoluteError (symbolic, spectral.getDissonance(), 0.1f * symbolic);
+        }
+
+        beginTest ("A campione esatto: un cambio per evento, al suo campione");
+        {
+            MidiDissonanceEstimator estimator;
+            estimator.setTimbre (Timbre::Sine);
+            estimator.buildTables (Timbre::Sine);
+
+            juce::MidiBuffer midi;
+            midi.addEvent (juce::MidiMessage::noteOn (1, 60, (juce::uint8) 127), 100);
+            midi.addEvent (juce::MidiMessage::noteOn (1, 61, (juce::uint8) 127), 300);
+            midi.addEvent (juce::MidiMessage::noteOff (1, 61), 400);
+            midi.addEvent (juce::MidiMessage::noteOn (2, 60, (juce::uint8) 127), 450);   // gia' suona: nessun cambio
+            estimator.process (midi, blockSize);
+
+            expectEquals (estimator.getNumChanges(), 4);
+            expectEquals (estimator.getChange (1).sample, 100);
+            expectEquals (estimator.getChange (1).dissonance, 0.0f);
+            expectEquals (estimator.getChange (2).sample, 300);
+            expectGreaterThan (estimator.getChange (2).dissonance, 0.1f);
+            expectEquals (estimator.getChange (3).sample, 400);
+            expectEquals (estimator.getChange (3).dissonance, 0.0f);
+            expectEquals (estimator.getNumSoundingNotes(), 1);
+        }
+
+        beginTest ("Pedale di sustain: le note rilasciate suonano fino al pedale su");
+        {
+            MidiDissonanceEstimator estimator;
+            estimator.setTimbre (Timbre::Sine);
+            estimator.buildTables (Timbre::Sine);
+
+            juce::MidiBuffer midi;
+            midi.addEvent (juce::MidiMessage::noteOn (1, 60, (juce::uint8) 100), 0);
+            midi.addEvent (juce::MidiMessage::noteOn (1, 61, (juce::uint8) 100), 0);
+            midi.addEvent (juce::MidiMessage::controllerEvent (1, 64, 127), 10);
+            midi.addEvent (juce::MidiMessage::noteOff (1, 61), 20);
+            estimator.process (midi, blockSize);
+            expectEquals (estimator.getNumSoundingNotes(), 2);
+            expectGreaterThan (estimator.getDissonance(), 0.1f);
+
+            midi.clear();
+            midi.addEvent (juce::MidiMessage::controllerEvent (1, 64, 0), 0);
+            estimator.process (midi, blockSize);
+            expectEquals (estimator.getNumSoundingNotes(), 1);
+            expectEquals (estimator.getDissonance(), 0.0f);
+        }
+
+        beginTest ("Aggiornamento incrementale: uguale al calcolo da capo dopo 2000 eventi");
+        {
+            MidiDissonanceEstimator incremental, fresh;
+            incremental.buildTables (Timbre::Sawtooth);   // condivise: valgono per entrambi
+            juce::Random random (47);
+            std::array<bool, 128> held{};
+
+            for (int block = 0; block < 100; ++block)
+            {
+                juce::MidiBuffer midi;
+                for (int e = 0; e < 20; ++e)
+                {
+                    const int note = 36 + random.nextInt (48);
+                    if (held[(size_t) note])
+                        midi.addEvent (juce::MidiMessage::noteOff (1, note), e);
+                    else
+                        midi.addEvent (juce::MidiMessage::noteOn (1, note, (juce::uint8) (1 + random.nextInt (127))), e);
+                    held[(size_t) note] = ! held[(size_t) note];
+                }
+                incremental.process (midi, blockSize);
+            }
+
+            // Le stesse note, con le stesse velocity, in un solo blocco
+            juce::MidiBuffer final;
+            for (int i = 0; i < incremental.getNumSoundingNotes(); ++i)
+            {
+                const int note = incremental.getSoundingNote (i);
+                final.addEvent (juce::MidiMessage::noteOn (1, note, incremental.getNoteGain (note)), 0);
+            }
+            fresh.process (final, blockSize);
+
+            expectGreaterThan (incremental.getNumSoundingNotes(), 2);
+            expectEquals (fresh.getNumSoundingNotes(), incremental.getNumSoundingNotes());
+            expectWithinAbsoluteError (incremental.getDissonance(), fresh.getDissonance(), 1e-5f);
+        }
+
+        beginTest ("Processor: accetta il MIDI e con il motore Midi legge le note senza audio");
+        {
+            DissonanceMeeterAudioProcessor processor;
+            expect (processor.acceptsMidi());
+
+            processor.prepareToPlay (sr, blockSize);
+            processor.setInputMode (DissonanceMeeterAudioProcessor::InputMode::ExternalInput);
+            processor.setDissonanceEngine (DissonanceMeeterAudioProcessor::DissonanceEngine::Midi);
+            processor.setMidiTimbre (Timbre::Sine);
+            expect (waitForTables (processor.getMidiEstimator(), Timbre::Sine));
+
+            juce::AudioBuffer<float> buffer (2, blockSize);
+            juce::MidiBuffer midi;
+            midi.addEvent (juce::MidiMessage::noteOn (1, 60, (juce::uint8) 127), 64);
+            midi.addEvent (juce::MidiMessage::noteOn (1, 61, (juce::uint8) 127), 64);
+
+            for (int b = 0; b < 50; ++b)
+            {
+                buffer.clear();
+                processor.processBlock (buffer, midi);
+                midi.clear();
+            }
+
+            expectEquals (processor.getMidiEstimator().getNumSoundingNotes(), 2);
+            expectGreaterThan (processor.getDissonance(), 0.1f);
+            processor.releaseResources();
+        }
+
+        beginTest ("Meter a campione esatto: ogni valore pesa per il tempo in cui vale nel blocco");
+        {
+            // Stesso bicordo a inizio blocco e a 7/8 del blocco, un solo blocco
+            auto meterAfterChordAt = [&] (int sample, float& reading)
+            {
+                DissonanceMeeterAudioProcessor processor;
+                processor.prepareToPlay (sr, blockSize);
+                processor.setInputMode (DissonanceMeeterAudioProcessor::InputMode::ExternalInput);
+                processor.setDissonanceEngine (DissonanceMeeterAudioProcessor::DissonanceEngine::Midi);
+                processor.setMidiTimbre (Timbre::Sine);
+                expect (waitForTables (processor.getMidiEstimator(), Timbre::Sine));
+
+                juce::AudioBuffer<float> buffer (2, blockSize);
+                buffer.clear();
+                juce::MidiBuffer midi;
+                midi.addEvent (juce::MidiMessage::noteOn (1, 60, (juce::uint8) 127), sample);
+                midi.addEvent (juce::MidiMessage::noteOn (1, 61, (juce::uint8) 127), sample);
+                processor.processBlock (buffer, midi);
+
+                reading = processor.getMidiEstimator().getDissonance();
+                const float meter = processor.getDissonance();
+                processor.releaseResources();
+                return meter;
+            };
+
+            float reading = 0.0f;
+            const float alpha = DissonanceMeeterAudioProcessor().getMeterSmoothing();
+            const float early = meterAfterChordAt (0, reading);
+            const float late = meterAfterChordAt (blockSize * 7 / 8, reading);
+
+            // A inizio blocco: il passo di un blocco intero
+            expectWithinAbsoluteError (early, alpha * reading, 1e-5f);
+            expectWithinAbsoluteError (late, (1.0f - std::pow (1.0f - alpha, 1.0f / 8.0f)) * reading, 1e-5f);
+            expectGreaterThan (late, 0.0f);
+            expectLessThan (late, early);
+        }
+    }
+
+private:
+    static constexpr double sr = 44100.0;
+    static constexpr int blockSize = 512;
+
+    // Le tabelle del processor arrivano da un thread del pool
+    static bool waitForTables (const MidiDissonanceEstimator& estimator, MidiDissonanceEstimator::Timbre timbre)
+    {
+        for (int ms = 0; ms < 10000 && ! estimator.hasTables (timbre); ++ms)
+            juce::Thread::sleep (1);
+
+        return estimator.hasTables (timbre);
+    }
+
+    static float measure (MidiDissonanceEstimator::Timbre timbre, std::initializer_list<int> notes)
+    {
+        MidiDissonanceEstimator estimator;
+        estimator.setTimbre (timbre);
+        estimator.buildTables (timbre);
+
+        juce::MidiBuffer midi;
+        for (auto note : notes)
+            midi.addEvent (juce::MidiMessage::noteOn (1, note, (juce::uint8) 127), 0);
+
+        estimator.process (midi, blockSize);
+        return estimator.getDissonance();
+    }
+};
+
+//==============================================================================
+// TEST 35 - Raggruppamento armonico dei parziali in note
+//
+// Le armoniche di una nota formano un gruppo con la sua fondamentale; la
+// dissonanza si divide in interna alle note e tra note. Senza raggruppamento
+// la lettura non cambia; con InterNoteOnly una nota sola vale 0 e due note
+// valgono quanto le sole coppie tra di loro.
+//==============================================================================
+class HarmonicGroupingTest : public juce::UnitTest
+{
+public:
+    HarmonicGroupingTest()
+        : juce::UnitTest ("HarmonicGrouper - parziali raggruppati in note", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        using Grouping = DissonanceAnalyser::PartialGrouping;
+
+        beginTest ("Do4 + Mi4 a 6 armoniche: due gruppi, fondamentali e appartenenza corrette");
+        {
+            // La quinta armonica del Do (1308 Hz) e la quarta del Mi (1319 Hz) restano separate
+            const float c4 = 261.63f, e4 = 329.63f;
+            std::vector<std::pair<float, int>> partials;
+            for (int k = 1; k <= 6; ++k)
+            {
+                partials.push_back ({ c4 * (float) k, 0 });
+                partials.push_back ({ e4 * (float) k, 1 });
+            }
+            std::sort (partials.begin(), partials.end());
+
+            std::vector<float> freqs, amps;
+            for (auto& p : partials)
+            {
+                freqs.push_back (p.first);
+                amps.push_back (0.1f);
+            }
+
+            HarmonicGrouper<DissonanceAnalyser::MAX_PARTIALS> grouper;
+            expectEquals (grouper.group (freqs.data(), amps.data(), (int) freqs.size(), 5.0f), 2);
+            expectWithinAbsoluteError (grouper.getFundamental (0), c4, 0.5f);
+            expectWithinAbsoluteError (grouper.getFundamental (1), e4, 0.5f);
+
+            for (size_t i = 0; i < partials.size(); ++i)
+                expectEquals (grouper.getGroupOf ((int) i), partials[i].second, juce::String (freqs[i]) + " Hz");
+
+            // Gruppi contigui nell'ordine delle coppie
+            for (int pos = 0; pos < (int) freqs.size(); ++pos)
+                expectEquals (grouper.getGroupEnd (pos), pos < 6 ? 6 : 12);
+        }
+
+        beginTest ("Una nota: senza gruppi stessa lettura, tutta interna; InterNoteOnly = 0");
+        {
+            const auto none = analyse (Grouping::None, { 110.0f });
+            const auto harmonic = analyse (Grouping::Harmonic, { 110.0f });
+            const auto interOnly = analyse (Grouping::InterNoteOnly, { 110.0f });
+
+            expectGreaterThan (none.dissonance, 0.001f);
+            expectEquals (none.groups, 4);
+            expectEquals (harmonic.groups, 1);
+            expectWithinAbsoluteError (harmonic.dissonance, none.dissonance, 1e-6f);
+            expectWithinAbsoluteError (harmonic.intra, none.dissonance, 1e-6f);
+            expectEquals (harmonic.inter, 0.0f);
+            expectEquals (interOnly.dissonance, 0.0f);
+            expectEquals (interOnly.intra, 0.0f);
+        }
+
+        beginTest ("Seconda maggiore a 3 armoniche: due note, la dissonanza tra note domina");
+        {
+            const auto harmonic = analyse (Grouping::Harmonic, { 440.0f, 493.88f });
+            const auto interOnly = analyse (Grouping::InterNoteOnly, { 440.0f, 493.88f });
+
+            expectEquals (harmonic.groups, 2);
+            expectGreaterThan (harmonic.inter, 0.01f);
+            expectGreaterThan (harmonic.inter, harmonic.intra);
+            expectWithinAbsoluteError (interOnly.dissonance, harmonic.inter, 1e-6f);
+        }
+    }
+
+private:
+    static constexpr double sr = 44100.0;
+
+    struct Reading { float dissonance, intra, inter; int groups; };
+
+    // 1 s di note a 4 armoniche (una sola nota) o 3 (piu' note), ampiezza 0.3 / k
+    static Reading analyse (DissonanceAnalyser::PartialGrouping grouping, std::initializer_list<float> fundamentals)
+    {
+        const int numHarmonics = fundamentals.size() > 1 ? 3 : 4;
+
+        DissonanceAnalyser analyser;
+        analyser.prepare (sr);
+        analyser.setPartialGrouping (grouping);
+
+        for (int n = 0; n < (int) sr; ++n)
+        {
+            float x = 0.0f;
+            for (auto f0 : fundamentals)
+                for (int k = 1; k <= numHarmonics; ++k)
+                    x += 0.3f / (float) k * (float) std::sin (juce::MathConstants<double>::twoPi * f0 * k * n / sr);
+            analyser.pushSample (x);
+        }
+
+        return { analyser.getDissonance(), analyser.getIntraNoteDissonance(),
+                 analyser.getInterNoteDissonance(), analyser.getNumFrameGroups() };
+    }
+};
+
+//==============================================================================
+// TEST 36 - Spettro di ruvidita' per banda critica
+//
+// Ogni coppia finisce nella banda Bark della sua frequenza centrale; le bande
+// sommano alla lettura scalare, sia nel downmix sia per canale. La copia
+// pubblicata si legge coerente anche mentre il thread di analisi scrive.
+//==============================================================================
+class RoughnessSpectrumTest : public juce::UnitTest
+{
+public:
+    RoughnessSpectrumTest()
+        : juce::UnitTest ("RoughnessSpectrum - dissonanza per banda critica", "DissonanceMeeter") {}
+
+    void runTest() override
+    {
+        using Bands = RoughnessSpectrum::Bands;
+
+        beginTest ("Tabella frequenza -> banda Bark");
+        {
+            expectEquals (RoughnessSpectrum::bandOf (0.0f), 0);
+            expectEquals (RoughnessSpectrum::bandOf (50.0f), 0);
+            expectEquals (RoughnessSpectrum::bandOf (100.0f), 1);
+            expectEquals (RoughnessSpectrum::bandOf (453.0f), 4);
+            expectEquals (RoughnessSpectrum::bandOf (1000.0f), 8);
+            expectEquals (RoughnessSpectrum::bandOf (3100.0f), 15);
+            expectEquals (RoughnessSpectrum::bandOf (15000.0f), 23);
+            expectEquals (RoughnessSpectrum::bandOf (30000.0f), 23);
+
+            for (int b = 0; b < RoughnessSpectrum::NUM_BANDS; ++b)
+            {
+                const float centre = 0.5f * (RoughnessSpectrum::getBandLowEdge (b) + RoughnessSpectrum::getBandHighEdge (b));
+                expectEquals (RoughnessSpectrum::bandOf (centre), b);
+            }
+        }
+
+        beginTest ("Semitono a 440 Hz: tutto nella banda del centro, somma = lettura");
+        {
+            DissonanceAnalyser analyser;
+            analyser.prepare (sr);
+            feed (analyser, { 440.0f, 466.16f });
+
+            Bands bands;
+            expect (analyser.getRoughnessSpectrum (bands));
+            expectGreaterThan (bands[4], 0.01f);
+            expectWithinAbsoluteError (sum (bands), analyser.getDissonance(), 1e-5f);
+            expectWithinAbsoluteError (bands[4], analyser.getDissonance(), 1e-5f);
+        }
+
+        beginTest ("Due semitoni lontani: due bande, nessuna confusione tra le due");
+        {
+            DissonanceAnalyser analyser;
+            analyser.prepare (sr);
+            feed (analyser, { 440.0f, 466.16f, 3000.0f, 3178.4f });
+
+            Bands bands;
+            expect (analyser.getRoughnessSpectrum (bands));
+            expectGreaterThan (bands[4], 0.01f);
+            expectGreaterThan (bands[15], 0.001f);
+            expectWithinAbsoluteError (sum (bands), analyser.getDissonance(), 1e-5f);
+            expectGreaterThan (bands[4] + bands[15], 0.99f * sum (bands));
+        }
+
+        beginTest ("Per canale: le bande sommano alla lettura; reset azzera");
+        {
+            DissonanceAnalyser analyser;
+            analyser.prepare (sr, DissonanceAnalyser::FFT_ORDER, 2);
+            for (int n = 0; n < (int) sr; ++n)
+            {
+                const float x = tone (440.0f, n) + tone (466.16f, n);
+                const float frame[] { x, -x };
+                analyser.pushFrame (frame);
+            }
+
+            Bands bands;
+            expect (analyser.getRoughnessSpectrum (bands));
+            expectGreaterThan (bands[4], 0.01f);
+            expectWithinAbsoluteError (sum (bands), analyser.getDissonance(), 1e-5f);
+
+            analyser.reset();
+            expect (analyser.getRoughnessSpectrum (bands));
+            expectEquals (sum (bands), 0.0f);
+        }
+
+        beginTest ("Lettura concorrente: mai una copia mista");
+        {
+            RoughnessSpectrum spectrum;
+            std::atomic<bool> stop { false };
+            juce::WaitableEvent finished;
+
+            // Ogni pubblicazione ha tutte le bande uguali
+            juce::Thread::launch ([&]
+            {
+                for (int k = 1; ! stop.load(); ++k)
+                {
+                    Bands bands;
+                    bands.fill ((float) (k % 1000));
+                    spectrum.publish (bands, 1.0f);
+                }
+                finished.signal();
+            });
+
+            int consistent = 0, mixed = 0;
+            for (int i = 0; i < 20000; ++i)
+            {
+                Bands bands;
+                if (! spectrum.read (bands))
+                    continue;
+
+                ++consistent;
+                if (std::any_of (bands.begin(), bands.end(), [&] (float b) { return b != bands[0]; }))
+                    ++mixed;
+            }
+
+            stop.store (true);
+            finished.wait (-1);
+
+            expectGreaterThan (consistent, 0);
+            expectEquals (mixed, 0);
+        }
+
+        beginTest ("Processor: spettro solo con il motore spettrale");
+        {
+            DissonanceMeeterAudioProcessor processor;
+            Bands bands;
+            expect (processor.getRoughnessSpectrum (bands));
+
+            processor.setDissonanceEngine (DissonanceMeeterAudioProcessor::DissonanceEngine::TimeDomain);
+            expect (! processor.getRoughnessSpectrum (bands));
+        }
+    }
+
+private:
+    static constexpr double sr = 44100.0;
+
+    static float tone (float freq, int n)
+    {
+        return 0.3f * (float) std::sin (juce::MathConstants<double>::twoPi * freq * n / sr);
+    }
+
+    // 1 s di sinusoidi pure, ampiezza 0.3
+    static void feed (DissonanceAnalyser& analyser, std::initializer_list<float> freqs)
+    {
+        for (int n = 0; n < (int) sr; ++n)
+        {
+            float x = 0.0f;
+            for (auto f : freqs)
+                x += tone (f, n);
+            analyser.pushSample (x);
+        }
+    }
+
+    static float sum (const RoughnessSpectrum::Bands& bands)
+    {
+        return std::accumulate (bands.begin(), bands.end(), 0.0f);
+    }
+};
+
+//==============================================================================
+// BENCHMARK - Carico CPU per stadio del processBlock
+//
+// Categoria "Benchmark": eseguito solo con DISSONANCE_METER_BENCHMARKS
+// impostata. Stampa p50/p99/max di ogni stadio in % della scadenza.
+//==============================================================================
+class ProcessorStageLoadBenchmark : public juce::UnitTest
+{
+public:
+    ProcessorStageLoadBenchmark()
+        : juce::UnitTest ("Benchmark - Carico per stadio", "Benchmark") {}
+
+    void runTest() override
+    {
+        using Engine = DissonanceMeeterAudioProcessor::DissonanceEngine;
+
+        for (int blockSize : { 64, 512 })
+            for (auto engine : { Engine::Spectral, Engine::TimeDomain })
+            {
+                beginTest (juce::String (blockSize) + " campioni, "
+                           + (engine == Engine::TimeDomain ? "dominio del tempo" : "spettrale"));
+
+                DissonanceMeeterAudioProcessor processor;
+                processor.prepareToPlay (48000.0, blockSize);
+                processor.setInputMode (DissonanceMeeterAudioProcessor::InputMode::Oscillator);
+                processor.setOscillatorFrequencies (440.0f, 466.0f);
+                processor.setDissonanceEngine (engine);
+
+                auto& profiler = processor.getProfiler();
+                profiler.setEnabled (true);
+
+                juce::AudioBuffer<float> buffer (2, blockSize);
+                juce::MidiBuffer midi;
+                const int numBlocks = 48000 * 5 / blockSize;   // 5 s di audio
+                for (int b = 0; b < numBlocks; ++b)
+                    processor.processBlock (buffer, midi);
+
+                for (int s = 0; s < StageProfiler::NUM_STAGES; ++s)
+                {
+                    const auto summary = profiler.getSummary ((StageProfiler::Stage) s);
+                    logMessage (juce::String (StageProfiler::getStageName (s)).paddedRight (' ', 16)
+                                + " p50 " + juce::String (summary.p50, 3) + "%"
+                                + "  p99 " + juce::String (summary.p99, 3) + "%"
+                                + "  max " + juce::String (summary.max, 3) + "%");
+                }
+
+                expectEquals ((int) profiler.getSummary (StageProfiler::Total).count, numBlocks);
+                expectLessThan (profiler.getSummary (StageProfiler::Total).p50, 100.0f);
+                processor.releaseResources();
+            }
+    }
+};
+
+//==============================================================================
+// BENCHMARK - Singola contro doppia precisione
+//
+// Tempo di 5 s di audio attraverso l'intero processBlock in float e in
+// double, per blocchi da 64 e 512 campioni.
+//==============================================================================
+class PrecisionThroughputBenchmark : public juce::UnitTest
+{
+public:
+    PrecisionThroughputBenchmark()
+        : juce::UnitTest ("Benchmark - Singola vs doppia precisione", "Benchmark") {}
+
+    void runTest() override
+    {
+        for (int blockSize : { 64, 512 })
+        {
+            beginTest (juce::String (blockSize) + " campioni");
+
+            const double floatSeconds  = render<float> (blockSize);
+            const double doubleSeconds = render<double> (blockSize);
+            logMessage ("float  " + juce::String (floatSeconds * 1000.0, 2) + " ms"
+                        + "  double " + juce::String (doubleSeconds * 1000.0, 2) + " ms"
+                        + "  rapporto " + juce::String (doubleSeconds / floatSeconds, 2) + "x");
+
+            // Entrambi i percorsi ben sotto il tempo reale (5 s di audio)
+            expectLessThan (floatSeconds, 5.0);
+            expectLessThan (doubleSeconds, 5.0);
+        }
+    }
+
+private:
+    template <typename SampleType>
+    static double render (int blockSize)
+    {
+        DissonanceMeeterAudioProcessor processor;
+        processor.setProcessingPrecision (std::is_same_v<SampleType, double> ? juce::AudioProcessor::doublePrecision
+                                                                            : juce::AudioProcessor::singlePrecision);
+        processor.prepareToPlay (48000.0, blockSize);
+        processor.setInputMode (DissonanceMeeterAudioProcessor::InputMode::Oscillator);
+        processor.setOscillatorFrequencies (440.0f, 466.0f);
+        processor.getParameterState().getParameter (Distortion::A_ID)->setValueNotifyingHost (0.4f);
+
+        juce::AudioBuffer<SampleType> buffer (2, blockSize);
+        juce::MidiBuffer midi;
+        const int numBlocks = 48000 * 5 / blockSize;
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        for (int b = 0; b < numBlocks; ++b)
+            processor.processBlock (buffer, midi);
+        const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+
+        processor.releaseResources();
+        return juce::Time::highResolutionTicksToSeconds (elapsed);
+    }
+};
+
+//==============================================================================
+// BENCHMARK - Banco di oscillatori
+//
+// 5 s di segnale di prova: due sinusoidi con std::sin in double (il vecchio
+// oscillatore) contro il banco, e un accordo di 8 voci da 16 parziali.
+//==============================================================================
+class OscillatorBankBenchmark : public juce::UnitTest
+{
+public:
+    OscillatorBankBenchmark()
+        : juce::UnitTest ("Benchmark - Banco di oscillatori", "Benchmark") {}
+
+    void runTest() override
+    {
+        constexpr double sr = 48000.0;
+        constexpr int numSamples = (int) sr * 5;
+        std::vector<float> out ((size_t) numSamples);
+
+        beginTest ("Due sinusoidi");
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            double phase1 = 0.0, phase2 = 0.0;
+            for (auto& y : out)
+            {
+                y = 0.5f * (float) std::sin (phase1) + 0.5f * (float) std::sin (phase2);
+                phase1 += juce::MathConstants<double>::twoPi * 440.0 / sr;
+                phase2 += juce::MathConstants<double>::twoPi * 466.0 / sr;
+                if (phase1 > juce::MathConstants<double>::twoPi) phase1 -= juce::MathConstants<double>::twoPi;
+                if (phase2 > juce::MathConstants<double>::twoPi) phase2 -= juce::MathConstants<double>::twoPi;
+            }
+            const double scalarSeconds = elapsedSeconds (start);
+
+            const OscillatorBank::Voice voices[] = { { 440.0f, 1.0f, 1, 1.0f }, { 466.0f, 1.0f, 1, 1.0f } };
+            const double bankSeconds = renderBank (voices, 2, sr, out);
+
+            logMessage ("std::sin " + juce::String (scalarSeconds * 1000.0, 2) + " ms"
+                        + "  banco " + juce::String (bankSeconds * 1000.0, 2) + " ms");
+            expectLessThan (bankSeconds, 5.0);
+        }
+
+        beginTest ("Accordo di 8 voci da 16 parziali");
+        {
+            std::array<OscillatorBank::Voice, OscillatorBank::MAX_VOICES> voices;
+            for (int v = 0; v < OscillatorBank::MAX_VOICES; ++v)
+                voices[(size_t) v] = { 110.0f * std::pow (2.0f, (float) v / 4.0f), 1.0f, OscillatorBank::MAX_PARTIALS, 1.0f };
+
+            const double bankSeconds = renderBank (voices.data(), OscillatorBank::MAX_VOICES, sr, out);
+            logMessage ("banco " + juce::String (bankSeconds * 1000.0, 2) + " ms ("
+                        + juce::String (OscillatorBank::LANES_PER_GROUP) + " corsie SIMD)");
+            expectLessThan (bankSeconds, 5.0);
+        }
+    }
+
+private:
+    static double elapsedSeconds (juce::int64 start)
+    {
+        return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+    }
+
+    static double renderBank (const OscillatorBank::Voice* voices, int numVoices, double sr, std::vector<float>& out)
+    {
+        OscillatorBank bank;
+        bank.setVoices (voices, numVoices);
+        bank.prepare (sr, 0.02);
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        bank.render (out.data(), (int) out.size());
+        return elapsedSeconds (start);
+    }
+};
+
+//==============================================================================
+// BENCHMARK - Costo dell'analisi per layout
+//
+// 5 s di audio a 48 kHz in blocchi da 512 con l'analisi per canale, dal
+// mono all'ambisonico di terzo ordine: il costo cresce con ceil(canali / 2)
+// FFT per frame piu' la copia dei canali. Riferimento: il downmix stereo.
+//==============================================================================
+class MultichannelLayoutBenchmark : public juce::UnitTest
+{
+public:
+    MultichannelLayoutBenchmark()
+        : juce::UnitTest ("Benchmark - Layout multicanale", "Benchmark") {}
+
+    void runTest() override
+    {
+        beginTest ("Analisi per canale");
+
+        const double downmixSeconds = render (juce::AudioChannelSet::stereo(),
+                                              DissonanceMeeterAudioProcessor::ChannelAnalysis::Downmix);
+        logMessage ("downmix stereo  " + juce::String (downmixSeconds * 1000.0, 2) + " ms");
+
+        for (auto set : { juce::AudioChannelSet::mono(),
+                          juce::AudioChannelSet::stereo(),
+                          juce::AudioChannelSet::create5point1(),
+                          juce::AudioChannelSet::create7point1point4(),
+                          juce::AudioChannelSet::ambisonic (3) })
+        {
+            const double seconds = render (set, DissonanceMeeterAudioProcessor::ChannelAnalysis::PerChannel);
+            logMessage (set.getDescription() + " (" + juce::String (set.size()) + " canali)  "
+                        + juce::String (seconds * 1000.0, 2) + " ms"
+                        + "  rapporto " + juce::String (seconds / downmixSeconds, 2) + "x");
+
+            // Ben sotto il tempo reale (5 s di audio) anche a 16 canali
+            expectLessThan (seconds, 5.0);
+        }
+    }
+
+private:
+    static double render (const juce::AudioChannelSet& set, DissonanceMeeterAudioProcessor::ChannelAnalysis analysis)
+    {
+        constexpr double sr = 48000.0;
+        constexpr int blockSize = 512;
+
+        DissonanceMeeterAudioProcessor processor;
+        auto layout = processor.getBusesLayout();
+        layout.inputBuses.getReference (0) = set;
+        layout.outputBuses.getReference (0) = set;
+        processor.setBusesLayout (layout);
+
+        processor.prepareToPlay (sr, blockSize);
+        processor.setInputMode (DissonanceMeeterAudioProcessor::InputMode::Oscillator);
+        processor.setOscillatorFrequencies (440.0f, 466.0f);
+        processor.setChannelAnalysis (analysis);
+
+        juce::AudioBuffer<float> buffer (set.size(), blockSize);
+        juce::MidiBuffer midi;
+        const int numBlocks = (int) sr * 5 / blockSize;
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        for (int b = 0; b < numBlocks; ++b)
+            processor.processBlock (buffer, midi);
+        const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+
+        processor.releaseResources();
+        return juce::Time::highResolutionTicksToSeconds (elapsed);
+    }
+};
+
 //==============================================================================
 // Registrazione automatica di tutti i test
 //==============================================================================
@@ -548,4 +4294,32 @@ static DissonanceAnalyserUnisonTest        dissonanceTest6;
 static DissonanceAnalyserRankingTest       dissonanceTest7;
 static BandPassFilterBasicTest             bpTest1;
 static ProcessorChainDissonanceTest        integrationTest1;
+static DissonanceAnalyserHighRateTest      dissonanceTest8;
+static DissonanceAnalyserLowLatencyTest    dissonanceTest9;
+static DissonanceAnalyserReassignmentTest  dissonanceTest10;
+static RoughnessAnalyserTest               dissonanceTest11;
+static DissonanceModelsTest                dissonanceTest12;
+static StaticProcessorChainTest            chainTest1;
+static ProcessorReconfigurationTest        processorTest1;
+static RealtimeSafetyGuardTest             realtimeTest1;
+static StageProfilerTest                   profilerTest1;
+static TraceRecorderTest                   traceTest1;
+static SilenceAndStationarityTest          silenceTest1;
+static StageBypassTest                    bypassTest1;
+static SampleAccurateAutomationTest       automationTest1;
+static DoublePrecisionTest                doublePrecisionTest1;
+static OscillatorBankTest                 oscillatorTest1;
+static DissonanceMapTest                  dissonanceMapTest1;
+static DissonanceMapArchiveTest           dissonanceMapTest2;
+static CrossDissonanceTest                crossTest1;
+static SessionDissonanceRegistryTest      sessionTest1;
+static SharedAnalysisResourcesTest       sharedAnalysisTest1;
+static MultichannelAnalysisTest          multichannelTest1;
+static MidiDissonanceEstimatorTest       midiTest1;
+static HarmonicGroupingTest              groupingTest1;
+static RoughnessSpectrumTest             roughnessSpectrumTest1;
+static ProcessorStageLoadBenchmark         benchmark1;
+static PrecisionThroughputBenchmark        benchmark2;
+static OscillatorBankBenchmark             benchmark3;
+static MultichannelLayoutBenchmark        benchmark4;
 
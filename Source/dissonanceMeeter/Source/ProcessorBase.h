@@ -14,6 +14,12 @@
 class ProcessorBase : public juce::AudioProcessor
 {
 public:
+	//==============================================================================
+	// Qualsiasi layout fino a 16 canali (7.1.4 = 12, ambisonico di terzo
+	// ordine = 16; vedi isBusesLayoutSupported): gli stadi preallocano lo
+	// stato per questo numero di canali e non ridimensionano mai nulla
+	static constexpr int MAX_CHANNELS = 16;
+
 	//==============================================================================
 	ProcessorBase()
 		: juce::AudioProcessor(BusesProperties()
@@ -22,6 +28,15 @@ public:
 	{
 	}
 
+	//==============================================================================
+	// Valore corrente di un parametro nelle sue unita': lettura atomica senza
+	// lock, che vede anche i cambi applicati con setValue() dal thread audio
+	// (automazione a campione esatto, vedi DissonanceMeeterAudioProcessor)
+	static float getParameterValue(const juce::RangedAudioParameter& parameter) noexcept
+	{
+		return parameter.convertFrom0to1(parameter.getValue());
+	}
+
 	//==============================================================================
 	void prepareToPlay(double, int) override {}
 	void releaseResources() override {}
@@ -51,8 +66,8 @@ public:
 	//==============================================================================
 	bool isBusesLayoutSupported(const BusesLayout& layouts) const override
 	{
-		if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo()
-			&& layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono())
+		const auto output = layouts.getMainOutputChannelSet();
+		if (output.isDisabled() || output.size() > MAX_CHANNELS)
 			return false;
 
 		// Assicura che il numero di canali di input corrisponda a quello di output
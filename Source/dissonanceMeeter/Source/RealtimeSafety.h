@@ -0,0 +1,311 @@
+/*
+	==============================================================================
+
+		RealtimeSafety.h
+
+		Strumentazione di debug per verificare che il thread audio sia
+		realtime-safe: mentre un ScopedAudioThreadGuard e' attivo sul thread
+		corrente, ogni allocazione, deallocazione e (su Linux) ogni
+		pthread_mutex_lock viene contata per lo stadio corrente (ScopedStage).
+
+		Uso:
+			RealtimeSafety::ScopedAudioThreadGuard guard(Mode::Assert);
+			{
+				RealtimeSafety::ScopedStage stage("analyser");
+				...
+			}
+
+		I guard sono annidabili: alla distruzione quello interno somma i propri
+		conteggi a quello esterno, cosi' un test che avvolge processBlock()
+		vede anche le violazioni registrate dal guard del processor.
+
+		ScopedToleratedLocks marca i lock brevi e noti di codice di terze parti
+		(BufferingAudioReader nel renderer ARA: il suo lock protegge solo lo
+		scambio dei blocchi, il disco si legge fuori). Restano contati, in
+		toleratedLocks, ma non sono violazioni e non fanno scattare l'assert.
+
+		Gli hook (operator new/delete globali e, su Linux, pthread_mutex_lock)
+		vanno definiti in un'unica unita' di traduzione, includendo questo file
+		con REALTIME_SAFETY_IMPLEMENT_HOOKS = 1 (vedi PluginProcessor.cpp).
+		Attivo solo in Debug: in Release guard e stadi sono vuoti.
+
+	==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstring>
+
+#if defined(JUCE_DEBUG) || defined(DEBUG)
+  #define REALTIME_SAFETY_ENABLED 1
+#else
+  #define REALTIME_SAFETY_ENABLED 0
+#endif
+
+// Intercettazione dei lock: solo dove si puo' interporre pthread_mutex_lock
+#ifndef REALTIME_SAFETY_DETECT_LOCKS
+  #define REALTIME_SAFETY_DETECT_LOCKS (REALTIME_SAFETY_ENABLED && JUCE_LINUX)
+#endif
+
+namespace RealtimeSafety
+{
+	//==============================================================================
+	enum class Mode
+	{
+		Count,   // conta soltanto (test)
+		Assert   // jassert alla chiusura del guard se ci sono violazioni
+	};
+
+	struct Violations
+	{
+		int allocations = 0;
+		int deallocations = 0;
+		int locks = 0;
+		int toleratedLocks = 0;   // dentro ScopedToleratedLocks, esclusi da total()
+
+		int total() const noexcept { return allocations + deallocations + locks; }
+
+		Violations& operator+= (const Violations& other) noexcept
+		{
+			allocations += other.allocations;
+			deallocations += other.deallocations;
+			locks += other.locks;
+			toleratedLocks += other.toleratedLocks;
+			return *this;
+		}
+	};
+
+	enum class Kind { Allocation, Deallocation, Lock };
+
+	static constexpr int MAX_STAGES = 16;
+
+	//==============================================================================
+	class ScopedAudioThreadGuard
+	{
+	public:
+	#if REALTIME_SAFETY_ENABLED
+		explicit ScopedAudioThreadGuard(Mode m = Mode::Count) noexcept
+			: mode(m), outer(active())
+		{
+			active() = this;
+		}
+
+		~ScopedAudioThreadGuard() noexcept
+		{
+			active() = outer;
+
+			if (outer != nullptr)
+				for (int s = 0; s < numStages; ++s)
+					outer->stageRecord(stageNames[(size_t)s]) += stageViolations[(size_t)s];
+
+			jassert(mode != Mode::Assert || getTotal().total() == 0);
+		}
+
+		// Chiamato dagli hook: nessuna allocazione, nessun lock
+		static void report(Kind kind) noexcept
+		{
+			auto* guard = active();
+			if (guard == nullptr)
+				return;
+
+			auto& v = guard->stageRecord(currentStage());
+			switch (kind)
+			{
+				case Kind::Allocation:   ++v.allocations;   break;
+				case Kind::Deallocation: ++v.deallocations; break;
+				case Kind::Lock:         ++(toleratingLocks() > 0 ? v.toleratedLocks : v.locks); break;
+			}
+		}
+
+		//==============================================================================
+		Violations getTotal() const noexcept
+		{
+			Violations total;
+			for (int s = 0; s < numStages; ++s)
+				total += stageViolations[(size_t)s];
+			return total;
+		}
+
+		// Violazioni di uno stadio (nome come passato a ScopedStage, oppure
+		// "unlabelled" per quelle fuori da ogni stadio)
+		Violations getStage(const char* name) const noexcept
+		{
+			for (int s = 0; s < numStages; ++s)
+				if (std::strcmp(stageNames[(size_t)s], name) == 0)
+					return stageViolations[(size_t)s];
+			return {};
+		}
+
+		int         getNumStages() const noexcept { return numStages; }
+		const char* getStageName(int s) const noexcept { return stageNames[(size_t)s]; }
+
+		static ScopedAudioThreadGuard*& active() noexcept
+		{
+			static thread_local ScopedAudioThreadGuard* guard = nullptr;
+			return guard;
+		}
+
+		static const char*& currentStage() noexcept
+		{
+			static thread_local const char* stage = "unlabelled";
+			return stage;
+		}
+
+		static int& toleratingLocks() noexcept
+		{
+			static thread_local int depth = 0;
+			return depth;
+		}
+
+	private:
+		Violations& stageRecord(const char* name) noexcept
+		{
+			for (int s = 0; s < numStages; ++s)
+				if (stageNames[(size_t)s] == name || std::strcmp(stageNames[(size_t)s], name) == 0)
+					return stageViolations[(size_t)s];
+
+			// Tabella piena: le violazioni finiscono nell'ultimo stadio
+			if (numStages == MAX_STAGES)
+				return stageViolations[(size_t)(MAX_STAGES - 1)];
+
+			stageNames[(size_t)numStages] = name;
+			return stageViolations[(size_t)numStages++];
+		}
+
+		Mode mode;
+		ScopedAudioThreadGuard* outer;
+		std::array<const char*, MAX_STAGES> stageNames{};
+		std::array<Violations, MAX_STAGES> stageViolations{};
+		int numStages = 0;
+	#else
+		explicit ScopedAudioThreadGuard(Mode = Mode::Count) noexcept {}
+		Violations  getTotal() const noexcept { return {}; }
+		Violations  getStage(const char*) const noexcept { return {}; }
+		int         getNumStages() const noexcept { return 0; }
+		const char* getStageName(int) const noexcept { return ""; }
+	#endif
+
+		JUCE_DECLARE_NON_COPYABLE(ScopedAudioThreadGuard)
+	};
+
+	//==============================================================================
+	// Etichetta lo stadio corrente del thread; 'name' deve restare valido
+	// (letterale stringa)
+	class ScopedStage
+	{
+	public:
+	#if REALTIME_SAFETY_ENABLED
+		explicit ScopedStage(const char* name) noexcept
+			: previous(ScopedAudioThreadGuard::currentStage())
+		{
+			ScopedAudioThreadGuard::currentStage() = name;
+		}
+
+		~ScopedStage() noexcept { ScopedAudioThreadGuard::currentStage() = previous; }
+
+	private:
+		const char* previous;
+	#else
+		explicit ScopedStage(const char*) noexcept {}
+	#endif
+
+		JUCE_DECLARE_NON_COPYABLE(ScopedStage)
+	};
+
+	//==============================================================================
+	// Lock ammessi nel blocco corrente (vedi sopra); annidabile
+	class ScopedToleratedLocks
+	{
+	public:
+	#if REALTIME_SAFETY_ENABLED
+		ScopedToleratedLocks() noexcept { ++ScopedAudioThreadGuard::toleratingLocks(); }
+		~ScopedToleratedLocks() noexcept { --ScopedAudioThreadGuard::toleratingLocks(); }
+	#else
+		ScopedToleratedLocks() noexcept {}
+	#endif
+
+		JUCE_DECLARE_NON_COPYABLE(ScopedToleratedLocks)
+	};
+}
+
+//==============================================================================
+// Hook globali: da definire in una sola unita' di traduzione
+#if REALTIME_SAFETY_ENABLED && defined(REALTIME_SAFETY_IMPLEMENT_HOOKS) && REALTIME_SAFETY_IMPLEMENT_HOOKS
+  #include <cstdlib>
+  #include <new>
+
+namespace RealtimeSafety::detail
+{
+	inline void* allocate(std::size_t size, std::size_t alignment)
+	{
+		ScopedAudioThreadGuard::report(Kind::Allocation);
+
+		if (size == 0)
+			size = 1;
+
+	   #if JUCE_WINDOWS
+		if (auto* p = alignment > 0 ? _aligned_malloc(size, alignment) : std::malloc(size))
+	   #else
+		if (auto* p = alignment > 0 ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+									: std::malloc(size))
+	   #endif
+			return p;
+
+		throw std::bad_alloc();
+	}
+
+	inline void release(void* p, bool aligned) noexcept
+	{
+		if (p == nullptr)
+			return;
+
+		ScopedAudioThreadGuard::report(Kind::Deallocation);
+
+	   #if JUCE_WINDOWS
+		if (aligned) { _aligned_free(p); return; }
+	   #else
+		juce::ignoreUnused(aligned);
+	   #endif
+		std::free(p);
+	}
+}
+
+void* operator new (std::size_t size)                              { return RealtimeSafety::detail::allocate(size, 0); }
+void* operator new (std::size_t size, std::align_val_t a)          { return RealtimeSafety::detail::allocate(size, (std::size_t)a); }
+void  operator delete (void* p) noexcept                           { RealtimeSafety::detail::release(p, false); }
+void  operator delete (void* p, std::size_t) noexcept              { RealtimeSafety::detail::release(p, false); }
+void  operator delete (void* p, std::align_val_t) noexcept         { RealtimeSafety::detail::release(p, true); }
+void  operator delete (void* p, std::size_t, std::align_val_t) noexcept { RealtimeSafety::detail::release(p, true); }
+
+  #if REALTIME_SAFETY_DETECT_LOCKS
+	#include <dlfcn.h>
+	#include <pthread.h>
+
+namespace RealtimeSafety::detail
+{
+	using LockFn = int (*)(pthread_mutex_t*);
+
+	// Inizializzazione costante: niente guardia di statico locale, che a sua
+	// volta potrebbe prendere un mutex e rientrare qui
+	inline std::atomic<LockFn> realLock{ nullptr };
+}
+
+// Interpone pthread_mutex_lock (usato da std::mutex e juce::CriticalSection)
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+	using namespace RealtimeSafety::detail;
+
+	auto lock = realLock.load(std::memory_order_relaxed);
+	if (lock == nullptr)
+	{
+		lock = (LockFn)dlsym(RTLD_NEXT, "pthread_mutex_lock");
+		realLock.store(lock, std::memory_order_relaxed);
+	}
+
+	RealtimeSafety::ScopedAudioThreadGuard::report(RealtimeSafety::Kind::Lock);
+	return lock(mutex);
+}
+  #endif
+#endif
@@ -0,0 +1,449 @@
+/*
+	==============================================================================
+
+		SessionDissonanceRegistry.h
+
+		Registro condiviso da tutte le istanze del plug-in nello stesso processo
+		host (juce::SharedResourcePointer): ogni istanza occupa uno slot e vi
+		pubblica i parziali del proprio ultimo frame, con il proprio modello
+		a coppie; un unico thread aggregatore calcola la matrice traccia x
+		traccia della dissonanza incrociata (solo coppie miste tra due tracce,
+		vedi CrossDissonanceAnalyser::computeCrossDissonance) e l'elenco delle
+		coppie di tracce che si scontrano di piu', letti da qualunque editor.
+
+		Costo: l'aggregatore gira solo mentre almeno un editor e' visibile
+		(addViewer() / removeViewer()), altrimenti dorme senza timeout. A
+		ogni passo ricalcola solo le righe delle tracce che hanno pubblicato
+		(o sono entrate o uscite dalla matrice) dal passo precedente, e il
+		passo successivo parte dopo AGGREGATION_INTERVAL_MS o, se il passo
+		e' costato di piu', in modo da non superare MAX_DUTY_CYCLE del thread.
+
+		Memoria limitata e fissa: MAX_TRACKS slot da MAX_SHARED_PARTIALS
+		parziali ciascuno e la matrice MAX_TRACKS x MAX_TRACKS; le istanze
+		oltre MAX_TRACKS restano fuori dalla matrice (slot -1).
+
+		Il thread audio non si blocca mai: publish() scrive lo slot con un
+		seqlock (un solo scrittore per slot, contatore dispari durante la
+		scrittura), nessun lock e nessuna allocazione. L'aggregatore rilegge
+		uno slot finche' il contatore non resta uguale e pari; se lo scrittore
+		e' sempre a meta', tiene il frame dell'hop precedente. Nomi delle
+		tracce e risultati stanno sotto un lock condiviso solo tra thread dei
+		messaggi e aggregatore.
+
+	==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include "../../CrossDissonanceAnalyser.h"
+#include "../../DissonanceModels.h"
+
+class SessionDissonanceRegistry
+{
+public:
+	//==============================================================================
+	static constexpr int          MAX_TRACKS = 128;
+	static constexpr int          MAX_SHARED_PARTIALS = 16;    // i piu' forti del frame
+	static constexpr int          MAX_REPORTED_CLASHES = 8;
+	static constexpr int          AGGREGATION_INTERVAL_MS = 20; // ~ un hop da 1024 campioni
+	static constexpr double       MAX_DUTY_CYCLE = 0.1;         // frazione del tempo spesa ad aggregare
+	static constexpr juce::uint32 STALE_MS = 500;               // traccia ferma: fuori dalla matrice
+	static constexpr float        CLASH_THRESHOLD = 0.01f;
+	static constexpr int          MAX_READ_ATTEMPTS = 4;
+
+	using Partial = CrossDissonanceAnalyser::Partial;
+
+	struct Clash
+	{
+		int trackA = -1, trackB = -1;
+		float dissonance = 0.0f;
+	};
+
+	//==============================================================================
+	SessionDissonanceRegistry()
+	{
+		aggregator.startThread(juce::Thread::Priority::low);
+	}
+
+	~SessionDissonanceRegistry()
+	{
+		aggregator.stopThread(1000);
+	}
+
+	//==============================================================================
+	// Istanze (thread dei messaggi). Restituisce lo slot, o -1 se sono gia'
+	// tutti occupati.
+	int claimSlot()
+	{
+		for (int i = 0; i < MAX_TRACKS; ++i)
+		{
+			bool expected = false;
+			if (slots[(size_t)i].inUse.compare_exchange_strong(expected, true))
+			{
+				publish(i, nullptr, 0);
+
+				const juce::ScopedLock sl(lock);
+				trackNames[(size_t)i] = "Track " + juce::String(i + 1);
+				return i;
+			}
+		}
+
+		return -1;
+	}
+
+	void releaseSlot(int slot)
+	{
+		if (! juce::isPositiveAndBelow(slot, MAX_TRACKS))
+			return;
+
+		publish(slot, nullptr, 0);
+		slots[(size_t)slot].inUse.store(false);
+	}
+
+	void setTrackName(int slot, const juce::String& name)
+	{
+		if (! juce::isPositiveAndBelow(slot, MAX_TRACKS))
+			return;
+
+		const juce::ScopedLock sl(lock);
+		trackNames[(size_t)slot] = name;
+	}
+
+	juce::String getTrackName(int slot) const
+	{
+		if (! juce::isPositiveAndBelow(slot, MAX_TRACKS))
+			return {};
+
+		const juce::ScopedLock sl(lock);
+		return trackNames[(size_t)slot];
+	}
+
+	//==============================================================================
+	// Thread audio dell'istanza proprietaria dello slot: nessun lock, nessuna
+	// allocazione. Tiene i MAX_SHARED_PARTIALS parziali piu' forti; 'model' e'
+	// il modello a coppie dell'istanza (vedi evaluatePair()).
+	void publish(int slot, const Partial* partials, int numPartials,
+		DissonanceModel model = DissonanceModel::Sethares) noexcept
+	{
+		if (! juce::isPositiveAndBelow(slot, MAX_TRACKS))
+			return;
+
+		std::array<Partial, CrossDissonanceAnalyser::MAX_PARTIALS> strongest{};
+		numPartials = juce::jlimit(0, (int)strongest.size(), numPartials);
+		std::copy(partials, partials + numPartials, strongest.begin());
+
+		const int numShared = juce::jmin(numPartials, MAX_SHARED_PARTIALS);
+		std::partial_sort(strongest.begin(), strongest.begin() + numShared, strongest.begin() + numPartials,
+			[](const Partial& a, const Partial& b) { return a.amp > b.amp; });
+
+		auto& s = slots[(size_t)slot];
+		const auto sequence = s.sequence.load(std::memory_order_relaxed);
+		s.sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		for (int i = 0; i < numShared; ++i)
+		{
+			s.freqs[(size_t)i].store(strongest[(size_t)i].freq, std::memory_order_relaxed);
+			s.amps[(size_t)i].store(strongest[(size_t)i].amp, std::memory_order_relaxed);
+		}
+		s.numPartials.store(numShared, std::memory_order_relaxed);
+		s.model.store((int)model, std::memory_order_relaxed);
+		s.publishedAt.store(juce::Time::getMillisecondCounter(), std::memory_order_relaxed);
+
+		s.sequence.store(sequence + 2, std::memory_order_release);
+	}
+
+	//==============================================================================
+	// Editor visibili (thread dei messaggi): l'aggregatore gira solo finche'
+	// ce n'e' almeno uno. Ogni addViewer() va bilanciato da un removeViewer().
+	void addViewer()
+	{
+		if (viewers.fetch_add(1) == 0)
+			aggregator.notify();
+	}
+
+	void removeViewer()
+	{
+		jassert(viewers.load() > 0);
+		viewers.fetch_sub(1);
+	}
+
+	int getNumViewers() const noexcept { return viewers.load(); }
+
+	//==============================================================================
+	// Risultati dell'ultimo passo (thread dei messaggi). La matrice e'
+	// simmetrica; 0 per le tracce inattive o senza parziali.
+	float getCrossDissonance(int trackA, int trackB) const
+	{
+		if (! juce::isPositiveAndBelow(trackA, MAX_TRACKS) || ! juce::isPositiveAndBelow(trackB, MAX_TRACKS))
+			return 0.0f;
+
+		const juce::ScopedLock sl(lock);
+		return matrix[(size_t)(trackA * MAX_TRACKS + trackB)];
+	}
+
+	bool isTrackActive(int slot) const
+	{
+		if (! juce::isPositiveAndBelow(slot, MAX_TRACKS))
+			return false;
+
+		const juce::ScopedLock sl(lock);
+		return activeTracks[(size_t)slot];
+	}
+
+	// Le coppie con dissonanza incrociata sopra CLASH_THRESHOLD, dalla peggiore
+	int getClashes(std::array<Clash, MAX_REPORTED_CLASHES>& destination) const
+	{
+		const juce::ScopedLock sl(lock);
+		destination = clashes;
+		return numClashes;
+	}
+
+	// Coppie di tracce ricalcolate dall'ultimo aggregate(): 0 se nessuna
+	// traccia ha pubblicato nel frattempo
+	int getNumEvaluatedPairs() const
+	{
+		const juce::ScopedLock al(aggregationLock);
+		return numEvaluatedPairs;
+	}
+
+	//==============================================================================
+	// Un passo dell'aggregatore: chiamato dal suo thread, o direttamente
+	// (test). O(tracce cambiate x tracce attive x MAX_SHARED_PARTIALS^2)
+	// valutazioni del modello, piu' O(tracce attive^2) confronti.
+	void aggregate()
+	{
+		const juce::ScopedLock al(aggregationLock);
+		const auto now = juce::Time::getMillisecondCounter();
+
+		// 1. Istantanea coerente di ogni slot attivo; una traccia e' cambiata
+		// se ha pubblicato (contatore del seqlock diverso) o se entra o esce
+		// dalla matrice
+		int numActive = 0;
+		for (int t = 0; t < MAX_TRACKS; ++t)
+		{
+			auto& snapshot = snapshots[(size_t)t];
+			const auto& s = slots[(size_t)t];
+
+			if (! s.inUse.load() || ! readSlot(s, snapshot))
+				snapshot.numPartials = 0;
+			else if (now - snapshot.publishedAt > STALE_MS)
+				snapshot.numPartials = 0;
+
+			const bool active = snapshot.numPartials > 0;
+			changedTracks[(size_t)t] = active != aggregatedActive[(size_t)t]
+				|| (active && snapshot.sequence != aggregatedSequences[(size_t)t]);
+			aggregatedActive[(size_t)t] = active;
+			aggregatedSequences[(size_t)t] = snapshot.sequence;
+
+			if (active)
+				activeIndices[(size_t)numActive++] = t;
+			else if (changedTracks[(size_t)t])
+				clearRow(t);
+		}
+
+		// 2. Coppie miste solo dove almeno una delle due tracce e' cambiata;
+		// le altre celle restano quelle del passo precedente
+		numEvaluatedPairs = 0;
+		for (int a = 0; a < numActive; ++a)
+		{
+			for (int b = a + 1; b < numActive; ++b)
+			{
+				const int ta = activeIndices[(size_t)a];
+				const int tb = activeIndices[(size_t)b];
+				if (! changedTracks[(size_t)ta] && ! changedTracks[(size_t)tb])
+					continue;
+
+				const float d = evaluatePair(snapshots[(size_t)ta], snapshots[(size_t)tb]);
+				workMatrix[(size_t)(ta * MAX_TRACKS + tb)] = d;
+				workMatrix[(size_t)(tb * MAX_TRACKS + ta)] = d;
+				++numEvaluatedPairs;
+			}
+		}
+
+		// Le coppie peggiori, su tutta la matrice
+		std::array<Clash, MAX_REPORTED_CLASHES> worst{};
+		int numWorst = 0;
+		for (int a = 0; a < numActive; ++a)
+		{
+			for (int b = a + 1; b < numActive; ++b)
+			{
+				const int ta = activeIndices[(size_t)a];
+				const int tb = activeIndices[(size_t)b];
+				const float d = workMatrix[(size_t)(ta * MAX_TRACKS + tb)];
+
+				if (d > CLASH_THRESHOLD)
+					insertClash(worst, numWorst, { ta, tb, d });
+			}
+		}
+
+		// 3. Pubblicazione per gli editor
+		const juce::ScopedLock sl(lock);
+		matrix = workMatrix;
+		clashes = worst;
+		numClashes = numWorst;
+		for (int t = 0; t < MAX_TRACKS; ++t)
+			activeTracks[(size_t)t] = snapshots[(size_t)t].numPartials > 0;
+	}
+
+private:
+	//==============================================================================
+	struct Slot
+	{
+		std::atomic<bool> inUse{ false };
+		std::atomic<juce::uint32> sequence{ 0 };
+		std::atomic<juce::uint32> publishedAt{ 0 };
+		std::atomic<int> numPartials{ 0 };
+		std::atomic<int> model{ (int)DissonanceModel::Sethares };
+		std::array<std::atomic<float>, MAX_SHARED_PARTIALS> freqs{}, amps{};
+	};
+
+	struct Snapshot
+	{
+		std::array<Partial, MAX_SHARED_PARTIALS> partials{};
+		int numPartials = 0;
+		DissonanceModel model = DissonanceModel::Sethares;
+		juce::uint32 publishedAt = 0;
+		juce::uint32 sequence = 0;
+	};
+
+	//==============================================================================
+	// Ogni traccia con il proprio modello: se le due istanze ne usano due
+	// diversi, la cella e' la media delle due letture (resta simmetrica)
+	static float evaluatePair(const Snapshot& a, const Snapshot& b) noexcept
+	{
+		const float d = evaluateModel(a.model, a, b);
+		return a.model == b.model ? d : 0.5f * (d + evaluateModel(b.model, a, b));
+	}
+
+	static float evaluateModel(DissonanceModel model, const Snapshot& a, const Snapshot& b) noexcept
+	{
+		const auto* pa = a.partials.data();
+		const auto* pb = b.partials.data();
+
+		switch (model)
+		{
+			case DissonanceModel::Vassilakis:        return CrossDissonanceAnalyser::computeCrossDissonance<VassilakisModel>(pa, a.numPartials, pb, b.numPartials);
+			case DissonanceModel::HutchinsonKnopoff: return CrossDissonanceAnalyser::computeCrossDissonance<HutchinsonKnopoffModel>(pa, a.numPartials, pb, b.numPartials);
+			case DissonanceModel::Sethares:
+			default:                                 return CrossDissonanceAnalyser::computeCrossDissonance<SetharesModel>(pa, a.numPartials, pb, b.numPartials);
+		}
+	}
+
+	// Traccia uscita dalla matrice: riga e colonna a 0
+	void clearRow(int track) noexcept
+	{
+		for (int t = 0; t < MAX_TRACKS; ++t)
+		{
+			workMatrix[(size_t)(track * MAX_TRACKS + t)] = 0.0f;
+			workMatrix[(size_t)(t * MAX_TRACKS + track)] = 0.0f;
+		}
+	}
+
+	// Lettura del seqlock: false se lo scrittore non ha lasciato uno stato
+	// stabile entro MAX_READ_ATTEMPTS tentativi (l'istantanea resta quella
+	// dell'hop precedente)
+	static bool readSlot(const Slot& s, Snapshot& snapshot) noexcept
+	{
+		for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; ++attempt)
+		{
+			const auto before = s.sequence.load(std::memory_order_acquire);
+			if ((before & 1) != 0)
+				continue;
+
+			Snapshot read;
+			read.numPartials = juce::jlimit(0, MAX_SHARED_PARTIALS, s.numPartials.load(std::memory_order_relaxed));
+			read.publishedAt = s.publishedAt.load(std::memory_order_relaxed);
+			read.model = (DissonanceModel)s.model.load(std::memory_order_relaxed);
+			read.sequence = before;
+			for (int i = 0; i < read.numPartials; ++i)
+				read.partials[(size_t)i] = { s.freqs[(size_t)i].load(std::memory_order_relaxed),
+				                             s.amps[(size_t)i].load(std::memory_order_relaxed) };
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (s.sequence.load(std::memory_order_relaxed) == before)
+			{
+				snapshot = read;
+				return true;
+			}
+		}
+
+		return snapshot.numPartials > 0;
+	}
+
+	// Inserimento ordinato (decrescente) nell'elenco limitato delle peggiori
+	static void insertClash(std::array<Clash, MAX_REPORTED_CLASHES>& list, int& size, Clash clash) noexcept
+	{
+		int pos = size;
+		while (pos > 0 && list[(size_t)(pos - 1)].dissonance < clash.dissonance)
+			--pos;
+
+		if (pos >= MAX_REPORTED_CLASHES)
+			return;
+
+		const int last = juce::jmin(size, MAX_REPORTED_CLASHES - 1);
+		for (int i = last; i > pos; --i)
+			list[(size_t)i] = list[(size_t)(i - 1)];
+
+		list[(size_t)pos] = clash;
+		size = juce::jmin(size + 1, MAX_REPORTED_CLASHES);
+	}
+
+	//==============================================================================
+	struct Aggregator : public juce::Thread
+	{
+		explicit Aggregator(SessionDissonanceRegistry& r) : juce::Thread("Dissonance session"), registry(r) {}
+
+		// Senza editor visibili dorme finche' addViewer() (o stopThread()) non
+		// lo sveglia; altrimenti attende in proporzione al costo dell'ultimo passo
+		void run() override
+		{
+			while (! threadShouldExit())
+			{
+				if (registry.viewers.load() == 0)
+				{
+					wait(-1);
+					continue;
+				}
+
+				const auto start = juce::Time::getMillisecondCounterHiRes();
+				registry.aggregate();
+				const auto cost = juce::Time::getMillisecondCounterHiRes() - start;
+
+				wait(juce::jmax(AGGREGATION_INTERVAL_MS, (int)std::ceil(cost * (1.0 / MAX_DUTY_CYCLE - 1.0))));
+			}
+		}
+
+		SessionDissonanceRegistry& registry;
+	};
+
+	//==============================================================================
+	std::array<Slot, MAX_TRACKS> slots;
+
+	// Solo aggregatore (sotto aggregationLock)
+	juce::CriticalSection aggregationLock;
+	std::array<Snapshot, MAX_TRACKS> snapshots{};
+	std::array<int, MAX_TRACKS> activeIndices{};
+	std::array<float, MAX_TRACKS * MAX_TRACKS> workMatrix{};
+	std::array<juce::uint32, MAX_TRACKS> aggregatedSequences{};
+	std::array<bool, MAX_TRACKS> aggregatedActive{};
+	std::array<bool, MAX_TRACKS> changedTracks{};
+	int numEvaluatedPairs = 0;
+
+	// Aggregatore -> editor, nomi delle tracce (mai dal thread audio)
+	juce::CriticalSection lock;
+	std::array<juce::String, MAX_TRACKS> trackNames;
+	std::array<float, MAX_TRACKS * MAX_TRACKS> matrix{};
+	std::array<bool, MAX_TRACKS> activeTracks{};
+	std::array<Clash, MAX_REPORTED_CLASHES> clashes{};
+	int numClashes = 0;
+
+	std::atomic<int> viewers{ 0 };
+	Aggregator aggregator{ *this };
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SessionDissonanceRegistry)
+};
@@ -0,0 +1,269 @@
+/*
+	==============================================================================
+
+		SharedAnalysisPool.h
+
+		Pool di thread di analisi condiviso da tutte le istanze del processo
+		(juce::SharedResourcePointer), al posto di un pool per istanza: un
+		thread per core, a priorita' bassa, creati con il primo Client e
+		fermati con l'ultimo.
+
+		Ogni utente (per esempio un document controller ARA) ha il suo Client
+		con la sua coda; i thread servono i Client a turno (round robin),
+		quindi un'istanza che accoda centinaia di file non affama le altre:
+		ognuna vede partire il proprio prossimo lavoro entro un giro.
+
+		Thread inattivi fermi senza timeout su jobAvailable: lo segnalano
+		enqueue(), un thread che prende un Job mentre altri restano in coda e
+		lo spegnimento (a catena: ogni thread che esce lo segnala al
+		successivo).
+
+		I Job non appartengono al pool: restano del Client che li accoda, che
+		li puo' togliere dalla coda, interrompere (shouldExit()) e attendere,
+		con la stessa semantica di juce::ThreadPool.
+
+	==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+class SharedAnalysisPool
+{
+public:
+	//==============================================================================
+	class Client;
+
+	class Job
+	{
+	public:
+		Job() = default;
+		virtual ~Job() = default;
+
+		// Thread del pool. Da controllare spesso: true quando il Client
+		// toglie il lavoro in corso.
+		virtual void run() = 0;
+		bool shouldExit() const noexcept { return exitSignalled.load(); }
+
+	private:
+		friend class SharedAnalysisPool;
+		enum class State { idle, queued, running };
+
+		State state = State::idle;                // sotto il lock del pool
+		std::atomic<bool> exitSignalled{ false };
+		juce::WaitableEvent finished{ true };
+
+		JUCE_DECLARE_NON_COPYABLE(Job)
+	};
+
+	//==============================================================================
+	class Client
+	{
+	public:
+		Client() { pool->addClient(*this); }
+
+		~Client()
+		{
+			removeAllJobs();
+			pool->removeClient(*this);
+		}
+
+		// Il Job deve restare vivo finche' non e' finito o tolto
+		void addJob(Job& job) { pool->enqueue(*this, job); }
+
+		// Toglie il Job dalla coda o, se gia' partito, gli chiede di uscire e
+		// ne attende la fine
+		void removeJob(Job& job) { pool->remove(job, true); }
+
+		// Attende la fine di un Job accodato o in corso, senza interromperlo
+		void waitForJobToFinish(Job& job) { pool->remove(job, false); }
+
+		void removeAllJobs() { pool->removeAll(*this); }
+
+		int getNumWorkers() const noexcept { return pool->getNumWorkers(); }
+
+	private:
+		friend class SharedAnalysisPool;
+
+		juce::SharedResourcePointer<SharedAnalysisPool> pool;
+		std::deque<Job*> pending;                 // sotto il lock del pool
+		std::vector<Job*> running;
+
+		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Client)
+	};
+
+	//==============================================================================
+	SharedAnalysisPool()
+	{
+		const int numWorkers = juce::jmax(1, juce::SystemStats::getNumCpus());
+		for (int i = 0; i < numWorkers; ++i)
+		{
+			workers.push_back(std::make_unique<Worker>(*this));
+			workers.back()->startThread(juce::Thread::Priority::low);
+		}
+	}
+
+	~SharedAnalysisPool()
+	{
+		for (auto& w : workers)
+			w->signalThreadShouldExit();
+
+		// Sveglia il primo thread fermo; ognuno sveglia il successivo uscendo
+		jobAvailable.signal();
+		for (auto& w : workers)
+			w->stopThread(-1);
+	}
+
+	int getNumWorkers() const noexcept { return (int)workers.size(); }
+
+private:
+	//==============================================================================
+	struct Worker : public juce::Thread
+	{
+		explicit Worker(SharedAnalysisPool& p) : juce::Thread("Dissonance analysis"), pool(p) {}
+
+		void run() override
+		{
+			while (! threadShouldExit())
+			{
+				if (auto* job = pool.takeNextJob())
+					pool.runJob(*job);
+				else
+					pool.jobAvailable.wait(-1);
+			}
+
+			pool.jobAvailable.signal();
+		}
+
+		SharedAnalysisPool& pool;
+	};
+
+	//==============================================================================
+	void addClient(Client& client)
+	{
+		const juce::ScopedLock sl(lock);
+		clients.push_back(&client);
+	}
+
+	void removeClient(Client& client)
+	{
+		const juce::ScopedLock sl(lock);
+		const auto it = std::find(clients.begin(), clients.end(), &client);
+		const auto index = (size_t)std::distance(clients.begin(), it);
+		clients.erase(it);
+		if (nextClient > index)
+			--nextClient;
+	}
+
+	void enqueue(Client& client, Job& job)
+	{
+		{
+			const juce::ScopedLock sl(lock);
+			jassert(job.state == Job::State::idle);
+			job.state = Job::State::queued;
+			job.exitSignalled.store(false);
+			job.finished.reset();
+			client.pending.push_back(&job);
+		}
+		jobAvailable.signal();
+	}
+
+	// Il prossimo Job del prossimo Client con lavoro in coda, a turno
+	Job* takeNextJob()
+	{
+		const juce::ScopedLock sl(lock);
+
+		for (size_t i = 0; i < clients.size(); ++i)
+		{
+			auto* client = clients[(nextClient + i) % clients.size()];
+			if (client->pending.empty())
+				continue;
+
+			auto* job = client->pending.front();
+			client->pending.pop_front();
+			client->running.push_back(job);
+			job->state = Job::State::running;
+			nextClient = (nextClient + i + 1) % clients.size();
+
+			// Altri lavori in coda: sveglia un altro thread
+			jobAvailable.signal();
+			return job;
+		}
+
+		return nullptr;
+	}
+
+	void runJob(Job& job)
+	{
+		job.run();
+
+		const juce::ScopedLock sl(lock);
+		for (auto* client : clients)
+		{
+			const auto it = std::find(client->running.begin(), client->running.end(), &job);
+			if (it != client->running.end())
+			{
+				client->running.erase(it);
+				break;
+			}
+		}
+
+		job.state = Job::State::idle;
+		job.finished.signal();
+	}
+
+	void remove(Job& job, bool interrupt)
+	{
+		{
+			const juce::ScopedLock sl(lock);
+
+			if (job.state == Job::State::idle)
+				return;
+
+			if (job.state == Job::State::queued && interrupt)
+			{
+				for (auto* client : clients)
+				{
+					auto& pending = client->pending;
+					pending.erase(std::remove(pending.begin(), pending.end(), &job), pending.end());
+				}
+
+				job.state = Job::State::idle;
+				job.finished.signal();
+				return;
+			}
+
+			if (interrupt)
+				job.exitSignalled.store(true);
+		}
+
+		job.finished.wait(-1);
+	}
+
+	void removeAll(Client& client)
+	{
+		std::vector<Job*> jobs;
+		{
+			const juce::ScopedLock sl(lock);
+			jobs.assign(client.pending.begin(), client.pending.end());
+			jobs.insert(jobs.end(), client.running.begin(), client.running.end());
+		}
+
+		for (auto* job : jobs)
+			remove(*job, true);
+	}
+
+	//==============================================================================
+	juce::CriticalSection lock;
+	std::vector<Client*> clients;
+	size_t nextClient = 0;
+	juce::WaitableEvent jobAvailable;
+	std::vector<std::unique_ptr<Worker>> workers;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedAnalysisPool)
+};
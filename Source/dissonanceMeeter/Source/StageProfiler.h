@@ -0,0 +1,202 @@
+/*
+	==============================================================================
+
+		StageProfiler.h
+
+		Profilatore del carico CPU per stadio del processBlock.
+
+		Il thread audio registra, per ogni blocco e ogni stadio, il tempo
+		speso come frazione della scadenza del blocco (numSamples / fs).
+		I valori finiscono in istogrammi lock-free a bin logaritmici
+		(BINS_PER_OCTAVE bin per ottava, da 2^MIN_LOG2 a 2^MAX_LOG2 della
+		scadenza): l'editor e i benchmark leggono p50 / p99 / max da
+		qualunque thread senza fermare l'audio.
+
+		Disattivato (nessuna lettura del timer) finche' non si chiama
+		setEnabled(true). Nessuna allocazione.
+
+	==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cmath>
+
+class StageProfiler
+{
+public:
+	//==============================================================================
+	enum Stage
+	{
+		AnalyserFeed = 0,   // alimentazione dell'analizzatore, senza analyseFrame
+		AnalyseFrame,       // FFT, picchi e dissonanza dei frame completati
+		Chain,              // Distortion -> BandPass
+		GainClip,           // guadagno master e soft clip
+		Meters,             // RMS e smoothing dei meter
+		Waveform,           // push verso l'AudioVisualiserComponent
+		Total,              // intero processBlock
+		NUM_STAGES
+	};
+
+	static constexpr int MIN_LOG2 = -15;          // ~0.003% della scadenza
+	static constexpr int MAX_LOG2 = 3;            // 800% della scadenza
+	static constexpr int BINS_PER_OCTAVE = 8;
+	static constexpr int NUM_BINS = (MAX_LOG2 - MIN_LOG2) * BINS_PER_OCTAVE + 2;  // + sotto/sopra soglia
+
+	// Percentuali della scadenza del blocco
+	struct Summary
+	{
+		float p50 = 0.0f;
+		float p99 = 0.0f;
+		float max = 0.0f;
+		juce::uint64 count = 0;
+	};
+
+	//==============================================================================
+	StageProfiler() noexcept { reset(); }
+
+	static const char* getStageName(int stage) noexcept
+	{
+		static constexpr const char* names[NUM_STAGES] = {
+			"analyser feed", "analyseFrame", "chain", "gain/clip", "meters", "waveform", "total"
+		};
+		return juce::isPositiveAndBelow(stage, (int)NUM_STAGES) ? names[stage] : "";
+	}
+
+	//==============================================================================
+	void setEnabled(bool shouldBeEnabled) noexcept { enabled.store(shouldBeEnabled, std::memory_order_relaxed); }
+	bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+
+	// Chiamato dal processor in prepareToPlay()
+	void prepare(double newSampleRate) noexcept { sampleRate.store(newSampleRate, std::memory_order_relaxed); }
+
+	//==============================================================================
+	// Thread audio: 'ticks' in unita' di juce::Time::getHighResolutionTicks()
+	void record(Stage stage, juce::int64 ticks, int numSamples) noexcept
+	{
+		if (numSamples <= 0)
+			return;
+
+		const double deadline = (double)numSamples / sampleRate.load(std::memory_order_relaxed);
+		const double load = (double)ticks * secondsPerTick / deadline;
+
+		auto& h = histograms[(size_t)stage];
+		h.bins[(size_t)binFor(load)].fetch_add(1, std::memory_order_relaxed);
+		h.count.fetch_add(1, std::memory_order_relaxed);
+
+		const float percent = (float)(load * 100.0);
+		if (percent > h.max.load(std::memory_order_relaxed))
+			h.max.store(percent, std::memory_order_relaxed);
+	}
+
+	// Cronometra uno stadio per la durata dello scope (solo se abilitato)
+	class ScopedTimer
+	{
+	public:
+		ScopedTimer(StageProfiler& p, Stage s, int n) noexcept
+			: profiler(p.isEnabled() ? &p : nullptr), stage(s), numSamples(n),
+			  start(profiler != nullptr ? juce::Time::getHighResolutionTicks() : 0)
+		{
+		}
+
+		~ScopedTimer() noexcept
+		{
+			if (profiler != nullptr)
+				profiler->record(stage, juce::Time::getHighResolutionTicks() - start, numSamples);
+		}
+
+	private:
+		StageProfiler* profiler;
+		Stage stage;
+		int numSamples;
+		juce::int64 start;
+
+		JUCE_DECLARE_NON_COPYABLE(ScopedTimer)
+	};
+
+	//==============================================================================
+	// Qualunque thread: percentili dal centro geometrico del bin
+	Summary getSummary(Stage stage) const noexcept
+	{
+		const auto& h = histograms[(size_t)stage];
+
+		std::array<juce::uint32, NUM_BINS> snapshot{};
+		juce::uint64 total = 0;
+		for (int b = 0; b < NUM_BINS; ++b)
+			total += (snapshot[(size_t)b] = h.bins[(size_t)b].load(std::memory_order_relaxed));
+
+		Summary summary;
+		summary.count = total;
+		summary.max = h.max.load(std::memory_order_relaxed);
+
+		if (total == 0)
+			return summary;
+
+		auto percentile = [&](double q)
+		{
+			const auto target = (juce::uint64)std::ceil(q * (double)total);
+			juce::uint64 cumulative = 0;
+			for (int b = 0; b < NUM_BINS; ++b)
+			{
+				cumulative += snapshot[(size_t)b];
+				if (cumulative >= target)
+					return juce::jmin(summary.max, binCentrePercent(b));
+			}
+			return summary.max;
+		};
+
+		summary.p50 = percentile(0.50);
+		summary.p99 = percentile(0.99);
+		return summary;
+	}
+
+	// Qualunque thread: i conteggi concorrenti persi durante l'azzeramento
+	// sono irrilevanti per una statistica
+	void reset() noexcept
+	{
+		for (auto& h : histograms)
+		{
+			for (auto& b : h.bins)
+				b.store(0, std::memory_order_relaxed);
+			h.count.store(0, std::memory_order_relaxed);
+			h.max.store(0.0f, std::memory_order_relaxed);
+		}
+	}
+
+private:
+	//==============================================================================
+	// Bin 0: sotto 2^MIN_LOG2; ultimo bin: da 2^MAX_LOG2 in su
+	static int binFor(double load) noexcept
+	{
+		if (load <= 0.0)
+			return 0;
+
+		const double position = (std::log2(load) - MIN_LOG2) * BINS_PER_OCTAVE;
+		return juce::jlimit(0, NUM_BINS - 1, position < 0.0 ? 0 : (int)position + 1);
+	}
+
+	static float binCentrePercent(int bin) noexcept
+	{
+		if (bin == 0)
+			return 0.0f;
+
+		const double log2Centre = MIN_LOG2 + ((double)(bin - 1) + 0.5) / BINS_PER_OCTAVE;
+		return (float)(std::exp2(log2Centre) * 100.0);
+	}
+
+	struct Histogram
+	{
+		std::array<std::atomic<juce::uint32>, NUM_BINS> bins;
+		std::atomic<juce::uint64> count{ 0 };
+		std::atomic<float> max{ 0.0f };
+	};
+
+	std::array<Histogram, NUM_STAGES> histograms;
+	std::atomic<bool>   enabled{ false };
+	std::atomic<double> sampleRate{ 44100.0 };
+	const double secondsPerTick = 1.0 / (double)juce::Time::getHighResolutionTicksPerSecond();
+
+	JUCE_DECLARE_NON_COPYABLE(StageProfiler)
+};
@@ -0,0 +1,150 @@
+/*
+	==============================================================================
+
+		StaticProcessorChain.h
+
+		Catena di processori composta a tempo di compilazione, nello stile di
+		juce::dsp::ProcessorChain, al posto di un juce::AudioProcessorGraph:
+			- gli stadi sono membri (std::tuple), non nodi allocati
+			- elaborazione in place sullo stesso buffer, nessun buffer intermedio
+			- nessuna connessione da ricostruire in prepareToPlay()
+			- gli stadi si ottengono con get<Index>() col tipo esatto, senza cast
+			- gli stadi si costruiscono di default o tutti con uno stesso argomento
+			- buffer float o double: ogni stadio deve fornire entrambi i processBlock()
+
+		L'ordine degli stadi e' una tabella di routing preallocata, codificata
+		in un'unica parola atomica (4 bit per stadio): setStageOrder() puo'
+		essere chiamato da qualunque thread e process() la legge una volta per
+		blocco, senza lock ne' letture parziali.
+
+	==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <tuple>
+#include <utility>
+
+template <typename... Processors>
+class StaticProcessorChain
+{
+public:
+	//==============================================================================
+	static constexpr int NUM_STAGES = (int)sizeof...(Processors);
+
+	static_assert (NUM_STAGES > 0 && NUM_STAGES <= 8, "La tabella di routing codifica al massimo 8 stadi");
+
+	using StageOrder = std::array<int, (size_t)NUM_STAGES>;
+
+	//==============================================================================
+	StaticProcessorChain() { setStageOrder(identityOrder()); }
+
+	// Costruisce ogni stadio con lo stesso argomento (es. l'albero dei
+	// parametri condiviso del plugin)
+	template <typename Argument>
+	explicit StaticProcessorChain(Argument& argument)
+		: processors(repeatFor<Processors>(argument)...)
+	{
+		setStageOrder(identityOrder());
+	}
+
+	template <int Index>
+	auto& get() noexcept { return std::get<(size_t)Index>(processors); }
+
+	template <int Index>
+	const auto& get() const noexcept { return std::get<(size_t)Index>(processors); }
+
+	//==============================================================================
+	void prepareToPlay(double sampleRate, int samplesPerBlock, int numChannels)
+	{
+		forEachStage([&](auto& p)
+		{
+			p.setPlayConfigDetails(numChannels, numChannels, sampleRate, samplesPerBlock);
+			p.prepareToPlay(sampleRate, samplesPerBlock);
+		});
+	}
+
+	void releaseResources() { forEachStage([](auto& p) { p.releaseResources(); }); }
+	void reset()            { forEachStage([](auto& p) { p.reset(); }); }
+
+	//==============================================================================
+	// Elabora il buffer in place attraversando gli stadi nell'ordine corrente
+	template <typename SampleType>
+	void process(juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midi)
+	{
+		const juce::uint32 order = routing.load(std::memory_order_acquire);
+
+		for (int s = 0; s < NUM_STAGES; ++s)
+			processStage((int)((order >> (4 * s)) & 0xfu), buffer, midi,
+				std::make_index_sequence<(size_t)NUM_STAGES>{});
+	}
+
+	//==============================================================================
+	// L'ordine deve essere una permutazione di 0..NUM_STAGES-1; altrimenti
+	// viene ignorato
+	bool setStageOrder(const StageOrder& order) noexcept
+	{
+		juce::uint32 packed = 0, seen = 0;
+
+		for (int s = 0; s < NUM_STAGES; ++s)
+		{
+			const int stage = order[(size_t)s];
+			if (stage < 0 || stage >= NUM_STAGES || (seen & (1u << stage)) != 0)
+				return false;
+
+			seen |= 1u << stage;
+			packed |= (juce::uint32)stage << (4 * s);
+		}
+
+		routing.store(packed, std::memory_order_release);
+		return true;
+	}
+
+	StageOrder getStageOrder() const noexcept
+	{
+		const juce::uint32 packed = routing.load(std::memory_order_acquire);
+		StageOrder order{};
+
+		for (int s = 0; s < NUM_STAGES; ++s)
+			order[(size_t)s] = (int)((packed >> (4 * s)) & 0xfu);
+
+		return order;
+	}
+
+	static StageOrder identityOrder() noexcept
+	{
+		StageOrder order{};
+		for (int s = 0; s < NUM_STAGES; ++s)
+			order[(size_t)s] = s;
+		return order;
+	}
+
+private:
+	//==============================================================================
+	// Ripete l'argomento del costruttore una volta per stadio
+	template <typename, typename Argument>
+	static Argument& repeatFor(Argument& argument) noexcept { return argument; }
+
+	template <typename Fn>
+	void forEachStage(Fn&& fn)
+	{
+		std::apply([&](auto&... p) { (fn(p), ...); }, processors);
+	}
+
+	// Dispatch sull'indice senza chiamate virtuali: ogni ramo chiama
+	// processBlock() sul tipo concreto (gli stadi sono final)
+	template <typename SampleType, size_t... Is>
+	void processStage(int index, juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midi,
+		std::index_sequence<Is...>)
+	{
+		(void)((index == (int)Is ? (std::get<Is>(processors).processBlock(buffer, midi), true) : false) || ...);
+	}
+
+	//==============================================================================
+	std::tuple<Processors...> processors;
+	std::atomic<juce::uint32> routing{ 0 };
+
+	JUCE_DECLARE_NON_COPYABLE(StaticProcessorChain)
+};
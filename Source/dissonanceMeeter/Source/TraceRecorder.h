@@ -0,0 +1,297 @@
+/*
+	==============================================================================
+
+		TraceRecorder.h
+
+		Registratore di timeline in formato Chrome trace (chrome://tracing,
+		ui.perfetto.dev), per correlare i picchi dell'analisi sul thread audio
+		con gli stalli dell'interfaccia.
+
+		Ogni thread che registra eventi riceve al primo uso un proprio ring
+		preallocato (single producer / single consumer), che torna libero a
+		ogni stop(): i thread che cambiano tra una registrazione e l'altra
+		(pool di worker dell'host) non esauriscono i ring. Registrare un evento
+		costa una lettura del timer e una scrittura nel ring, senza lock ne'
+		allocazioni. Un thread di scrittura in background svuota i ring ogni
+		WRITE_INTERVAL_MS e scrive gli eventi B/E come JSON sul file.
+
+		Uso:
+			tracer.start(file);                       // thread dei messaggi
+			{ TraceRecorder::ScopedEvent e(tracer, "processBlock"); ... }
+			tracer.stop();                            // chiude il JSON
+
+		Disattivato finche' non si chiama start(): ScopedEvent legge solo un
+		flag atomico. Se un ring e' pieno gli eventi vengono scartati e contati
+		(otherData.droppedEvents nel file).
+
+		Ogni start() apre una nuova sessione e ogni evento porta la sessione
+		letta prima del controllo di isRecording(): un evento scritto a
+		cavallo di stop() e start(), o la fine di uno ScopedEvent iniziato
+		nella registrazione precedente, non finisce nel file nuovo.
+
+	==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+
+class TraceRecorder
+{
+public:
+	//==============================================================================
+	static constexpr int MAX_THREADS = 8;
+	static constexpr int RING_SIZE = 1 << 13;           // eventi per thread (potenza di 2)
+	static constexpr int WRITE_INTERVAL_MS = 50;
+
+	TraceRecorder() = default;
+	~TraceRecorder() { stop(); }
+
+	//==============================================================================
+	// Thread dei messaggi: apre il file e avvia la scrittura in background.
+	// Restituisce false se il file non si puo' aprire.
+	bool start(const juce::File& file)
+	{
+		stop();
+
+		auto stream = std::make_unique<juce::FileOutputStream>(file);
+		if (! stream->openedOk())
+			return false;
+
+		stream->setPosition(0);
+		stream->truncate();
+		*stream << "{\"traceEvents\":[\n";
+
+		// I ring si allocano al primo start() e restano fino alla distruzione:
+		// un evento iniziato prima di stop() puo' ancora chiudersi dopo
+		if (rings == nullptr)
+			rings = std::make_unique<std::array<Ring, MAX_THREADS>>();
+
+		for (auto& ring : *rings)
+			ring.readIndex.store(ring.writeIndex.load(std::memory_order_acquire), std::memory_order_relaxed);
+
+		out = std::move(stream);
+		session.fetch_add(1, std::memory_order_acq_rel);
+		firstEvent = true;
+		labelledThreads = 0;
+		droppedEvents.store(0, std::memory_order_relaxed);
+		messageThread.store(juce::Thread::getCurrentThreadId(), std::memory_order_relaxed);
+		originTicks = juce::Time::getHighResolutionTicks();
+
+		recording.store(true, std::memory_order_release);
+		writer.startThread();
+		return true;
+	}
+
+	// Thread dei messaggi: ferma la scrittura, scarica gli ultimi eventi e
+	// chiude il JSON
+	void stop()
+	{
+		if (! recording.exchange(false, std::memory_order_acq_rel))
+			return;
+
+		writer.stopThread(1000);
+		drain();
+
+		// Ring liberi per la prossima registrazione, reclamati da chi registra
+		// per primo: gli eventi residui si scartano in start()
+		for (auto& ring : *rings)
+			ring.owner.store(nullptr, std::memory_order_release);
+
+		*out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":\""
+			 << juce::String((juce::int64)droppedEvents.load(std::memory_order_relaxed)) << "\"}}\n";
+		out->flush();
+		out.reset();
+	}
+
+	bool isRecording() const noexcept { return recording.load(std::memory_order_acquire); }
+
+	//==============================================================================
+	// Qualunque thread: 'name' deve restare valido (letterale stringa);
+	// 'ticks' in unita' di juce::Time::getHighResolutionTicks()
+	void begin(const char* name, juce::int64 ticks) noexcept { push(name, ticks, 'B', currentSession()); }
+	void end(const char* name, juce::int64 ticks) noexcept   { push(name, ticks, 'E', currentSession()); }
+
+	// Evento B/E che copre lo scope; la fine viene registrata solo se lo e'
+	// stato anche l'inizio, e nella stessa sessione
+	class ScopedEvent
+	{
+	public:
+		ScopedEvent(TraceRecorder& t, const char* n) noexcept
+			: session(t.currentSession()), tracer(t.isRecording() ? &t : nullptr), name(n)
+		{
+			if (tracer != nullptr)
+				tracer->push(name, juce::Time::getHighResolutionTicks(), 'B', session);
+		}
+
+		~ScopedEvent() noexcept
+		{
+			if (tracer != nullptr)
+				tracer->push(name, juce::Time::getHighResolutionTicks(), 'E', session);
+		}
+
+	private:
+		const juce::uint32 session;
+		TraceRecorder* tracer;
+		const char* name;
+
+		JUCE_DECLARE_NON_COPYABLE(ScopedEvent)
+	};
+
+private:
+	//==============================================================================
+	struct Event
+	{
+		const char* name;
+		juce::int64 ticks;
+		char phase;
+		juce::uint32 session;   // sessione letta prima di isRecording()
+	};
+
+	struct Ring
+	{
+		std::atomic<juce::Thread::ThreadID> owner{ nullptr };
+		std::atomic<bool> isMessageThread{ false };
+		std::atomic<int>  writeIndex{ 0 };   // solo il thread proprietario
+		std::atomic<int>  readIndex{ 0 };    // solo il thread di scrittura
+		std::array<Event, RING_SIZE> events{};
+	};
+
+	//==============================================================================
+	juce::uint32 currentSession() const noexcept { return session.load(std::memory_order_acquire); }
+
+	// eventSession va letta prima di isRecording(): se nel frattempo stop() e
+	// start() si sono alternati, l'evento resta della sessione vecchia
+	void push(const char* name, juce::int64 ticks, char phase, juce::uint32 eventSession) noexcept
+	{
+		if (! isRecording())
+			return;
+
+		auto* ring = ringForCurrentThread();
+		if (ring == nullptr)
+		{
+			droppedEvents.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		const int w = ring->writeIndex.load(std::memory_order_relaxed);
+		if (w - ring->readIndex.load(std::memory_order_acquire) >= RING_SIZE)
+		{
+			droppedEvents.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		ring->events[(size_t)(w & (RING_SIZE - 1))] = { name, ticks, phase, eventSession };
+		ring->writeIndex.store(w + 1, std::memory_order_release);
+	}
+
+	// Cerca il ring del thread corrente; al primo evento della registrazione
+	// ne reclama uno libero (nessuna allocazione). nullptr se in questa
+	// registrazione hanno gia' registrato MAX_THREADS thread.
+	Ring* ringForCurrentThread() noexcept
+	{
+		const auto id = juce::Thread::getCurrentThreadId();
+
+		for (auto& ring : *rings)
+			if (ring.owner.load(std::memory_order_acquire) == id)
+				return &ring;
+
+		for (auto& ring : *rings)
+		{
+			juce::Thread::ThreadID expected = nullptr;
+			if (ring.owner.compare_exchange_strong(expected, id, std::memory_order_acq_rel))
+			{
+				// Niente MessageManager qui: isThisTheMessageThread() puo' prendere un lock
+				ring.isMessageThread.store(id == messageThread.load(std::memory_order_relaxed), std::memory_order_relaxed);
+				return &ring;
+			}
+		}
+
+		return nullptr;
+	}
+
+	//==============================================================================
+	// Thread di scrittura (o stop()): converte gli eventi in JSON
+	void drain()
+	{
+		const auto current = currentSession();
+
+		for (int tid = 0; tid < MAX_THREADS; ++tid)
+		{
+			auto& ring = (*rings)[(size_t)tid];
+			const int w = ring.writeIndex.load(std::memory_order_acquire);
+			int r = ring.readIndex.load(std::memory_order_relaxed);
+			if (r == w)
+				continue;
+
+			if ((labelledThreads & (1u << tid)) == 0)
+			{
+				labelledThreads |= 1u << tid;
+				const juce::String label = ring.isMessageThread.load(std::memory_order_relaxed)
+					? juce::String("message thread") : "audio/worker thread " + juce::String(tid);
+				writeEvent("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + juce::String(tid)
+					+ ",\"args\":{\"name\":\"" + label + "\"}}");
+			}
+
+			for (; r != w; ++r)
+			{
+				const auto& e = ring.events[(size_t)(r & (RING_SIZE - 1))];
+				if (e.session != current)
+					continue;
+
+				const double micros = juce::Time::highResolutionTicksToSeconds(e.ticks - originTicks) * 1.0e6;
+				writeEvent("{\"name\":\"" + juce::String(e.name) + "\",\"ph\":\"" + juce::String::charToString(e.phase)
+					+ "\",\"ts\":" + juce::String(micros, 3) + ",\"pid\":1,\"tid\":" + juce::String(tid) + "}");
+			}
+
+			ring.readIndex.store(w, std::memory_order_release);
+		}
+
+		out->flush();
+	}
+
+	void writeEvent(const juce::String& json)
+	{
+		if (! firstEvent)
+			*out << ",\n";
+		firstEvent = false;
+		*out << json;
+	}
+
+	class Writer : public juce::Thread
+	{
+	public:
+		explicit Writer(TraceRecorder& o) : juce::Thread("Trace writer"), owner(o) {}
+
+		void run() override
+		{
+			while (! threadShouldExit())
+			{
+				wait(WRITE_INTERVAL_MS);
+				owner.drain();
+			}
+		}
+
+	private:
+		TraceRecorder& owner;
+	};
+
+	//==============================================================================
+	std::unique_ptr<std::array<Ring, MAX_THREADS>> rings;
+	std::atomic<bool>        recording{ false };
+	std::atomic<juce::uint32> session{ 0 };   // incrementata da ogni start()
+	std::atomic<juce::int64> droppedEvents{ 0 };
+	std::atomic<juce::Thread::ThreadID> messageThread{ nullptr };   // chi ha chiamato start()
+	juce::int64              originTicks = 0;
+
+	// Solo thread di scrittura (o stop(), a scrittura ferma)
+	std::unique_ptr<juce::FileOutputStream> out;
+	bool         firstEvent = true;
+	juce::uint32 labelledThreads = 0;
+
+	Writer writer{ *this };
+
+	JUCE_DECLARE_NON_COPYABLE(TraceRecorder)
+};